@@ -0,0 +1,894 @@
+//
+//  BatchCompulations.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchCompulations.h"
+#include "Compulations.h"
+#include "SIMDMath.h"
+#include "UnitConversion.h"
+
+#include <stdatomic.h>
+
+// Records are transposed into arrays of this many entries at a time.
+#define RECORD_BLOCK_SIZE 64
+
+// SIMD level selection
+
+static _Atomic int selectedSIMDLevel = -1;
+
+CompulationsSIMDLevel compulationsDetectedSIMDLevel(void)
+{
+    CompulationsSIMDLevel level = CompulationsSIMDLevelScalar;
+
+#if COMPULATIONS_HAVE_X86_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        level = CompulationsSIMDLevelAVX512;
+    }
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        level = CompulationsSIMDLevelAVX2;
+    }
+#endif
+
+    return level;
+}
+
+CompulationsSIMDLevel compulationsSIMDLevel(void)
+{
+    int level = atomic_load_explicit(&selectedSIMDLevel, memory_order_relaxed);
+
+    if (level < 0)
+    {
+        level = compulationsDetectedSIMDLevel();
+        atomic_store_explicit(&selectedSIMDLevel, level, memory_order_relaxed);
+    }
+
+    return (CompulationsSIMDLevel)level;
+}
+
+void compulationsSetSIMDLevel(CompulationsSIMDLevel level)
+{
+    CompulationsSIMDLevel detected = compulationsDetectedSIMDLevel();
+
+    if (level > detected)
+    {
+        level = detected;
+    }
+
+    atomic_store_explicit(&selectedSIMDLevel, level, memory_order_relaxed);
+}
+
+// ACFM SCFM conversions
+
+static void flowConversionScalar(const FlowConversionArrays *in,
+                                 double *out,
+                                 size_t start,
+                                 size_t count,
+                                 int toStandard)
+{
+    for (size_t i = start; i < count; i++)
+    {
+        if (toStandard)
+        {
+            out[i] = scfmFromACFM(in->flowCFM[i],
+                                  in->standardAmbientPressurePSI[i],
+                                  in->standardAmbientTempF[i],
+                                  in->standardAmbientRH[i],
+                                  in->siteAmbientPressurePSI[i],
+                                  in->siteAmbientTempF[i],
+                                  in->siteAmbientRH[i],
+                                  in->inletPressurePSI[i]);
+        }
+        else
+        {
+            out[i] = acfmFromSCFM(in->flowCFM[i],
+                                  in->standardAmbientPressurePSI[i],
+                                  in->standardAmbientTempF[i],
+                                  in->standardAmbientRH[i],
+                                  in->siteAmbientPressurePSI[i],
+                                  in->siteAmbientTempF[i],
+                                  in->siteAmbientRH[i],
+                                  in->inletPressurePSI[i]);
+        }
+    }
+}
+
+#if COMPULATIONS_HAVE_X86_SIMD
+
+COMPULATIONS_TARGET_AVX2
+static __m256d vaporPressureOfWaterInPsiForTempAVX2(__m256d degreesFahrenheit)
+{
+    __m256d tempC = _mm256_mul_pd(_mm256_sub_pd(degreesFahrenheit, _mm256_set1_pd(32.0)), _mm256_set1_pd(5.0 / 9.0));
+
+    // Same Antoine constant switch as the scalar function, done with a blend
+    __m256d low = _mm256_cmp_pd(tempC, _mm256_set1_pd(100.0), _CMP_LE_OQ);
+    __m256d conA = _mm256_blendv_pd(_mm256_set1_pd(8.14019), _mm256_set1_pd(8.07131), low);
+    __m256d conB = _mm256_blendv_pd(_mm256_set1_pd(1810.94), _mm256_set1_pd(1730.63), low);
+    __m256d conC = _mm256_blendv_pd(_mm256_set1_pd(244.485), _mm256_set1_pd(233.426), low);
+
+    __m256d exponent = _mm256_sub_pd(conA, _mm256_div_pd(conB, _mm256_add_pd(conC, tempC)));
+
+    return _mm256_mul_pd(simdExp10AVX2(exponent), _mm256_set1_pd(0.0193367747));
+}
+
+COMPULATIONS_TARGET_AVX2
+static void flowConversionAVX2(const FlowConversionArrays *in,
+                               double *out,
+                               size_t count,
+                               int toStandard)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d flow = _mm256_loadu_pd(in->flowCFM + i);
+        __m256d stdP = _mm256_loadu_pd(in->standardAmbientPressurePSI + i);
+        __m256d stdT = _mm256_loadu_pd(in->standardAmbientTempF + i);
+        __m256d stdRH = _mm256_loadu_pd(in->standardAmbientRH + i);
+        __m256d siteP = _mm256_loadu_pd(in->siteAmbientPressurePSI + i);
+        __m256d siteT = _mm256_loadu_pd(in->siteAmbientTempF + i);
+        __m256d siteRH = _mm256_loadu_pd(in->siteAmbientRH + i);
+        __m256d inletP = _mm256_loadu_pd(in->inletPressurePSI + i);
+
+        __m256d rhNumerator = _mm256_sub_pd(stdP, _mm256_mul_pd(stdRH, vaporPressureOfWaterInPsiForTempAVX2(stdT)));
+        __m256d rhDenominator = _mm256_sub_pd(siteP, _mm256_mul_pd(siteRH, vaporPressureOfWaterInPsiForTempAVX2(siteT)));
+        __m256d rhMultiplier = _mm256_div_pd(rhNumerator, rhDenominator);
+        __m256d rankine = _mm256_set1_pd(459.67);
+        __m256d tempMultiplier = _mm256_div_pd(_mm256_add_pd(siteT, rankine), _mm256_add_pd(stdT, rankine));
+        __m256d inletPressureMultiplier = _mm256_div_pd(siteP, inletP);
+
+        __m256d result;
+
+        if (toStandard)
+        {
+            result = _mm256_div_pd(_mm256_div_pd(_mm256_div_pd(flow, rhMultiplier), tempMultiplier), inletPressureMultiplier);
+        }
+        else
+        {
+            result = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(flow, rhMultiplier), tempMultiplier), inletPressureMultiplier);
+        }
+
+        _mm256_storeu_pd(out + i, result);
+    }
+
+    flowConversionScalar(in, out, i, count, toStandard);
+}
+
+COMPULATIONS_TARGET_AVX512
+static __m512d vaporPressureOfWaterInPsiForTempAVX512(__m512d degreesFahrenheit)
+{
+    __m512d tempC = _mm512_mul_pd(_mm512_sub_pd(degreesFahrenheit, _mm512_set1_pd(32.0)), _mm512_set1_pd(5.0 / 9.0));
+
+    __mmask8 low = _mm512_cmp_pd_mask(tempC, _mm512_set1_pd(100.0), _CMP_LE_OQ);
+    __m512d conA = _mm512_mask_blend_pd(low, _mm512_set1_pd(8.14019), _mm512_set1_pd(8.07131));
+    __m512d conB = _mm512_mask_blend_pd(low, _mm512_set1_pd(1810.94), _mm512_set1_pd(1730.63));
+    __m512d conC = _mm512_mask_blend_pd(low, _mm512_set1_pd(244.485), _mm512_set1_pd(233.426));
+
+    __m512d exponent = _mm512_sub_pd(conA, _mm512_div_pd(conB, _mm512_add_pd(conC, tempC)));
+
+    return _mm512_mul_pd(simdExp10AVX512(exponent), _mm512_set1_pd(0.0193367747));
+}
+
+COMPULATIONS_TARGET_AVX512
+static void flowConversionAVX512(const FlowConversionArrays *in,
+                                 double *out,
+                                 size_t count,
+                                 int toStandard)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m512d flow = _mm512_loadu_pd(in->flowCFM + i);
+        __m512d stdP = _mm512_loadu_pd(in->standardAmbientPressurePSI + i);
+        __m512d stdT = _mm512_loadu_pd(in->standardAmbientTempF + i);
+        __m512d stdRH = _mm512_loadu_pd(in->standardAmbientRH + i);
+        __m512d siteP = _mm512_loadu_pd(in->siteAmbientPressurePSI + i);
+        __m512d siteT = _mm512_loadu_pd(in->siteAmbientTempF + i);
+        __m512d siteRH = _mm512_loadu_pd(in->siteAmbientRH + i);
+        __m512d inletP = _mm512_loadu_pd(in->inletPressurePSI + i);
+
+        __m512d rhNumerator = _mm512_sub_pd(stdP, _mm512_mul_pd(stdRH, vaporPressureOfWaterInPsiForTempAVX512(stdT)));
+        __m512d rhDenominator = _mm512_sub_pd(siteP, _mm512_mul_pd(siteRH, vaporPressureOfWaterInPsiForTempAVX512(siteT)));
+        __m512d rhMultiplier = _mm512_div_pd(rhNumerator, rhDenominator);
+        __m512d rankine = _mm512_set1_pd(459.67);
+        __m512d tempMultiplier = _mm512_div_pd(_mm512_add_pd(siteT, rankine), _mm512_add_pd(stdT, rankine));
+        __m512d inletPressureMultiplier = _mm512_div_pd(siteP, inletP);
+
+        __m512d result;
+
+        if (toStandard)
+        {
+            result = _mm512_div_pd(_mm512_div_pd(_mm512_div_pd(flow, rhMultiplier), tempMultiplier), inletPressureMultiplier);
+        }
+        else
+        {
+            result = _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(flow, rhMultiplier), tempMultiplier), inletPressureMultiplier);
+        }
+
+        _mm512_storeu_pd(out + i, result);
+    }
+
+    flowConversionScalar(in, out, i, count, toStandard);
+}
+
+#endif // COMPULATIONS_HAVE_X86_SIMD
+
+static void flowConversionArrays(const FlowConversionArrays *input,
+                                 double *out,
+                                 size_t count,
+                                 int toStandard)
+{
+    switch (compulationsSIMDLevel())
+    {
+#if COMPULATIONS_HAVE_X86_SIMD
+        case CompulationsSIMDLevelAVX512:
+            flowConversionAVX512(input, out, count, toStandard);
+            break;
+
+        case CompulationsSIMDLevelAVX2:
+            flowConversionAVX2(input, out, count, toStandard);
+            break;
+#endif
+        default:
+            flowConversionScalar(input, out, 0, count, toStandard);
+            break;
+    }
+}
+
+static void flowConversionRecords(const FlowConversionRecord *records,
+                                  double *out,
+                                  size_t count,
+                                  int toStandard)
+{
+    double columns[8][RECORD_BLOCK_SIZE];
+
+    FlowConversionArrays block = {
+        columns[0], columns[1], columns[2], columns[3],
+        columns[4], columns[5], columns[6], columns[7]
+    };
+
+    for (size_t start = 0; start < count; start += RECORD_BLOCK_SIZE)
+    {
+        size_t blockCount = count - start < RECORD_BLOCK_SIZE ? count - start : RECORD_BLOCK_SIZE;
+
+        for (size_t i = 0; i < blockCount; i++)
+        {
+            const FlowConversionRecord *record = &records[start + i];
+
+            columns[0][i] = record->flowCFM;
+            columns[1][i] = record->standardAmbientPressurePSI;
+            columns[2][i] = record->standardAmbientTempF;
+            columns[3][i] = record->standardAmbientRH;
+            columns[4][i] = record->siteAmbientPressurePSI;
+            columns[5][i] = record->siteAmbientTempF;
+            columns[6][i] = record->siteAmbientRH;
+            columns[7][i] = record->inletPressurePSI;
+        }
+
+        flowConversionArrays(&block, out + start, blockCount, toStandard);
+    }
+}
+
+void scfmFromACFMArrays(const FlowConversionArrays *input,
+                        double *scfm,
+                        size_t count)
+{
+    flowConversionArrays(input, scfm, count, 1);
+}
+
+void acfmFromSCFMArrays(const FlowConversionArrays *input,
+                        double *acfm,
+                        size_t count)
+{
+    flowConversionArrays(input, acfm, count, 0);
+}
+
+void scfmFromACFMRecords(const FlowConversionRecord *records,
+                         double *scfm,
+                         size_t count)
+{
+    flowConversionRecords(records, scfm, count, 1);
+}
+
+void acfmFromSCFMRecords(const FlowConversionRecord *records,
+                         double *acfm,
+                         size_t count)
+{
+    flowConversionRecords(records, acfm, count, 0);
+}
+
+// Pressure-Altitude relationship
+
+void ambientPSIAForAltitudeInFeetArray(const double *altitude,
+                                       double *ambientPSIA,
+                                       size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        ambientPSIA[i] = ambientPSIAForAltitudeInFeetFast(altitude[i]);
+    }
+}
+
+void altitudeFeetFromPSIAArray(const double *psia,
+                               double *altitude,
+                               size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        altitude[i] = altitudeFeetFromPSIAFast(psia[i]);
+    }
+}
+
+// Optimal operating temperature for oil flooded screw
+
+static void operatingTempScalar(const double *inletTempF,
+                                const double *dischargePressurePSIG,
+                                const double *ambientPSIA,
+                                double *operatingTempF,
+                                double *pressureDewPointC,
+                                size_t start,
+                                size_t count)
+{
+    for (size_t i = start; i < count; i++)
+    {
+        double tempF = oilFloodedScrewOperatingTempF(inletTempF[i], dischargePressurePSIG[i], ambientPSIA[i]);
+
+        operatingTempF[i] = tempF;
+
+        if (pressureDewPointC)
+        {
+            pressureDewPointC[i] = celsiusFromFahrenheit(tempF);
+        }
+    }
+}
+
+#if COMPULATIONS_HAVE_X86_SIMD
+
+// log(x / c) is computed as log(x) - log(c) so each lane needs one log.
+#define LN_6_1121 1.81027041298692
+#define LN_6_1115 1.8101722422351805
+#define LN_6_115  1.8107447691391356
+
+COMPULATIONS_TARGET_AVX2
+static void operatingTempAVX2(const double *inletTempF,
+                              const double *dischargePressurePSIG,
+                              const double *ambientPSIA,
+                              double *operatingTempF,
+                              double *pressureDewPointC,
+                              size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d inlet = _mm256_loadu_pd(inletTempF + i);
+        __m256d discharge = _mm256_loadu_pd(dischargePressurePSIG + i);
+        __m256d ambient = _mm256_loadu_pd(ambientPSIA + i);
+
+        __m256d psiaLine = _mm256_add_pd(discharge, ambient);
+        __m256d ambientTemp = _mm256_mul_pd(_mm256_sub_pd(inlet, _mm256_set1_pd(32.0)), _mm256_set1_pd(5.0 / 9.0));
+
+        // Saturation pressure over ice below 0 PSIG, over water otherwise
+        __m256d ice = _mm256_cmp_pd(discharge, _mm256_setzero_pd(), _CMP_LT_OQ);
+        __m256d conA = _mm256_blendv_pd(_mm256_set1_pd(6.1121), _mm256_set1_pd(6.1115), ice);
+        __m256d conB = _mm256_blendv_pd(_mm256_set1_pd(17.502), _mm256_set1_pd(22.452), ice);
+        __m256d conC = _mm256_blendv_pd(_mm256_set1_pd(240.9), _mm256_set1_pd(272.55), ice);
+
+        __m256d opTempC = _mm256_mul_pd(conA, simdExpAVX2(_mm256_div_pd(_mm256_mul_pd(conB, ambientTemp), _mm256_add_pd(conC, ambientTemp))));
+        opTempC = _mm256_mul_pd(opTempC, _mm256_div_pd(psiaLine, ambient));
+
+        __m256d logOpTemp = simdLogAVX2(opTempC);
+        __m256d logHi = _mm256_sub_pd(logOpTemp, _mm256_set1_pd(LN_6_1121));
+        __m256d hiNumerator = _mm256_mul_pd(logHi, _mm256_set1_pd(240.9));
+        __m256d hiDenominator = _mm256_sub_pd(_mm256_set1_pd(17.502), logHi);
+        __m256d logLo = _mm256_sub_pd(logOpTemp, _mm256_set1_pd(LN_6_1115));
+        __m256d loNumerator = _mm256_mul_pd(logLo, _mm256_set1_pd(272.55));
+        __m256d loDenominator = _mm256_sub_pd(_mm256_set1_pd(22.452), _mm256_sub_pd(logOpTemp, _mm256_set1_pd(LN_6_115)));
+
+        // pdpHi < 0 exactly when its numerator and denominator differ in sign,
+        // so the branch is picked before the one division.
+        __m256d negative = _mm256_xor_pd(_mm256_cmp_pd(hiNumerator, _mm256_setzero_pd(), _CMP_LT_OQ),
+                                         _mm256_cmp_pd(hiDenominator, _mm256_setzero_pd(), _CMP_LT_OQ));
+        __m256d pdp = _mm256_div_pd(_mm256_blendv_pd(hiNumerator, loNumerator, negative),
+                                    _mm256_blendv_pd(hiDenominator, loDenominator, negative));
+
+        _mm256_storeu_pd(operatingTempF + i, _mm256_add_pd(_mm256_mul_pd(pdp, _mm256_set1_pd(1.8)), _mm256_set1_pd(32.0)));
+
+        if (pressureDewPointC)
+        {
+            _mm256_storeu_pd(pressureDewPointC + i, pdp);
+        }
+    }
+
+    operatingTempScalar(inletTempF, dischargePressurePSIG, ambientPSIA, operatingTempF, pressureDewPointC, i, count);
+}
+
+COMPULATIONS_TARGET_AVX512
+static void operatingTempAVX512(const double *inletTempF,
+                                const double *dischargePressurePSIG,
+                                const double *ambientPSIA,
+                                double *operatingTempF,
+                                double *pressureDewPointC,
+                                size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m512d inlet = _mm512_loadu_pd(inletTempF + i);
+        __m512d discharge = _mm512_loadu_pd(dischargePressurePSIG + i);
+        __m512d ambient = _mm512_loadu_pd(ambientPSIA + i);
+
+        __m512d psiaLine = _mm512_add_pd(discharge, ambient);
+        __m512d ambientTemp = _mm512_mul_pd(_mm512_sub_pd(inlet, _mm512_set1_pd(32.0)), _mm512_set1_pd(5.0 / 9.0));
+
+        __mmask8 ice = _mm512_cmp_pd_mask(discharge, _mm512_setzero_pd(), _CMP_LT_OQ);
+        __m512d conA = _mm512_mask_blend_pd(ice, _mm512_set1_pd(6.1121), _mm512_set1_pd(6.1115));
+        __m512d conB = _mm512_mask_blend_pd(ice, _mm512_set1_pd(17.502), _mm512_set1_pd(22.452));
+        __m512d conC = _mm512_mask_blend_pd(ice, _mm512_set1_pd(240.9), _mm512_set1_pd(272.55));
+
+        __m512d opTempC = _mm512_mul_pd(conA, simdExpAVX512(_mm512_div_pd(_mm512_mul_pd(conB, ambientTemp), _mm512_add_pd(conC, ambientTemp))));
+        opTempC = _mm512_mul_pd(opTempC, _mm512_div_pd(psiaLine, ambient));
+
+        __m512d logOpTemp = simdLogAVX512(opTempC);
+        __m512d logHi = _mm512_sub_pd(logOpTemp, _mm512_set1_pd(LN_6_1121));
+        __m512d hiNumerator = _mm512_mul_pd(logHi, _mm512_set1_pd(240.9));
+        __m512d hiDenominator = _mm512_sub_pd(_mm512_set1_pd(17.502), logHi);
+        __m512d logLo = _mm512_sub_pd(logOpTemp, _mm512_set1_pd(LN_6_1115));
+        __m512d loNumerator = _mm512_mul_pd(logLo, _mm512_set1_pd(272.55));
+        __m512d loDenominator = _mm512_sub_pd(_mm512_set1_pd(22.452), _mm512_sub_pd(logOpTemp, _mm512_set1_pd(LN_6_115)));
+
+        __mmask8 negative = _mm512_cmp_pd_mask(hiNumerator, _mm512_setzero_pd(), _CMP_LT_OQ) ^
+                            _mm512_cmp_pd_mask(hiDenominator, _mm512_setzero_pd(), _CMP_LT_OQ);
+        __m512d pdp = _mm512_div_pd(_mm512_mask_blend_pd(negative, hiNumerator, loNumerator),
+                                    _mm512_mask_blend_pd(negative, hiDenominator, loDenominator));
+
+        _mm512_storeu_pd(operatingTempF + i, _mm512_add_pd(_mm512_mul_pd(pdp, _mm512_set1_pd(1.8)), _mm512_set1_pd(32.0)));
+
+        if (pressureDewPointC)
+        {
+            _mm512_storeu_pd(pressureDewPointC + i, pdp);
+        }
+    }
+
+    operatingTempScalar(inletTempF, dischargePressurePSIG, ambientPSIA, operatingTempF, pressureDewPointC, i, count);
+}
+
+#endif // COMPULATIONS_HAVE_X86_SIMD
+
+void oilFloodedScrewOperatingTempFArray(const double *inletTempF,
+                                        const double *dischargePressurePSIG,
+                                        const double *ambientPSIA,
+                                        double *operatingTempF,
+                                        double *pressureDewPointC,
+                                        size_t count)
+{
+    switch (compulationsSIMDLevel())
+    {
+#if COMPULATIONS_HAVE_X86_SIMD
+        case CompulationsSIMDLevelAVX512:
+            operatingTempAVX512(inletTempF, dischargePressurePSIG, ambientPSIA, operatingTempF, pressureDewPointC, count);
+            break;
+
+        case CompulationsSIMDLevelAVX2:
+            operatingTempAVX2(inletTempF, dischargePressurePSIG, ambientPSIA, operatingTempF, pressureDewPointC, count);
+            break;
+#endif
+        default:
+            operatingTempScalar(inletTempF, dischargePressurePSIG, ambientPSIA, operatingTempF, pressureDewPointC, 0, count);
+            break;
+    }
+}
+
+// Guarded functions with validity masks
+//
+// Each kernel covers calls [start, end), at most 64 of them, and returns the
+// validity bits for them starting at bit 0. The guards are evaluated as
+// masks and the result is masked to 0.0, so a lane that fails divides by
+// zero harmlessly instead of branching.
+
+typedef uint64_t (*MaskedKernel)(const double *const *arguments, double *results, size_t start, size_t end);
+
+static size_t runMaskedKernel(MaskedKernel scalar,
+                              MaskedKernel avx2,
+                              MaskedKernel avx512,
+                              const double *const *arguments,
+                              double *results,
+                              uint64_t *valid,
+                              size_t count)
+{
+    MaskedKernel kernel = scalar;
+
+    switch (compulationsSIMDLevel())
+    {
+        case CompulationsSIMDLevelAVX512:
+            kernel = avx512 ? avx512 : scalar;
+            break;
+
+        case CompulationsSIMDLevelAVX2:
+            kernel = avx2 ? avx2 : scalar;
+            break;
+
+        default:
+            break;
+    }
+
+    size_t validCount = 0;
+
+    for (size_t start = 0; start < count; start += 64)
+    {
+        size_t end = count - start < 64 ? count : start + 64;
+        uint64_t word = kernel(arguments, results, start, end);
+
+        validCount += (size_t)__builtin_popcountll(word);
+
+        if (valid)
+        {
+            valid[start / 64] = word;
+        }
+    }
+
+    return validCount;
+}
+
+static uint64_t refillRateScalar(const double *const *a, double *cfm, size_t start, size_t end)
+{
+    uint64_t word = 0;
+
+    for (size_t i = start; i < end; i++)
+    {
+        double deltaP = a[2][i] - a[1][i];
+        uint64_t ok = (deltaP > 0.0) & (a[0][i] > 0.0) & (a[3][i] > 0.0) & (a[4][i] > 0.0);
+        double value = (a[0][i] * deltaP) / (a[3][i] * a[4][i]);
+
+        cfm[i] = ok ? value : 0.0;
+        word |= ok << (i - start);
+    }
+
+    return word;
+}
+
+static uint64_t eventStorageScalar(const double *const *a, double *volumeCF, size_t start, size_t end)
+{
+    uint64_t word = 0;
+
+    for (size_t i = start; i < end; i++)
+    {
+        double deltaP = a[4][i] - a[5][i];
+        double deltaV = a[1][i] - a[2][i];
+        uint64_t ok = (a[0][i] > 0.0) & (deltaV > 0.0) & (deltaP > 0.0) & (a[3][i] > 0.0);
+        double value = (a[0][i] * deltaV * a[3][i]) / deltaP;
+
+        volumeCF[i] = ok ? value : 0.0;
+        word |= ok << (i - start);
+    }
+
+    return word;
+}
+
+static uint64_t oilCarryoverScalar(const double *const *a, double *gallons, size_t start, size_t end)
+{
+    uint64_t word = 0;
+
+    for (size_t i = start; i < end; i++)
+    {
+        uint64_t ok = (a[0][i] > 0.0) & (a[1][i] > 0.0) & (a[2][i] > 0.0) & (a[3][i] > 0.0);
+        double value = (a[1][i] * a[0][i] * a[2][i] * 60.0 * 0.0000012) / (a[3][i] * 128.0);
+
+        gallons[i] = ok ? value : 0.0;
+        word |= ok << (i - start);
+    }
+
+    return word;
+}
+
+static uint64_t velocityScalar(const double *const *a, double *fps, size_t start, size_t end)
+{
+    uint64_t word = 0;
+
+    for (size_t i = start; i < end; i++)
+    {
+        uint64_t ok = (a[0][i] > 0.0) & (a[1][i] > 0.0) & (a[2][i] > 0.0) & (a[3][i] > 0.0);
+        double compressionRatio = a[2][i] / (a[1][i] + a[2][i]);
+        double pipeArea = (a[3][i] / 24.0) * (a[3][i] / 24.0);
+        double value = (a[0][i] * compressionRatio) / (60.0 * M_PI * pipeArea);
+
+        fps[i] = ok ? value : 0.0;
+        word |= ok << (i - start);
+    }
+
+    return word;
+}
+
+#if COMPULATIONS_HAVE_X86_SIMD
+
+#define GT_ZERO_AVX2(x) _mm256_cmp_pd((x), _mm256_setzero_pd(), _CMP_GT_OQ)
+#define GT_ZERO_AVX512(x) _mm512_cmp_pd_mask((x), _mm512_setzero_pd(), _CMP_GT_OQ)
+
+COMPULATIONS_TARGET_AVX2
+static uint64_t refillRateAVX2(const double *const *a, double *cfm, size_t start, size_t end)
+{
+    uint64_t word = 0;
+    size_t i = start;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m256d storage = _mm256_loadu_pd(a[0] + i);
+        __m256d deltaP = _mm256_sub_pd(_mm256_loadu_pd(a[2] + i), _mm256_loadu_pd(a[1] + i));
+        __m256d refillTime = _mm256_loadu_pd(a[3] + i);
+        __m256d ambient = _mm256_loadu_pd(a[4] + i);
+
+        __m256d ok = _mm256_and_pd(_mm256_and_pd(GT_ZERO_AVX2(deltaP), GT_ZERO_AVX2(storage)),
+                                   _mm256_and_pd(GT_ZERO_AVX2(refillTime), GT_ZERO_AVX2(ambient)));
+        __m256d value = _mm256_div_pd(_mm256_mul_pd(storage, deltaP), _mm256_mul_pd(refillTime, ambient));
+
+        _mm256_storeu_pd(cfm + i, _mm256_and_pd(value, ok));
+        word |= (uint64_t)_mm256_movemask_pd(ok) << (i - start);
+    }
+
+    return i < end ? word | refillRateScalar(a, cfm, i, end) << (i - start) : word;
+}
+
+COMPULATIONS_TARGET_AVX512
+static uint64_t refillRateAVX512(const double *const *a, double *cfm, size_t start, size_t end)
+{
+    uint64_t word = 0;
+    size_t i = start;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m512d storage = _mm512_loadu_pd(a[0] + i);
+        __m512d deltaP = _mm512_sub_pd(_mm512_loadu_pd(a[2] + i), _mm512_loadu_pd(a[1] + i));
+        __m512d refillTime = _mm512_loadu_pd(a[3] + i);
+        __m512d ambient = _mm512_loadu_pd(a[4] + i);
+
+        __mmask8 ok = GT_ZERO_AVX512(deltaP) & GT_ZERO_AVX512(storage) & GT_ZERO_AVX512(refillTime) & GT_ZERO_AVX512(ambient);
+        __m512d value = _mm512_div_pd(_mm512_mul_pd(storage, deltaP), _mm512_mul_pd(refillTime, ambient));
+
+        _mm512_storeu_pd(cfm + i, _mm512_maskz_mov_pd(ok, value));
+        word |= (uint64_t)ok << (i - start);
+    }
+
+    return i < end ? word | refillRateScalar(a, cfm, i, end) << (i - start) : word;
+}
+
+COMPULATIONS_TARGET_AVX2
+static uint64_t eventStorageAVX2(const double *const *a, double *volumeCF, size_t start, size_t end)
+{
+    uint64_t word = 0;
+    size_t i = start;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m256d duration = _mm256_loadu_pd(a[0] + i);
+        __m256d deltaV = _mm256_sub_pd(_mm256_loadu_pd(a[1] + i), _mm256_loadu_pd(a[2] + i));
+        __m256d ambient = _mm256_loadu_pd(a[3] + i);
+        __m256d deltaP = _mm256_sub_pd(_mm256_loadu_pd(a[4] + i), _mm256_loadu_pd(a[5] + i));
+
+        __m256d ok = _mm256_and_pd(_mm256_and_pd(GT_ZERO_AVX2(duration), GT_ZERO_AVX2(deltaV)),
+                                   _mm256_and_pd(GT_ZERO_AVX2(deltaP), GT_ZERO_AVX2(ambient)));
+        __m256d value = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(duration, deltaV), ambient), deltaP);
+
+        _mm256_storeu_pd(volumeCF + i, _mm256_and_pd(value, ok));
+        word |= (uint64_t)_mm256_movemask_pd(ok) << (i - start);
+    }
+
+    return i < end ? word | eventStorageScalar(a, volumeCF, i, end) << (i - start) : word;
+}
+
+COMPULATIONS_TARGET_AVX512
+static uint64_t eventStorageAVX512(const double *const *a, double *volumeCF, size_t start, size_t end)
+{
+    uint64_t word = 0;
+    size_t i = start;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m512d duration = _mm512_loadu_pd(a[0] + i);
+        __m512d deltaV = _mm512_sub_pd(_mm512_loadu_pd(a[1] + i), _mm512_loadu_pd(a[2] + i));
+        __m512d ambient = _mm512_loadu_pd(a[3] + i);
+        __m512d deltaP = _mm512_sub_pd(_mm512_loadu_pd(a[4] + i), _mm512_loadu_pd(a[5] + i));
+
+        __mmask8 ok = GT_ZERO_AVX512(duration) & GT_ZERO_AVX512(deltaV) & GT_ZERO_AVX512(deltaP) & GT_ZERO_AVX512(ambient);
+        __m512d value = _mm512_div_pd(_mm512_mul_pd(_mm512_mul_pd(duration, deltaV), ambient), deltaP);
+
+        _mm512_storeu_pd(volumeCF + i, _mm512_maskz_mov_pd(ok, value));
+        word |= (uint64_t)ok << (i - start);
+    }
+
+    return i < end ? word | eventStorageScalar(a, volumeCF, i, end) << (i - start) : word;
+}
+
+COMPULATIONS_TARGET_AVX2
+static uint64_t oilCarryoverAVX2(const double *const *a, double *gallons, size_t start, size_t end)
+{
+    uint64_t word = 0;
+    size_t i = start;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m256d flow = _mm256_loadu_pd(a[0] + i);
+        __m256d ppm = _mm256_loadu_pd(a[1] + i);
+        __m256d hours = _mm256_loadu_pd(a[2] + i);
+        __m256d gravity = _mm256_loadu_pd(a[3] + i);
+
+        __m256d ok = _mm256_and_pd(_mm256_and_pd(GT_ZERO_AVX2(flow), GT_ZERO_AVX2(ppm)),
+                                   _mm256_and_pd(GT_ZERO_AVX2(hours), GT_ZERO_AVX2(gravity)));
+        __m256d numerator = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(ppm, flow), hours), _mm256_set1_pd(60.0)),
+                                          _mm256_set1_pd(0.0000012));
+        __m256d value = _mm256_div_pd(numerator, _mm256_mul_pd(gravity, _mm256_set1_pd(128.0)));
+
+        _mm256_storeu_pd(gallons + i, _mm256_and_pd(value, ok));
+        word |= (uint64_t)_mm256_movemask_pd(ok) << (i - start);
+    }
+
+    return i < end ? word | oilCarryoverScalar(a, gallons, i, end) << (i - start) : word;
+}
+
+COMPULATIONS_TARGET_AVX512
+static uint64_t oilCarryoverAVX512(const double *const *a, double *gallons, size_t start, size_t end)
+{
+    uint64_t word = 0;
+    size_t i = start;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m512d flow = _mm512_loadu_pd(a[0] + i);
+        __m512d ppm = _mm512_loadu_pd(a[1] + i);
+        __m512d hours = _mm512_loadu_pd(a[2] + i);
+        __m512d gravity = _mm512_loadu_pd(a[3] + i);
+
+        __mmask8 ok = GT_ZERO_AVX512(flow) & GT_ZERO_AVX512(ppm) & GT_ZERO_AVX512(hours) & GT_ZERO_AVX512(gravity);
+        __m512d numerator = _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(ppm, flow), hours), _mm512_set1_pd(60.0)),
+                                          _mm512_set1_pd(0.0000012));
+        __m512d value = _mm512_div_pd(numerator, _mm512_mul_pd(gravity, _mm512_set1_pd(128.0)));
+
+        _mm512_storeu_pd(gallons + i, _mm512_maskz_mov_pd(ok, value));
+        word |= (uint64_t)ok << (i - start);
+    }
+
+    return i < end ? word | oilCarryoverScalar(a, gallons, i, end) << (i - start) : word;
+}
+
+COMPULATIONS_TARGET_AVX2
+static uint64_t velocityAVX2(const double *const *a, double *fps, size_t start, size_t end)
+{
+    uint64_t word = 0;
+    size_t i = start;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m256d flow = _mm256_loadu_pd(a[0] + i);
+        __m256d line = _mm256_loadu_pd(a[1] + i);
+        __m256d ambient = _mm256_loadu_pd(a[2] + i);
+        __m256d diameter = _mm256_loadu_pd(a[3] + i);
+
+        __m256d ok = _mm256_and_pd(_mm256_and_pd(GT_ZERO_AVX2(flow), GT_ZERO_AVX2(line)),
+                                   _mm256_and_pd(GT_ZERO_AVX2(ambient), GT_ZERO_AVX2(diameter)));
+        __m256d compressionRatio = _mm256_div_pd(ambient, _mm256_add_pd(line, ambient));
+        __m256d diameterFt = _mm256_div_pd(diameter, _mm256_set1_pd(24.0));
+        __m256d pipeArea = _mm256_mul_pd(diameterFt, diameterFt);
+        __m256d value = _mm256_div_pd(_mm256_mul_pd(flow, compressionRatio), _mm256_mul_pd(_mm256_set1_pd(60.0 * M_PI), pipeArea));
+
+        _mm256_storeu_pd(fps + i, _mm256_and_pd(value, ok));
+        word |= (uint64_t)_mm256_movemask_pd(ok) << (i - start);
+    }
+
+    return i < end ? word | velocityScalar(a, fps, i, end) << (i - start) : word;
+}
+
+COMPULATIONS_TARGET_AVX512
+static uint64_t velocityAVX512(const double *const *a, double *fps, size_t start, size_t end)
+{
+    uint64_t word = 0;
+    size_t i = start;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m512d flow = _mm512_loadu_pd(a[0] + i);
+        __m512d line = _mm512_loadu_pd(a[1] + i);
+        __m512d ambient = _mm512_loadu_pd(a[2] + i);
+        __m512d diameter = _mm512_loadu_pd(a[3] + i);
+
+        __mmask8 ok = GT_ZERO_AVX512(flow) & GT_ZERO_AVX512(line) & GT_ZERO_AVX512(ambient) & GT_ZERO_AVX512(diameter);
+        __m512d compressionRatio = _mm512_div_pd(ambient, _mm512_add_pd(line, ambient));
+        __m512d diameterFt = _mm512_div_pd(diameter, _mm512_set1_pd(24.0));
+        __m512d pipeArea = _mm512_mul_pd(diameterFt, diameterFt);
+        __m512d value = _mm512_div_pd(_mm512_mul_pd(flow, compressionRatio), _mm512_mul_pd(_mm512_set1_pd(60.0 * M_PI), pipeArea));
+
+        _mm512_storeu_pd(fps + i, _mm512_maskz_mov_pd(ok, value));
+        word |= (uint64_t)ok << (i - start);
+    }
+
+    return i < end ? word | velocityScalar(a, fps, i, end) << (i - start) : word;
+}
+
+#undef GT_ZERO_AVX2
+#undef GT_ZERO_AVX512
+
+#define MASKED_KERNELS(name) name##Scalar, name##AVX2, name##AVX512
+
+#else
+
+#define MASKED_KERNELS(name) name##Scalar, NULL, NULL
+
+#endif // COMPULATIONS_HAVE_X86_SIMD
+
+size_t refillRateCFMArray(const double *storageCF,
+                          const double *startPressurePSIG,
+                          const double *endPressurePSIG,
+                          const double *refillTimeMins,
+                          const double *ambientPreesurePSIA,
+                          double *cfm,
+                          uint64_t *valid,
+                          size_t count)
+{
+    const double *arguments[] = { storageCF, startPressurePSIG, endPressurePSIG, refillTimeMins, ambientPreesurePSIA };
+
+    return runMaskedKernel(MASKED_KERNELS(refillRate), arguments, cfm, valid, count);
+}
+
+size_t eventStorageCubicFeetArray(const double *eventDurationMins,
+                                  const double *cfmRequiredForEvent,
+                                  const double *meteredCFMSupplied,
+                                  const double *ambientPSIA,
+                                  const double *initialPressurePSIG,
+                                  const double *minPressureForEventPSIG,
+                                  double *volumeCF,
+                                  uint64_t *valid,
+                                  size_t count)
+{
+    const double *arguments[] = { eventDurationMins, cfmRequiredForEvent, meteredCFMSupplied, ambientPSIA,
+                                  initialPressurePSIG, minPressureForEventPSIG };
+
+    return runMaskedKernel(MASKED_KERNELS(eventStorage), arguments, volumeCF, valid, count);
+}
+
+size_t oilCarryoverGallonsArray(const double *flowRateCFM,
+                                const double *concentrationPPM,
+                                const double *operatingHours,
+                                const double *oilSpecificGravity,
+                                double *gallons,
+                                uint64_t *valid,
+                                size_t count)
+{
+    const double *arguments[] = { flowRateCFM, concentrationPPM, operatingHours, oilSpecificGravity };
+
+    return runMaskedKernel(MASKED_KERNELS(oilCarryover), arguments, gallons, valid, count);
+}
+
+size_t velocityInPipeFPSArray(const double *flowRateCFM,
+                              const double *linePressurePSIG,
+                              const double *ambientPreesurePSIA,
+                              const double *pipeDiameterIn,
+                              double *fps,
+                              uint64_t *valid,
+                              size_t count)
+{
+    const double *arguments[] = { flowRateCFM, linePressurePSIG, ambientPreesurePSIA, pipeDiameterIn };
+
+    return runMaskedKernel(MASKED_KERNELS(velocity), arguments, fps, valid, count);
+}
@@ -0,0 +1,173 @@
+//
+//  BatchCompulations.h
+//
+//  Array-in/array-out versions of the Compulations formulas.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BatchCompulations_h
+#define BatchCompulations_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Instruction set used by the batch kernels. The best level the CPU supports
+// is picked on first use; the scalar level simply calls the scalar functions.
+typedef enum CompulationsSIMDLevel
+{
+    CompulationsSIMDLevelScalar = 0,
+    CompulationsSIMDLevelAVX2,
+    CompulationsSIMDLevelAVX512
+} CompulationsSIMDLevel;
+
+CompulationsSIMDLevel compulationsDetectedSIMDLevel(void);
+CompulationsSIMDLevel compulationsSIMDLevel(void);
+
+// Force a level, e.g. to benchmark the scalar path. Levels above the detected
+// one are clamped to it.
+void compulationsSetSIMDLevel(CompulationsSIMDLevel level);
+
+// ACFM SCFM conversions
+//
+// The SIMD kernels evaluate 10^x with a polynomial instead of pow() (1 ULP).
+// For ambient temperatures up to 180 F and pressures of 10 psia or more their
+// results are within 8 ULP of scfmFromACFM/acfmFromSCFM. The error grows as
+// RH * vapor pressure approaches the ambient pressure, where the RH correction
+// cancels. The scalar level matches the scalar functions exactly.
+// compulations_flow_accuracy checks both at every level.
+
+// Structure-of-arrays input, one array per scalar argument
+typedef struct FlowConversionArrays
+{
+    const double *flowCFM;
+    const double *standardAmbientPressurePSI;
+    const double *standardAmbientTempF;
+    const double *standardAmbientRH;
+    const double *siteAmbientPressurePSI;
+    const double *siteAmbientTempF;
+    const double *siteAmbientRH;
+    const double *inletPressurePSI;
+} FlowConversionArrays;
+
+// Contiguous input, one record per conversion
+typedef struct FlowConversionRecord
+{
+    double flowCFM;
+    double standardAmbientPressurePSI;
+    double standardAmbientTempF;
+    double standardAmbientRH;
+    double siteAmbientPressurePSI;
+    double siteAmbientTempF;
+    double siteAmbientRH;
+    double inletPressurePSI;
+} FlowConversionRecord;
+
+void scfmFromACFMArrays(const FlowConversionArrays *input,
+                        double *scfm,
+                        size_t count);
+
+void acfmFromSCFMArrays(const FlowConversionArrays *input,
+                        double *acfm,
+                        size_t count);
+
+void scfmFromACFMRecords(const FlowConversionRecord *records,
+                         double *scfm,
+                         size_t count);
+
+void acfmFromSCFMRecords(const FlowConversionRecord *records,
+                         double *acfm,
+                         size_t count);
+
+// Pressure-Altitude relationship, using the interpolated table versions
+void ambientPSIAForAltitudeInFeetArray(const double *altitude,
+                                       double *ambientPSIA,
+                                       size_t count);
+
+void altitudeFeetFromPSIAArray(const double *psia,
+                               double *altitude,
+                               size_t count);
+
+// Optimal operating temperature for oil flooded screw
+//
+// Same result as oilFloodedScrewOperatingTempF, which reports the pressure
+// dew point at discharge in F. pressureDewPointC receives the same dew point
+// in C and may be NULL. The SIMD kernels pick the over-ice or over-water
+// Magnus constants per lane with masks and use one vector exp and one vector
+// log per lane; results agree with the scalar function to about 1e-12 C.
+void oilFloodedScrewOperatingTempFArray(const double *inletTempF,
+                                        const double *dischargePressurePSIG,
+                                        const double *ambientPSIA,
+                                        double *operatingTempF,
+                                        double *pressureDewPointC,
+                                        size_t count);
+
+// Guarded functions with validity masks
+//
+// Where the scalar function's guard fails it returns 0.0, which can't be
+// told apart from a real zero. These compute every call without branches
+// and also set bit k % 64 of valid[k / 64] when call k passes the guard.
+// valid needs (count + 63) / 64 words, bits past count are left clear, and
+// it may be NULL. Results are the scalar function's bit for bit, including
+// 0.0 for calls that fail the guard, so sums need no mask. Each returns the
+// number of valid calls.
+size_t refillRateCFMArray(const double *storageCF,
+                          const double *startPressurePSIG,
+                          const double *endPressurePSIG,
+                          const double *refillTimeMins,
+                          const double *ambientPreesurePSIA,
+                          double *cfm,
+                          uint64_t *valid,
+                          size_t count);
+
+size_t eventStorageCubicFeetArray(const double *eventDurationMins,
+                                  const double *cfmRequiredForEvent,
+                                  const double *meteredCFMSupplied,
+                                  const double *ambientPSIA,
+                                  const double *initialPressurePSIG,
+                                  const double *minPressureForEventPSIG,
+                                  double *volumeCF,
+                                  uint64_t *valid,
+                                  size_t count);
+
+size_t oilCarryoverGallonsArray(const double *flowRateCFM,
+                                const double *concentrationPPM,
+                                const double *operatingHours,
+                                const double *oilSpecificGravity,
+                                double *gallons,
+                                uint64_t *valid,
+                                size_t count);
+
+size_t velocityInPipeFPSArray(const double *flowRateCFM,
+                              const double *linePressurePSIG,
+                              const double *ambientPreesurePSIA,
+                              const double *pipeDiameterIn,
+                              double *fps,
+                              uint64_t *valid,
+                              size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BatchCompulations_h */
@@ -0,0 +1,1418 @@
+//
+//  CalculationDaemon.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// memfd_create and file sealing are declared for _GNU_SOURCE only
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "CalculationDaemon.h"
+#include "BatchCompulations.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+// Values per tile of work handed to the pool
+#define DAEMON_TILE 4096
+
+// Free space kept at the end of a connection's input for each read
+#define DAEMON_READ_BYTES 65536
+
+// Unparsed input held per connection: one largest frame. Reading stops
+// there until the frame is parsed.
+#define DAEMON_MAX_INPUT_BYTES (sizeof(DaemonFrameHeader) + DAEMON_MAX_FRAME_BYTES)
+
+// Unsent output per connection past which no more frames are parsed or read
+#define DAEMON_MAX_OUTPUT_BYTES (4 * DAEMON_READ_BYTES)
+
+// File descriptors received but not yet claimed by a map request
+#define DAEMON_MAX_PENDING_FDS 8
+
+// 8 buckets per doubling of nanoseconds, up to 2^48 ns
+#define DAEMON_HISTOGRAM_BUCKETS (48 * 8)
+
+typedef struct DaemonBuffer
+{
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+} DaemonBuffer;
+
+typedef struct DaemonRegion
+{
+    uint8_t *base;
+    size_t size;
+} DaemonRegion;
+
+typedef struct DaemonConnection
+{
+    int fd;
+    int closing;
+
+    // input[consumed, length) is not parsed yet; output[sent, length) not
+    // written yet
+    DaemonBuffer input;
+    size_t consumed;
+    DaemonBuffer output;
+    size_t sent;
+
+    int pendingFds[DAEMON_MAX_PENDING_FDS];
+    size_t pendingFdCount;
+    DaemonRegion regions[DAEMON_MAX_REGIONS];
+} DaemonConnection;
+
+// One evaluate request in the current wave. Inline results are an offset
+// into the connection's output until every reply of the wave is queued,
+// since queueing may move the buffer.
+typedef struct DaemonJob
+{
+    CompulationColumns kernel;
+    const double *arguments[COMPULATION_MAX_ARITY];
+    size_t arity;
+    size_t count;
+    DaemonConnection *connection;
+    double *results;
+    size_t resultOffset;
+    double started;
+} DaemonJob;
+
+typedef struct DaemonTile
+{
+    size_t job;
+    size_t begin;
+    size_t end;
+} DaemonTile;
+
+struct CalculationDaemon
+{
+    struct sockaddr_un address;
+    int listenFd;
+    int wakeFds[2];
+    atomic_int stopping;
+    ThreadPool *pool;
+    CompulationColumns *kernels;
+
+    DaemonConnection **connections;
+    size_t connectionCount;
+    size_t connectionCapacity;
+
+    DaemonJob *jobs;
+    size_t jobCount;
+    size_t jobCapacity;
+    DaemonTile *tiles;
+    size_t tileCapacity;
+
+    pthread_mutex_t statsLock;
+    uint64_t histogram[DAEMON_HISTOGRAM_BUCKETS];
+    uint64_t requests;
+    uint64_t values;
+    double maxSeconds;
+};
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int growArray(void **items, size_t *capacity, size_t needed, size_t itemSize)
+{
+    if (needed <= *capacity)
+    {
+        return 0;
+    }
+
+    size_t grown = *capacity ? *capacity * 2 : 16;
+    grown = grown > needed ? grown : needed;
+
+    void *resized = realloc(*items, grown * itemSize);
+
+    if (!resized)
+    {
+        return -1;
+    }
+
+    *items = resized;
+    *capacity = grown;
+
+    return 0;
+}
+
+static int bufferReserve(DaemonBuffer *buffer, size_t extra)
+{
+    return growArray((void **)&buffer->data, &buffer->capacity, buffer->length + extra, 1);
+}
+
+// Returns the offset of the appended bytes, or SIZE_MAX
+static size_t bufferAppend(DaemonBuffer *buffer, const void *bytes, size_t size)
+{
+    if (bufferReserve(buffer, size) != 0)
+    {
+        return SIZE_MAX;
+    }
+
+    size_t offset = buffer->length;
+
+    if (bytes)
+    {
+        memcpy(buffer->data + offset, bytes, size);
+    }
+
+    buffer->length += size;
+
+    return offset;
+}
+
+// Batch kernels
+
+static void scfmFromACFMKernel(const double *const *a, double *results, size_t count)
+{
+    FlowConversionArrays input = { a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7] };
+    scfmFromACFMArrays(&input, results, count);
+}
+
+static void acfmFromSCFMKernel(const double *const *a, double *results, size_t count)
+{
+    FlowConversionArrays input = { a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7] };
+    acfmFromSCFMArrays(&input, results, count);
+}
+
+static void ambientPSIAForAltitudeInFeetFastKernel(const double *const *a, double *results, size_t count)
+{
+    ambientPSIAForAltitudeInFeetArray(a[0], results, count);
+}
+
+static void altitudeFeetFromPSIAFastKernel(const double *const *a, double *results, size_t count)
+{
+    altitudeFeetFromPSIAArray(a[0], results, count);
+}
+
+static void oilFloodedScrewOperatingTempFKernel(const double *const *a, double *results, size_t count)
+{
+    oilFloodedScrewOperatingTempFArray(a[0], a[1], a[2], results, NULL, count);
+}
+
+static const struct
+{
+    const char *name;
+    CompulationColumns kernel;
+} batchKernels[] = {
+    { "scfmFromACFM", scfmFromACFMKernel },
+    { "acfmFromSCFM", acfmFromSCFMKernel },
+    { "ambientPSIAForAltitudeInFeetFast", ambientPSIAForAltitudeInFeetFastKernel },
+    { "altitudeFeetFromPSIAFast", altitudeFeetFromPSIAFastKernel },
+    { "oilFloodedScrewOperatingTempF", oilFloodedScrewOperatingTempFKernel },
+};
+
+// Latency
+
+static size_t latencyBucket(double seconds)
+{
+    double ns = seconds * 1e9;
+
+    if (!(ns >= 1.0))
+    {
+        return 0;
+    }
+
+    int exponent;
+    double mantissa = frexp(ns, &exponent);
+    size_t bucket = (size_t)(exponent - 1) * 8 + (size_t)((mantissa * 2.0 - 1.0) * 8.0);
+
+    return bucket < DAEMON_HISTOGRAM_BUCKETS ? bucket : DAEMON_HISTOGRAM_BUCKETS - 1;
+}
+
+// Middle of the bucket holding the given fraction of requests, in us
+static double latencyPercentile(const uint64_t *histogram, uint64_t requests, double fraction)
+{
+    uint64_t rank = (uint64_t)ceil(fraction * (double)requests);
+    uint64_t seen = 0;
+
+    for (size_t bucket = 0; bucket < DAEMON_HISTOGRAM_BUCKETS; bucket++)
+    {
+        seen += histogram[bucket];
+
+        if (seen >= rank && seen > 0)
+        {
+            return ldexp(1.0 + ((bucket % 8) + 0.5) / 8.0, (int)(bucket / 8)) * 1e-3;
+        }
+    }
+
+    return 0.0;
+}
+
+// Connections
+
+static int setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+
+    return flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0 || fcntl(fd, F_SETFD, FD_CLOEXEC) != 0 ? -1 : 0;
+}
+
+static void connectionFree(DaemonConnection *connection)
+{
+    close(connection->fd);
+
+    for (size_t f = 0; f < connection->pendingFdCount; f++)
+    {
+        close(connection->pendingFds[f]);
+    }
+
+    for (size_t r = 0; r < DAEMON_MAX_REGIONS; r++)
+    {
+        if (connection->regions[r].base)
+        {
+            munmap(connection->regions[r].base, connection->regions[r].size);
+        }
+    }
+
+    free(connection->input.data);
+    free(connection->output.data);
+    free(connection);
+}
+
+static void acceptConnections(CalculationDaemon *daemon)
+{
+    for (;;)
+    {
+        int fd = accept(daemon->listenFd, NULL, NULL);
+
+        if (fd < 0)
+        {
+            return;
+        }
+
+        if (setNonBlocking(fd) != 0)
+        {
+            close(fd);
+            continue;
+        }
+
+        DaemonConnection *connection = calloc(1, sizeof(DaemonConnection));
+
+        if (!connection || growArray((void **)&daemon->connections, &daemon->connectionCapacity,
+                                     daemon->connectionCount + 1, sizeof(DaemonConnection *)) != 0)
+        {
+            free(connection);
+            close(fd);
+            return;
+        }
+
+        connection->fd = fd;
+        daemon->connections[daemon->connectionCount++] = connection;
+    }
+}
+
+// A slow reader or a flood of frames must not grow the buffers without bound
+static int connectionOutputFull(const DaemonConnection *connection)
+{
+    return connection->output.length - connection->sent >= DAEMON_MAX_OUTPUT_BYTES;
+}
+
+static int connectionWantsInput(const DaemonConnection *connection)
+{
+    return connection->input.length - connection->consumed < DAEMON_MAX_INPUT_BYTES &&
+           !connectionOutputFull(connection);
+}
+
+// True if a whole frame is waiting and there is room for its reply
+static int connectionCanParse(const DaemonConnection *connection)
+{
+    DaemonFrameHeader header;
+    size_t pending = connection->input.length - connection->consumed;
+
+    if (connection->closing || connectionOutputFull(connection) || pending < sizeof(header))
+    {
+        return 0;
+    }
+
+    memcpy(&header, connection->input.data + connection->consumed, sizeof(header));
+
+    return header.length > DAEMON_MAX_FRAME_BYTES || pending >= sizeof(header) + header.length;
+}
+
+// Reads whatever is available up to the input cap, keeping any file
+// descriptors that arrive
+static void connectionRead(DaemonConnection *connection)
+{
+    for (;;)
+    {
+        size_t room = DAEMON_MAX_INPUT_BYTES - (connection->input.length - connection->consumed);
+
+        if (!connectionWantsInput(connection))
+        {
+            return;
+        }
+
+        if (bufferReserve(&connection->input, room < DAEMON_READ_BYTES ? room : DAEMON_READ_BYTES) != 0)
+        {
+            connection->closing = 1;
+            return;
+        }
+
+        size_t space = connection->input.capacity - connection->input.length;
+
+        union
+        {
+            struct cmsghdr header;
+            char space[CMSG_SPACE(sizeof(int) * DAEMON_MAX_PENDING_FDS)];
+        } control;
+
+        struct iovec vector = { connection->input.data + connection->input.length, space < room ? space : room };
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control.space;
+        message.msg_controllen = sizeof(control.space);
+
+        ssize_t received = recvmsg(connection->fd, &message, MSG_CMSG_CLOEXEC);
+
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return;
+        }
+
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        for (struct cmsghdr *header = received > 0 ? CMSG_FIRSTHDR(&message) : NULL; header;
+             header = CMSG_NXTHDR(&message, header))
+        {
+            if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+            {
+                continue;
+            }
+
+            size_t fdCount = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+            for (size_t f = 0; f < fdCount; f++)
+            {
+                int fd;
+                memcpy(&fd, CMSG_DATA(header) + f * sizeof(int), sizeof(int));
+
+                if (connection->pendingFdCount < DAEMON_MAX_PENDING_FDS)
+                {
+                    connection->pendingFds[connection->pendingFdCount++] = fd;
+                }
+                else
+                {
+                    close(fd);
+                }
+            }
+        }
+
+        if (received <= 0)
+        {
+            connection->closing = 1;
+            return;
+        }
+
+        connection->input.length += (size_t)received;
+    }
+}
+
+static void connectionFlush(DaemonConnection *connection)
+{
+    while (connection->sent < connection->output.length)
+    {
+        ssize_t written = send(connection->fd, connection->output.data + connection->sent,
+                               connection->output.length - connection->sent, MSG_NOSIGNAL);
+
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (written <= 0)
+        {
+            if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                connection->closing = 1;
+            }
+
+            return;
+        }
+
+        connection->sent += (size_t)written;
+    }
+
+    connection->output.length = 0;
+    connection->sent = 0;
+}
+
+// Queues a reply header and body; extra more bytes are reserved after the
+// body. Returns the offset of the extra bytes, or SIZE_MAX.
+static size_t queueReply(DaemonConnection *connection,
+                         const DaemonFrameHeader *request,
+                         const void *body,
+                         size_t bodySize,
+                         size_t extra)
+{
+    DaemonFrameHeader header = { (uint32_t)(bodySize + extra), request->type, request->tag };
+
+    if (bufferReserve(&connection->output, sizeof(header) + bodySize + extra) != 0)
+    {
+        connection->closing = 1;
+        return SIZE_MAX;
+    }
+
+    bufferAppend(&connection->output, &header, sizeof(header));
+    bufferAppend(&connection->output, body, bodySize);
+
+    return bufferAppend(&connection->output, NULL, extra);
+}
+
+static void handleLookup(DaemonConnection *connection, const DaemonFrameHeader *header, const uint8_t *payload)
+{
+    DaemonLookupReply reply = { -1, 0 };
+
+    if (header->length > 0 && memchr(payload, '\0', header->length))
+    {
+        for (size_t i = 0; i < compulationFunctionCount(); i++)
+        {
+            if (strcmp(compulationFunctionAt(i)->name, (const char *)payload) == 0)
+            {
+                reply.function = (int32_t)i;
+                reply.arity = (uint32_t)compulationFunctionAt(i)->arity;
+                break;
+            }
+        }
+    }
+
+    queueReply(connection, header, &reply, sizeof(reply), 0);
+}
+
+static void handleMapRegion(DaemonConnection *connection, const DaemonFrameHeader *header, const uint8_t *payload)
+{
+    DaemonMapReply reply = { -1, 0 };
+    DaemonMapRequest request;
+    int fd = -1;
+
+    if (connection->pendingFdCount > 0)
+    {
+        fd = connection->pendingFds[0];
+        memmove(connection->pendingFds, connection->pendingFds + 1, --connection->pendingFdCount * sizeof(int));
+    }
+
+    if (fd >= 0 && header->length >= sizeof(request))
+    {
+        memcpy(&request, payload, sizeof(request));
+    }
+    else
+    {
+        request.size = 0;
+    }
+
+    // Touching pages past the end of the file raises SIGBUS, so the file
+    // must cover the region and be sealed so it cannot shrink later.
+    struct stat status;
+    int seals = fd >= 0 ? fcntl(fd, F_GET_SEALS) : -1;
+
+    if (request.size > 0 && seals >= 0 && (seals & F_SEAL_SHRINK) && fstat(fd, &status) == 0 &&
+        request.size <= (uint64_t)status.st_size)
+    {
+        for (size_t r = 0; r < DAEMON_MAX_REGIONS; r++)
+        {
+            if (connection->regions[r].base)
+            {
+                continue;
+            }
+
+            void *base = mmap(NULL, (size_t)request.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+            if (base != MAP_FAILED)
+            {
+                connection->regions[r] = (DaemonRegion){ base, (size_t)request.size };
+                reply.region = (int32_t)r;
+            }
+
+            break;
+        }
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    queueReply(connection, header, &reply, sizeof(reply), 0);
+}
+
+static void handleStats(CalculationDaemon *daemon, DaemonConnection *connection, const DaemonFrameHeader *header)
+{
+    DaemonStatsReply reply;
+    calculationDaemonStats(daemon, &reply);
+    queueReply(connection, header, &reply, sizeof(reply), 0);
+}
+
+// 1 if count doubles at offset lie inside the region
+static int regionHolds(const DaemonRegion *region, uint64_t offset, uint64_t count)
+{
+    return offset % sizeof(double) == 0 && offset <= region->size &&
+           count <= (region->size - offset) / sizeof(double);
+}
+
+static void handleEvaluate(CalculationDaemon *daemon,
+                           DaemonConnection *connection,
+                           const DaemonFrameHeader *header,
+                           const uint8_t *payload,
+                           double started)
+{
+    DaemonEvaluateRequest request;
+    DaemonEvaluateReply reply = { DaemonStatusBadRequest, 0, 0 };
+    DaemonJob job;
+    memset(&job, 0, sizeof(job));
+
+    if (header->length < sizeof(request))
+    {
+        queueReply(connection, header, &reply, sizeof(reply), 0);
+        return;
+    }
+
+    memcpy(&request, payload, sizeof(request));
+
+    const CompulationFunction *function = compulationFunctionAt(request.function);
+
+    if (!function)
+    {
+        reply.status = DaemonStatusUnknownFunction;
+        queueReply(connection, header, &reply, sizeof(reply), 0);
+        return;
+    }
+
+    job.kernel = daemon->kernels[request.function];
+    job.arity = function->arity;
+    job.connection = connection;
+    job.started = started;
+
+    if (request.region == DAEMON_REGION_INLINE)
+    {
+        // Arguments are read where they arrived
+        uint64_t available = (header->length - sizeof(request)) / sizeof(double);
+
+        if (request.count > available / function->arity || request.count * function->arity != available)
+        {
+            queueReply(connection, header, &reply, sizeof(reply), 0);
+            return;
+        }
+
+        for (size_t p = 0; p < function->arity; p++)
+        {
+            job.arguments[p] = (const double *)(payload + sizeof(request)) + p * request.count;
+        }
+
+        job.count = (size_t)request.count;
+        reply.status = DaemonStatusOK;
+        reply.count = request.count;
+        job.resultOffset = queueReply(connection, header, &reply, sizeof(reply), job.count * sizeof(double));
+    }
+    else
+    {
+        const DaemonRegion *region = request.region < DAEMON_MAX_REGIONS ? &connection->regions[request.region] : NULL;
+        int valid = region && region->base && regionHolds(region, request.resultOffset, request.count);
+
+        for (size_t p = 0; p < function->arity && valid; p++)
+        {
+            valid = regionHolds(region, request.argumentOffsets[p], request.count);
+        }
+
+        if (!valid)
+        {
+            reply.status = DaemonStatusBadRegion;
+            queueReply(connection, header, &reply, sizeof(reply), 0);
+            return;
+        }
+
+        // Results go straight into the shared region
+        for (size_t p = 0; p < function->arity; p++)
+        {
+            job.arguments[p] = (const double *)(region->base + request.argumentOffsets[p]);
+        }
+
+        job.results = (double *)(region->base + request.resultOffset);
+        job.resultOffset = SIZE_MAX;
+        job.count = (size_t)request.count;
+        reply.status = DaemonStatusOK;
+        reply.count = request.count;
+
+        if (queueReply(connection, header, &reply, sizeof(reply), 0) == SIZE_MAX)
+        {
+            return;
+        }
+    }
+
+    if (connection->closing || growArray((void **)&daemon->jobs, &daemon->jobCapacity, daemon->jobCount + 1,
+                                         sizeof(DaemonJob)) != 0)
+    {
+        connection->closing = 1;
+        return;
+    }
+
+    daemon->jobs[daemon->jobCount++] = job;
+}
+
+// Handles every complete frame in the connection's input
+static void connectionParse(CalculationDaemon *daemon, DaemonConnection *connection, double now)
+{
+    while (!connection->closing && !connectionOutputFull(connection) &&
+           connection->input.length - connection->consumed >= sizeof(DaemonFrameHeader))
+    {
+        DaemonFrameHeader header;
+        const uint8_t *frame = connection->input.data + connection->consumed;
+        memcpy(&header, frame, sizeof(header));
+
+        if (header.length > DAEMON_MAX_FRAME_BYTES || header.length % 8 != 0)
+        {
+            connection->closing = 1;
+            return;
+        }
+
+        if (connection->input.length - connection->consumed < sizeof(header) + header.length)
+        {
+            return;
+        }
+
+        const uint8_t *payload = frame + sizeof(header);
+
+        switch (header.type)
+        {
+            case DaemonFrameLookup:
+                handleLookup(connection, &header, payload);
+                break;
+
+            case DaemonFrameMapRegion:
+                handleMapRegion(connection, &header, payload);
+                break;
+
+            case DaemonFrameEvaluate:
+                handleEvaluate(daemon, connection, &header, payload, now);
+                break;
+
+            case DaemonFrameStats:
+                handleStats(daemon, connection, &header);
+                break;
+
+            default:
+                connection->closing = 1;
+                return;
+        }
+
+        connection->consumed += sizeof(header) + header.length;
+    }
+}
+
+static void runTiles(void *context, size_t begin, size_t end, size_t worker)
+{
+    const CalculationDaemon *daemon = context;
+
+    (void)worker;
+
+    for (size_t t = begin; t < end; t++)
+    {
+        const DaemonTile *tile = &daemon->tiles[t];
+        const DaemonJob *job = &daemon->jobs[tile->job];
+        const double *arguments[COMPULATION_MAX_ARITY];
+
+        for (size_t p = 0; p < job->arity; p++)
+        {
+            arguments[p] = job->arguments[p] + tile->begin;
+        }
+
+        job->kernel(arguments, job->results + tile->begin, tile->end - tile->begin);
+    }
+}
+
+// Runs every job of the wave, tile by tile across the pool
+static void runJobs(CalculationDaemon *daemon)
+{
+    size_t tileCount = 0;
+
+    for (size_t j = 0; j < daemon->jobCount; j++)
+    {
+        DaemonJob *job = &daemon->jobs[j];
+
+        if (job->resultOffset != SIZE_MAX)
+        {
+            job->results = (double *)(job->connection->output.data + job->resultOffset);
+        }
+
+        size_t tiles = (job->count + DAEMON_TILE - 1) / DAEMON_TILE;
+
+        if (growArray((void **)&daemon->tiles, &daemon->tileCapacity, tileCount + tiles, sizeof(DaemonTile)) != 0)
+        {
+            // Run this wave unsplit rather than not at all
+            tileCount = 0;
+            break;
+        }
+
+        for (size_t first = 0; first < job->count; first += DAEMON_TILE)
+        {
+            size_t end = job->count - first < DAEMON_TILE ? job->count : first + DAEMON_TILE;
+            daemon->tiles[tileCount++] = (DaemonTile){ j, first, end };
+        }
+    }
+
+    if (tileCount == 0)
+    {
+        for (size_t j = 0; j < daemon->jobCount; j++)
+        {
+            DaemonJob *job = &daemon->jobs[j];
+
+            if (job->resultOffset != SIZE_MAX)
+            {
+                job->results = (double *)(job->connection->output.data + job->resultOffset);
+            }
+
+            job->kernel(job->arguments, job->results, job->count);
+        }
+
+        return;
+    }
+
+    if (daemon->pool)
+    {
+        threadPoolParallelFor(daemon->pool, tileCount, 1, runTiles, daemon);
+    }
+    else
+    {
+        runTiles(daemon, 0, tileCount, 0);
+    }
+}
+
+static void recordLatencies(CalculationDaemon *daemon, double now)
+{
+    pthread_mutex_lock(&daemon->statsLock);
+
+    for (size_t j = 0; j < daemon->jobCount; j++)
+    {
+        double seconds = now - daemon->jobs[j].started;
+
+        daemon->histogram[latencyBucket(seconds)]++;
+        daemon->requests++;
+        daemon->values += daemon->jobs[j].count;
+        daemon->maxSeconds = seconds > daemon->maxSeconds ? seconds : daemon->maxSeconds;
+    }
+
+    pthread_mutex_unlock(&daemon->statsLock);
+}
+
+// Server
+
+CalculationDaemon *calculationDaemonCreate(const char *socketPath, ThreadPool *pool)
+{
+    CalculationDaemon *daemon = calloc(1, sizeof(CalculationDaemon));
+
+    if (!daemon || strlen(socketPath) >= sizeof(daemon->address.sun_path))
+    {
+        free(daemon);
+        return NULL;
+    }
+
+    daemon->pool = pool;
+    daemon->listenFd = -1;
+    daemon->wakeFds[0] = -1;
+    daemon->wakeFds[1] = -1;
+    daemon->address.sun_family = AF_UNIX;
+    strcpy(daemon->address.sun_path, socketPath);
+    atomic_init(&daemon->stopping, 0);
+    pthread_mutex_init(&daemon->statsLock, NULL);
+
+    daemon->kernels = calloc(compulationFunctionCount(), sizeof(CompulationColumns));
+
+    if (!daemon->kernels)
+    {
+        calculationDaemonDestroy(daemon);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < compulationFunctionCount(); i++)
+    {
+        daemon->kernels[i] = compulationFunctionAt(i)->evaluateColumns;
+
+        for (size_t k = 0; k < sizeof(batchKernels) / sizeof(batchKernels[0]); k++)
+        {
+            if (strcmp(batchKernels[k].name, compulationFunctionAt(i)->name) == 0)
+            {
+                daemon->kernels[i] = batchKernels[k].kernel;
+            }
+        }
+    }
+
+    if (pipe(daemon->wakeFds) != 0 || setNonBlocking(daemon->wakeFds[0]) != 0 || setNonBlocking(daemon->wakeFds[1]) != 0)
+    {
+        calculationDaemonDestroy(daemon);
+        return NULL;
+    }
+
+    daemon->listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath);
+
+    if (daemon->listenFd < 0 || setNonBlocking(daemon->listenFd) != 0 ||
+        bind(daemon->listenFd, (const struct sockaddr *)&daemon->address, sizeof(daemon->address)) != 0 ||
+        listen(daemon->listenFd, SOMAXCONN) != 0)
+    {
+        calculationDaemonDestroy(daemon);
+        return NULL;
+    }
+
+    return daemon;
+}
+
+int calculationDaemonRun(CalculationDaemon *daemon)
+{
+    struct pollfd *polls = NULL;
+    size_t pollCapacity = 0;
+    int status = 0;
+
+    while (!atomic_load(&daemon->stopping))
+    {
+        if (growArray((void **)&polls, &pollCapacity, daemon->connectionCount + 2, sizeof(struct pollfd)) != 0)
+        {
+            status = -1;
+            break;
+        }
+
+        polls[0] = (struct pollfd){ daemon->listenFd, POLLIN, 0 };
+        polls[1] = (struct pollfd){ daemon->wakeFds[0], POLLIN, 0 };
+        int timeout = -1;
+
+        // A connection at its caps is not read until its frames are parsed
+        // and its replies drained; frames held back that way are parsed
+        // without waiting.
+        for (size_t c = 0; c < daemon->connectionCount; c++)
+        {
+            DaemonConnection *connection = daemon->connections[c];
+            short events = (connectionWantsInput(connection) ? POLLIN : 0) |
+                           (connection->sent < connection->output.length ? POLLOUT : 0);
+
+            polls[c + 2] = (struct pollfd){ connection->fd, events, 0 };
+
+            if (connectionCanParse(connection))
+            {
+                timeout = 0;
+            }
+        }
+
+        size_t polledConnections = daemon->connectionCount;
+
+        if (poll(polls, polledConnections + 2, timeout) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            status = -1;
+            break;
+        }
+
+        if (polls[1].revents)
+        {
+            char drain[64];
+
+            while (read(daemon->wakeFds[0], drain, sizeof(drain)) > 0)
+            {
+            }
+        }
+
+        // Read everything first: jobs point into the inputs, which must not
+        // move until the wave is done.
+        for (size_t c = 0; c < polledConnections; c++)
+        {
+            if (polls[c + 2].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                connectionRead(daemon->connections[c]);
+            }
+        }
+
+        if (polls[0].revents & POLLIN)
+        {
+            acceptConnections(daemon);
+        }
+
+        double now = secondsNow();
+        daemon->jobCount = 0;
+
+        for (size_t c = 0; c < daemon->connectionCount; c++)
+        {
+            connectionParse(daemon, daemon->connections[c], now);
+        }
+
+        runJobs(daemon);
+
+        for (size_t c = 0; c < daemon->connectionCount; c++)
+        {
+            connectionFlush(daemon->connections[c]);
+        }
+
+        recordLatencies(daemon, secondsNow());
+
+        // Compact the inputs and drop closed connections
+        size_t kept = 0;
+
+        for (size_t c = 0; c < daemon->connectionCount; c++)
+        {
+            DaemonConnection *connection = daemon->connections[c];
+
+            if (connection->closing)
+            {
+                connectionFree(connection);
+                continue;
+            }
+
+            if (connection->consumed > 0)
+            {
+                memmove(connection->input.data, connection->input.data + connection->consumed,
+                        connection->input.length - connection->consumed);
+                connection->input.length -= connection->consumed;
+                connection->consumed = 0;
+            }
+            daemon->connections[kept++] = connection;
+        }
+
+        daemon->connectionCount = kept;
+    }
+
+    free(polls);
+
+    return status;
+}
+
+void calculationDaemonStop(CalculationDaemon *daemon)
+{
+    char wake = 1;
+
+    atomic_store(&daemon->stopping, 1);
+
+    if (write(daemon->wakeFds[1], &wake, 1) < 0)
+    {
+        // The pipe is full, so the loop is waking anyway.
+    }
+}
+
+void calculationDaemonStats(CalculationDaemon *daemon, DaemonStatsReply *stats)
+{
+    pthread_mutex_lock(&daemon->statsLock);
+
+    stats->requests = daemon->requests;
+    stats->values = daemon->values;
+    stats->p50Microseconds = latencyPercentile(daemon->histogram, daemon->requests, 0.50);
+    stats->p99Microseconds = latencyPercentile(daemon->histogram, daemon->requests, 0.99);
+    stats->maxMicroseconds = daemon->maxSeconds * 1e6;
+
+    pthread_mutex_unlock(&daemon->statsLock);
+}
+
+void calculationDaemonDestroy(CalculationDaemon *daemon)
+{
+    if (!daemon)
+    {
+        return;
+    }
+
+    for (size_t c = 0; c < daemon->connectionCount; c++)
+    {
+        connectionFree(daemon->connections[c]);
+    }
+
+    if (daemon->listenFd >= 0)
+    {
+        close(daemon->listenFd);
+        unlink(daemon->address.sun_path);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (daemon->wakeFds[i] >= 0)
+        {
+            close(daemon->wakeFds[i]);
+        }
+    }
+
+    pthread_mutex_destroy(&daemon->statsLock);
+    free(daemon->connections);
+    free(daemon->jobs);
+    free(daemon->tiles);
+    free(daemon->kernels);
+    free(daemon);
+}
+
+// Client
+
+struct CalculationClient
+{
+    int fd;
+    size_t outstanding;
+};
+
+// Sends the vectors completely, with fd attached to the first byte if it
+// isn't -1
+static int sendVectors(int socketFd, struct iovec *vectors, size_t vectorCount, int fd)
+{
+    union
+    {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    while (vectorCount > 0)
+    {
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = vectors;
+        message.msg_iovlen = vectorCount;
+
+        if (fd >= 0)
+        {
+            memset(&control, 0, sizeof(control));
+            message.msg_control = control.space;
+            message.msg_controllen = sizeof(control.space);
+
+            struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(header), &fd, sizeof(int));
+        }
+
+        ssize_t sent = sendmsg(socketFd, &message, MSG_NOSIGNAL);
+
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (sent <= 0)
+        {
+            return -1;
+        }
+
+        fd = -1;
+
+        while (vectorCount > 0 && (size_t)sent >= vectors->iov_len)
+        {
+            sent -= (ssize_t)vectors->iov_len;
+            vectors++;
+            vectorCount--;
+        }
+
+        if (vectorCount > 0)
+        {
+            vectors->iov_base = (uint8_t *)vectors->iov_base + sent;
+            vectors->iov_len -= (size_t)sent;
+        }
+    }
+
+    return 0;
+}
+
+static int receiveAll(int socketFd, void *bytes, size_t size)
+{
+    uint8_t *next = bytes;
+
+    while (size > 0)
+    {
+        ssize_t received = recv(socketFd, next, size, 0);
+
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (received <= 0)
+        {
+            return -1;
+        }
+
+        next += received;
+        size -= (size_t)received;
+    }
+
+    return 0;
+}
+
+// One request, one reply of exactly replySize bytes; only with nothing
+// outstanding, since replies come back in order
+static int clientExchange(CalculationClient *client,
+                          DaemonFrameType type,
+                          const void *payload,
+                          size_t payloadSize,
+                          int fd,
+                          void *reply,
+                          size_t replySize)
+{
+    DaemonFrameHeader header = { (uint32_t)payloadSize, type, 0 };
+    struct iovec vectors[2] = { { &header, sizeof(header) }, { (void *)payload, payloadSize } };
+
+    if (client->outstanding > 0 || sendVectors(client->fd, vectors, payloadSize ? 2 : 1, fd) != 0 ||
+        receiveAll(client->fd, &header, sizeof(header)) != 0 || header.type != (uint32_t)type ||
+        header.length != replySize)
+    {
+        return -1;
+    }
+
+    return receiveAll(client->fd, reply, replySize);
+}
+
+CalculationClient *calculationClientConnect(const char *socketPath)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        return NULL;
+    }
+
+    strcpy(address.sun_path, socketPath);
+
+    CalculationClient *client = calloc(1, sizeof(CalculationClient));
+
+    if (!client)
+    {
+        return NULL;
+    }
+
+    client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (client->fd < 0 || connect(client->fd, (const struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        calculationClientClose(client);
+        return NULL;
+    }
+
+    return client;
+}
+
+void calculationClientClose(CalculationClient *client)
+{
+    if (client)
+    {
+        if (client->fd >= 0)
+        {
+            close(client->fd);
+        }
+
+        free(client);
+    }
+}
+
+int calculationClientLookup(CalculationClient *client, const char *name, size_t *arity)
+{
+    // NUL padded to a multiple of 8
+    size_t length = (strlen(name) + 8) & ~(size_t)7;
+    char *padded = calloc(1, length);
+    DaemonLookupReply reply;
+
+    if (!padded)
+    {
+        return -1;
+    }
+
+    memcpy(padded, name, strlen(name));
+    int status = clientExchange(client, DaemonFrameLookup, padded, length, -1, &reply, sizeof(reply));
+    free(padded);
+
+    if (status != 0)
+    {
+        return -1;
+    }
+
+    if (arity)
+    {
+        *arity = reply.arity;
+    }
+
+    return reply.function;
+}
+
+int calculationRegionCreate(size_t size)
+{
+    int fd = memfd_create("compulations", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if (fd >= 0 && (ftruncate(fd, (off_t)size) != 0 || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL) != 0))
+    {
+        close(fd);
+        fd = -1;
+    }
+
+    return fd;
+}
+
+int calculationClientMapRegion(CalculationClient *client, int fd, size_t size)
+{
+    DaemonMapRequest request = { size };
+    DaemonMapReply reply;
+
+    if (fd < 0 || clientExchange(client, DaemonFrameMapRegion, &request, sizeof(request), fd, &reply, sizeof(reply)) != 0)
+    {
+        return -1;
+    }
+
+    return reply.region;
+}
+
+int calculationClientSubmit(CalculationClient *client,
+                            uint64_t tag,
+                            int function,
+                            uint32_t region,
+                            const uint64_t *argumentOffsets,
+                            size_t arity,
+                            uint64_t resultOffset,
+                            size_t count)
+{
+    DaemonEvaluateRequest request;
+    memset(&request, 0, sizeof(request));
+
+    if (arity > COMPULATION_MAX_ARITY)
+    {
+        return -1;
+    }
+
+    request.function = (uint32_t)function;
+    request.region = region;
+    request.count = count;
+    memcpy(request.argumentOffsets, argumentOffsets, arity * sizeof(uint64_t));
+    request.resultOffset = resultOffset;
+
+    DaemonFrameHeader header = { sizeof(request), DaemonFrameEvaluate, tag };
+    struct iovec vectors[2] = { { &header, sizeof(header) }, { &request, sizeof(request) } };
+
+    if (sendVectors(client->fd, vectors, 2, -1) != 0)
+    {
+        return -1;
+    }
+
+    client->outstanding++;
+
+    return 0;
+}
+
+int calculationClientSubmitInline(CalculationClient *client,
+                                  uint64_t tag,
+                                  int function,
+                                  const double *const *arguments,
+                                  size_t arity,
+                                  size_t count)
+{
+    DaemonEvaluateRequest request;
+    memset(&request, 0, sizeof(request));
+
+    if (arity > COMPULATION_MAX_ARITY || count > (DAEMON_MAX_FRAME_BYTES - sizeof(request)) / sizeof(double) / (arity ? arity : 1))
+    {
+        return -1;
+    }
+
+    request.function = (uint32_t)function;
+    request.region = DAEMON_REGION_INLINE;
+    request.count = count;
+
+    // The columns go out straight from the caller's arrays
+    DaemonFrameHeader header = { (uint32_t)(sizeof(request) + arity * count * sizeof(double)), DaemonFrameEvaluate, tag };
+    struct iovec vectors[2 + COMPULATION_MAX_ARITY] = { { &header, sizeof(header) }, { &request, sizeof(request) } };
+
+    for (size_t p = 0; p < arity; p++)
+    {
+        vectors[2 + p] = (struct iovec){ (void *)arguments[p], count * sizeof(double) };
+    }
+
+    if (sendVectors(client->fd, vectors, 2 + arity, -1) != 0)
+    {
+        return -1;
+    }
+
+    client->outstanding++;
+
+    return 0;
+}
+
+int calculationClientReceive(CalculationClient *client,
+                             uint64_t *tag,
+                             DaemonEvaluateReply *reply,
+                             double *results,
+                             size_t capacity)
+{
+    DaemonFrameHeader header;
+
+    if (client->outstanding == 0 || receiveAll(client->fd, &header, sizeof(header)) != 0 ||
+        header.type != DaemonFrameEvaluate || header.length < sizeof(*reply) ||
+        receiveAll(client->fd, reply, sizeof(*reply)) != 0)
+    {
+        return -1;
+    }
+
+    client->outstanding--;
+
+    if (tag)
+    {
+        *tag = header.tag;
+    }
+
+    size_t resultBytes = header.length - sizeof(*reply);
+
+    if (resultBytes > capacity * sizeof(double))
+    {
+        // Keep the stream in step, then report the overflow
+        uint8_t discard[4096];
+
+        while (resultBytes > 0)
+        {
+            size_t chunk = resultBytes < sizeof(discard) ? resultBytes : sizeof(discard);
+
+            if (receiveAll(client->fd, discard, chunk) != 0)
+            {
+                return -1;
+            }
+
+            resultBytes -= chunk;
+        }
+
+        return -1;
+    }
+
+    return resultBytes ? receiveAll(client->fd, results, resultBytes) : 0;
+}
+
+int calculationClientStats(CalculationClient *client, DaemonStatsReply *stats)
+{
+    return clientExchange(client, DaemonFrameStats, NULL, 0, -1, stats, sizeof(*stats));
+}
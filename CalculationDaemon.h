@@ -0,0 +1,215 @@
+//
+//  CalculationDaemon.h
+//
+//  Serves every function in FunctionTable.h over a Unix domain socket, so
+//  many processes can share one set of batch kernels and one thread pool.
+//  Arguments and results travel inline in the frames or stay in shared
+//  memory the client hands over once.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CalculationDaemon_h
+#define CalculationDaemon_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FunctionTable.h"
+#include "ThreadPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Protocol
+//
+// Every frame is a DaemonFrameHeader followed by length bytes of payload,
+// in host byte order, length a multiple of 8 so doubles in the payload stay
+// aligned. Requests can be sent back to back without waiting; replies come
+// back in request order with the request's tag.
+//
+//  DaemonFrameLookup    name, NUL padded           -> DaemonLookupReply
+//  DaemonFrameMapRegion DaemonMapRequest, plus the -> DaemonMapReply
+//                       region's fd as SCM_RIGHTS
+//  DaemonFrameEvaluate  DaemonEvaluateRequest,     -> DaemonEvaluateReply,
+//                       then arity * count doubles    then count doubles
+//                       column by column if inline    if inline
+//  DaemonFrameStats     nothing                    -> DaemonStatsReply
+
+#define DAEMON_REGION_INLINE UINT32_MAX
+#define DAEMON_MAX_REGIONS 16
+
+// Largest frame accepted; bigger batches should use a shared region.
+#define DAEMON_MAX_FRAME_BYTES (64u << 20)
+
+typedef enum DaemonFrameType
+{
+    DaemonFrameLookup = 1,
+    DaemonFrameMapRegion,
+    DaemonFrameEvaluate,
+    DaemonFrameStats
+} DaemonFrameType;
+
+typedef enum DaemonStatus
+{
+    DaemonStatusOK = 0,
+    DaemonStatusUnknownFunction,
+    DaemonStatusBadRegion,
+    DaemonStatusBadRequest
+} DaemonStatus;
+
+typedef struct DaemonFrameHeader
+{
+    uint32_t length;
+    uint32_t type;
+    uint64_t tag;
+} DaemonFrameHeader;
+
+typedef struct DaemonLookupReply
+{
+    int32_t function;
+    uint32_t arity;
+} DaemonLookupReply;
+
+typedef struct DaemonMapRequest
+{
+    uint64_t size;
+} DaemonMapRequest;
+
+// region is -1 if the fd could not be mapped, is shorter than size or is not
+// sealed with F_SEAL_SHRINK, or the connection has DAEMON_MAX_REGIONS already
+typedef struct DaemonMapReply
+{
+    int32_t region;
+    uint32_t reserved;
+} DaemonMapReply;
+
+// function is an index from DaemonFrameLookup. For a shared region,
+// argumentOffsets[i] and resultOffset are byte offsets of count doubles in
+// it; the results are written there and only the reply header comes back.
+typedef struct DaemonEvaluateRequest
+{
+    uint32_t function;
+    uint32_t region;
+    uint64_t count;
+    uint64_t argumentOffsets[COMPULATION_MAX_ARITY];
+    uint64_t resultOffset;
+} DaemonEvaluateRequest;
+
+typedef struct DaemonEvaluateReply
+{
+    uint32_t status;
+    uint32_t reserved;
+    uint64_t count;
+} DaemonEvaluateReply;
+
+// Server side latency of evaluate requests, from the frame being read to
+// its reply being written to the socket, in microseconds. Percentiles are
+// from a log histogram with 8 buckets per doubling, so within 9%.
+typedef struct DaemonStatsReply
+{
+    uint64_t requests;
+    uint64_t values;
+    double p50Microseconds;
+    double p99Microseconds;
+    double maxMicroseconds;
+} DaemonStatsReply;
+
+// Server
+
+typedef struct CalculationDaemon CalculationDaemon;
+
+// Listens on socketPath, replacing any stale socket file. Batches run on
+// pool, which may be NULL, and go through the SIMD kernels in
+// BatchCompulations.h where the function has one. Returns NULL on failure.
+CalculationDaemon *calculationDaemonCreate(const char *socketPath, ThreadPool *pool);
+
+// Serves until calculationDaemonStop. Returns 0, or -1 if polling fails.
+int calculationDaemonRun(CalculationDaemon *daemon);
+
+// Safe from other threads and from signal handlers
+void calculationDaemonStop(CalculationDaemon *daemon);
+
+// Latency so far; safe from other threads
+void calculationDaemonStats(CalculationDaemon *daemon, DaemonStatsReply *stats);
+
+// Closes every connection and removes the socket file
+void calculationDaemonDestroy(CalculationDaemon *daemon);
+
+// Client
+//
+// Blocking, one thread at a time per client. Submit as many batches as
+// needed before receiving; each receive returns the oldest outstanding
+// reply. Lookups, region maps and stats wait for their own reply, so they
+// fail while any batch is outstanding.
+
+typedef struct CalculationClient CalculationClient;
+
+CalculationClient *calculationClientConnect(const char *socketPath);
+void calculationClientClose(CalculationClient *client);
+
+// Function index for the name, or -1. arity may be NULL.
+int calculationClientLookup(CalculationClient *client, const char *name, size_t *arity);
+
+// A memfd of size bytes sealed against shrinking, as the daemon requires for
+// a shared region, or -1.
+int calculationRegionCreate(size_t size);
+
+// Shares size bytes of fd, e.g. from calculationRegionCreate, with the daemon.
+// Returns the region number, or -1.
+int calculationClientMapRegion(CalculationClient *client, int fd, size_t size);
+
+// Queues a batch whose arguments and results live in region. Returns 0, or
+// -1 if the connection failed.
+int calculationClientSubmit(CalculationClient *client,
+                            uint64_t tag,
+                            int function,
+                            uint32_t region,
+                            const uint64_t *argumentOffsets,
+                            size_t arity,
+                            uint64_t resultOffset,
+                            size_t count);
+
+// Queues a batch whose arguments are copied into the frame;
+// arguments[i][k] is parameter i of call k.
+int calculationClientSubmitInline(CalculationClient *client,
+                                  uint64_t tag,
+                                  int function,
+                                  const double *const *arguments,
+                                  size_t arity,
+                                  size_t count);
+
+// Waits for the next reply to a submitted batch. Inline results go to
+// results, which has room for the batch's count. Returns 0, or -1 if the
+// connection failed or the reply doesn't fit.
+int calculationClientReceive(CalculationClient *client,
+                             uint64_t *tag,
+                             DaemonEvaluateReply *reply,
+                             double *results,
+                             size_t capacity);
+
+// Daemon latency. Returns 0, or -1.
+int calculationClientStats(CalculationClient *client, DaemonStatsReply *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CalculationDaemon_h */
@@ -23,14 +23,19 @@
  */
 
 #include "Compulations.h"
+#include "CompulationsInstrumentation.h"
 #include "UnitConversion.h"
-#include "Math.h"
+#include <math.h>
+
+#include <pthread.h>
 
 // Power factor from nameplate data
 double threePhaseMotorPowerFactor(double nameplateHP,
                                   double nameplateVolts,
                                   double nameplateAmps)
 {
+    COMPULATIONS_ENTER(threePhaseMotorPowerFactor);
+
     double pf = 0.0;
 
     if (nameplateHP > 0.0 && nameplateVolts > 0.0 && nameplateAmps > 0.0)
@@ -40,14 +45,20 @@ double threePhaseMotorPowerFactor(double nameplateHP,
 
         pf = numerator / denominator;
     }
+    else
+    {
+        COMPULATIONS_REJECT(threePhaseMotorPowerFactor, nameplateHP > 0.0, nameplateVolts > 0.0, nameplateAmps > 0.0);
+    }
 
-    return pf;
+    return COMPULATIONS_LEAVE(threePhaseMotorPowerFactor, pf);
 }
 
 double singlePhaseMotorPowerFactor(double nameplateHP,
                                    double nameplateVolts,
                                    double nameplateAmps)
 {
+    COMPULATIONS_ENTER(singlePhaseMotorPowerFactor);
+
     double pf = 0.0;
     
     if (nameplateHP > 0.0 && nameplateVolts > 0.0 && nameplateAmps > 0.0)
@@ -57,8 +68,12 @@ double singlePhaseMotorPowerFactor(double nameplateHP,
         
         pf = numerator / denominator;
     }
+    else
+    {
+        COMPULATIONS_REJECT(singlePhaseMotorPowerFactor, nameplateHP > 0.0, nameplateVolts > 0.0, nameplateAmps > 0.0);
+    }
     
-    return pf;
+    return COMPULATIONS_LEAVE(singlePhaseMotorPowerFactor, pf);
 }
 
 
@@ -66,14 +81,20 @@ double threePhaseMotorInputPowerKW(double volts,
                                    double amps,
                                    double powerFactor)
 {
+    COMPULATIONS_ENTER(threePhaseMotorInputPowerKW);
+
     double kw = 0.0;
     
     if (volts > 0.0 && amps > 0.0 && powerFactor > 0.0)
     {
         kw = (volts * amps * powerFactor * sqrt(3.0)) / 1000.0;
     }
+    else
+    {
+        COMPULATIONS_REJECT(threePhaseMotorInputPowerKW, volts > 0.0, amps > 0.0, powerFactor > 0.0);
+    }
 
-    return kw;
+    return COMPULATIONS_LEAVE(threePhaseMotorInputPowerKW, kw);
 }
 
 // Shaft Power
@@ -82,6 +103,8 @@ double threePhaseShaftPowerHP(double volts,
                               double efficiency,
                               double powerFactor)
 {
+    COMPULATIONS_ENTER(threePhaseShaftPowerHP);
+
     double hp = 0.0;
 
     if (volts > 0.0 && amps > 0.0 && efficiency > 0.0 && powerFactor > 0.0)
@@ -89,8 +112,12 @@ double threePhaseShaftPowerHP(double volts,
         double shaftKw = (volts * amps * efficiency * powerFactor * sqrt(3.0)) / 1000.0;
         hp = hpFromKw(shaftKw);
     }
+    else
+    {
+        COMPULATIONS_REJECT(threePhaseShaftPowerHP, volts > 0.0, amps > 0.0, efficiency > 0.0, powerFactor > 0.0);
+    }
 
-    return hp;
+    return COMPULATIONS_LEAVE(threePhaseShaftPowerHP, hp);
 }
 
 // Optimal operating temperature for oil flooded screw
@@ -98,6 +125,8 @@ double oilFloodedScrewOperatingTempF(double inletTempF,
                                      double dischargePressurePSIG,
                                      double ambientPSIA)
 {
+    COMPULATIONS_ENTER(oilFloodedScrewOperatingTempF);
+
     double opTempC = 0.0;
 
     double psiaLine = dischargePressurePSIG + ambientPSIA;
@@ -127,26 +156,179 @@ double oilFloodedScrewOperatingTempF(double inletTempF,
         opTempC = pdpHi;
     }
 
-    return fahrenheitFromCelsius(opTempC);
+    return COMPULATIONS_LEAVE(oilFloodedScrewOperatingTempF, fahrenheitFromCelsius(opTempC));
 }
 
 // Pressure-Altitude relationship
-double ambientPSIAForAltitudeInFeet(double altitude)
-{    
-    double ambientPSIA = (101325.0 * pow((1 - 0.0000225577 * metersFromFeet(altitude)), 5.25588)) / 6894.75729;
-    
-    return ambientPSIA;
+// The formulas themselves, uninstrumented, so the tables and the Fast
+// fallbacks do not show up as calls to the exact functions
+static double psiaForAltitude(double altitude)
+{
+    return (101325.0 * pow((1 - 0.0000225577 * metersFromFeet(altitude)), 5.25588)) / 6894.75729;
 }
 
-double altitudeFeetFromPSIA(double psia)
+static double altitudeForPSIA(double psia)
 {
     double mBar = kPaFromPSI(psia) * 10.0;
     
     double pstd = 1013.25;
     
-    double altitude = (1 - pow((mBar/pstd), 0.190284)) * 145366.45;
+    return (1 - pow((mBar/pstd), 0.190284)) * 145366.45;
+}
+
+double ambientPSIAForAltitudeInFeet(double altitude)
+{    
+    COMPULATIONS_ENTER(ambientPSIAForAltitudeInFeet);
+
+    double ambientPSIA = psiaForAltitude(altitude);
+    
+    return COMPULATIONS_LEAVE(ambientPSIAForAltitudeInFeet, ambientPSIA);
+}
+
+double altitudeFeetFromPSIA(double psia)
+{
+    COMPULATIONS_ENTER(altitudeFeetFromPSIA);
+
+    double altitude = altitudeForPSIA(psia);
     
-    return altitude;
+    return COMPULATIONS_LEAVE(altitudeFeetFromPSIA, altitude);
+}
+
+// Interpolated pressure-altitude relationship
+//
+// Cubic Hermite segments through the exact curve and its exact slope, with
+// the Fritsch-Carlson limit applied so the interpolant stays monotone. The
+// altitude table is uniform in feet and the pressure table uniform in psia,
+// so a lookup is one multiply, one truncation and a cubic.
+#define ALTITUDE_TABLE_MIN_FEET -1000.0
+#define ALTITUDE_TABLE_MAX_FEET 30000.0
+#define ALTITUDE_TABLE_SEGMENTS 155
+#define PSIA_TABLE_SEGMENTS 275
+
+static double altitudeTable[ALTITUDE_TABLE_SEGMENTS][4];
+static double psiaTable[PSIA_TABLE_SEGMENTS][4];
+static double psiaTableMin;
+static double psiaTableMax;
+static double psiaTableScale;
+static pthread_once_t altitudeTablesOnce = PTHREAD_ONCE_INIT;
+
+static double ambientPSIASlopeForAltitudeInFeet(double altitude)
+{
+    double base = 1 - 0.0000225577 * metersFromFeet(altitude);
+
+    return (101325.0 * 5.25588 * pow(base, 4.25588) * -0.0000225577 / 3.2808399) / 6894.75729;
+}
+
+static double altitudeFeetSlopeFromPSIA(double psia)
+{
+    double ratio = kPaFromPSI(psia) * 10.0 / 1013.25;
+
+    return -145366.45 * 0.190284 * pow(ratio, 0.190284 - 1.0) * (10.0 / 0.14503773773020923) / 1013.25;
+}
+
+// Coefficients in u = (x - x0) / h for the Hermite cubic on one segment
+static void hermiteSegment(double y0, double y1, double slope0, double slope1, double h, double *a)
+{
+    double secant = (y1 - y0) / h;
+
+    // Fritsch-Carlson: keep the scaled slopes inside the circle of radius 3
+    if (secant == 0.0)
+    {
+        slope0 = 0.0;
+        slope1 = 0.0;
+    }
+    else
+    {
+        // A slope against the secant is zeroed before the radius test, so
+        // the rescale cannot bring it back with the wrong sign.
+        double alpha = fmax(slope0 / secant, 0.0);
+        double beta = fmax(slope1 / secant, 0.0);
+        double radius = alpha * alpha + beta * beta;
+        double tau = radius > 9.0 ? 3.0 / sqrt(radius) : 1.0;
+
+        slope0 = tau * alpha * secant;
+        slope1 = tau * beta * secant;
+    }
+
+    double m0 = slope0 * h;
+    double m1 = slope1 * h;
+
+    a[0] = y0;
+    a[1] = m0;
+    a[2] = 3.0 * (y1 - y0) - 2.0 * m0 - m1;
+    a[3] = 2.0 * (y0 - y1) + m0 + m1;
+}
+
+static void buildAltitudeTables(void)
+{
+    double h = (ALTITUDE_TABLE_MAX_FEET - ALTITUDE_TABLE_MIN_FEET) / ALTITUDE_TABLE_SEGMENTS;
+
+    for (int k = 0; k < ALTITUDE_TABLE_SEGMENTS; k++)
+    {
+        double x0 = ALTITUDE_TABLE_MIN_FEET + k * h;
+        double x1 = x0 + h;
+
+        hermiteSegment(psiaForAltitude(x0), psiaForAltitude(x1),
+                       ambientPSIASlopeForAltitudeInFeet(x0), ambientPSIASlopeForAltitudeInFeet(x1),
+                       h, altitudeTable[k]);
+    }
+
+    psiaTableMin = psiaForAltitude(ALTITUDE_TABLE_MAX_FEET);
+    psiaTableMax = psiaForAltitude(ALTITUDE_TABLE_MIN_FEET);
+    h = (psiaTableMax - psiaTableMin) / PSIA_TABLE_SEGMENTS;
+    psiaTableScale = 1.0 / h;
+
+    for (int k = 0; k < PSIA_TABLE_SEGMENTS; k++)
+    {
+        double x0 = psiaTableMin + k * h;
+        double x1 = x0 + h;
+
+        hermiteSegment(altitudeForPSIA(x0), altitudeForPSIA(x1),
+                       altitudeFeetSlopeFromPSIA(x0), altitudeFeetSlopeFromPSIA(x1),
+                       h, psiaTable[k]);
+    }
+}
+
+double ambientPSIAForAltitudeInFeetFast(double altitude)
+{
+    COMPULATIONS_ENTER(ambientPSIAForAltitudeInFeetFast);
+
+    if (!(altitude >= ALTITUDE_TABLE_MIN_FEET && altitude <= ALTITUDE_TABLE_MAX_FEET))
+    {
+        return COMPULATIONS_LEAVE(ambientPSIAForAltitudeInFeetFast, psiaForAltitude(altitude));
+    }
+
+    pthread_once(&altitudeTablesOnce, buildAltitudeTables);
+
+    double x = (altitude - ALTITUDE_TABLE_MIN_FEET) * (ALTITUDE_TABLE_SEGMENTS / (ALTITUDE_TABLE_MAX_FEET - ALTITUDE_TABLE_MIN_FEET));
+    int k = (int)x;
+    k = k < ALTITUDE_TABLE_SEGMENTS - 1 ? k : ALTITUDE_TABLE_SEGMENTS - 1;
+
+    double u = x - k;
+    const double *a = altitudeTable[k];
+
+    return COMPULATIONS_LEAVE(ambientPSIAForAltitudeInFeetFast, ((a[3] * u + a[2]) * u + a[1]) * u + a[0]);
+}
+
+double altitudeFeetFromPSIAFast(double psia)
+{
+    COMPULATIONS_ENTER(altitudeFeetFromPSIAFast);
+
+    pthread_once(&altitudeTablesOnce, buildAltitudeTables);
+
+    if (!(psia >= psiaTableMin && psia <= psiaTableMax))
+    {
+        return COMPULATIONS_LEAVE(altitudeFeetFromPSIAFast, altitudeForPSIA(psia));
+    }
+
+    double x = (psia - psiaTableMin) * psiaTableScale;
+    int k = (int)x;
+    k = k < PSIA_TABLE_SEGMENTS - 1 ? k : PSIA_TABLE_SEGMENTS - 1;
+
+    double u = x - k;
+    const double *a = psiaTable[k];
+
+    return COMPULATIONS_LEAVE(altitudeFeetFromPSIAFast, ((a[3] * u + a[2]) * u + a[1]) * u + a[0]);
 }
 
 // Pumpup Time
@@ -156,6 +338,8 @@ double pumpupTimeInSeconds(double tankSizeGallons,
                            double endPressurePSIG,
                            double ambientAtmosphericPressurePSIA)
 {
+    COMPULATIONS_ENTER(pumpupTimeInSeconds);
+
     double time = 0.0;
 
     double deltaP = endPressurePSIG - startPressurePSIG;
@@ -166,8 +350,12 @@ double pumpupTimeInSeconds(double tankSizeGallons,
         double denominator = (ambientAtmosphericPressurePSIA * flowRateCFM);
         time = ((numerator / denominator) * 60.0);
     }
+    else
+    {
+        COMPULATIONS_REJECT(pumpupTimeInSeconds, tankSizeGallons > 0.0, flowRateCFM > 0.0, deltaP > 0.0);
+    }
 
-    return time;
+    return COMPULATIONS_LEAVE(pumpupTimeInSeconds, time);
 }
 
 // Leak Rate
@@ -177,6 +365,8 @@ double leakRateCFM(double tankSizeGallons,
                    double ambientPSIA,
                    double decayTimeMins)
 {
+    COMPULATIONS_ENTER(leakRateCFM);
+
     double cfm = 0.0;
 
     if (tankSizeGallons > 0.0 && decayTimeMins > 0.0 && startPSIG > 0.0 && ambientPSIA > 0.0)
@@ -199,8 +389,12 @@ double leakRateCFM(double tankSizeGallons,
 
         cfm = numerator / denominator;
     }
+    else
+    {
+        COMPULATIONS_REJECT(leakRateCFM, tankSizeGallons > 0.0, decayTimeMins > 0.0, startPSIG > 0.0, ambientPSIA > 0.0);
+    }
 
-    return cfm;
+    return COMPULATIONS_LEAVE(leakRateCFM, cfm);
 }
 
 // Refill Rate
@@ -210,6 +404,8 @@ double refillRateCFM(double storageCF,
                      double refillTimeMins,
                      double ambientPreesurePSIA)
 {
+    COMPULATIONS_ENTER(refillRateCFM);
+
     double cfm = 0.0;
 
     double deltaP = endPressurePSIG - startPressurePSIG;
@@ -220,8 +416,12 @@ double refillRateCFM(double storageCF,
         double denominator = refillTimeMins * ambientPreesurePSIA;
         cfm = numerator / denominator;
     }
+    else
+    {
+        COMPULATIONS_REJECT(refillRateCFM, deltaP > 0.0, storageCF > 0.0, refillTimeMins > 0.0, ambientPreesurePSIA > 0.0);
+    }
     
-    return cfm;
+    return COMPULATIONS_LEAVE(refillRateCFM, cfm);
 }
 
 // System Capacity Estimator
@@ -232,6 +432,8 @@ double systemCapacityCubicFeetByCycleTime(double unloadedTimeSec,
                                           double ratedFlowCFM,
                                           double ambientPreesurePSIA)
 {
+    COMPULATIONS_ENTER(systemCapacityCubicFeetByCycleTime);
+
     double volumeCF = 0.0;
 
     // Need these later, but we do it now to simplify > 0 for all vars.
@@ -245,8 +447,12 @@ double systemCapacityCubicFeetByCycleTime(double unloadedTimeSec,
 
         volumeCF = numerator / denominator;
     }
+    else
+    {
+        COMPULATIONS_REJECT(systemCapacityCubicFeetByCycleTime, totalTime > 0.0, deltaP > 0.0, ratedFlowCFM > 0.0, ambientPreesurePSIA > 0.0);
+    }
 
-    return volumeCF;
+    return COMPULATIONS_LEAVE(systemCapacityCubicFeetByCycleTime, volumeCF);
 }
 
 // Secondary storage
@@ -257,6 +463,8 @@ double eventStorageCubicFeet(double eventDurationMins,
                              double initialPressurePSIG,
                              double minPressureForEventPSIG)
 {
+    COMPULATIONS_ENTER(eventStorageCubicFeet);
+
     double volumeCF = 0.0;
     
     double deltaP = initialPressurePSIG - minPressureForEventPSIG;
@@ -267,13 +475,19 @@ double eventStorageCubicFeet(double eventDurationMins,
         double numerator = eventDurationMins * deltaV * ambientPSIA;
         volumeCF = numerator / deltaP;
     }
+    else
+    {
+        COMPULATIONS_REJECT(eventStorageCubicFeet, eventDurationMins > 0.0, deltaV > 0.0, deltaP > 0.0, ambientPSIA > 0.0);
+    }
     
-    return volumeCF;
+    return COMPULATIONS_LEAVE(eventStorageCubicFeet, volumeCF);
 }
 
 // Vapor pressure of water
 double vaporPressureOfWaterInPsiForTemp(double degreesFahrenheit)
 {
+    COMPULATIONS_ENTER(vaporPressureOfWaterInPsiForTemp);
+
     // Return the vapor pressure of water using Antoine Equation
     // Good for temp range between 1-374 C
     double tempC = celsiusFromFahrenheit(degreesFahrenheit);
@@ -298,7 +512,94 @@ double vaporPressureOfWaterInPsiForTemp(double degreesFahrenheit)
     double vapMMHG = pow(10, exponent);
     double vapPSIG = vapMMHG * 0.0193367747; //mmHG to PSI
 
-    return vapPSIG;
+    return COMPULATIONS_LEAVE(vaporPressureOfWaterInPsiForTemp, vapPSIG);
+}
+
+// Fast vapor pressure of water
+//
+// Piecewise cubic table over 1 C segments. Segment k covers the half-open
+// interval (VAPOR_TABLE_MIN_C + k, VAPOR_TABLE_MIN_C + k + 1], so the 100 C
+// Antoine constant switch falls on a segment edge and needs no branch. Each
+// cubic interpolates its side of the Antoine equation at four Chebyshev nodes.
+#define VAPOR_TABLE_MIN_C -40.0
+#define VAPOR_TABLE_SEGMENTS 414
+
+static double vaporTable[VAPOR_TABLE_SEGMENTS][4];
+static pthread_once_t vaporTableOnce = PTHREAD_ONCE_INIT;
+
+static double antoineVaporPressurePsi(double tempC, int highRange)
+{
+    double conA = highRange ? 8.14019 : 8.07131;
+    double conB = highRange ? 1810.94 : 1730.63;
+    double conC = highRange ? 244.485 : 233.426;
+
+    return pow(10, conA - (conB / (conC + tempC))) * 0.0193367747;
+}
+
+static void buildVaporTable(void)
+{
+    for (int k = 0; k < VAPOR_TABLE_SEGMENTS; k++)
+    {
+        double segmentStartC = VAPOR_TABLE_MIN_C + k;
+        int highRange = (segmentStartC + 0.5) > 100.0;
+
+        // Newton form through the Chebyshev nodes of [0, 1]
+        double u[4], c[4];
+
+        for (int i = 0; i < 4; i++)
+        {
+            u[i] = 0.5 - 0.5 * cos((2.0 * i + 1.0) * M_PI / 8.0);
+            c[i] = antoineVaporPressurePsi(segmentStartC + u[i], highRange);
+        }
+
+        for (int j = 1; j < 4; j++)
+        {
+            for (int i = 3; i >= j; i--)
+            {
+                c[i] = (c[i] - c[i - 1]) / (u[i] - u[i - j]);
+            }
+        }
+
+        // Expand to monomial coefficients in u
+        double a[4] = { c[3], 0.0, 0.0, 0.0 };
+
+        for (int i = 2; i >= 0; i--)
+        {
+            for (int j = 3; j > 0; j--)
+            {
+                a[j] = a[j - 1] - u[i] * a[j];
+            }
+
+            a[0] = c[i] - u[i] * a[0];
+        }
+
+        for (int j = 0; j < 4; j++)
+        {
+            vaporTable[k][j] = a[j];
+        }
+    }
+}
+
+double vaporPressureOfWaterInPsiForTempFast(double degreesFahrenheit)
+{
+    COMPULATIONS_ENTER(vaporPressureOfWaterInPsiForTempFast);
+
+    pthread_once(&vaporTableOnce, buildVaporTable);
+
+    double x = celsiusFromFahrenheit(degreesFahrenheit) - VAPOR_TABLE_MIN_C;
+
+    // Clamp without branches; the end segments extrapolate.
+    x = x < 0.0 ? 0.0 : x;
+    x = x > VAPOR_TABLE_SEGMENTS ? VAPOR_TABLE_SEGMENTS : x;
+
+    int k = (int)x;
+    k -= ((double)k == x);
+    k = k < 0 ? 0 : k;
+
+    double u = x - k;
+    const double *a = vaporTable[k];
+
+    return COMPULATIONS_LEAVE(vaporPressureOfWaterInPsiForTempFast, ((a[3] * u + a[2]) * u + a[1]) * u + a[0]);
 }
 
 // ACFM SCFM conversions
@@ -311,6 +612,8 @@ double scfmFromACFM(double acfm,
                     double siteAmbientRH,
                     double inletPressurePSI)
 {
+    COMPULATIONS_ENTER(scfmFromACFM);
+
     double scfm = 0.0;
     double rhNumerator = standardAmbientPressurePSI - (standardAmbientRH * vaporPressureOfWaterInPsiForTemp(standardAmbientTempF));
     double rhDenominator = siteAmbientPressurePSI - (siteAmbientRH * vaporPressureOfWaterInPsiForTemp(siteAmbientTempF));
@@ -319,7 +622,7 @@ double scfmFromACFM(double acfm,
     double inletPressureMultiplier = siteAmbientPressurePSI / inletPressurePSI;
     scfm = (acfm / rhMultiplier) / tempMultiplier / inletPressureMultiplier;
 
-    return scfm;
+    return COMPULATIONS_LEAVE(scfmFromACFM, scfm);
 }
 
 double acfmFromSCFM(double scfm,
@@ -331,6 +634,8 @@ double acfmFromSCFM(double scfm,
                     double siteAmbientRH,
                     double inletPressurePSI)
 {
+    COMPULATIONS_ENTER(acfmFromSCFM);
+
     double acfm = 0.0;
     double rhNumerator = standardAmbientPressurePSI - (standardAmbientRH * vaporPressureOfWaterInPsiForTemp(standardAmbientTempF));
     double rhDenominator = siteAmbientPressurePSI - (siteAmbientRH * vaporPressureOfWaterInPsiForTemp(siteAmbientTempF));
@@ -339,7 +644,7 @@ double acfmFromSCFM(double scfm,
     double inletPressureMultiplier = siteAmbientPressurePSI / inletPressurePSI;
     acfm = scfm * rhMultiplier * tempMultiplier * inletPressureMultiplier;
 
-    return acfm;
+    return COMPULATIONS_LEAVE(acfmFromSCFM, acfm);
 }
 
 // Determine pipe size in inches to obtain a specific velocity for site conditions.
@@ -348,6 +653,8 @@ double pipeDiameterInchesForVelocity(double flowRateCFM,
                                      double linePressurePSIG,
                                      double ambientPreesurePSIA)
 {
+    COMPULATIONS_ENTER(pipeDiameterInchesForVelocity);
+
     double pipeDiameterIn = 0.0;
     
     if (flowRateCFM > 0.0 && velocityFPS > 0.0 && linePressurePSIG > 0.0)
@@ -357,8 +664,12 @@ double pipeDiameterInchesForVelocity(double flowRateCFM,
         double areaInSq = numerator / denominator;
         pipeDiameterIn = sqrt(areaInSq / M_PI) * 2.0;
     }
+    else
+    {
+        COMPULATIONS_REJECT(pipeDiameterInchesForVelocity, flowRateCFM > 0.0, velocityFPS > 0.0, linePressurePSIG > 0.0);
+    }
 
-    return pipeDiameterIn;
+    return COMPULATIONS_LEAVE(pipeDiameterInchesForVelocity, pipeDiameterIn);
 }
 
 // Velocity for diameter
@@ -367,6 +678,8 @@ double velocityInPipeFPS(double flowRateCFM,
                          double ambientPreesurePSIA,
                          double pipeDiameterIn)
 {
+    COMPULATIONS_ENTER(velocityInPipeFPS);
+
     double fps = 0.0;
 
     if (flowRateCFM > 0.0 && linePressurePSIG > 0.0 && ambientPreesurePSIA > 0.0 && pipeDiameterIn > 0.0)
@@ -379,8 +692,12 @@ double velocityInPipeFPS(double flowRateCFM,
         
         fps = numerator / denominator;
     }
+    else
+    {
+        COMPULATIONS_REJECT(velocityInPipeFPS, flowRateCFM > 0.0, linePressurePSIG > 0.0, ambientPreesurePSIA > 0.0, pipeDiameterIn > 0.0);
+    }
     
-    return fps;
+    return COMPULATIONS_LEAVE(velocityInPipeFPS, fps);
 }
 
 // Density of air lbs/ft^3
@@ -388,6 +705,8 @@ double airDensityPoundsPerCubicFoot(double linePressurePSIG,
                                     double ambientPreesurePSIA,
                                     double airTemperatureF)
 {
+    COMPULATIONS_ENTER(airDensityPoundsPerCubicFoot);
+
     double lbsCF = 0.0;
     double absoluteP = linePressurePSIG + ambientPreesurePSIA;
 
@@ -395,8 +714,62 @@ double airDensityPoundsPerCubicFoot(double linePressurePSIG,
     {
         lbsCF = (2.7 * absoluteP) / rankineFromFahrenheit(airTemperatureF);
     }
+    else
+    {
+        COMPULATIONS_REJECT(airDensityPoundsPerCubicFoot, absoluteP > 0.0);
+    }
     
-    return lbsCF;
+    return COMPULATIONS_LEAVE(airDensityPoundsPerCubicFoot, lbsCF);
+}
+
+// Darcy-Weisbach pressure drop
+double pipePressureDropPSI(double flowRateCFM,
+                           double linePressurePSIG,
+                           double ambientPreesurePSIA,
+                           double airTemperatureF,
+                           double pipeDiameterIn,
+                           double pipeLengthFt)
+{
+    COMPULATIONS_ENTER(pipePressureDropPSI);
+
+    double dropPSI = 0.0;
+    double fps = velocityInPipeFPS(flowRateCFM, linePressurePSIG, ambientPreesurePSIA, pipeDiameterIn);
+
+    if (fps > 0.0 && pipeLengthFt > 0.0)
+    {
+        double lbsCF = airDensityPoundsPerCubicFoot(linePressurePSIG, ambientPreesurePSIA, airTemperatureF);
+        double diameterFt = pipeDiameterIn / 12.0;
+
+        // Viscosity of air near room temperature is 1.22e-5 lb/ft-s, steel
+        // roughness 0.00015 ft.
+        double reynolds = lbsCF * fps * diameterFt / 1.22e-5;
+        double relativeRoughness = 0.00015 / diameterFt;
+
+        // Laminar below Re 2000, Swamee-Jain above 4000 and a straight line
+        // between them, so the factor stays finite and continuous at low flow
+        double friction = 64.0 / reynolds;
+
+        if (reynolds > 2000.0)
+        {
+            double turbulentRe = reynolds > 4000.0 ? reynolds : 4000.0;
+            double logTerm = log10(relativeRoughness / 3.7 + 5.74 / pow(turbulentRe, 0.9));
+            friction = 0.25 / (logTerm * logTerm);
+
+            if (reynolds < 4000.0)
+            {
+                double blend = (reynolds - 2000.0) / 2000.0;
+                friction = 0.032 + blend * (friction - 0.032);
+            }
+        }
+
+        dropPSI = friction * (pipeLengthFt / diameterFt) * lbsCF * fps * fps / (2.0 * 32.174 * 144.0);
+    }
+    else
+    {
+        COMPULATIONS_REJECT(pipePressureDropPSI, fps > 0.0, pipeLengthFt > 0.0);
+    }
+
+    return COMPULATIONS_LEAVE(pipePressureDropPSI, dropPSI);
 }
 
 // Mapping Function, useful for sensors
@@ -406,21 +779,25 @@ double mappedValue(double inputValue,
                    double outputMin,
                    double outputMax)
 {
+    COMPULATIONS_ENTER(mappedValue);
+
     double mapped = 0.0;
 
     double slope = 1.0 * (outputMax - outputMin) / (inputMax - inputMin);
     mapped = outputMin + slope * (inputValue - inputMin);
 
-    return mapped;
+    return COMPULATIONS_LEAVE(mappedValue, mapped);
 }
 
 // Gear speed
 double gearSpeedFeetPerMinute(double gearDiameterInches,
                               double rpm)
 {
+    COMPULATIONS_ENTER(gearSpeedFeetPerMinute);
+
     double speed = (M_PI / 12.0) * gearDiameterInches * rpm;
 
-    return speed;
+    return COMPULATIONS_LEAVE(gearSpeedFeetPerMinute, speed);
 }
 
 // Oil Carryover Volume
@@ -429,6 +806,8 @@ double oilCarryoverGallons(double flowRateCFM,
                            double operatingHours,
                            double oilSpecificGravity)
 {
+    COMPULATIONS_ENTER(oilCarryoverGallons);
+
     double gallons = 0.0;
 
     if (flowRateCFM > 0.0 && concentrationPPM > 0.0 && operatingHours > 0.0 && oilSpecificGravity > 0.0)
@@ -437,8 +816,12 @@ double oilCarryoverGallons(double flowRateCFM,
         double denominator = (oilSpecificGravity * 128.0);
         gallons = numerator / denominator;
     }
+    else
+    {
+        COMPULATIONS_REJECT(oilCarryoverGallons, flowRateCFM > 0.0, concentrationPPM > 0.0, operatingHours > 0.0, oilSpecificGravity > 0.0);
+    }
 
-    return gallons;
+    return COMPULATIONS_LEAVE(oilCarryoverGallons, gallons);
 }
 
 // Oil Carryover Concentration
@@ -447,6 +830,8 @@ double oilCarryoverConcentrationPPM(double flowRateCFM,
                                     double operatingHours,
                                     double oilSpecificGravity)
 {
+    COMPULATIONS_ENTER(oilCarryoverConcentrationPPM);
+
     double ppm = 0.0;
 
     if (flowRateCFM > 0.0 && oilLossGallons > 0.0 && operatingHours > 0.0 && oilSpecificGravity > 0.0)
@@ -455,6 +840,10 @@ double oilCarryoverConcentrationPPM(double flowRateCFM,
         double denominator = (operatingHours * 60.0 * flowRateCFM * 0.0000012);
         ppm = numerator / denominator;
     }
+    else
+    {
+        COMPULATIONS_REJECT(oilCarryoverConcentrationPPM, flowRateCFM > 0.0, oilLossGallons > 0.0, operatingHours > 0.0, oilSpecificGravity > 0.0);
+    }
     
-    return ppm;
+    return COMPULATIONS_LEAVE(oilCarryoverConcentrationPPM, ppm);
 }
@@ -22,6 +22,13 @@
  along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef Compulations_h
+#define Compulations_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Power factor from nameplate
 double threePhaseMotorPowerFactor(double nameplateHP,
                                   double nameplateVolts,
@@ -51,6 +58,13 @@ double oilFloodedScrewOperatingTempF(double inletTempF,
 double ambientPSIAForAltitudeInFeet(double altitude);
 double altitudeFeetFromPSIA(double psia);
 
+// Table versions of the above, monotone cubic interpolation without pow().
+// Covers -1,000 to 30,000 ft (15.24 to 4.36 psia); outside that range they
+// fall back to the exact functions. Maximum error against the exact functions
+// is 3e-11 psia and 2e-6 ft. Thread safe; the tables are built on first use.
+double ambientPSIAForAltitudeInFeetFast(double altitude);
+double altitudeFeetFromPSIAFast(double psia);
+
 // Pumpup Time
 double pumpupTimeInSeconds(double tankSizeGallons,
                            double flowRateCFM,
@@ -91,6 +105,12 @@ double eventStorageCubicFeet(double eventDurationMins,
 // ACFM SCFM conversions
 double vaporPressureOfWaterInPsiForTemp(double degreesFahrenheit);
 
+// Table version of vaporPressureOfWaterInPsiForTemp, no pow() and no branch on
+// the 100 C constant switch. Maximum relative error against the Antoine
+// version is 4e-9 over 1-374 C, and 2.2e-8 down to -40 C. Thread safe; the
+// table is built on first use.
+double vaporPressureOfWaterInPsiForTempFast(double degreesFahrenheit);
+
 double scfmFromACFM(double acfm,
                     double standardAmbientPressurePSI,
                     double standardAmbientTempF,
@@ -126,6 +146,14 @@ double airDensityPoundsPerCubicFoot(double linePressurePSIG,
                                     double ambientPreesurePSIA,
                                     double airTemperatureF);
 
+// Darcy-Weisbach pressure drop in psi over a length of commercial steel pipe
+double pipePressureDropPSI(double flowRateCFM,
+                           double linePressurePSIG,
+                           double ambientPreesurePSIA,
+                           double airTemperatureF,
+                           double pipeDiameterIn,
+                           double pipeLengthFt);
+
 // Mapping Function, useful for sensors
 double mappedValue(double inputValue,
                    double inputMin,
@@ -148,3 +176,9 @@ double oilCarryoverConcentrationPPM(double flowRateCFM,
                                     double oilLossGallons,
                                     double operatingHours,
                                     double oilSpecificGravity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Compulations_h */
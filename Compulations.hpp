@@ -0,0 +1,971 @@
+//
+//  Compulations.hpp
+//
+//  Header-only C++17 version of Compulations.h and UnitConversion.h. Every
+//  function is constexpr and noexcept, so conversion chains fold at compile
+//  time and inline into callers' loops. The C library is unchanged.
+//
+//  Runtime calls use <cmath> and give the same results as the C functions.
+//  In constant expressions exp, log and pow come from the series below and
+//  can differ from libm by a few ULP. The Fast tables are built that way, so
+//  the Fast versions agree with the C library to about 1e-15, not exactly.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Compulations_hpp
+#define Compulations_hpp
+
+#if __cplusplus < 201703L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#error "Compulations.hpp needs C++17 or later"
+#endif
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace compulations
+{
+
+namespace detail
+{
+
+constexpr double pi = 3.141592653589793;
+constexpr double sqrt2 = 1.4142135623730951;
+constexpr double sqrt3 = 1.7320508075688772;
+constexpr double ln2Hi = 6.93147180369123816490e-01;
+constexpr double ln2Lo = 1.90821492927058770002e-10;
+constexpr double infinity = std::numeric_limits<double>::infinity();
+constexpr double notANumber = std::numeric_limits<double>::quiet_NaN();
+
+constexpr bool constantEvaluated() noexcept
+{
+#if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#else
+    return __builtin_is_constant_evaluated();
+#endif
+}
+
+// Round x to k*ln2 + r with |r| <= ln2/2, then Taylor series for e^r.
+constexpr double seriesExp(double x) noexcept
+{
+    if (x != x)
+    {
+        return x;
+    }
+
+    if (x > 709.782712893384)
+    {
+        return infinity;
+    }
+
+    if (x < -745.1332191019412)
+    {
+        return 0.0;
+    }
+
+    double kd = x * 1.4426950408889634;
+    int k = static_cast<int>(kd < 0.0 ? kd - 0.5 : kd + 0.5);
+    double r = (x - k * ln2Hi) - k * ln2Lo;
+
+    double sum = 1.0;
+
+    for (int n = 22; n >= 1; n--)
+    {
+        sum = 1.0 + sum * r / n;
+    }
+
+    for (; k > 0; k--)
+    {
+        sum *= 2.0;
+    }
+
+    for (; k < 0; k++)
+    {
+        sum *= 0.5;
+    }
+
+    return sum;
+}
+
+// Scale into [sqrt(1/2), sqrt(2)), then log(m) = 2 atanh((m - 1) / (m + 1)).
+constexpr double seriesLog(double x) noexcept
+{
+    if (x != x || x < 0.0)
+    {
+        return notANumber;
+    }
+
+    if (x == 0.0)
+    {
+        return -infinity;
+    }
+
+    if (x == infinity)
+    {
+        return x;
+    }
+
+    int e = 0;
+    double m = x;
+
+    while (m >= sqrt2)
+    {
+        m *= 0.5;
+        e++;
+    }
+
+    while (m < sqrt2 * 0.5)
+    {
+        m *= 2.0;
+        e--;
+    }
+
+    double z = (m - 1.0) / (m + 1.0);
+    double z2 = z * z;
+    double sum = 0.0;
+
+    for (int n = 41; n >= 1; n -= 2)
+    {
+        sum = 1.0 / n + z2 * sum;
+    }
+
+    return e * ln2Hi + (2.0 * z * sum + e * ln2Lo);
+}
+
+constexpr double seriesPow(double x, double y) noexcept
+{
+    if (y == 0.0 || x == 1.0)
+    {
+        return 1.0;
+    }
+
+    if (x == 0.0)
+    {
+        return y > 0.0 ? 0.0 : infinity;
+    }
+
+    if (x < 0.0)
+    {
+        double whole = static_cast<double>(static_cast<long long>(y));
+
+        if (whole != y)
+        {
+            return notANumber;
+        }
+
+        double magnitude = seriesExp(y * seriesLog(-x));
+        return static_cast<long long>(y) % 2 ? -magnitude : magnitude;
+    }
+
+    return seriesExp(y * seriesLog(x));
+}
+
+constexpr double exp(double x) noexcept
+{
+    return constantEvaluated() ? seriesExp(x) : std::exp(x);
+}
+
+constexpr double log(double x) noexcept
+{
+    return constantEvaluated() ? seriesLog(x) : std::log(x);
+}
+
+constexpr double log10(double x) noexcept
+{
+    return constantEvaluated() ? seriesLog(x) / 2.302585092994046 : std::log10(x);
+}
+
+constexpr double pow(double x, double y) noexcept
+{
+    return constantEvaluated() ? seriesPow(x, y) : std::pow(x, y);
+}
+
+// Newton from above; stops once the iterate no longer falls.
+constexpr double sqrt(double x) noexcept
+{
+    if (!constantEvaluated())
+    {
+        return std::sqrt(x);
+    }
+
+    if (x != x || x < 0.0)
+    {
+        return notANumber;
+    }
+
+    if (x == 0.0 || x == infinity)
+    {
+        return x;
+    }
+
+    double r = x > 1.0 ? x : 1.0;
+
+    for (;;)
+    {
+        double next = 0.5 * (r + x / r);
+
+        if (!(next < r))
+        {
+            return r;
+        }
+
+        r = next;
+    }
+}
+
+} // namespace detail
+
+// UnitConversion.h
+
+// Motor speed
+constexpr double frequencyFromSynchronousSpeedAndPoles(double speed, int poles) noexcept { return (poles * speed) / 120.0; }
+constexpr int numberOfPolesFromSynchronousSpeedAndFrequency(double speed, double hz) noexcept { return static_cast<int>(static_cast<int>(120 * hz) / speed); }
+constexpr double synchronousMotorSpeedForFrequencyAndPoles(double hz, int poles) noexcept { return (120.0 * hz) / poles; }
+
+// Temperature
+constexpr double celsiusFromFahrenheit(double f) noexcept { return (f - 32.0) * (5.0f / 9.0); }
+constexpr double celsiusFromKelvin(double k) noexcept { return k - 273.15; }
+constexpr double fahrenheitFromCelsius(double c) noexcept { return (c * 1.8) + 32.0; }
+constexpr double fahrenheitFromKelvin(double k) noexcept { return (k - 273.15) * 1.8 + 32.0; }
+constexpr double fahrenheitFromRankine(double r) noexcept { return r - 459.67; }
+constexpr double kelvinFromCelsius(double c) noexcept { return c + 273.15; }
+constexpr double kelvinFromFahrenheit(double f) noexcept { return ((f - 32.0) * (5.0f / 9.0)) + 273.15; }
+constexpr double rankineFromFahrenheit(double f) noexcept { return f + 459.67; }
+
+// Pressure
+constexpr double barFromPSI(double psi) noexcept { return psi / 14.503773773020923; }
+constexpr double inH20FromkPa(double kPa) noexcept { return kPa * 4.01474213311; }
+constexpr double inHgFromMmHg(double mmHg) noexcept { return mmHg / 25.399999705; }
+constexpr double inHgFromkPa(double kPa) noexcept { return kPa * 0.295299802; }
+constexpr double inHgFromPSI(double psi) noexcept { return psi * 2.036025; }
+constexpr double kPaFromInH2O(double inH2O) noexcept { return inH2O / 4.01474213311; }
+constexpr double kPaFromInHg(double inHg) noexcept { return inHg / 0.295299802; }
+constexpr double kPaFromMmH2O(double mmH2O) noexcept { return mmH2O / 101.971621298; }
+constexpr double kPaFromMmHg(double mmHg) noexcept { return mmHg / 7.5006183; }
+constexpr double kPaFromPSI(double PSI) noexcept { return PSI / 0.14503773773020923; }
+constexpr double mmH2OFromkPa(double kPa) noexcept { return kPa * 101.971621298; }
+constexpr double mmHgFromInHg(double inHg) noexcept { return inHg * 25.399999705; }
+constexpr double mmHgFromkPa(double kPa) noexcept { return kPa * 7.5006183; }
+constexpr double psiFromBar(double bar) noexcept { return bar * 14.503773773020923; }
+constexpr double psiFromInHg(double inHg) noexcept { return inHg / 2.036025; }
+constexpr double psiFromkPa(double kPa) noexcept { return kPa * 0.14503773773020923; }
+
+// Length
+constexpr double inFromMillimeter(double mm) noexcept { return mm / 25.4; }
+constexpr double feetFromMeters(double meters) noexcept { return meters * 3.2808399; }
+constexpr double metersFromFeet(double feet) noexcept { return feet / 3.2808399; }
+constexpr double mmFromInch(double inch) noexcept { return inch * 25.4; }
+
+// Volume
+constexpr double cubicFeetFromGallons(double gal) noexcept { return gal / 7.48051948; }
+constexpr double cubicFeetFromCubicMeters(double m) noexcept { return m * 35.3146667; }
+constexpr double cubicMetersFromCubicFeet(double ft) noexcept { return ft / 35.3146667; }
+constexpr double gallonsFromCubicFeet(double ft) noexcept { return ft * 7.48051948; }
+constexpr double gallonsFromLiters(double liters) noexcept { return liters / 3.78541178; }
+constexpr double litersFromGallons(double gallons) noexcept { return gallons * 3.78541178; }
+
+// Power
+constexpr double hpFromKw(double kw) noexcept { return kw / 0.745699872; }
+constexpr double kwFromHP(double hp) noexcept { return hp * 0.745699872; }
+
+// Voltage
+constexpr double voltsPeakFromVoltsRms(double vrms) noexcept { return vrms * detail::sqrt2; }
+constexpr double voltsRmsFromVoltsPeak(double vp) noexcept { return vp / detail::sqrt2; }
+
+// Current
+constexpr double ampsFLAFromWyeDelta(double wda) noexcept { return wda * detail::sqrt3; }
+constexpr double ampsWyeDeltaFromFLA(double fla) noexcept { return fla / detail::sqrt3; }
+
+// Flow
+constexpr double cfmFromM3minute(double m3m) noexcept { return m3m * 35.3146667; }
+constexpr double m3MinuteFromCFM(double cfm) noexcept { return cfm / 35.3146667; }
+
+// Force
+constexpr double newtonsFromPounds(double pounds) noexcept { return pounds * 4.44822162825; }
+constexpr double poundsFromNewtons(double newtons) noexcept { return newtons / 4.44822162825; }
+
+// Compulations.h
+
+// Power factor from nameplate
+constexpr double threePhaseMotorPowerFactor(double nameplateHP,
+                                            double nameplateVolts,
+                                            double nameplateAmps) noexcept
+{
+    double pf = 0.0;
+
+    if (nameplateHP > 0.0 && nameplateVolts > 0.0 && nameplateAmps > 0.0)
+    {
+        double numerator = kwFromHP(nameplateHP) * 1000.0;
+        double denominator = (detail::sqrt3 * nameplateVolts * nameplateAmps);
+
+        pf = numerator / denominator;
+    }
+
+    return pf;
+}
+
+constexpr double singlePhaseMotorPowerFactor(double nameplateHP,
+                                             double nameplateVolts,
+                                             double nameplateAmps) noexcept
+{
+    double pf = 0.0;
+
+    if (nameplateHP > 0.0 && nameplateVolts > 0.0 && nameplateAmps > 0.0)
+    {
+        double numerator = kwFromHP(nameplateHP) * 1000.0;
+        double denominator = (nameplateVolts * nameplateAmps);
+
+        pf = numerator / denominator;
+    }
+
+    return pf;
+}
+
+// Power
+constexpr double threePhaseMotorInputPowerKW(double volts,
+                                             double amps,
+                                             double powerFactor) noexcept
+{
+    double kw = 0.0;
+
+    if (volts > 0.0 && amps > 0.0 && powerFactor > 0.0)
+    {
+        kw = (volts * amps * powerFactor * detail::sqrt3) / 1000.0;
+    }
+
+    return kw;
+}
+
+// Shaft Power
+constexpr double threePhaseShaftPowerHP(double volts,
+                                        double amps,
+                                        double efficiency,
+                                        double powerFactor) noexcept
+{
+    double hp = 0.0;
+
+    if (volts > 0.0 && amps > 0.0 && efficiency > 0.0 && powerFactor > 0.0)
+    {
+        double shaftKw = (volts * amps * efficiency * powerFactor * detail::sqrt3) / 1000.0;
+        hp = hpFromKw(shaftKw);
+    }
+
+    return hp;
+}
+
+// Optimal operating temperature for oil flooded screw
+constexpr double oilFloodedScrewOperatingTempF(double inletTempF,
+                                               double dischargePressurePSIG,
+                                               double ambientPSIA) noexcept
+{
+    double opTempC = 0.0;
+
+    double psiaLine = dischargePressurePSIG + ambientPSIA;
+
+    double ambientTemp = celsiusFromFahrenheit(inletTempF);
+
+    if (dischargePressurePSIG < 0)
+    {
+        opTempC = 6.1115 * detail::exp((22.452 * ambientTemp) / (272.55 + ambientTemp));
+    }
+    else
+    {
+        opTempC = 6.1121 * detail::exp((17.502 * ambientTemp) / (240.9 + ambientTemp));
+    }
+
+    opTempC = opTempC * (psiaLine / ambientPSIA);
+
+    double pdpHi = detail::log(opTempC / 6.1121) * 240.9 / (17.502 - detail::log(opTempC / 6.1121));
+    double pdpLo = detail::log(opTempC / 6.1115) * 272.55 / (22.452 - detail::log(opTempC / 6.115));
+
+    if (pdpHi < 0)
+    {
+        opTempC = pdpLo;
+    }
+    else
+    {
+        opTempC = pdpHi;
+    }
+
+    return fahrenheitFromCelsius(opTempC);
+}
+
+// Pressure-Altitude relationship
+constexpr double ambientPSIAForAltitudeInFeet(double altitude) noexcept
+{
+    double ambientPSIA = (101325.0 * detail::pow((1 - 0.0000225577 * metersFromFeet(altitude)), 5.25588)) / 6894.75729;
+
+    return ambientPSIA;
+}
+
+constexpr double altitudeFeetFromPSIA(double psia) noexcept
+{
+    double mBar = kPaFromPSI(psia) * 10.0;
+
+    double pstd = 1013.25;
+
+    double altitude = (1 - detail::pow((mBar / pstd), 0.190284)) * 145366.45;
+
+    return altitude;
+}
+
+// Pumpup Time
+constexpr double pumpupTimeInSeconds(double tankSizeGallons,
+                                     double flowRateCFM,
+                                     double startPressurePSIG,
+                                     double endPressurePSIG,
+                                     double ambientAtmosphericPressurePSIA) noexcept
+{
+    double time = 0.0;
+
+    double deltaP = endPressurePSIG - startPressurePSIG;
+
+    if (tankSizeGallons > 0.0 && flowRateCFM > 0.0 && deltaP > 0.0)
+    {
+        double numerator = (cubicFeetFromGallons(tankSizeGallons) * deltaP);
+        double denominator = (ambientAtmosphericPressurePSIA * flowRateCFM);
+        time = ((numerator / denominator) * 60.0);
+    }
+
+    return time;
+}
+
+// Leak Rate
+constexpr double leakRateCFM(double tankSizeGallons,
+                             double startPSIG,
+                             double endPSIG,
+                             double ambientPSIA,
+                             double decayTimeMins) noexcept
+{
+    double cfm = 0.0;
+
+    if (tankSizeGallons > 0.0 && decayTimeMins > 0.0 && startPSIG > 0.0 && ambientPSIA > 0.0)
+    {
+        double tankSizeCF = cubicFeetFromGallons(tankSizeGallons);
+        double deltaP = (startPSIG - endPSIG);
+
+        // Flow correction for wide pressure bands, per the Compressed Air Challenge
+        double flowCorrection = 1.0;
+
+        if (endPSIG <= (startPSIG / 2.0))
+        {
+            flowCorrection = 1.25;
+        }
+
+        double numerator = tankSizeCF * deltaP * flowCorrection;
+        double denominator = decayTimeMins * ambientPSIA;
+
+        cfm = numerator / denominator;
+    }
+
+    return cfm;
+}
+
+// Refill Rate
+constexpr double refillRateCFM(double storageCF,
+                               double startPressurePSIG,
+                               double endPressurePSIG,
+                               double refillTimeMins,
+                               double ambientPreesurePSIA) noexcept
+{
+    double cfm = 0.0;
+
+    double deltaP = endPressurePSIG - startPressurePSIG;
+
+    if (deltaP > 0.0 && storageCF > 0.0 && refillTimeMins > 0.0 && ambientPreesurePSIA > 0.0)
+    {
+        double numerator = storageCF * deltaP;
+        double denominator = refillTimeMins * ambientPreesurePSIA;
+        cfm = numerator / denominator;
+    }
+
+    return cfm;
+}
+
+// System Capacity Estimator
+constexpr double systemCapacityCubicFeetByCycleTime(double unloadedTimeSec,
+                                                    double loadedTimeSec,
+                                                    double unloadPressurePSIG,
+                                                    double loadPressurePSIG,
+                                                    double ratedFlowCFM,
+                                                    double ambientPreesurePSIA) noexcept
+{
+    double volumeCF = 0.0;
+
+    double totalTime = unloadedTimeSec + loadedTimeSec;
+    double deltaP = unloadPressurePSIG - loadPressurePSIG;
+
+    if (totalTime > 0.0 && deltaP > 0.0 && ratedFlowCFM > 0.0 && ambientPreesurePSIA > 0.0)
+    {
+        double numerator = (loadedTimeSec / 60.0) * (unloadedTimeSec / 60.0) * ratedFlowCFM * ambientPreesurePSIA;
+        double denominator = (totalTime / 60.0) * deltaP;
+
+        volumeCF = numerator / denominator;
+    }
+
+    return volumeCF;
+}
+
+// Secondary storage
+constexpr double eventStorageCubicFeet(double eventDurationMins,
+                                       double cfmRequiredForEvent,
+                                       double meteredCFMSupplied,
+                                       double ambientPSIA,
+                                       double initialPressurePSIG,
+                                       double minPressureForEventPSIG) noexcept
+{
+    double volumeCF = 0.0;
+
+    double deltaP = initialPressurePSIG - minPressureForEventPSIG;
+    double deltaV = cfmRequiredForEvent - meteredCFMSupplied;
+
+    if (eventDurationMins > 0.0 && deltaV > 0.0 && deltaP > 0.0 && ambientPSIA > 0.0)
+    {
+        double numerator = eventDurationMins * deltaV * ambientPSIA;
+        volumeCF = numerator / deltaP;
+    }
+
+    return volumeCF;
+}
+
+// Vapor pressure of water, Antoine equation, good for 1-374 C
+constexpr double vaporPressureOfWaterInPsiForTemp(double degreesFahrenheit) noexcept
+{
+    double tempC = celsiusFromFahrenheit(degreesFahrenheit);
+
+    double conA = 0.0, conB = 0.0, conC = 0.0;
+
+    if (tempC <= 100.0)
+    {
+        conA = 8.07131;
+        conB = 1730.63;
+        conC = 233.426;
+    }
+    else
+    {
+        conA = 8.14019;
+        conB = 1810.94;
+        conC = 244.485;
+    }
+
+    double exponent = conA - (conB / (conC + tempC));
+    double vapMMHG = detail::pow(10, exponent);
+    double vapPSIG = vapMMHG * 0.0193367747;
+
+    return vapPSIG;
+}
+
+// ACFM SCFM conversions
+constexpr double scfmFromACFM(double acfm,
+                              double standardAmbientPressurePSI,
+                              double standardAmbientTempF,
+                              double standardAmbientRH,
+                              double siteAmbientPressurePSI,
+                              double siteAmbientTempF,
+                              double siteAmbientRH,
+                              double inletPressurePSI) noexcept
+{
+    double rhNumerator = standardAmbientPressurePSI - (standardAmbientRH * vaporPressureOfWaterInPsiForTemp(standardAmbientTempF));
+    double rhDenominator = siteAmbientPressurePSI - (siteAmbientRH * vaporPressureOfWaterInPsiForTemp(siteAmbientTempF));
+    double rhMultiplier = rhNumerator / rhDenominator;
+    double tempMultiplier = rankineFromFahrenheit(siteAmbientTempF) / rankineFromFahrenheit(standardAmbientTempF);
+    double inletPressureMultiplier = siteAmbientPressurePSI / inletPressurePSI;
+
+    return (acfm / rhMultiplier) / tempMultiplier / inletPressureMultiplier;
+}
+
+constexpr double acfmFromSCFM(double scfm,
+                              double standardAmbientPressurePSI,
+                              double standardAmbientTempF,
+                              double standardAmbientRH,
+                              double siteAmbientPressurePSI,
+                              double siteAmbientTempF,
+                              double siteAmbientRH,
+                              double inletPressurePSI) noexcept
+{
+    double rhNumerator = standardAmbientPressurePSI - (standardAmbientRH * vaporPressureOfWaterInPsiForTemp(standardAmbientTempF));
+    double rhDenominator = siteAmbientPressurePSI - (siteAmbientRH * vaporPressureOfWaterInPsiForTemp(siteAmbientTempF));
+    double rhMultiplier = rhNumerator / rhDenominator;
+    double tempMultiplier = rankineFromFahrenheit(siteAmbientTempF) / rankineFromFahrenheit(standardAmbientTempF);
+    double inletPressureMultiplier = siteAmbientPressurePSI / inletPressurePSI;
+
+    return scfm * rhMultiplier * tempMultiplier * inletPressureMultiplier;
+}
+
+// Diameter in inches for flow and velocity
+constexpr double pipeDiameterInchesForVelocity(double flowRateCFM,
+                                               double velocityFPS,
+                                               double linePressurePSIG,
+                                               double ambientPreesurePSIA) noexcept
+{
+    double pipeDiameterIn = 0.0;
+
+    if (flowRateCFM > 0.0 && velocityFPS > 0.0 && linePressurePSIG > 0.0)
+    {
+        double numerator = (144.0 * flowRateCFM * ambientPreesurePSIA);
+        double denominator = (velocityFPS * 60.0 * (linePressurePSIG + ambientPreesurePSIA));
+        double areaInSq = numerator / denominator;
+        pipeDiameterIn = detail::sqrt(areaInSq / detail::pi) * 2.0;
+    }
+
+    return pipeDiameterIn;
+}
+
+// Velocity of air for pipe diameter
+constexpr double velocityInPipeFPS(double flowRateCFM,
+                                   double linePressurePSIG,
+                                   double ambientPreesurePSIA,
+                                   double pipeDiameterIn) noexcept
+{
+    double fps = 0.0;
+
+    if (flowRateCFM > 0.0 && linePressurePSIG > 0.0 && ambientPreesurePSIA > 0.0 && pipeDiameterIn > 0.0)
+    {
+        double compressionRatio = (ambientPreesurePSIA / (linePressurePSIG + ambientPreesurePSIA));
+        double numerator = flowRateCFM * compressionRatio;
+
+        double pipeArea = (pipeDiameterIn / 24.0) * (pipeDiameterIn / 24.0);
+        double denominator = 60.0 * detail::pi * pipeArea;
+
+        fps = numerator / denominator;
+    }
+
+    return fps;
+}
+
+// Density of air lbs/ft^3
+constexpr double airDensityPoundsPerCubicFoot(double linePressurePSIG,
+                                              double ambientPreesurePSIA,
+                                              double airTemperatureF) noexcept
+{
+    double lbsCF = 0.0;
+    double absoluteP = linePressurePSIG + ambientPreesurePSIA;
+
+    if (absoluteP > 0.0)
+    {
+        lbsCF = (2.7 * absoluteP) / rankineFromFahrenheit(airTemperatureF);
+    }
+
+    return lbsCF;
+}
+
+// Darcy-Weisbach pressure drop in psi over a length of commercial steel pipe
+constexpr double pipePressureDropPSI(double flowRateCFM,
+                                     double linePressurePSIG,
+                                     double ambientPreesurePSIA,
+                                     double airTemperatureF,
+                                     double pipeDiameterIn,
+                                     double pipeLengthFt) noexcept
+{
+    double dropPSI = 0.0;
+    double fps = velocityInPipeFPS(flowRateCFM, linePressurePSIG, ambientPreesurePSIA, pipeDiameterIn);
+
+    if (fps > 0.0 && pipeLengthFt > 0.0)
+    {
+        double lbsCF = airDensityPoundsPerCubicFoot(linePressurePSIG, ambientPreesurePSIA, airTemperatureF);
+        double diameterFt = pipeDiameterIn / 12.0;
+        double reynolds = lbsCF * fps * diameterFt / 1.22e-5;
+        double relativeRoughness = 0.00015 / diameterFt;
+
+        // Laminar below Re 2000, Swamee-Jain above 4000 and a straight line
+        // between them, so the factor stays finite and continuous at low flow
+        double friction = 64.0 / reynolds;
+
+        if (reynolds > 2000.0)
+        {
+            double turbulentRe = reynolds > 4000.0 ? reynolds : 4000.0;
+            double logTerm = detail::log10(relativeRoughness / 3.7 + 5.74 / detail::pow(turbulentRe, 0.9));
+            friction = 0.25 / (logTerm * logTerm);
+
+            if (reynolds < 4000.0)
+            {
+                double blend = (reynolds - 2000.0) / 2000.0;
+                friction = 0.032 + blend * (friction - 0.032);
+            }
+        }
+
+        dropPSI = friction * (pipeLengthFt / diameterFt) * lbsCF * fps * fps / (2.0 * 32.174 * 144.0);
+    }
+
+    return dropPSI;
+}
+
+// Mapping Function, useful for sensors
+constexpr double mappedValue(double inputValue,
+                             double inputMin,
+                             double inputMax,
+                             double outputMin,
+                             double outputMax) noexcept
+{
+    double slope = 1.0 * (outputMax - outputMin) / (inputMax - inputMin);
+
+    return outputMin + slope * (inputValue - inputMin);
+}
+
+// Gear speed along pitch line in ft/min
+constexpr double gearSpeedFeetPerMinute(double gearDiameterInches,
+                                        double rpm) noexcept
+{
+    return (detail::pi / 12.0) * gearDiameterInches * rpm;
+}
+
+// Oil Carryover Volume
+constexpr double oilCarryoverGallons(double flowRateCFM,
+                                     double concentrationPPM,
+                                     double operatingHours,
+                                     double oilSpecificGravity) noexcept
+{
+    double gallons = 0.0;
+
+    if (flowRateCFM > 0.0 && concentrationPPM > 0.0 && operatingHours > 0.0 && oilSpecificGravity > 0.0)
+    {
+        double numerator = concentrationPPM * flowRateCFM * operatingHours * 60.0 * 0.0000012;
+        double denominator = (oilSpecificGravity * 128.0);
+        gallons = numerator / denominator;
+    }
+
+    return gallons;
+}
+
+// Oil Carryover Concentration
+constexpr double oilCarryoverConcentrationPPM(double flowRateCFM,
+                                              double oilLossGallons,
+                                              double operatingHours,
+                                              double oilSpecificGravity) noexcept
+{
+    double ppm = 0.0;
+
+    if (flowRateCFM > 0.0 && oilLossGallons > 0.0 && operatingHours > 0.0 && oilSpecificGravity > 0.0)
+    {
+        double numerator = oilLossGallons * (oilSpecificGravity * 128.0);
+        double denominator = (operatingHours * 60.0 * flowRateCFM * 0.0000012);
+        ppm = numerator / denominator;
+    }
+
+    return ppm;
+}
+
+// Table versions. The C library builds its tables on first use; here they
+// are built by the compiler, the same way as in Compulations.c.
+
+namespace detail
+{
+
+using CubicTable4 = std::array<double, 4>;
+
+constexpr double altitudeTableMinFeet = -1000.0;
+constexpr double altitudeTableMaxFeet = 30000.0;
+constexpr int altitudeTableSegments = 155;
+constexpr int psiaTableSegments = 275;
+constexpr double vaporTableMinC = -40.0;
+constexpr int vaporTableSegments = 414;
+
+constexpr double ambientPSIASlopeForAltitudeInFeet(double altitude) noexcept
+{
+    double base = 1 - 0.0000225577 * metersFromFeet(altitude);
+
+    return (101325.0 * 5.25588 * pow(base, 4.25588) * -0.0000225577 / 3.2808399) / 6894.75729;
+}
+
+constexpr double altitudeFeetSlopeFromPSIA(double psia) noexcept
+{
+    double ratio = kPaFromPSI(psia) * 10.0 / 1013.25;
+
+    return -145366.45 * 0.190284 * pow(ratio, 0.190284 - 1.0) * (10.0 / 0.14503773773020923) / 1013.25;
+}
+
+// Monotone cubic Hermite segment, Fritsch-Carlson limited
+constexpr CubicTable4 hermiteSegment(double y0, double y1, double slope0, double slope1, double h) noexcept
+{
+    double secant = (y1 - y0) / h;
+
+    if (secant == 0.0)
+    {
+        slope0 = 0.0;
+        slope1 = 0.0;
+    }
+    else
+    {
+        // A slope against the secant is zeroed before the radius test, so
+        // the rescale cannot bring it back with the wrong sign.
+        double alpha = slope0 / secant > 0.0 ? slope0 / secant : 0.0;
+        double beta = slope1 / secant > 0.0 ? slope1 / secant : 0.0;
+        double radius = alpha * alpha + beta * beta;
+        double tau = radius > 9.0 ? 3.0 / sqrt(radius) : 1.0;
+
+        slope0 = tau * alpha * secant;
+        slope1 = tau * beta * secant;
+    }
+
+    double m0 = slope0 * h;
+    double m1 = slope1 * h;
+
+    return { y0, m0, 3.0 * (y1 - y0) - 2.0 * m0 - m1, 2.0 * (y0 - y1) + m0 + m1 };
+}
+
+constexpr std::array<CubicTable4, altitudeTableSegments> buildAltitudeTable() noexcept
+{
+    std::array<CubicTable4, altitudeTableSegments> table{};
+    double h = (altitudeTableMaxFeet - altitudeTableMinFeet) / altitudeTableSegments;
+
+    for (int k = 0; k < altitudeTableSegments; k++)
+    {
+        double x0 = altitudeTableMinFeet + k * h;
+        double x1 = x0 + h;
+
+        table[k] = hermiteSegment(ambientPSIAForAltitudeInFeet(x0), ambientPSIAForAltitudeInFeet(x1),
+                                  ambientPSIASlopeForAltitudeInFeet(x0), ambientPSIASlopeForAltitudeInFeet(x1), h);
+    }
+
+    return table;
+}
+
+constexpr double psiaTableMin = ambientPSIAForAltitudeInFeet(altitudeTableMaxFeet);
+constexpr double psiaTableMax = ambientPSIAForAltitudeInFeet(altitudeTableMinFeet);
+constexpr double psiaTableScale = 1.0 / ((psiaTableMax - psiaTableMin) / psiaTableSegments);
+
+constexpr std::array<CubicTable4, psiaTableSegments> buildPSIATable() noexcept
+{
+    std::array<CubicTable4, psiaTableSegments> table{};
+    double h = (psiaTableMax - psiaTableMin) / psiaTableSegments;
+
+    for (int k = 0; k < psiaTableSegments; k++)
+    {
+        double x0 = psiaTableMin + k * h;
+        double x1 = x0 + h;
+
+        table[k] = hermiteSegment(altitudeFeetFromPSIA(x0), altitudeFeetFromPSIA(x1),
+                                  altitudeFeetSlopeFromPSIA(x0), altitudeFeetSlopeFromPSIA(x1), h);
+    }
+
+    return table;
+}
+
+constexpr double antoineVaporPressurePsi(double tempC, bool highRange) noexcept
+{
+    double conA = highRange ? 8.14019 : 8.07131;
+    double conB = highRange ? 1810.94 : 1730.63;
+    double conC = highRange ? 244.485 : 233.426;
+
+    return pow(10, conA - (conB / (conC + tempC))) * 0.0193367747;
+}
+
+// Cubic through the Chebyshev nodes of each 1 C segment
+constexpr std::array<CubicTable4, vaporTableSegments> buildVaporTable() noexcept
+{
+    std::array<CubicTable4, vaporTableSegments> table{};
+    constexpr double nodes[4] = { 0.03806023374435663, 0.3086582838174551, 0.6913417161825448, 0.9619397662556434 };
+
+    for (int k = 0; k < vaporTableSegments; k++)
+    {
+        double segmentStartC = vaporTableMinC + k;
+        bool highRange = (segmentStartC + 0.5) > 100.0;
+        double c[4] = {};
+
+        for (int i = 0; i < 4; i++)
+        {
+            c[i] = antoineVaporPressurePsi(segmentStartC + nodes[i], highRange);
+        }
+
+        for (int j = 1; j < 4; j++)
+        {
+            for (int i = 3; i >= j; i--)
+            {
+                c[i] = (c[i] - c[i - 1]) / (nodes[i] - nodes[i - j]);
+            }
+        }
+
+        double a[4] = { c[3], 0.0, 0.0, 0.0 };
+
+        for (int i = 2; i >= 0; i--)
+        {
+            for (int j = 3; j > 0; j--)
+            {
+                a[j] = a[j - 1] - nodes[i] * a[j];
+            }
+
+            a[0] = c[i] - nodes[i] * a[0];
+        }
+
+        table[k] = { a[0], a[1], a[2], a[3] };
+    }
+
+    return table;
+}
+
+inline constexpr std::array<CubicTable4, altitudeTableSegments> altitudeTable = buildAltitudeTable();
+inline constexpr std::array<CubicTable4, psiaTableSegments> psiaTable = buildPSIATable();
+inline constexpr std::array<CubicTable4, vaporTableSegments> vaporTable = buildVaporTable();
+
+constexpr double evaluateCubic(const CubicTable4 &a, double u) noexcept
+{
+    return ((a[3] * u + a[2]) * u + a[1]) * u + a[0];
+}
+
+} // namespace detail
+
+constexpr double ambientPSIAForAltitudeInFeetFast(double altitude) noexcept
+{
+    if (!(altitude >= detail::altitudeTableMinFeet && altitude <= detail::altitudeTableMaxFeet))
+    {
+        return ambientPSIAForAltitudeInFeet(altitude);
+    }
+
+    double x = (altitude - detail::altitudeTableMinFeet) *
+               (detail::altitudeTableSegments / (detail::altitudeTableMaxFeet - detail::altitudeTableMinFeet));
+    int k = static_cast<int>(x);
+    k = k < detail::altitudeTableSegments - 1 ? k : detail::altitudeTableSegments - 1;
+
+    return detail::evaluateCubic(detail::altitudeTable[k], x - k);
+}
+
+constexpr double altitudeFeetFromPSIAFast(double psia) noexcept
+{
+    if (!(psia >= detail::psiaTableMin && psia <= detail::psiaTableMax))
+    {
+        return altitudeFeetFromPSIA(psia);
+    }
+
+    double x = (psia - detail::psiaTableMin) * detail::psiaTableScale;
+    int k = static_cast<int>(x);
+    k = k < detail::psiaTableSegments - 1 ? k : detail::psiaTableSegments - 1;
+
+    return detail::evaluateCubic(detail::psiaTable[k], x - k);
+}
+
+constexpr double vaporPressureOfWaterInPsiForTempFast(double degreesFahrenheit) noexcept
+{
+    double x = celsiusFromFahrenheit(degreesFahrenheit) - detail::vaporTableMinC;
+
+    x = x < 0.0 ? 0.0 : x;
+    x = x > detail::vaporTableSegments ? detail::vaporTableSegments : x;
+
+    int k = static_cast<int>(x);
+    k -= (static_cast<double>(k) == x);
+    k = k < 0 ? 0 : k;
+
+    return detail::evaluateCubic(detail::vaporTable[k], x - k);
+}
+
+} // namespace compulations
+
+#endif /* Compulations_hpp */
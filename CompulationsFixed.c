@@ -0,0 +1,124 @@
+//
+//  CompulationsFixed.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CompulationsFixed.h"
+#include "UnitConversionFixed.h"
+
+// Nearest quotient, halves away from zero; denominator > 0
+static int64_t divideRounded(int64_t numerator, int64_t denominator)
+{
+    if (numerator < 0)
+    {
+        return -((-numerator + denominator / 2) / denominator);
+    }
+
+    return (numerator + denominator / 2) / denominator;
+}
+
+// Mapping Function, useful for sensors
+Q16 mappedValueQ16(Q16 inputValue,
+                   Q16 inputMin,
+                   Q16 inputMax,
+                   Q16 outputMin,
+                   Q16 outputMax)
+{
+    int64_t inputSpan = (int64_t)inputMax - inputMin;
+    int64_t outputSpan = (int64_t)outputMax - outputMin;
+    int64_t offset = (int64_t)inputValue - inputMin;
+
+    if (inputSpan == 0)
+    {
+        return outputMin;
+    }
+
+    // Magnitudes below 2^32, so their product fits in 64 bits unsigned
+    int negative = (inputSpan < 0) ^ (outputSpan < 0) ^ (offset < 0);
+    uint64_t divisor = (uint64_t)(inputSpan < 0 ? -inputSpan : inputSpan);
+    uint64_t product = (uint64_t)(outputSpan < 0 ? -outputSpan : outputSpan) * (uint64_t)(offset < 0 ? -offset : offset);
+    uint64_t quotient = product / divisor;
+    uint64_t remainder = product % divisor;
+
+    quotient += remainder >= divisor - remainder;
+
+    // Anything this big saturates whatever outputMin is
+    if (quotient > ((uint64_t)1 << 33))
+    {
+        return negative ? Q16_MIN : Q16_MAX;
+    }
+
+    return q16Saturate((int64_t)outputMin + (negative ? -(int64_t)quotient : (int64_t)quotient));
+}
+
+// Leak Rate
+Q16 leakRateCFMQ16(Q16 tankSizeGallons,
+                   Q16 startPSIG,
+                   Q16 endPSIG,
+                   Q16 ambientPSIA,
+                   Q16 decayTimeMins)
+{
+    Q16 cfm = 0;
+
+    if (tankSizeGallons > 0 && decayTimeMins > 0 && startPSIG > 0 && ambientPSIA > 0)
+    {
+        Q16 tankSizeCF = cubicFeetFromGallonsQ16(tankSizeGallons);
+        int64_t deltaP = (int64_t)startPSIG - endPSIG;
+
+        // Q32; below 2^61 since tankSizeCF < 4,381 ft^3
+        int64_t numerator = (int64_t)tankSizeCF * deltaP;
+
+        // Wide band correction, x1.25. Only when endPSIG <= startPSIG / 2,
+        // so the numerator is positive here.
+        if ((int64_t)endPSIG * 2 <= startPSIG)
+        {
+            numerator += numerator >> 2;
+        }
+
+        // Q32
+        int64_t denominator = (int64_t)decayTimeMins * ambientPSIA;
+
+        // Q32 / Q32 needs 16 more bits on top. Take as many as fit from the
+        // numerator and the rest off the denominator, so small results keep
+        // their precision.
+        int shift = 16;
+
+        while (shift > 0 && numerator < ((int64_t)1 << 61) && numerator > -((int64_t)1 << 61))
+        {
+            numerator *= 2;
+            shift--;
+        }
+
+        if (shift > 0)
+        {
+            denominator = (denominator + ((int64_t)1 << (shift - 1))) >> shift;
+        }
+
+        if (denominator == 0)
+        {
+            return numerator == 0 ? 0 : (numerator < 0 ? Q16_MIN : Q16_MAX);
+        }
+
+        cfm = q16Saturate(divideRounded(numerator, denominator));
+    }
+
+    return cfm;
+}
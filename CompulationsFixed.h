@@ -0,0 +1,62 @@
+//
+//  CompulationsFixed.h
+//
+//  Q16.16 fixed point versions of the sensor and leak paths in
+//  Compulations.h, named with a Q16 suffix, for controllers without an FPU.
+//  compulations_fixed_bench checks them against reference vectors and the
+//  double versions.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CompulationsFixed_h
+#define CompulationsFixed_h
+
+#include "UnitConversionFixed.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mapping Function, useful for sensors. Exact to the nearest Q16 step, halves
+// rounded away from zero, for any inputs: the intermediate product is 64
+// bits unsigned, so nothing overflows before the result saturates. An empty
+// input range, inputMax == inputMin, gives outputMin.
+Q16 mappedValueQ16(Q16 inputValue,
+                   Q16 inputMin,
+                   Q16 inputMax,
+                   Q16 outputMin,
+                   Q16 outputMax);
+
+// Leak Rate, with the same validity checks and wide band correction as
+// leakRateCFM. Tanks up to 32,767 gallons; results beyond 32,768 cfm
+// saturate. The tank volume is rounded to Q16 first, so results are within
+// 1 + deltaP / (2 * decayTimeMins * ambientPSIA) steps of the double version,
+// 3 steps over the usual field ranges.
+Q16 leakRateCFMQ16(Q16 tankSizeGallons,
+                   Q16 startPSIG,
+                   Q16 endPSIG,
+                   Q16 ambientPSIA,
+                   Q16 decayTimeMins);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CompulationsFixed_h */
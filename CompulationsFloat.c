@@ -0,0 +1,521 @@
+//
+//  CompulationsFloat.c
+//
+// 
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+ 
+ This file is part of Compulations.
+ 
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CompulationsFloat.h"
+#include "Compulations.h"
+#include "UnitConversionFloat.h"
+#include <math.h>
+
+// Power factor from nameplate data
+float threePhaseMotorPowerFactorf(float nameplateHP,
+                                  float nameplateVolts,
+                                  float nameplateAmps)
+{
+    float pf = 0.0f;
+
+    if (nameplateHP > 0.0f && nameplateVolts > 0.0f && nameplateAmps > 0.0f)
+    {
+        float numerator = kwFromHPf(nameplateHP) * 1000.0f;
+        float denominator = (sqrtf(3.0f) * nameplateVolts * nameplateAmps);
+
+        pf = numerator / denominator;
+    }
+
+    return pf;
+}
+
+float singlePhaseMotorPowerFactorf(float nameplateHP,
+                                   float nameplateVolts,
+                                   float nameplateAmps)
+{
+    float pf = 0.0f;
+    
+    if (nameplateHP > 0.0f && nameplateVolts > 0.0f && nameplateAmps > 0.0f)
+    {
+        float numerator = kwFromHPf(nameplateHP) * 1000.0f;
+        float denominator = (nameplateVolts * nameplateAmps);
+        
+        pf = numerator / denominator;
+    }
+    
+    return pf;
+}
+
+
+float threePhaseMotorInputPowerKWf(float volts,
+                                   float amps,
+                                   float powerFactor)
+{
+    float kw = 0.0f;
+    
+    if (volts > 0.0f && amps > 0.0f && powerFactor > 0.0f)
+    {
+        kw = (volts * amps * powerFactor * sqrtf(3.0f)) / 1000.0f;
+    }
+
+    return kw;
+}
+
+// Shaft Power
+float threePhaseShaftPowerHPf(float volts,
+                              float amps,
+                              float efficiency,
+                              float powerFactor)
+{
+    float hp = 0.0f;
+
+    if (volts > 0.0f && amps > 0.0f && efficiency > 0.0f && powerFactor > 0.0f)
+    {
+        float shaftKw = (volts * amps * efficiency * powerFactor * sqrtf(3.0f)) / 1000.0f;
+        hp = hpFromKwf(shaftKw);
+    }
+
+    return hp;
+}
+
+// Optimal operating temperature for oil flooded screw
+float oilFloodedScrewOperatingTempFf(float inletTempF,
+                                     float dischargePressurePSIG,
+                                     float ambientPSIA)
+{
+    float opTempC = 0.0f;
+
+    float psiaLine = dischargePressurePSIG + ambientPSIA;
+    
+    float ambientTemp = celsiusFromFahrenheitf(inletTempF);
+    
+    if (dischargePressurePSIG < 0)
+    {
+        opTempC = 6.1115f * expf((22.452f * ambientTemp) / (272.55f + ambientTemp));
+    }
+    else
+    {
+        opTempC = 6.1121f * expf((17.502f * ambientTemp) / (240.9f + ambientTemp));
+    }
+    
+    opTempC = opTempC * (psiaLine / ambientPSIA);
+    
+    float pdpHi = logf(opTempC / 6.1121f) * 240.9f / (17.502f - logf(opTempC / 6.1121f));
+    float pdpLo = logf(opTempC / 6.1115f) * 272.55f / (22.452f - logf(opTempC / 6.115f));
+    
+    if (pdpHi < 0)
+    {
+        opTempC = pdpLo;
+    }
+    else
+    {
+        opTempC = pdpHi;
+    }
+
+    return fahrenheitFromCelsiusf(opTempC);
+}
+
+// Pressure-Altitude relationship
+float ambientPSIAForAltitudeInFeetf(float altitude)
+{    
+    float ambientPSIA = (101325.0f * powf((1 - 0.0000225577f * metersFromFeetf(altitude)), 5.25588f)) / 6894.75729f;
+    
+    return ambientPSIA;
+}
+
+float altitudeFeetFromPSIAf(float psia)
+{
+    float mBar = kPaFromPSIf(psia) * 10.0f;
+    
+    float pstd = 1013.25f;
+    
+    // 1 - pow(r, 0.190284) cancels near sea level in single precision
+    float altitude = -expm1f(0.190284f * logf(mBar/pstd)) * 145366.45f;
+    
+    return altitude;
+}
+
+float ambientPSIAForAltitudeInFeetFastf(float altitude)
+{
+    return (float)ambientPSIAForAltitudeInFeetFast(altitude);
+}
+
+float altitudeFeetFromPSIAFastf(float psia)
+{
+    return (float)altitudeFeetFromPSIAFast(psia);
+}
+
+// Pumpup Time
+float pumpupTimeInSecondsf(float tankSizeGallons,
+                           float flowRateCFM,
+                           float startPressurePSIG,
+                           float endPressurePSIG,
+                           float ambientAtmosphericPressurePSIA)
+{
+    float time = 0.0f;
+
+    float deltaP = endPressurePSIG - startPressurePSIG;
+
+    if(tankSizeGallons > 0.0f && flowRateCFM > 0.0f && deltaP > 0.0f)
+    {
+        float numerator = (cubicFeetFromGallonsf(tankSizeGallons) * deltaP);
+        float denominator = (ambientAtmosphericPressurePSIA * flowRateCFM);
+        time = ((numerator / denominator) * 60.0f);
+    }
+
+    return time;
+}
+
+// Leak Rate
+float leakRateCFMf(float tankSizeGallons,
+                   float startPSIG,
+                   float endPSIG,
+                   float ambientPSIA,
+                   float decayTimeMins)
+{
+    float cfm = 0.0f;
+
+    if (tankSizeGallons > 0.0f && decayTimeMins > 0.0f && startPSIG > 0.0f && ambientPSIA > 0.0f)
+    {
+        float tankSizeCF = cubicFeetFromGallonsf(tankSizeGallons);
+        float deltaP = (startPSIG - endPSIG);
+
+        // No need for curving the flow rate for normal pressure changes
+        float flowCorrection = 1.0f;
+
+        // Compressed Air Challenge says we need flow correction for wide pressure bands,
+        // specifically if low pressure is 50% or less than the high pressure.
+        if(endPSIG <= (startPSIG / 2.0f))
+        {
+            flowCorrection = 1.25f;
+        }
+
+        float numerator = tankSizeCF * deltaP * flowCorrection;
+        float denominator = decayTimeMins * ambientPSIA;
+
+        cfm = numerator / denominator;
+    }
+
+    return cfm;
+}
+
+// Refill Rate
+float refillRateCFMf(float storageCF,
+                     float startPressurePSIG,
+                     float endPressurePSIG,
+                     float refillTimeMins,
+                     float ambientPreesurePSIA)
+{
+    float cfm = 0.0f;
+
+    float deltaP = endPressurePSIG - startPressurePSIG;
+    
+    if (deltaP > 0.0f && storageCF > 0.0f && refillTimeMins > 0.0f && ambientPreesurePSIA > 0.0f)
+    {
+        float numerator = storageCF * deltaP;
+        float denominator = refillTimeMins * ambientPreesurePSIA;
+        cfm = numerator / denominator;
+    }
+    
+    return cfm;
+}
+
+// System Capacity Estimator
+float systemCapacityCubicFeetByCycleTimef(float unloadedTimeSec,
+                                          float loadedTimeSec,
+                                          float unloadPressurePSIG,
+                                          float loadPressurePSIG,
+                                          float ratedFlowCFM,
+                                          float ambientPreesurePSIA)
+{
+    float volumeCF = 0.0f;
+
+    // Need these later, but we do it now to simplify > 0 for all vars.
+    float totalTime = unloadedTimeSec + loadedTimeSec;
+    float deltaP = unloadPressurePSIG - loadPressurePSIG;
+
+    if (totalTime > 0.0f && deltaP > 0.0f && ratedFlowCFM > 0.0f && ambientPreesurePSIA > 0.0f)
+    {
+        float numerator = (loadedTimeSec / 60.0f) * (unloadedTimeSec / 60.0f) * ratedFlowCFM * ambientPreesurePSIA;
+        float denominator = (totalTime / 60.0f) * deltaP;
+
+        volumeCF = numerator / denominator;
+    }
+
+    return volumeCF;
+}
+
+// Secondary storage
+float eventStorageCubicFeetf(float eventDurationMins,
+                             float cfmRequiredForEvent,
+                             float meteredCFMSupplied,
+                             float ambientPSIA,
+                             float initialPressurePSIG,
+                             float minPressureForEventPSIG)
+{
+    float volumeCF = 0.0f;
+    
+    float deltaP = initialPressurePSIG - minPressureForEventPSIG;
+    float deltaV = cfmRequiredForEvent - meteredCFMSupplied;
+    
+    if (eventDurationMins > 0.0f && deltaV > 0.0f && deltaP > 0.0f && ambientPSIA > 0.0f)
+    {
+        float numerator = eventDurationMins * deltaV * ambientPSIA;
+        volumeCF = numerator / deltaP;
+    }
+    
+    return volumeCF;
+}
+
+// Vapor pressure of water
+float vaporPressureOfWaterInPsiForTempf(float degreesFahrenheit)
+{
+    // Return the vapor pressure of water using Antoine Equation
+    // Good for temp range between 1-374 C
+    float tempC = celsiusFromFahrenheitf(degreesFahrenheit);
+    
+    float conA, conB, conC;
+    
+    if( tempC <= 100.0f )
+    {
+        conA = 8.07131f;
+        conB = 1730.63f;
+        conC = 233.426f;
+    }
+    else
+    {
+        conA = 8.14019f;
+        conB = 1810.94f;
+        conC = 244.485f;
+        
+    }
+    
+    float exponent = conA - (conB / (conC + tempC));
+    float vapMMHG = powf(10.0f, exponent);
+    float vapPSIG = vapMMHG * 0.0193367747f; //mmHG to PSI
+
+    return vapPSIG;
+}
+
+float vaporPressureOfWaterInPsiForTempFastf(float degreesFahrenheit)
+{
+    return (float)vaporPressureOfWaterInPsiForTempFast(degreesFahrenheit);
+}
+
+// ACFM SCFM conversions
+float scfmFromACFMf(float acfm,
+                    float standardAmbientPressurePSI,
+                    float standardAmbientTempF,
+                    float standardAmbientRH,
+                    float siteAmbientPressurePSI,
+                    float siteAmbientTempF,
+                    float siteAmbientRH,
+                    float inletPressurePSI)
+{
+    float scfm = 0.0f;
+    float rhNumerator = standardAmbientPressurePSI - (standardAmbientRH * vaporPressureOfWaterInPsiForTempf(standardAmbientTempF));
+    float rhDenominator = siteAmbientPressurePSI - (siteAmbientRH * vaporPressureOfWaterInPsiForTempf(siteAmbientTempF));
+    float rhMultiplier = rhNumerator / rhDenominator;
+    float tempMultiplier = rankineFromFahrenheitf(siteAmbientTempF) / rankineFromFahrenheitf(standardAmbientTempF);
+    float inletPressureMultiplier = siteAmbientPressurePSI / inletPressurePSI;
+    scfm = (acfm / rhMultiplier) / tempMultiplier / inletPressureMultiplier;
+
+    return scfm;
+}
+
+float acfmFromSCFMf(float scfm,
+                    float standardAmbientPressurePSI,
+                    float standardAmbientTempF,
+                    float standardAmbientRH,
+                    float siteAmbientPressurePSI,
+                    float siteAmbientTempF,
+                    float siteAmbientRH,
+                    float inletPressurePSI)
+{
+    float acfm = 0.0f;
+    float rhNumerator = standardAmbientPressurePSI - (standardAmbientRH * vaporPressureOfWaterInPsiForTempf(standardAmbientTempF));
+    float rhDenominator = siteAmbientPressurePSI - (siteAmbientRH * vaporPressureOfWaterInPsiForTempf(siteAmbientTempF));
+    float rhMultiplier = rhNumerator / rhDenominator;
+    float tempMultiplier = rankineFromFahrenheitf(siteAmbientTempF) / rankineFromFahrenheitf(standardAmbientTempF);
+    float inletPressureMultiplier = siteAmbientPressurePSI / inletPressurePSI;
+    acfm = scfm * rhMultiplier * tempMultiplier * inletPressureMultiplier;
+
+    return acfm;
+}
+
+// Determine pipe size in inches to obtain a specific velocity for site conditions.
+float pipeDiameterInchesForVelocityf(float flowRateCFM,
+                                     float velocityFPS,
+                                     float linePressurePSIG,
+                                     float ambientPreesurePSIA)
+{
+    float pipeDiameterIn = 0.0f;
+    
+    if (flowRateCFM > 0.0f && velocityFPS > 0.0f && linePressurePSIG > 0.0f)
+    {
+        float numerator = (144.0f * flowRateCFM * ambientPreesurePSIA);
+        float denominator = (velocityFPS * 60.0f * (linePressurePSIG + ambientPreesurePSIA));
+        float areaInSq = numerator / denominator;
+        pipeDiameterIn = sqrtf(areaInSq / (float)M_PI) * 2.0f;
+    }
+
+    return pipeDiameterIn;
+}
+
+// Velocity for diameter
+float velocityInPipeFPSf(float flowRateCFM,
+                         float linePressurePSIG,
+                         float ambientPreesurePSIA,
+                         float pipeDiameterIn)
+{
+    float fps = 0.0f;
+
+    if (flowRateCFM > 0.0f && linePressurePSIG > 0.0f && ambientPreesurePSIA > 0.0f && pipeDiameterIn > 0.0f)
+    {
+        float compressionRatio = (ambientPreesurePSIA / (linePressurePSIG + ambientPreesurePSIA));
+        float numerator = flowRateCFM * compressionRatio;
+        
+        float pipeArea = (pipeDiameterIn / 24.0f) * (pipeDiameterIn / 24.0f);
+        float denominator = 60.0f * (float)M_PI * pipeArea;
+        
+        fps = numerator / denominator;
+    }
+    
+    return fps;
+}
+
+// Density of air lbs/ft^3
+float airDensityPoundsPerCubicFootf(float linePressurePSIG,
+                                    float ambientPreesurePSIA,
+                                    float airTemperatureF)
+{
+    float lbsCF = 0.0f;
+    float absoluteP = linePressurePSIG + ambientPreesurePSIA;
+
+    if (absoluteP > 0.0f)
+    {
+        lbsCF = (2.7f * absoluteP) / rankineFromFahrenheitf(airTemperatureF);
+    }
+    
+    return lbsCF;
+}
+
+// Darcy-Weisbach pressure drop
+float pipePressureDropPSIf(float flowRateCFM,
+                           float linePressurePSIG,
+                           float ambientPreesurePSIA,
+                           float airTemperatureF,
+                           float pipeDiameterIn,
+                           float pipeLengthFt)
+{
+    float dropPSI = 0.0f;
+    float fps = velocityInPipeFPSf(flowRateCFM, linePressurePSIG, ambientPreesurePSIA, pipeDiameterIn);
+
+    if (fps > 0.0f && pipeLengthFt > 0.0f)
+    {
+        float lbsCF = airDensityPoundsPerCubicFootf(linePressurePSIG, ambientPreesurePSIA, airTemperatureF);
+        float diameterFt = pipeDiameterIn / 12.0f;
+
+        // Viscosity of air near room temperature is 1.22e-5 lb/ft-s, steel
+        // roughness 0.00015 ft.
+        float reynolds = lbsCF * fps * diameterFt / 1.22e-5f;
+        float relativeRoughness = 0.00015f / diameterFt;
+
+        // Laminar below Re 2000, Swamee-Jain above 4000 and a straight line
+        // between them, so the factor stays finite and continuous at low flow
+        float friction = 64.0f / reynolds;
+
+        if (reynolds > 2000.0f)
+        {
+            float turbulentRe = reynolds > 4000.0f ? reynolds : 4000.0f;
+            float logTerm = log10f(relativeRoughness / 3.7f + 5.74f / powf(turbulentRe, 0.9f));
+            friction = 0.25f / (logTerm * logTerm);
+
+            if (reynolds < 4000.0f)
+            {
+                float blend = (reynolds - 2000.0f) / 2000.0f;
+                friction = 0.032f + blend * (friction - 0.032f);
+            }
+        }
+
+        dropPSI = friction * (pipeLengthFt / diameterFt) * lbsCF * fps * fps / (2.0f * 32.174f * 144.0f);
+    }
+
+    return dropPSI;
+}
+
+// Mapping Function, useful for sensors
+float mappedValuef(float inputValue,
+                   float inputMin,
+                   float inputMax,
+                   float outputMin,
+                   float outputMax)
+{
+    float mapped = 0.0f;
+
+    float slope = 1.0f * (outputMax - outputMin) / (inputMax - inputMin);
+    mapped = outputMin + slope * (inputValue - inputMin);
+
+    return mapped;
+}
+
+// Gear speed
+float gearSpeedFeetPerMinutef(float gearDiameterInches,
+                              float rpm)
+{
+    float speed = ((float)M_PI / 12.0f) * gearDiameterInches * rpm;
+
+    return speed;
+}
+
+// Oil Carryover Volume
+float oilCarryoverGallonsf(float flowRateCFM,
+                           float concentrationPPM,
+                           float operatingHours,
+                           float oilSpecificGravity)
+{
+    float gallons = 0.0f;
+
+    if (flowRateCFM > 0.0f && concentrationPPM > 0.0f && operatingHours > 0.0f && oilSpecificGravity > 0.0f)
+    {
+        float numerator = concentrationPPM * flowRateCFM * operatingHours * 60.0f * 0.0000012f;
+        float denominator = (oilSpecificGravity * 128.0f);
+        gallons = numerator / denominator;
+    }
+
+    return gallons;
+}
+
+// Oil Carryover Concentration
+float oilCarryoverConcentrationPPMf(float flowRateCFM,
+                                    float oilLossGallons,
+                                    float operatingHours,
+                                    float oilSpecificGravity)
+{
+    float ppm = 0.0f;
+
+    if (flowRateCFM > 0.0f && oilLossGallons > 0.0f && operatingHours > 0.0f && oilSpecificGravity > 0.0f)
+    {
+        float numerator = oilLossGallons * (oilSpecificGravity * 128.0f) ;
+        float denominator = (operatingHours * 60.0f * flowRateCFM * 0.0000012f);
+        ppm = numerator / denominator;
+    }
+    
+    return ppm;
+}
@@ -0,0 +1,182 @@
+//
+//  CompulationsFloat.h
+//
+//  Single precision versions of Compulations.h, named with an f suffix. The
+//  formulas and constants are the same; compulations_accuracy reports how
+//  far each one lands from the double version.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+ 
+ This file is part of Compulations.
+ 
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CompulationsFloat_h
+#define CompulationsFloat_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Power factor from nameplate
+float threePhaseMotorPowerFactorf(float nameplateHP,
+                                  float nameplateVolts,
+                                  float nameplateAmps);
+
+float singlePhaseMotorPowerFactorf(float nameplateHP,
+                                   float nameplateVolts,
+                                   float nameplateAmps);
+
+// Power
+float threePhaseMotorInputPowerKWf(float volts,
+                                   float amps,
+                                   float powerFactor);
+
+// Shaft Power
+float threePhaseShaftPowerHPf(float volts,
+                              float amps,
+                              float efficiency,
+                              float powerFactor);
+
+// Optimal operating temperature for oil flooded screw
+float oilFloodedScrewOperatingTempFf(float inletTempF,
+                                     float dischargePressurePSIG,
+                                     float ambientPSIA);
+
+// Pressure-Altitude relationship
+float ambientPSIAForAltitudeInFeetf(float altitude);
+float altitudeFeetFromPSIAf(float psia);
+
+// Look up the double tables and round the result. A cubic in double is
+// cheaper than powf and logf, and rounding once keeps the error at half a
+// float ulp.
+float ambientPSIAForAltitudeInFeetFastf(float altitude);
+float altitudeFeetFromPSIAFastf(float psia);
+
+// Pumpup Time
+float pumpupTimeInSecondsf(float tankSizeGallons,
+                           float flowRateCFM,
+                           float startPressurePSIG,
+                           float endPressurePSIG,
+                           float ambientAtmosphericPressurePSIA);
+
+// Leak Rate
+float leakRateCFMf(float tankSizeGallons,
+                   float startPSIG,
+                   float endPSIG,
+                   float ambientPSIA,
+                   float decayTimeMins);
+
+// Refill Rate
+float refillRateCFMf(float storageCF,
+                     float startPressurePSIG,
+                     float endPressurePSIG,
+                     float refillTimeMins,
+                     float ambientPreesurePSIA);
+
+// System Capacity Estimator
+float systemCapacityCubicFeetByCycleTimef(float unloadedTimeSec,
+                                          float loadedTimeSec,
+                                          float unloadPressurePSIG,
+                                          float loadPressurePSIG,
+                                          float ratedFlowCFM,
+                                          float ambientPreesurePSIA);
+
+// Secondary storage
+float eventStorageCubicFeetf(float eventDurationMins,
+                             float cfmRequiredForEvent,
+                             float meteredCFMSupplied,
+                             float ambientPSIA,
+                             float initialPressurePSIG,
+                             float minPressureForEventPSIG);
+
+// ACFM SCFM conversions
+float vaporPressureOfWaterInPsiForTempf(float degreesFahrenheit);
+
+// Looks up the double table, as for the altitude versions
+float vaporPressureOfWaterInPsiForTempFastf(float degreesFahrenheit);
+
+float scfmFromACFMf(float acfm,
+                    float standardAmbientPressurePSI,
+                    float standardAmbientTempF,
+                    float standardAmbientRH,
+                    float siteAmbientPressurePSI,
+                    float siteAmbientTempF,
+                    float siteAmbientRH,
+                    float inletPressurePSI);
+
+float acfmFromSCFMf(float scfm,
+                    float standardAmbientPressurePSI,
+                    float standardAmbientTempF,
+                    float standardAmbientRH,
+                    float siteAmbientPressurePSI,
+                    float siteAmbientTempF,
+                    float siteAmbientRH,
+                    float inletPressurePSI);
+
+// Diameter in inches for flow and velocity
+float pipeDiameterInchesForVelocityf(float flowRateCFM,
+                                     float velocityFPS,
+                                     float linePressurePSIG,
+                                     float ambientPreesurePSIA);
+
+// Velocity of air for pipe diameter
+float velocityInPipeFPSf(float flowRateCFM,
+                         float linePressurePSIG,
+                         float ambientPreesurePSIA,
+                         float pipeDiameterIn);
+
+// Density of air lbs/ft^3
+float airDensityPoundsPerCubicFootf(float linePressurePSIG,
+                                    float ambientPreesurePSIA,
+                                    float airTemperatureF);
+
+// Darcy-Weisbach pressure drop in psi over a length of commercial steel pipe
+float pipePressureDropPSIf(float flowRateCFM,
+                           float linePressurePSIG,
+                           float ambientPreesurePSIA,
+                           float airTemperatureF,
+                           float pipeDiameterIn,
+                           float pipeLengthFt);
+
+// Mapping Function, useful for sensors
+float mappedValuef(float inputValue,
+                   float inputMin,
+                   float inputMax,
+                   float outputMin,
+                   float outputMax);
+
+// Gear speed along pitch line in ft/min
+float gearSpeedFeetPerMinutef(float gearDiameterInches,
+                              float rpm);
+
+// Oil Carryover Volume
+float oilCarryoverGallonsf(float flowRateCFM,
+                           float concentrationPPM,
+                           float operatingHours,
+                           float oilSpecificGravity);
+
+// Oil Carryover Concentration
+float oilCarryoverConcentrationPPMf(float flowRateCFM,
+                                    float oilLossGallons,
+                                    float operatingHours,
+                                    float oilSpecificGravity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CompulationsFloat_h */
@@ -0,0 +1,408 @@
+//
+//  CompulationsInstrumentation.c
+//
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CompulationsInstrumentation.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+#define INSTRUMENTED_FUNCTION_NAME(function) #function,
+
+static const char *const functionNames[InstrumentedFunctionCount] = {
+    COMPULATIONS_INSTRUMENTED_FUNCTIONS(INSTRUMENTED_FUNCTION_NAME)
+};
+
+#undef INSTRUMENTED_FUNCTION_NAME
+
+typedef struct Totals
+{
+    uint64_t calls[InstrumentedFunctionCount];
+    uint64_t nonFinite[InstrumentedFunctionCount];
+    uint64_t rejections[InstrumentedFunctionCount][COMPULATIONS_MAX_GUARDS];
+    uint64_t latency[InstrumentedFunctionCount][COMPULATIONS_LATENCY_BUCKETS];
+} Totals;
+
+#ifdef COMPULATIONS_INSTRUMENTATION
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Only the owning thread writes its counters, so a relaxed load and store
+// is enough and avoids a locked add; snapshots read them from other threads.
+typedef struct ThreadCounters
+{
+    _Atomic uint64_t calls[InstrumentedFunctionCount];
+    _Atomic uint64_t nonFinite[InstrumentedFunctionCount];
+    _Atomic uint64_t rejections[InstrumentedFunctionCount][COMPULATIONS_MAX_GUARDS];
+    _Atomic uint64_t latency[InstrumentedFunctionCount][COMPULATIONS_LATENCY_BUCKETS];
+
+    // Calls left until the next timed one
+    uint32_t countdown[InstrumentedFunctionCount];
+
+    struct ThreadCounters *previous;
+    struct ThreadCounters *next;
+} ThreadCounters;
+
+static pthread_mutex_t registryLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t threadKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t threadKey;
+
+// Guarded by registryLock
+static ThreadCounters *liveThreads;
+static Totals retired;
+static Totals baseline;
+
+static _Atomic(const char *) guardTexts[InstrumentedFunctionCount];
+static _Thread_local ThreadCounters *threadCounters;
+
+static inline void increment(_Atomic uint64_t *counter)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+static uint64_t nanosecondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static size_t latencyBucket(uint64_t ns)
+{
+    if (ns == 0)
+    {
+        return 0;
+    }
+
+    size_t exponent = 63 - (size_t)__builtin_clzll(ns);
+    size_t quarter = exponent >= 2 ? (size_t)(ns >> (exponent - 2)) & 3 : (size_t)(ns << (2 - exponent)) & 3;
+    size_t bucket = exponent * 4 + quarter;
+
+    return bucket < COMPULATIONS_LATENCY_BUCKETS ? bucket : COMPULATIONS_LATENCY_BUCKETS - 1;
+}
+
+static void addCounters(Totals *totals, ThreadCounters *thread)
+{
+    for (size_t f = 0; f < InstrumentedFunctionCount; f++)
+    {
+        totals->calls[f] += atomic_load_explicit(&thread->calls[f], memory_order_relaxed);
+        totals->nonFinite[f] += atomic_load_explicit(&thread->nonFinite[f], memory_order_relaxed);
+
+        for (size_t g = 0; g < COMPULATIONS_MAX_GUARDS; g++)
+        {
+            totals->rejections[f][g] += atomic_load_explicit(&thread->rejections[f][g], memory_order_relaxed);
+        }
+
+        for (size_t b = 0; b < COMPULATIONS_LATENCY_BUCKETS; b++)
+        {
+            totals->latency[f][b] += atomic_load_explicit(&thread->latency[f][b], memory_order_relaxed);
+        }
+    }
+}
+
+// Caller holds registryLock
+static void currentTotals(Totals *totals)
+{
+    *totals = retired;
+
+    for (ThreadCounters *thread = liveThreads; thread; thread = thread->next)
+    {
+        addCounters(totals, thread);
+    }
+}
+
+// Folds an exiting thread's counts into retired
+static void threadExited(void *value)
+{
+    ThreadCounters *thread = value;
+
+    pthread_mutex_lock(&registryLock);
+    addCounters(&retired, thread);
+
+    if (thread->previous)
+    {
+        thread->previous->next = thread->next;
+    }
+    else
+    {
+        liveThreads = thread->next;
+    }
+
+    if (thread->next)
+    {
+        thread->next->previous = thread->previous;
+    }
+
+    pthread_mutex_unlock(&registryLock);
+    free(thread);
+}
+
+static void createThreadKey(void)
+{
+    pthread_key_create(&threadKey, threadExited);
+}
+
+static ThreadCounters *registerThread(void)
+{
+    pthread_once(&threadKeyOnce, createThreadKey);
+
+    ThreadCounters *thread = calloc(1, sizeof(*thread));
+
+    if (!thread)
+    {
+        return NULL;
+    }
+
+    // Time the first call of each function
+    for (size_t f = 0; f < InstrumentedFunctionCount; f++)
+    {
+        thread->countdown[f] = 1;
+    }
+
+    pthread_mutex_lock(&registryLock);
+    thread->next = liveThreads;
+
+    if (liveThreads)
+    {
+        liveThreads->previous = thread;
+    }
+
+    liveThreads = thread;
+    pthread_mutex_unlock(&registryLock);
+
+    pthread_setspecific(threadKey, thread);
+    threadCounters = thread;
+
+    return thread;
+}
+
+uint64_t compulationsInstrumentationEnter(InstrumentedFunction function)
+{
+    ThreadCounters *thread = threadCounters ? threadCounters : registerThread();
+
+    if (!thread)
+    {
+        return 0;
+    }
+
+    increment(&thread->calls[function]);
+
+    if (--thread->countdown[function] > 0)
+    {
+        return 0;
+    }
+
+    thread->countdown[function] = COMPULATIONS_LATENCY_SAMPLE_INTERVAL;
+
+    return nanosecondsNow();
+}
+
+double compulationsInstrumentationLeave(InstrumentedFunction function, uint64_t start, double result)
+{
+    ThreadCounters *thread = threadCounters;
+
+    if (!thread)
+    {
+        return result;
+    }
+
+    if (start)
+    {
+        increment(&thread->latency[function][latencyBucket(nanosecondsNow() - start)]);
+    }
+
+    if (!isfinite(result))
+    {
+        increment(&thread->nonFinite[function]);
+    }
+
+    return result;
+}
+
+void compulationsInstrumentationReject(InstrumentedFunction function, const char *guardText, const int *passed, size_t count)
+{
+    ThreadCounters *thread = threadCounters;
+
+    if (!thread)
+    {
+        return;
+    }
+
+    if (!atomic_load_explicit(&guardTexts[function], memory_order_relaxed))
+    {
+        atomic_store_explicit(&guardTexts[function], guardText, memory_order_relaxed);
+    }
+
+    for (size_t g = 0; g < count; g++)
+    {
+        if (!passed[g])
+        {
+            increment(&thread->rejections[function][g < COMPULATIONS_MAX_GUARDS ? g : COMPULATIONS_MAX_GUARDS - 1]);
+            return;
+        }
+    }
+}
+
+int compulationsInstrumentationEnabled(void)
+{
+    return 1;
+}
+
+static void snapshotTotals(Totals *totals)
+{
+    pthread_mutex_lock(&registryLock);
+    currentTotals(totals);
+
+    for (size_t f = 0; f < InstrumentedFunctionCount; f++)
+    {
+        totals->calls[f] -= baseline.calls[f];
+        totals->nonFinite[f] -= baseline.nonFinite[f];
+
+        for (size_t g = 0; g < COMPULATIONS_MAX_GUARDS; g++)
+        {
+            totals->rejections[f][g] -= baseline.rejections[f][g];
+        }
+
+        for (size_t b = 0; b < COMPULATIONS_LATENCY_BUCKETS; b++)
+        {
+            totals->latency[f][b] -= baseline.latency[f][b];
+        }
+    }
+
+    pthread_mutex_unlock(&registryLock);
+}
+
+static const char *guardTextFor(size_t function)
+{
+    return atomic_load_explicit(&guardTexts[function], memory_order_relaxed);
+}
+
+// Counters keep running in other threads, so a reset moves the baseline
+// rather than zeroing them.
+void compulationsInstrumentationReset(void)
+{
+    pthread_mutex_lock(&registryLock);
+    currentTotals(&baseline);
+    pthread_mutex_unlock(&registryLock);
+}
+
+#else
+
+static void snapshotTotals(Totals *totals)
+{
+    memset(totals, 0, sizeof(*totals));
+}
+
+static const char *guardTextFor(size_t function)
+{
+    (void)function;
+
+    return NULL;
+}
+
+int compulationsInstrumentationEnabled(void)
+{
+    return 0;
+}
+
+void compulationsInstrumentationReset(void)
+{
+}
+
+#endif
+
+void compulationsInstrumentationSnapshot(CompulationsSnapshot *snapshot)
+{
+    static Totals totals;
+    static pthread_mutex_t totalsLock = PTHREAD_MUTEX_INITIALIZER;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    pthread_mutex_lock(&totalsLock);
+    snapshotTotals(&totals);
+
+    for (size_t f = 0; f < InstrumentedFunctionCount; f++)
+    {
+        CompulationCallStats *stats = &snapshot->functions[f];
+
+        stats->name = functionNames[f];
+        stats->calls = totals.calls[f];
+        stats->nonFinite = totals.nonFinite[f];
+        memcpy(stats->rejections, totals.rejections[f], sizeof(stats->rejections));
+        memcpy(stats->latency, totals.latency[f], sizeof(stats->latency));
+
+        for (size_t b = 0; b < COMPULATIONS_LATENCY_BUCKETS; b++)
+        {
+            stats->latencySamples += stats->latency[b];
+        }
+
+        // Split "a > 0.0, b > 0.0" into its conditions
+        const char *text = guardTextFor(f);
+
+        if (text)
+        {
+            char *copy = snapshot->guardText[f];
+            strncpy(copy, text, sizeof(snapshot->guardText[f]) - 1);
+
+            while (*copy && stats->guardCount < COMPULATIONS_MAX_GUARDS)
+            {
+                stats->guards[stats->guardCount++] = copy;
+                copy = strchr(copy, ',');
+
+                if (!copy)
+                {
+                    break;
+                }
+
+                *copy++ = '\0';
+
+                while (*copy == ' ')
+                {
+                    copy++;
+                }
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&totalsLock);
+}
+
+double compulationLatencyPercentile(const CompulationCallStats *stats, double fraction)
+{
+    uint64_t rank = (uint64_t)ceil(fraction * (double)stats->latencySamples);
+    uint64_t seen = 0;
+
+    for (size_t bucket = 0; bucket < COMPULATIONS_LATENCY_BUCKETS; bucket++)
+    {
+        seen += stats->latency[bucket];
+
+        if (seen >= rank && seen > 0)
+        {
+            return ldexp(1.0 + ((bucket % 4) + 0.5) / 4.0, (int)(bucket / 4));
+        }
+    }
+
+    return 0.0;
+}
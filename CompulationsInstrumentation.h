@@ -0,0 +1,170 @@
+//
+//  CompulationsInstrumentation.h
+//
+//  Optional counters for the functions in Compulations.h: calls, inputs
+//  rejected by each guard, non-finite results and sampled latency. Built in
+//  when the library is compiled with COMPULATIONS_INSTRUMENTATION, e.g.
+//  cmake -DCOMPULATIONS_INSTRUMENTATION=ON; otherwise the hooks compile to
+//  nothing and snapshots are empty.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CompulationsInstrumentation_h
+#define CompulationsInstrumentation_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COMPULATIONS_INSTRUMENTED_FUNCTIONS(X) \
+    X(threePhaseMotorPowerFactor) \
+    X(singlePhaseMotorPowerFactor) \
+    X(threePhaseMotorInputPowerKW) \
+    X(threePhaseShaftPowerHP) \
+    X(oilFloodedScrewOperatingTempF) \
+    X(ambientPSIAForAltitudeInFeet) \
+    X(altitudeFeetFromPSIA) \
+    X(ambientPSIAForAltitudeInFeetFast) \
+    X(altitudeFeetFromPSIAFast) \
+    X(pumpupTimeInSeconds) \
+    X(leakRateCFM) \
+    X(refillRateCFM) \
+    X(systemCapacityCubicFeetByCycleTime) \
+    X(eventStorageCubicFeet) \
+    X(vaporPressureOfWaterInPsiForTemp) \
+    X(vaporPressureOfWaterInPsiForTempFast) \
+    X(scfmFromACFM) \
+    X(acfmFromSCFM) \
+    X(pipeDiameterInchesForVelocity) \
+    X(velocityInPipeFPS) \
+    X(airDensityPoundsPerCubicFoot) \
+    X(pipePressureDropPSI) \
+    X(mappedValue) \
+    X(gearSpeedFeetPerMinute) \
+    X(oilCarryoverGallons) \
+    X(oilCarryoverConcentrationPPM)
+
+#define INSTRUMENTED_FUNCTION_ENUM(function) InstrumentedFunction_##function,
+
+typedef enum InstrumentedFunction
+{
+    COMPULATIONS_INSTRUMENTED_FUNCTIONS(INSTRUMENTED_FUNCTION_ENUM)
+    InstrumentedFunctionCount
+} InstrumentedFunction;
+
+#undef INSTRUMENTED_FUNCTION_ENUM
+
+#define COMPULATIONS_MAX_GUARDS 6
+
+// One call in this many, per function per thread, is timed.
+#ifndef COMPULATIONS_LATENCY_SAMPLE_INTERVAL
+#define COMPULATIONS_LATENCY_SAMPLE_INTERVAL 64
+#endif
+
+// 4 buckets per doubling of nanoseconds, up to 2^32 ns
+#define COMPULATIONS_LATENCY_BUCKETS (32 * 4)
+
+typedef struct CompulationCallStats
+{
+    const char *name;
+    uint64_t calls;
+
+    // Results that were NaN or infinite, e.g. mappedValue with an empty
+    // input range
+    uint64_t nonFinite;
+
+    // The function's guard conditions as written in Compulations.c, e.g.
+    // "deltaP > 0.0", and how many calls returned 0.0 because that one was
+    // the first to fail. guardCount is 0 until some call has been rejected.
+    size_t guardCount;
+    const char *guards[COMPULATIONS_MAX_GUARDS];
+    uint64_t rejections[COMPULATIONS_MAX_GUARDS];
+
+    // Sampled calls by latency, including the clock reads around them
+    uint64_t latencySamples;
+    uint64_t latency[COMPULATIONS_LATENCY_BUCKETS];
+} CompulationCallStats;
+
+typedef struct CompulationsSnapshot
+{
+    CompulationCallStats functions[InstrumentedFunctionCount];
+
+    // Backing store for the guard strings
+    char guardText[InstrumentedFunctionCount][256];
+} CompulationsSnapshot;
+
+// 1 if the library was built with COMPULATIONS_INSTRUMENTATION
+int compulationsInstrumentationEnabled(void);
+
+// Totals over every thread, including ones that have exited, since the
+// last reset. Safe while other threads are calling; counts from calls in
+// flight may or may not be included. Calls one function makes to another,
+// e.g. pipePressureDropPSI to velocityInPipeFPS, count for both.
+void compulationsInstrumentationSnapshot(CompulationsSnapshot *snapshot);
+
+// Starts the totals again from zero
+void compulationsInstrumentationReset(void);
+
+// Middle of the latency bucket holding the given fraction of the samples,
+// in ns, or 0 without samples
+double compulationLatencyPercentile(const CompulationCallStats *stats, double fraction);
+
+// Hooks for Compulations.c
+//
+//  COMPULATIONS_ENTER(function);            first statement
+//  return COMPULATIONS_LEAVE(function, x);  every return
+//  COMPULATIONS_REJECT(function, guards);   where the guards failed, with
+//                                           the same comma separated
+//                                           conditions the if tested
+#ifdef COMPULATIONS_INSTRUMENTATION
+
+uint64_t compulationsInstrumentationEnter(InstrumentedFunction function);
+double compulationsInstrumentationLeave(InstrumentedFunction function, uint64_t start, double result);
+void compulationsInstrumentationReject(InstrumentedFunction function, const char *guardText, const int *passed, size_t count);
+
+#define COMPULATIONS_ENTER(function) \
+    uint64_t instrumentationStart = compulationsInstrumentationEnter(InstrumentedFunction_##function)
+#define COMPULATIONS_LEAVE(function, result) \
+    compulationsInstrumentationLeave(InstrumentedFunction_##function, instrumentationStart, (result))
+#define COMPULATIONS_REJECT(function, ...) \
+    do \
+    { \
+        static const char guardText[] = #__VA_ARGS__; \
+        const int passed[] = { __VA_ARGS__ }; \
+        compulationsInstrumentationReject(InstrumentedFunction_##function, guardText, passed, \
+                                          sizeof(passed) / sizeof(passed[0])); \
+    } while (0)
+
+#else
+
+#define COMPULATIONS_ENTER(function) ((void)0)
+#define COMPULATIONS_LEAVE(function, result) (result)
+#define COMPULATIONS_REJECT(function, ...) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CompulationsInstrumentation_h */
@@ -0,0 +1,221 @@
+//
+//  CycleAnalyzer.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CycleAnalyzer.h"
+#include "Compulations.h"
+
+#include <math.h>
+#include <string.h>
+
+static void startCycle(CycleAnalyzer *analyzer)
+{
+    analyzer->highPSIG = -INFINITY;
+    analyzer->lowPSIG = INFINITY;
+    analyzer->sawPressure = 0;
+}
+
+void cycleAnalyzerInit(CycleAnalyzer *analyzer,
+                       double loadPressurePSIG,
+                       double unloadPressurePSIG,
+                       double deadbandPSI,
+                       double ratedFlowCFM,
+                       double ambientPSIA,
+                       double smoothing,
+                       size_t windowCycles)
+{
+    memset(analyzer, 0, sizeof(*analyzer));
+
+    analyzer->loadPressurePSIG = loadPressurePSIG;
+    analyzer->unloadPressurePSIG = unloadPressurePSIG;
+    analyzer->deadbandPSI = deadbandPSI;
+    analyzer->ratedFlowCFM = ratedFlowCFM;
+    analyzer->ambientPSIA = ambientPSIA;
+    analyzer->smoothing = smoothing;
+    analyzer->windowCycles = windowCycles < 1 ? 1 : (windowCycles > CYCLE_WINDOW_MAX ? CYCLE_WINDOW_MAX : windowCycles);
+    analyzer->state = CycleStateUnknown;
+    analyzer->loadedSec = -1.0;
+
+    startCycle(analyzer);
+}
+
+static void finishCycle(CycleAnalyzer *analyzer, double timeSec, CycleResult *cycle)
+{
+    cycle->endTimeSec = timeSec;
+    cycle->loadedSec = analyzer->loadedSec;
+    cycle->unloadedSec = timeSec - analyzer->phaseStartSec;
+
+    // Observed band when the log has pressures, setpoints otherwise
+    cycle->unloadPressurePSIG = analyzer->sawPressure ? analyzer->highPSIG : analyzer->unloadPressurePSIG;
+    cycle->loadPressurePSIG = analyzer->sawPressure ? analyzer->lowPSIG : analyzer->loadPressurePSIG;
+
+    cycle->capacityCF = systemCapacityCubicFeetByCycleTime(cycle->unloadedSec,
+                                                           cycle->loadedSec,
+                                                           cycle->unloadPressurePSIG,
+                                                           cycle->loadPressurePSIG,
+                                                           analyzer->ratedFlowCFM,
+                                                           analyzer->ambientPSIA);
+
+    if (analyzer->cycles == 0)
+    {
+        analyzer->averageCapacityCF = cycle->capacityCF;
+    }
+    else
+    {
+        analyzer->averageCapacityCF += analyzer->smoothing * (cycle->capacityCF - analyzer->averageCapacityCF);
+    }
+
+    analyzer->window[analyzer->windowNext] = *cycle;
+    analyzer->windowNext = (analyzer->windowNext + 1) % analyzer->windowCycles;
+
+    if (analyzer->windowCount < analyzer->windowCycles)
+    {
+        analyzer->windowCount++;
+    }
+
+    analyzer->last = *cycle;
+    analyzer->cycles++;
+}
+
+int cycleAnalyzerAddEvent(CycleAnalyzer *analyzer,
+                          double timeSec,
+                          CycleEventKind kind,
+                          double value,
+                          CycleResult *cycle)
+{
+    CycleState next = analyzer->state;
+
+    if (kind == CycleEventPressure)
+    {
+        analyzer->highPSIG = value > analyzer->highPSIG ? value : analyzer->highPSIG;
+        analyzer->lowPSIG = value < analyzer->lowPSIG ? value : analyzer->lowPSIG;
+        analyzer->sawPressure = 1;
+
+        if (value >= analyzer->unloadPressurePSIG - analyzer->deadbandPSI)
+        {
+            next = CycleStateUnloaded;
+        }
+        else if (value <= analyzer->loadPressurePSIG + analyzer->deadbandPSI)
+        {
+            next = CycleStateLoaded;
+        }
+    }
+    else
+    {
+        next = kind == CycleEventLoaded ? CycleStateLoaded : CycleStateUnloaded;
+    }
+
+    if (next == analyzer->state)
+    {
+        return 0;
+    }
+
+    int completed = 0;
+    CycleResult result;
+
+    if (next == CycleStateUnloaded)
+    {
+        // A loaded phase only counts if we saw it start.
+        analyzer->loadedSec = analyzer->state == CycleStateLoaded && analyzer->phaseComplete ? timeSec - analyzer->phaseStartSec : -1.0;
+    }
+    else if (analyzer->state == CycleStateUnloaded && analyzer->loadedSec >= 0.0)
+    {
+        finishCycle(analyzer, timeSec, &result);
+        completed = 1;
+
+        if (cycle)
+        {
+            *cycle = result;
+        }
+    }
+
+    if (next == CycleStateLoaded)
+    {
+        startCycle(analyzer);
+    }
+
+    analyzer->phaseComplete = analyzer->state != CycleStateUnknown;
+    analyzer->phaseStartSec = timeSec;
+    analyzer->state = next;
+
+    return completed;
+}
+
+size_t cycleAnalyzerProcessEvents(CycleAnalyzer *analyzers,
+                                  size_t machineCount,
+                                  const CycleEvent *events,
+                                  size_t count,
+                                  CycleCallback callback,
+                                  void *context)
+{
+    size_t completed = 0;
+    CycleResult cycle;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const CycleEvent *event = &events[i];
+
+        if (event->machine >= machineCount)
+        {
+            continue;
+        }
+
+        if (cycleAnalyzerAddEvent(&analyzers[event->machine], event->timeSec, (CycleEventKind)event->kind, event->value, &cycle))
+        {
+            completed++;
+
+            if (callback)
+            {
+                callback(context, event->machine, &cycle);
+            }
+        }
+    }
+
+    return completed;
+}
+
+double cycleAnalyzerWindowCapacityCF(const CycleAnalyzer *analyzer)
+{
+    if (analyzer->windowCount == 0)
+    {
+        return 0.0;
+    }
+
+    double loaded = 0.0, unloaded = 0.0, high = 0.0, low = 0.0;
+
+    for (size_t i = 0; i < analyzer->windowCount; i++)
+    {
+        loaded += analyzer->window[i].loadedSec;
+        unloaded += analyzer->window[i].unloadedSec;
+        high += analyzer->window[i].unloadPressurePSIG;
+        low += analyzer->window[i].loadPressurePSIG;
+    }
+
+    double n = (double)analyzer->windowCount;
+
+    return systemCapacityCubicFeetByCycleTime(unloaded / n,
+                                              loaded / n,
+                                              high / n,
+                                              low / n,
+                                              analyzer->ratedFlowCFM,
+                                              analyzer->ambientPSIA);
+}
@@ -0,0 +1,146 @@
+//
+//  CycleAnalyzer.h
+//
+//  Streaming load/unload cycle detection feeding
+//  systemCapacityCubicFeetByCycleTime.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CycleAnalyzer_h
+#define CycleAnalyzer_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CYCLE_WINDOW_MAX 64
+
+// A raw event from a compressor log. Pressure events carry the discharge
+// pressure in value; state events come from the controller and ignore it.
+typedef enum CycleEventKind
+{
+    CycleEventPressure = 0,
+    CycleEventLoaded,
+    CycleEventUnloaded
+} CycleEventKind;
+
+typedef struct CycleEvent
+{
+    double timeSec;
+    double value;
+    uint32_t machine;
+    uint32_t kind;
+} CycleEvent;
+
+// One complete cycle: a loaded phase followed by an unloaded phase
+typedef struct CycleResult
+{
+    double endTimeSec;
+    double loadedSec;
+    double unloadedSec;
+    double unloadPressurePSIG;
+    double loadPressurePSIG;
+    double capacityCF;
+} CycleResult;
+
+typedef void (*CycleCallback)(void *context, uint32_t machine, const CycleResult *cycle);
+
+typedef enum CycleState
+{
+    CycleStateUnknown = 0,
+    CycleStateLoaded,
+    CycleStateUnloaded
+} CycleState;
+
+typedef struct CycleAnalyzer
+{
+    // Configuration
+    double loadPressurePSIG;
+    double unloadPressurePSIG;
+    double deadbandPSI;
+    double ratedFlowCFM;
+    double ambientPSIA;
+    double smoothing;
+    size_t windowCycles;
+
+    // Current cycle
+    CycleState state;
+    double phaseStartSec;
+    double loadedSec;
+    double highPSIG;
+    double lowPSIG;
+    int sawPressure;
+    int phaseComplete;
+
+    // Results
+    size_t cycles;
+    CycleResult last;
+    double averageCapacityCF;
+
+    // Last windowCycles cycles, oldest overwritten first
+    CycleResult window[CYCLE_WINDOW_MAX];
+    size_t windowCount;
+    size_t windowNext;
+} CycleAnalyzer;
+
+// Pressure events switch to unloaded at or above unloadPressurePSIG and back
+// to loaded at or below loadPressurePSIG, each threshold pulled in by
+// deadbandPSI. The band between the thresholds is the hysteresis. smoothing
+// is the weight of the newest cycle in averageCapacityCF; windowCycles is
+// clamped to CYCLE_WINDOW_MAX.
+void cycleAnalyzerInit(CycleAnalyzer *analyzer,
+                       double loadPressurePSIG,
+                       double unloadPressurePSIG,
+                       double deadbandPSI,
+                       double ratedFlowCFM,
+                       double ambientPSIA,
+                       double smoothing,
+                       size_t windowCycles);
+
+// Feeds one event. Returns 1 and fills cycle, if not NULL, when the event
+// completes a cycle; 0 otherwise.
+int cycleAnalyzerAddEvent(CycleAnalyzer *analyzer,
+                          double timeSec,
+                          CycleEventKind kind,
+                          double value,
+                          CycleResult *cycle);
+
+// Feeds a log from many machines; each event goes to analyzers[event.machine].
+// callback, if not NULL, is called for every completed cycle. Returns the
+// number of completed cycles.
+size_t cycleAnalyzerProcessEvents(CycleAnalyzer *analyzers,
+                                  size_t machineCount,
+                                  const CycleEvent *events,
+                                  size_t count,
+                                  CycleCallback callback,
+                                  void *context);
+
+// Capacity from the mean loaded and unloaded times and pressures of the
+// cycles in the window, or 0.0 before the first complete cycle.
+double cycleAnalyzerWindowCapacityCF(const CycleAnalyzer *analyzer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CycleAnalyzer_h */
@@ -0,0 +1,681 @@
+//
+//  FleetEnergy.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FleetEnergy.h"
+#include "Compulations.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLEET_TABLE_INITIAL_CAPACITY 16
+#define FLEET_PARALLEL_GRAIN 16384
+
+// Compensated sums
+
+static inline void fleetSumAdd(FleetSum *total, double value)
+{
+    double sum = total->sum + value;
+
+    if (fabs(total->sum) >= fabs(value))
+    {
+        total->compensation += (total->sum - sum) + value;
+    }
+    else
+    {
+        total->compensation += (value - sum) + total->sum;
+    }
+
+    total->sum = sum;
+}
+
+static inline double fleetSumValue(const FleetSum *total)
+{
+    return total->sum + total->compensation;
+}
+
+static void fleetTotalsMerge(FleetTotals *into, const FleetTotals *from)
+{
+    fleetSumAdd(&into->kw, from->kw.sum);
+    fleetSumAdd(&into->kw, from->kw.compensation);
+    fleetSumAdd(&into->cfm, from->cfm.sum);
+    fleetSumAdd(&into->cfm, from->cfm.compensation);
+    into->samples += from->samples;
+    into->loadedSamples += from->loadedSamples;
+}
+
+// Machine-hour tables
+
+static inline uint64_t mixBits(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+
+    return x;
+}
+
+// Partition depends on the machine alone, so one partition holds every
+// hour of its machines.
+static inline size_t machinePartition(uint32_t machine)
+{
+    return (size_t)(mixBits(machine) % FLEET_PARTITIONS);
+}
+
+static inline size_t entrySlot(uint32_t machine, int64_t hour, size_t capacity)
+{
+    return (size_t)(mixBits(((uint64_t)machine << 32) ^ (uint64_t)hour) & (capacity - 1));
+}
+
+static int fleetTableGrow(FleetTable *table)
+{
+    size_t capacity = table->capacity ? table->capacity * 2 : FLEET_TABLE_INITIAL_CAPACITY;
+    FleetEntry *entries = calloc(capacity, sizeof(FleetEntry));
+
+    if (!entries)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        const FleetEntry *entry = &table->entries[i];
+
+        if (entry->used)
+        {
+            size_t slot = entrySlot(entry->machine, entry->hour, capacity);
+
+            while (entries[slot].used)
+            {
+                slot = (slot + 1) & (capacity - 1);
+            }
+
+            entries[slot] = *entry;
+        }
+    }
+
+    free(table->entries);
+    table->entries = entries;
+    table->capacity = capacity;
+
+    return 0;
+}
+
+// Finds or adds the entry for a machine-hour; NULL if memory runs out.
+static FleetEntry *fleetTableEntry(FleetTable *table, uint32_t machine, int64_t hour)
+{
+    // Keep the load at or below 3/4
+    if (4 * (table->count + 1) > 3 * table->capacity && fleetTableGrow(table) != 0)
+    {
+        return NULL;
+    }
+
+    size_t slot = entrySlot(machine, hour, table->capacity);
+
+    for (;;)
+    {
+        FleetEntry *entry = &table->entries[slot];
+
+        if (!entry->used)
+        {
+            entry->used = 1;
+            entry->machine = machine;
+            entry->hour = hour;
+            table->count++;
+            return entry;
+        }
+
+        if (entry->machine == machine && entry->hour == hour)
+        {
+            return entry;
+        }
+
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+}
+
+static void fleetTableFree(FleetTable *table)
+{
+    free(table->entries);
+    memset(table, 0, sizeof(*table));
+}
+
+// Setup
+
+int fleetEnergyInit(FleetEnergy *fleet, size_t shardCount, double sampleIntervalSec)
+{
+    memset(fleet, 0, sizeof(*fleet));
+
+    if (shardCount == 0 || !(sampleIntervalSec > 0.0))
+    {
+        return -1;
+    }
+
+    fleet->shards = calloc(shardCount, sizeof(FleetShard));
+
+    if (!fleet->shards)
+    {
+        return -1;
+    }
+
+    fleet->shardCount = shardCount;
+    fleet->sampleIntervalSec = sampleIntervalSec;
+
+    return 0;
+}
+
+static void fleetEnergyFreeBuckets(FleetEnergy *fleet)
+{
+    for (int p = 0; p < FleetPeriodCount; p++)
+    {
+        free(fleet->buckets[p]);
+        fleet->buckets[p] = NULL;
+        fleet->bucketCounts[p] = 0;
+    }
+}
+
+void fleetEnergyFree(FleetEnergy *fleet)
+{
+    for (size_t s = 0; s < fleet->shardCount; s++)
+    {
+        for (size_t p = 0; p < FLEET_PARTITIONS; p++)
+        {
+            fleetTableFree(&fleet->shards[s].tables[p]);
+        }
+    }
+
+    free(fleet->shards);
+    fleet->shards = NULL;
+    fleet->shardCount = 0;
+    fleetEnergyFreeBuckets(fleet);
+}
+
+// Adding samples
+
+static void shardAddSamples(FleetShard *shard, const FleetSample *samples, size_t count)
+{
+    FleetEntry *entry = NULL;
+    double hourStartSec = 0.0;
+    double hourEndSec = 0.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const FleetSample *sample = &samples[i];
+
+        // Logs run machine by machine, so the last entry usually matches. It
+        // stays valid until the next insert, which replaces it.
+        if (!entry || entry->machine != sample->machine || !(sample->timeSec >= hourStartSec && sample->timeSec < hourEndSec))
+        {
+            int64_t hour = (int64_t)floor(sample->timeSec / 3600.0);
+            FleetTable *table = &shard->tables[machinePartition(sample->machine)];
+            entry = fleetTableEntry(table, sample->machine, hour);
+
+            if (!entry)
+            {
+                shard->status = -1;
+                continue;
+            }
+
+            hourStartSec = hour * 3600.0;
+            hourEndSec = hourStartSec + 3600.0;
+        }
+
+        fleetSumAdd(&entry->totals.kw, threePhaseMotorInputPowerKW(sample->volts, sample->amps, sample->powerFactor));
+        fleetSumAdd(&entry->totals.cfm, sample->flowCFM);
+        entry->totals.samples++;
+        entry->totals.loadedSamples += sample->loaded != 0;
+    }
+}
+
+int fleetEnergyAddSamples(FleetEnergy *fleet,
+                          size_t shard,
+                          const FleetSample *samples,
+                          size_t count)
+{
+    if (shard >= fleet->shardCount)
+    {
+        return -1;
+    }
+
+    shardAddSamples(&fleet->shards[shard], samples, count);
+
+    return fleet->shards[shard].status;
+}
+
+typedef struct FleetAddJob
+{
+    FleetEnergy *fleet;
+    const FleetSample *samples;
+} FleetAddJob;
+
+static void fleetAddRange(void *context, size_t begin, size_t end, size_t worker)
+{
+    FleetAddJob *job = context;
+
+    shardAddSamples(&job->fleet->shards[worker], job->samples + begin, end - begin);
+}
+
+int fleetEnergyAddSamplesParallel(FleetEnergy *fleet,
+                                  ThreadPool *pool,
+                                  const FleetSample *samples,
+                                  size_t count)
+{
+    if (!pool)
+    {
+        return fleetEnergyAddSamples(fleet, 0, samples, count);
+    }
+
+    size_t workers = threadPoolSize(pool);
+
+    if (workers > fleet->shardCount)
+    {
+        return -1;
+    }
+
+    FleetAddJob job = { fleet, samples };
+    threadPoolParallelFor(pool, count, FLEET_PARALLEL_GRAIN, fleetAddRange, &job);
+
+    int status = 0;
+
+    for (size_t s = 0; s < workers; s++)
+    {
+        status |= fleet->shards[s].status;
+    }
+
+    return status;
+}
+
+// Rollups
+
+typedef struct FleetRow
+{
+    uint32_t machine;
+    int64_t periodStartSec;
+    FleetTotals totals;
+} FleetRow;
+
+typedef struct FleetRows
+{
+    FleetRow *rows[FleetPeriodCount];
+    size_t counts[FleetPeriodCount];
+} FleetRows;
+
+static int compareRows(const void *a, const void *b)
+{
+    const FleetRow *x = a;
+    const FleetRow *y = b;
+
+    if (x->machine != y->machine)
+    {
+        return x->machine < y->machine ? -1 : 1;
+    }
+
+    return (x->periodStartSec > y->periodStartSec) - (x->periodStartSec < y->periodStartSec);
+}
+
+static int compareRowPeriods(const void *a, const void *b)
+{
+    const FleetRow *x = a;
+    const FleetRow *y = b;
+
+    return (x->periodStartSec > y->periodStartSec) - (x->periodStartSec < y->periodStartSec);
+}
+
+static int64_t floorDivide(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return q - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+// Civil calendar from days since 1970-01-01, proleptic Gregorian
+static void civilFromDays(int64_t days, int64_t *year, unsigned *month)
+{
+    days += 719468;
+    int64_t era = floorDivide(days, 146097);
+    unsigned dayOfEra = (unsigned)(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+
+    *month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    *year = (int64_t)yearOfEra + era * 400 + (*month <= 2);
+}
+
+static int64_t daysFromCivil(int64_t year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    int64_t era = floorDivide(year, 400);
+    unsigned yearOfEra = (unsigned)(year - era * 400);
+    unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * 146097 + (int64_t)dayOfEra - 719468;
+}
+
+static int64_t periodStart(int64_t hourStartSec, FleetPeriod period)
+{
+    int64_t day = floorDivide(hourStartSec, 86400);
+
+    switch (period)
+    {
+        case FleetPeriodHour:
+            return hourStartSec;
+        case FleetPeriodDay:
+            return day * 86400;
+        default:
+        {
+            int64_t year;
+            unsigned month;
+            civilFromDays(day, &year, &month);
+            return daysFromCivil(year, month, 1) * 86400;
+        }
+    }
+}
+
+// Folds rows sorted by machine and hour into day or month rows, which come
+// out in the same order. Returns the number of rows written.
+static size_t rollRows(const FleetRow *hours, size_t count, FleetPeriod period, FleetRow *rows)
+{
+    size_t written = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int64_t start = periodStart(hours[i].periodStartSec, period);
+
+        if (written == 0 || rows[written - 1].machine != hours[i].machine || rows[written - 1].periodStartSec != start)
+        {
+            memset(&rows[written], 0, sizeof(FleetRow));
+            rows[written].machine = hours[i].machine;
+            rows[written].periodStartSec = start;
+            written++;
+        }
+
+        fleetTotalsMerge(&rows[written - 1].totals, &hours[i].totals);
+    }
+
+    return written;
+}
+
+static int buildRollups(FleetRows *rows)
+{
+    for (int p = FleetPeriodDay; p < FleetPeriodCount; p++)
+    {
+        rows->rows[p] = malloc((rows->counts[FleetPeriodHour] + 1) * sizeof(FleetRow));
+
+        if (!rows->rows[p])
+        {
+            return -1;
+        }
+
+        rows->counts[p] = rollRows(rows->rows[FleetPeriodHour], rows->counts[FleetPeriodHour], (FleetPeriod)p, rows->rows[p]);
+    }
+
+    return 0;
+}
+
+typedef struct FleetRollupJob
+{
+    FleetEnergy *fleet;
+    FleetRows *partitions;
+    int *status;
+} FleetRollupJob;
+
+// Merges one partition of every shard and rolls its machines up
+static void rollupPartition(FleetEnergy *fleet, size_t partition, FleetRows *rows)
+{
+    FleetTable merged;
+    memset(&merged, 0, sizeof(merged));
+
+    int status = 0;
+
+    for (size_t s = 0; s < fleet->shardCount && status == 0; s++)
+    {
+        const FleetTable *table = &fleet->shards[s].tables[partition];
+
+        for (size_t i = 0; i < table->capacity; i++)
+        {
+            const FleetEntry *entry = &table->entries[i];
+
+            if (!entry->used)
+            {
+                continue;
+            }
+
+            FleetEntry *into = fleetTableEntry(&merged, entry->machine, entry->hour);
+
+            if (!into)
+            {
+                status = -1;
+                break;
+            }
+
+            fleetTotalsMerge(&into->totals, &entry->totals);
+        }
+    }
+
+    rows->rows[FleetPeriodHour] = malloc((merged.count + 1) * sizeof(FleetRow));
+
+    if (status == 0 && rows->rows[FleetPeriodHour])
+    {
+        size_t count = 0;
+
+        for (size_t i = 0; i < merged.capacity; i++)
+        {
+            if (merged.entries[i].used)
+            {
+                rows->rows[FleetPeriodHour][count].machine = merged.entries[i].machine;
+                rows->rows[FleetPeriodHour][count].periodStartSec = merged.entries[i].hour * 3600;
+                rows->rows[FleetPeriodHour][count].totals = merged.entries[i].totals;
+                count++;
+            }
+        }
+
+        rows->counts[FleetPeriodHour] = count;
+        qsort(rows->rows[FleetPeriodHour], count, sizeof(FleetRow), compareRows);
+        status = buildRollups(rows);
+    }
+    else
+    {
+        status = -1;
+    }
+
+    fleetTableFree(&merged);
+
+    if (status != 0)
+    {
+        for (int p = 0; p < FleetPeriodCount; p++)
+        {
+            free(rows->rows[p]);
+            rows->rows[p] = NULL;
+            rows->counts[p] = 0;
+        }
+    }
+}
+
+static void rollupRange(void *context, size_t begin, size_t end, size_t worker)
+{
+    FleetRollupJob *job = context;
+    (void)worker;
+
+    for (size_t p = begin; p < end; p++)
+    {
+        rollupPartition(job->fleet, p, &job->partitions[p]);
+        job->status[p] = job->partitions[p].rows[FleetPeriodHour] ? 0 : -1;
+    }
+}
+
+static void bucketFromRow(const FleetRow *row, double sampleIntervalSec, FleetBucket *bucket)
+{
+    double samples = (double)row->totals.samples;
+
+    bucket->machine = row->machine;
+    bucket->periodStartSec = row->periodStartSec;
+    bucket->samples = row->totals.samples;
+    bucket->energyKWh = fleetSumValue(&row->totals.kw) * sampleIntervalSec / 3600.0;
+    bucket->airCubicFeet = fleetSumValue(&row->totals.cfm) * sampleIntervalSec / 60.0;
+    bucket->hours = samples * sampleIntervalSec / 3600.0;
+    bucket->loadedHours = (double)row->totals.loadedSamples * sampleIntervalSec / 3600.0;
+    bucket->specificPowerKWPer100CFM = bucket->airCubicFeet > 0.0 ? bucket->energyKWh * 6000.0 / bucket->airCubicFeet : 0.0;
+    bucket->loadFactor = samples > 0.0 ? (double)row->totals.loadedSamples / samples : 0.0;
+}
+
+int fleetEnergyRollup(FleetEnergy *fleet, ThreadPool *pool)
+{
+    fleetEnergyFreeBuckets(fleet);
+
+    FleetRows *partitions = calloc(FLEET_PARTITIONS, sizeof(FleetRows));
+    int *partitionStatus = calloc(FLEET_PARTITIONS, sizeof(int));
+    FleetRow *machineRows = NULL;
+    FleetRow *fleetRows = NULL;
+    int status = partitions && partitionStatus ? 0 : -1;
+
+    if (status == 0)
+    {
+        FleetRollupJob job = { fleet, partitions, partitionStatus };
+
+        if (pool)
+        {
+            threadPoolParallelFor(pool, FLEET_PARTITIONS, 1, rollupRange, &job);
+        }
+        else
+        {
+            rollupRange(&job, 0, FLEET_PARTITIONS, 0);
+        }
+
+        for (size_t p = 0; p < FLEET_PARTITIONS; p++)
+        {
+            status |= partitionStatus[p];
+        }
+    }
+
+    size_t hourCount = 0;
+
+    if (status == 0)
+    {
+        for (size_t p = 0; p < FLEET_PARTITIONS; p++)
+        {
+            hourCount += partitions[p].counts[FleetPeriodHour];
+        }
+
+        machineRows = malloc((hourCount + 1) * sizeof(FleetRow));
+        fleetRows = malloc((hourCount + 1) * sizeof(FleetRow));
+        status = machineRows && fleetRows ? 0 : -1;
+    }
+
+    for (int period = 0; period < FleetPeriodCount && status == 0; period++)
+    {
+        // Every partition holds whole machines, sorted; gather and sort them
+        size_t machineCount = 0;
+
+        for (size_t p = 0; p < FLEET_PARTITIONS; p++)
+        {
+            memcpy(machineRows + machineCount, partitions[p].rows[period], partitions[p].counts[period] * sizeof(FleetRow));
+            machineCount += partitions[p].counts[period];
+        }
+
+        qsort(machineRows, machineCount, sizeof(FleetRow), compareRows);
+
+        // Fleet-wide rows for the period
+        size_t fleetCount = 0;
+
+        if (machineCount > 0)
+        {
+            memcpy(fleetRows, machineRows, machineCount * sizeof(FleetRow));
+            qsort(fleetRows, machineCount, sizeof(FleetRow), compareRowPeriods);
+
+            // Reduced in place; the write index never passes the read index
+            for (size_t i = 0; i < machineCount; i++)
+            {
+                FleetRow source = fleetRows[i];
+
+                if (fleetCount == 0 || fleetRows[fleetCount - 1].periodStartSec != source.periodStartSec)
+                {
+                    FleetRow row = { FLEET_ALL_MACHINES, source.periodStartSec, { { 0.0, 0.0 }, { 0.0, 0.0 }, 0, 0 } };
+                    fleetRows[fleetCount++] = row;
+                }
+
+                fleetTotalsMerge(&fleetRows[fleetCount - 1].totals, &source.totals);
+            }
+        }
+
+        fleet->buckets[period] = malloc((machineCount + fleetCount + 1) * sizeof(FleetBucket));
+
+        if (!fleet->buckets[period])
+        {
+            status = -1;
+            break;
+        }
+
+        for (size_t i = 0; i < machineCount; i++)
+        {
+            bucketFromRow(&machineRows[i], fleet->sampleIntervalSec, &fleet->buckets[period][i]);
+        }
+
+        for (size_t i = 0; i < fleetCount; i++)
+        {
+            bucketFromRow(&fleetRows[i], fleet->sampleIntervalSec, &fleet->buckets[period][machineCount + i]);
+        }
+
+        fleet->bucketCounts[period] = machineCount + fleetCount;
+    }
+
+    if (partitions)
+    {
+        for (size_t p = 0; p < FLEET_PARTITIONS; p++)
+        {
+            for (int period = 0; period < FleetPeriodCount; period++)
+            {
+                free(partitions[p].rows[period]);
+            }
+        }
+    }
+
+    free(partitions);
+    free(partitionStatus);
+    free(machineRows);
+    free(fleetRows);
+
+    if (status != 0)
+    {
+        fleetEnergyFreeBuckets(fleet);
+    }
+
+    return status;
+}
+
+size_t fleetEnergyBuckets(const FleetEnergy *fleet,
+                          FleetPeriod period,
+                          const FleetBucket **buckets)
+{
+    if (period < 0 || period >= FleetPeriodCount)
+    {
+        *buckets = NULL;
+        return 0;
+    }
+
+    *buckets = fleet->buckets[period];
+
+    return fleet->bucketCounts[period];
+}
@@ -0,0 +1,171 @@
+//
+//  FleetEnergy.h
+//
+//  Energy, specific power and load factor totals for a fleet of compressors,
+//  rolled up by hour, day and month.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FleetEnergy_h
+#define FleetEnergy_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ThreadPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Machines hash into this many partitions. Each shard keeps one table per
+// partition, so a rollup merges partition p of every shard with no locks.
+#define FLEET_PARTITIONS 64
+
+// Machine number of the fleet-wide buckets
+#define FLEET_ALL_MACHINES UINT32_MAX
+
+#define FLEET_CACHE_LINE 64
+
+// One reading, covering sampleIntervalSec from timeSec (Unix time, UTC).
+// Power comes from threePhaseMotorInputPowerKW.
+typedef struct FleetSample
+{
+    double timeSec;
+    double volts;
+    double amps;
+    double powerFactor;
+    double flowCFM;
+    uint32_t machine;
+    uint32_t loaded;
+} FleetSample;
+
+typedef enum FleetPeriod
+{
+    FleetPeriodHour = 0,
+    FleetPeriodDay,
+    FleetPeriodMonth,
+    FleetPeriodCount
+} FleetPeriod;
+
+// Totals for one machine, or the whole fleet, over one calendar period
+typedef struct FleetBucket
+{
+    uint32_t machine;
+    int64_t periodStartSec;
+    uint64_t samples;
+    double energyKWh;
+    double airCubicFeet;
+    double hours;
+    double loadedHours;
+    double specificPowerKWPer100CFM;
+    double loadFactor;
+} FleetBucket;
+
+// Neumaier compensated sum; the value is sum + compensation.
+typedef struct FleetSum
+{
+    double sum;
+    double compensation;
+} FleetSum;
+
+typedef struct FleetTotals
+{
+    FleetSum kw;
+    FleetSum cfm;
+    uint64_t samples;
+    uint64_t loadedSamples;
+} FleetTotals;
+
+// Open-addressed table of machine-hours
+typedef struct FleetEntry
+{
+    uint32_t machine;
+    uint32_t used;
+    int64_t hour;
+    FleetTotals totals;
+} FleetEntry;
+
+typedef struct FleetTable
+{
+    FleetEntry *entries;
+    size_t capacity;
+    size_t count;
+} FleetTable;
+
+// Written by one thread at a time
+typedef struct FleetShard
+{
+    FleetTable tables[FLEET_PARTITIONS];
+    int status;
+    char padding[FLEET_CACHE_LINE];
+} FleetShard;
+
+typedef struct FleetEnergy
+{
+    double sampleIntervalSec;
+    size_t shardCount;
+    FleetShard *shards;
+
+    // From the last fleetEnergyRollup, sorted by machine then period with
+    // the fleet-wide buckets last
+    FleetBucket *buckets[FleetPeriodCount];
+    size_t bucketCounts[FleetPeriodCount];
+} FleetEnergy;
+
+// shardCount is the number of threads that may add samples at once; use
+// threadPoolSize() for fleetEnergyAddSamplesParallel. Returns 0, or -1 on
+// bad arguments or allocation failure.
+int fleetEnergyInit(FleetEnergy *fleet, size_t shardCount, double sampleIntervalSec);
+
+void fleetEnergyFree(FleetEnergy *fleet);
+
+// Adds samples to one shard. Different threads may add to different shards
+// at the same time. Machine numbers must be below FLEET_ALL_MACHINES.
+// Returns 0, or -1 if memory ran out and samples were dropped.
+int fleetEnergyAddSamples(FleetEnergy *fleet,
+                          size_t shard,
+                          const FleetSample *samples,
+                          size_t count);
+
+// Splits samples across pool, each worker into its own shard. pool may be
+// NULL to add them all to shard 0. Returns 0, or -1 if the pool has more
+// workers than there are shards or memory ran out.
+int fleetEnergyAddSamplesParallel(FleetEnergy *fleet,
+                                  ThreadPool *pool,
+                                  const FleetSample *samples,
+                                  size_t count);
+
+// Merges the shards into hourly, daily and monthly buckets, one partition
+// per task on pool (which may be NULL). Shards are left as they are, so
+// more samples can be added and rolled up again; no thread may be adding
+// during the call. Returns 0, or -1 if memory ran out.
+int fleetEnergyRollup(FleetEnergy *fleet, ThreadPool *pool);
+
+// Buckets for one period from the last rollup
+size_t fleetEnergyBuckets(const FleetEnergy *fleet,
+                          FleetPeriod period,
+                          const FleetBucket **buckets);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FleetEnergy_h */
@@ -0,0 +1,191 @@
+//
+//  FunctionTable.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FunctionTable.h"
+#include "Compulations.h"
+#include "CompulationsFloat.h"
+#include "UnitConversion.h"
+#include "UnitConversionFloat.h"
+
+#include <string.h>
+
+#define P(name, low, high) { name, low, high }
+
+#define COMPULATIONS_H "Compulations.h"
+#define UNIT_CONVERSION_H "UnitConversion.h"
+
+// function, header, arity, parameters
+#define COMPULATION_FUNCTIONS(X) \
+    X(threePhaseMotorPowerFactor, COMPULATIONS_H, 3, P("nameplateHP", 5.0, 500.0), P("nameplateVolts", 208.0, 575.0), P("nameplateAmps", 7.0, 550.0)) \
+    X(singlePhaseMotorPowerFactor, COMPULATIONS_H, 3, P("nameplateHP", 0.5, 10.0), P("nameplateVolts", 115.0, 230.0), P("nameplateAmps", 5.0, 50.0)) \
+    X(threePhaseMotorInputPowerKW, COMPULATIONS_H, 3, P("volts", 208.0, 575.0), P("amps", 5.0, 550.0), P("powerFactor", 0.75, 0.92)) \
+    X(threePhaseShaftPowerHP, COMPULATIONS_H, 4, P("volts", 208.0, 575.0), P("amps", 5.0, 550.0), P("efficiency", 0.88, 0.96), P("powerFactor", 0.75, 0.92)) \
+    X(oilFloodedScrewOperatingTempF, COMPULATIONS_H, 3, P("inletTempF", 40.0, 115.0), P("dischargePressurePSIG", 90.0, 175.0), P("ambientPSIA", 11.0, 14.9)) \
+    X(ambientPSIAForAltitudeInFeet, COMPULATIONS_H, 1, P("altitude", -200.0, 10000.0)) \
+    X(altitudeFeetFromPSIA, COMPULATIONS_H, 1, P("psia", 10.1, 14.8)) \
+    X(ambientPSIAForAltitudeInFeetFast, COMPULATIONS_H, 1, P("altitude", -200.0, 10000.0)) \
+    X(altitudeFeetFromPSIAFast, COMPULATIONS_H, 1, P("psia", 10.1, 14.8)) \
+    X(pumpupTimeInSeconds, COMPULATIONS_H, 5, P("tankSizeGallons", 60.0, 5000.0), P("flowRateCFM", 20.0, 2000.0), P("startPressurePSIG", 0.0, 90.0), P("endPressurePSIG", 100.0, 150.0), P("ambientAtmosphericPressurePSIA", 13.0, 14.7)) \
+    X(leakRateCFM, COMPULATIONS_H, 5, P("tankSizeGallons", 200.0, 10000.0), P("startPSIG", 100.0, 125.0), P("endPSIG", 60.0, 95.0), P("ambientPSIA", 13.0, 14.7), P("decayTimeMins", 1.0, 30.0)) \
+    X(refillRateCFM, COMPULATIONS_H, 5, P("storageCF", 20.0, 1500.0), P("startPressurePSIG", 60.0, 95.0), P("endPressurePSIG", 100.0, 125.0), P("refillTimeMins", 0.5, 10.0), P("ambientPreesurePSIA", 13.0, 14.7)) \
+    X(systemCapacityCubicFeetByCycleTime, COMPULATIONS_H, 6, P("unloadedTimeSec", 10.0, 600.0), P("loadedTimeSec", 10.0, 600.0), P("unloadPressurePSIG", 105.0, 125.0), P("loadPressurePSIG", 90.0, 100.0), P("ratedFlowCFM", 100.0, 2000.0), P("ambientPreesurePSIA", 13.0, 14.7)) \
+    X(eventStorageCubicFeet, COMPULATIONS_H, 6, P("eventDurationMins", 0.5, 15.0), P("cfmRequiredForEvent", 100.0, 1500.0), P("meteredCFMSupplied", 0.0, 100.0), P("ambientPSIA", 13.0, 14.7), P("initialPressurePSIG", 110.0, 125.0), P("minPressureForEventPSIG", 80.0, 95.0)) \
+    X(vaporPressureOfWaterInPsiForTemp, COMPULATIONS_H, 1, P("degreesFahrenheit", 32.0, 150.0)) \
+    X(vaporPressureOfWaterInPsiForTempFast, COMPULATIONS_H, 1, P("degreesFahrenheit", 32.0, 150.0)) \
+    X(scfmFromACFM, COMPULATIONS_H, 8, P("acfm", 50.0, 5000.0), P("standardAmbientPressurePSI", 14.5, 14.7), P("standardAmbientTempF", 60.0, 68.0), P("standardAmbientRH", 0.0, 0.36), P("siteAmbientPressurePSI", 11.0, 14.7), P("siteAmbientTempF", 20.0, 110.0), P("siteAmbientRH", 0.0, 1.0), P("inletPressurePSI", 11.0, 14.7)) \
+    X(acfmFromSCFM, COMPULATIONS_H, 8, P("scfm", 50.0, 5000.0), P("standardAmbientPressurePSI", 14.5, 14.7), P("standardAmbientTempF", 60.0, 68.0), P("standardAmbientRH", 0.0, 0.36), P("siteAmbientPressurePSI", 11.0, 14.7), P("siteAmbientTempF", 20.0, 110.0), P("siteAmbientRH", 0.0, 1.0), P("inletPressurePSI", 11.0, 14.7)) \
+    X(pipeDiameterInchesForVelocity, COMPULATIONS_H, 4, P("flowRateCFM", 10.0, 5000.0), P("velocityFPS", 15.0, 30.0), P("linePressurePSIG", 80.0, 125.0), P("ambientPreesurePSIA", 13.0, 14.7)) \
+    X(velocityInPipeFPS, COMPULATIONS_H, 4, P("flowRateCFM", 10.0, 5000.0), P("linePressurePSIG", 80.0, 125.0), P("ambientPreesurePSIA", 13.0, 14.7), P("pipeDiameterIn", 0.5, 12.0)) \
+    X(airDensityPoundsPerCubicFoot, COMPULATIONS_H, 3, P("linePressurePSIG", 0.0, 150.0), P("ambientPreesurePSIA", 13.0, 14.7), P("airTemperatureF", 40.0, 200.0)) \
+    X(pipePressureDropPSI, COMPULATIONS_H, 6, P("flowRateCFM", 10.0, 5000.0), P("linePressurePSIG", 80.0, 125.0), P("ambientPreesurePSIA", 13.0, 14.7), P("airTemperatureF", 60.0, 120.0), P("pipeDiameterIn", 1.0, 12.0), P("pipeLengthFt", 10.0, 1000.0)) \
+    X(mappedValue, COMPULATIONS_H, 5, P("inputValue", 4.0, 20.0), P("inputMin", 3.8, 4.2), P("inputMax", 19.8, 20.2), P("outputMin", -1.0, 0.0), P("outputMax", 150.0, 250.0)) \
+    X(gearSpeedFeetPerMinute, COMPULATIONS_H, 2, P("gearDiameterInches", 2.0, 20.0), P("rpm", 1000.0, 20000.0)) \
+    X(oilCarryoverGallons, COMPULATIONS_H, 4, P("flowRateCFM", 50.0, 5000.0), P("concentrationPPM", 1.0, 10.0), P("operatingHours", 100.0, 8760.0), P("oilSpecificGravity", 0.85, 0.9)) \
+    X(oilCarryoverConcentrationPPM, COMPULATIONS_H, 4, P("flowRateCFM", 50.0, 5000.0), P("oilLossGallons", 0.1, 20.0), P("operatingHours", 100.0, 8760.0), P("oilSpecificGravity", 0.85, 0.9)) \
+    X(frequencyFromSynchronousSpeedAndPoles, UNIT_CONVERSION_H, 2, P("speed", 600.0, 3600.0), P("poles", 2.0, 12.0)) \
+    X(numberOfPolesFromSynchronousSpeedAndFrequency, UNIT_CONVERSION_H, 2, P("speed", 600.0, 3600.0), P("hz", 50.0, 60.0)) \
+    X(synchronousMotorSpeedForFrequencyAndPoles, UNIT_CONVERSION_H, 2, P("hz", 50.0, 60.0), P("poles", 2.0, 12.0)) \
+    X(celsiusFromFahrenheit, UNIT_CONVERSION_H, 1, P("f", -40.0, 250.0)) \
+    X(celsiusFromKelvin, UNIT_CONVERSION_H, 1, P("k", 233.0, 394.0)) \
+    X(fahrenheitFromCelsius, UNIT_CONVERSION_H, 1, P("c", -40.0, 120.0)) \
+    X(fahrenheitFromKelvin, UNIT_CONVERSION_H, 1, P("k", 233.0, 394.0)) \
+    X(fahrenheitFromRankine, UNIT_CONVERSION_H, 1, P("r", 420.0, 710.0)) \
+    X(kelvinFromCelsius, UNIT_CONVERSION_H, 1, P("c", -40.0, 120.0)) \
+    X(kelvinFromFahrenheit, UNIT_CONVERSION_H, 1, P("f", -40.0, 250.0)) \
+    X(rankineFromFahrenheit, UNIT_CONVERSION_H, 1, P("f", -40.0, 250.0)) \
+    X(barFromPSI, UNIT_CONVERSION_H, 1, P("psi", 0.0, 200.0)) \
+    X(inH20FromkPa, UNIT_CONVERSION_H, 1, P("kPa", 0.0, 10.0)) \
+    X(inHgFromMmHg, UNIT_CONVERSION_H, 1, P("mmHg", 500.0, 800.0)) \
+    X(inHgFromkPa, UNIT_CONVERSION_H, 1, P("kPa", 60.0, 105.0)) \
+    X(inHgFromPSI, UNIT_CONVERSION_H, 1, P("psi", 9.0, 15.0)) \
+    X(kPaFromInH2O, UNIT_CONVERSION_H, 1, P("inH2O", 0.0, 40.0)) \
+    X(kPaFromInHg, UNIT_CONVERSION_H, 1, P("inHg", 18.0, 31.0)) \
+    X(kPaFromMmH2O, UNIT_CONVERSION_H, 1, P("mmH2O", 0.0, 1000.0)) \
+    X(kPaFromMmHg, UNIT_CONVERSION_H, 1, P("mmHg", 500.0, 800.0)) \
+    X(kPaFromPSI, UNIT_CONVERSION_H, 1, P("PSI", 0.0, 200.0)) \
+    X(mmH2OFromkPa, UNIT_CONVERSION_H, 1, P("kPa", 0.0, 10.0)) \
+    X(mmHgFromInHg, UNIT_CONVERSION_H, 1, P("inHg", 18.0, 31.0)) \
+    X(mmHgFromkPa, UNIT_CONVERSION_H, 1, P("kPa", 60.0, 105.0)) \
+    X(psiFromBar, UNIT_CONVERSION_H, 1, P("bar", 0.0, 14.0)) \
+    X(psiFromInHg, UNIT_CONVERSION_H, 1, P("inHg", 18.0, 31.0)) \
+    X(psiFromkPa, UNIT_CONVERSION_H, 1, P("kPa", 0.0, 1400.0)) \
+    X(inFromMillimeter, UNIT_CONVERSION_H, 1, P("mm", 10.0, 600.0)) \
+    X(feetFromMeters, UNIT_CONVERSION_H, 1, P("meters", 0.0, 3000.0)) \
+    X(metersFromFeet, UNIT_CONVERSION_H, 1, P("feet", 0.0, 10000.0)) \
+    X(mmFromInch, UNIT_CONVERSION_H, 1, P("inch", 0.25, 24.0)) \
+    X(cubicFeetFromGallons, UNIT_CONVERSION_H, 1, P("gal", 1.0, 10000.0)) \
+    X(cubicFeetFromCubicMeters, UNIT_CONVERSION_H, 1, P("m", 0.1, 40.0)) \
+    X(cubicMetersFromCubicFeet, UNIT_CONVERSION_H, 1, P("ft", 1.0, 1500.0)) \
+    X(gallonsFromCubicFeet, UNIT_CONVERSION_H, 1, P("ft", 1.0, 1500.0)) \
+    X(gallonsFromLiters, UNIT_CONVERSION_H, 1, P("liters", 1.0, 40000.0)) \
+    X(litersFromGallons, UNIT_CONVERSION_H, 1, P("gallons", 1.0, 10000.0)) \
+    X(hpFromKw, UNIT_CONVERSION_H, 1, P("kw", 1.0, 500.0)) \
+    X(kwFromHP, UNIT_CONVERSION_H, 1, P("hp", 1.0, 700.0)) \
+    X(voltsPeakFromVoltsRms, UNIT_CONVERSION_H, 1, P("vrms", 120.0, 600.0)) \
+    X(voltsRmsFromVoltsPeak, UNIT_CONVERSION_H, 1, P("vp", 170.0, 850.0)) \
+    X(ampsFLAFromWyeDelta, UNIT_CONVERSION_H, 1, P("wda", 5.0, 600.0)) \
+    X(ampsWyeDeltaFromFLA, UNIT_CONVERSION_H, 1, P("fla", 5.0, 600.0)) \
+    X(cfmFromM3minute, UNIT_CONVERSION_H, 1, P("m3m", 0.5, 150.0)) \
+    X(m3MinuteFromCFM, UNIT_CONVERSION_H, 1, P("cfm", 20.0, 5000.0)) \
+    X(newtonsFromPounds, UNIT_CONVERSION_H, 1, P("pounds", 1.0, 10000.0)) \
+    X(poundsFromNewtons, UNIT_CONVERSION_H, 1, P("newtons", 5.0, 45000.0))
+
+// Argument lists for each arity
+#define SCALAR_ARGUMENTS_1(a) a[0]
+#define SCALAR_ARGUMENTS_2(a) SCALAR_ARGUMENTS_1(a), a[1]
+#define SCALAR_ARGUMENTS_3(a) SCALAR_ARGUMENTS_2(a), a[2]
+#define SCALAR_ARGUMENTS_4(a) SCALAR_ARGUMENTS_3(a), a[3]
+#define SCALAR_ARGUMENTS_5(a) SCALAR_ARGUMENTS_4(a), a[4]
+#define SCALAR_ARGUMENTS_6(a) SCALAR_ARGUMENTS_5(a), a[5]
+#define SCALAR_ARGUMENTS_7(a) SCALAR_ARGUMENTS_6(a), a[6]
+#define SCALAR_ARGUMENTS_8(a) SCALAR_ARGUMENTS_7(a), a[7]
+
+#define COLUMN_ARGUMENTS_1(a, k) a[0][k]
+#define COLUMN_ARGUMENTS_2(a, k) COLUMN_ARGUMENTS_1(a, k), a[1][k]
+#define COLUMN_ARGUMENTS_3(a, k) COLUMN_ARGUMENTS_2(a, k), a[2][k]
+#define COLUMN_ARGUMENTS_4(a, k) COLUMN_ARGUMENTS_3(a, k), a[3][k]
+#define COLUMN_ARGUMENTS_5(a, k) COLUMN_ARGUMENTS_4(a, k), a[4][k]
+#define COLUMN_ARGUMENTS_6(a, k) COLUMN_ARGUMENTS_5(a, k), a[5][k]
+#define COLUMN_ARGUMENTS_7(a, k) COLUMN_ARGUMENTS_6(a, k), a[6][k]
+#define COLUMN_ARGUMENTS_8(a, k) COLUMN_ARGUMENTS_7(a, k), a[7][k]
+
+// The column loops call the function directly, so inline conversions are
+// inlined into them.
+#define DEFINE_WRAPPERS(function, header, arity, ...) \
+    static double function##Scalar(const double *a) \
+    { \
+        return function(SCALAR_ARGUMENTS_##arity(a)); \
+    } \
+    static void function##Columns(const double *const *a, double *results, size_t count) \
+    { \
+        for (size_t k = 0; k < count; k++) \
+        { \
+            results[k] = function(COLUMN_ARGUMENTS_##arity(a, k)); \
+        } \
+    } \
+    static void function##FloatColumns(const float *const *a, float *results, size_t count) \
+    { \
+        for (size_t k = 0; k < count; k++) \
+        { \
+            results[k] = function##f(COLUMN_ARGUMENTS_##arity(a, k)); \
+        } \
+    } \
+    static void function##MixedColumns(const float *const *a, float *results, size_t count) \
+    { \
+        for (size_t k = 0; k < count; k++) \
+        { \
+            results[k] = (float)function(COLUMN_ARGUMENTS_##arity(a, k)); \
+        } \
+    }
+
+#define TABLE_ROW(function, header, arity, ...) { #function, header, arity, { __VA_ARGS__ }, function##Scalar, function##Columns, \
+                                                function##FloatColumns, function##MixedColumns },
+
+COMPULATION_FUNCTIONS(DEFINE_WRAPPERS)
+
+static const CompulationFunction functionTable[] = {
+    COMPULATION_FUNCTIONS(TABLE_ROW)
+};
+
+size_t compulationFunctionCount(void)
+{
+    return sizeof(functionTable) / sizeof(functionTable[0]);
+}
+
+const CompulationFunction *compulationFunctionAt(size_t index)
+{
+    return index < compulationFunctionCount() ? &functionTable[index] : NULL;
+}
+
+const CompulationFunction *compulationFunctionNamed(const char *name)
+{
+    for (size_t i = 0; i < compulationFunctionCount(); i++)
+    {
+        if (strcmp(functionTable[i].name, name) == 0)
+        {
+            return &functionTable[i];
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,82 @@
+//
+//  FunctionTable.h
+//
+//  Descriptors for every function in Compulations.h and UnitConversion.h, so
+//  tools can call them by name.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FunctionTable_h
+#define FunctionTable_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COMPULATION_MAX_ARITY 8
+
+// low and high bound the values seen in the field, e.g. for benchmark inputs.
+typedef struct CompulationParameter
+{
+    const char *name;
+    double low;
+    double high;
+} CompulationParameter;
+
+// arguments[i] is parameter i
+typedef double (*CompulationScalar)(const double *arguments);
+
+// arguments[i][k] is parameter i of call k
+typedef void (*CompulationColumns)(const double *const *arguments, double *results, size_t count);
+
+// As above with float columns
+typedef void (*CompulationColumnsFloat)(const float *const *arguments, float *results, size_t count);
+
+typedef struct CompulationFunction
+{
+    const char *name;
+    const char *header;
+    size_t arity;
+    CompulationParameter parameters[COMPULATION_MAX_ARITY];
+    CompulationScalar evaluate;
+    CompulationColumns evaluateColumns;
+
+    // Float columns through the single precision versions in
+    // CompulationsFloat.h and UnitConversionFloat.h
+    CompulationColumnsFloat evaluateColumnsFloat;
+
+    // Float columns through the double version: each argument is widened,
+    // the math is done in double, and only the result is rounded to float.
+    CompulationColumnsFloat evaluateColumnsMixed;
+} CompulationFunction;
+
+size_t compulationFunctionCount(void);
+const CompulationFunction *compulationFunctionAt(size_t index);
+
+// NULL if there is no such function
+const CompulationFunction *compulationFunctionNamed(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FunctionTable_h */
@@ -0,0 +1,643 @@
+//
+//  InverseSolver.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "InverseSolver.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// Cases solved in step by one worker
+#define INVERSE_TILE 256
+
+#define INVERSE_EXPANSION 1.6
+
+// A closed-form solution is kept if it reproduces the target this closely
+#define INVERSE_CLOSED_FORM_TOLERANCE 1e-10
+
+// Brent's method converges on a jump as readily as on a root. A root leaves
+// a residual many orders below the bracket's; a jump leaves one near it.
+#define INVERSE_JUMP_TOLERANCE 1e-6
+
+#define INVERSE_PENDING 0xFF
+
+// Closed forms. An exponent p means the function goes as x^p in that
+// parameter, so x = x0 (target / f(x0))^(1/p). An exponent of 0 means it is
+// affine in x and two evaluations give the line.
+typedef struct InverseForm
+{
+    const char *function;
+    const char *parameter;
+    double exponent;
+} InverseForm;
+
+static const InverseForm inverseForms[] = {
+    { "threePhaseMotorInputPowerKW", "volts", 1.0 },
+    { "threePhaseMotorInputPowerKW", "amps", 1.0 },
+    { "threePhaseMotorInputPowerKW", "powerFactor", 1.0 },
+    { "threePhaseShaftPowerHP", "volts", 1.0 },
+    { "threePhaseShaftPowerHP", "amps", 1.0 },
+    { "threePhaseShaftPowerHP", "efficiency", 1.0 },
+    { "threePhaseShaftPowerHP", "powerFactor", 1.0 },
+    { "pumpupTimeInSeconds", "tankSizeGallons", 1.0 },
+    { "pumpupTimeInSeconds", "flowRateCFM", -1.0 },
+    { "pumpupTimeInSeconds", "startPressurePSIG", 0.0 },
+    { "pumpupTimeInSeconds", "endPressurePSIG", 0.0 },
+    { "pumpupTimeInSeconds", "ambientAtmosphericPressurePSIA", -1.0 },
+    { "leakRateCFM", "tankSizeGallons", 1.0 },
+    { "leakRateCFM", "startPSIG", 0.0 },
+    { "leakRateCFM", "endPSIG", 0.0 },
+    { "leakRateCFM", "ambientPSIA", -1.0 },
+    { "leakRateCFM", "decayTimeMins", -1.0 },
+    { "refillRateCFM", "storageCF", 1.0 },
+    { "refillRateCFM", "startPressurePSIG", 0.0 },
+    { "refillRateCFM", "endPressurePSIG", 0.0 },
+    { "refillRateCFM", "refillTimeMins", -1.0 },
+    { "refillRateCFM", "ambientPreesurePSIA", -1.0 },
+    { "systemCapacityCubicFeetByCycleTime", "ratedFlowCFM", 1.0 },
+    { "systemCapacityCubicFeetByCycleTime", "ambientPreesurePSIA", 1.0 },
+    { "eventStorageCubicFeet", "eventDurationMins", 1.0 },
+    { "eventStorageCubicFeet", "cfmRequiredForEvent", 0.0 },
+    { "eventStorageCubicFeet", "meteredCFMSupplied", 0.0 },
+    { "eventStorageCubicFeet", "ambientPSIA", 1.0 },
+    { "pipeDiameterInchesForVelocity", "flowRateCFM", 0.5 },
+    { "pipeDiameterInchesForVelocity", "velocityFPS", -0.5 },
+    { "velocityInPipeFPS", "flowRateCFM", 1.0 },
+    { "velocityInPipeFPS", "pipeDiameterIn", -2.0 },
+    { "mappedValue", "inputValue", 0.0 },
+    { "mappedValue", "outputMin", 0.0 },
+    { "mappedValue", "outputMax", 0.0 },
+    { "gearSpeedFeetPerMinute", "gearDiameterInches", 1.0 },
+    { "gearSpeedFeetPerMinute", "rpm", 1.0 },
+    { "oilCarryoverGallons", "flowRateCFM", 1.0 },
+    { "oilCarryoverGallons", "concentrationPPM", 1.0 },
+    { "oilCarryoverGallons", "operatingHours", 1.0 },
+    { "oilCarryoverGallons", "oilSpecificGravity", -1.0 },
+    { "oilCarryoverConcentrationPPM", "flowRateCFM", -1.0 },
+    { "oilCarryoverConcentrationPPM", "oilLossGallons", 1.0 },
+    { "oilCarryoverConcentrationPPM", "operatingHours", -1.0 },
+    { "oilCarryoverConcentrationPPM", "oilSpecificGravity", 1.0 }
+};
+
+// Every one-argument unit conversion is a scale or a scale and offset.
+static const InverseForm unitConversionForm = { NULL, NULL, 0.0 };
+
+static const InverseForm *inverseForm(const CompulationFunction *function, size_t unknown)
+{
+    if (unknown >= function->arity)
+    {
+        return NULL;
+    }
+
+    if (function->arity == 1 && strcmp(function->header, "UnitConversion.h") == 0)
+    {
+        return &unitConversionForm;
+    }
+
+    for (size_t i = 0; i < sizeof(inverseForms) / sizeof(inverseForms[0]); i++)
+    {
+        if (strcmp(inverseForms[i].function, function->name) == 0 &&
+            strcmp(inverseForms[i].parameter, function->parameters[unknown].name) == 0)
+        {
+            return &inverseForms[i];
+        }
+    }
+
+    return NULL;
+}
+
+void inverseOptionsDefault(InverseOptions *options)
+{
+    options->low = NAN;
+    options->high = NAN;
+    options->tolerance = 1e-12;
+    options->maxIterations = 100;
+    options->maxExpansions = 60;
+}
+
+int inverseHasClosedForm(const CompulationFunction *function, size_t unknown)
+{
+    return inverseForm(function, unknown) != NULL;
+}
+
+typedef struct InverseJob
+{
+    const CompulationFunction *function;
+    size_t unknown;
+    const double *const *arguments;
+    const double *targets;
+    double *solutions;
+    uint8_t *status;
+    size_t count;
+    const InverseForm *form;
+    InverseOptions options;
+} InverseJob;
+
+// One bracket per case, with g = f - target, as in Brent's zeroin
+typedef struct BrentState
+{
+    double a;
+    double b;
+    double c;
+    double ga;
+    double gb;
+    double gc;
+    double d;
+    double e;
+
+    // |g| and width of the first bracket
+    double scale;
+    double span;
+} BrentState;
+
+typedef struct InverseTile
+{
+    const double *columns[COMPULATION_MAX_ARITY];
+    double x[INVERSE_TILE];
+    double f[INVERSE_TILE];
+    BrentState brent[INVERSE_TILE];
+    size_t count;
+} InverseTile;
+
+// Evaluates the function at tile->x for every case in the tile
+static inline void tileEvaluate(const InverseJob *job, InverseTile *tile)
+{
+    job->function->evaluateColumns(tile->columns, tile->f, tile->count);
+}
+
+static void solveClosedForm(const InverseJob *job, InverseTile *tile, const double *targets, double *solutions, uint8_t *status)
+{
+    const CompulationParameter *parameter = &job->function->parameters[job->unknown];
+    double exponent = job->form->exponent;
+    double x0 = exponent == 0.0 ? parameter->low : 0.5 * (parameter->low + parameter->high);
+    double x1 = parameter->high;
+    double f0[INVERSE_TILE];
+    double f1[INVERSE_TILE];
+    double candidates[INVERSE_TILE];
+
+    for (size_t k = 0; k < tile->count; k++)
+    {
+        tile->x[k] = x0;
+    }
+
+    tileEvaluate(job, tile);
+    memcpy(f0, tile->f, tile->count * sizeof(double));
+
+    if (exponent == 0.0)
+    {
+        for (size_t k = 0; k < tile->count; k++)
+        {
+            tile->x[k] = x1;
+        }
+
+        tileEvaluate(job, tile);
+        memcpy(f1, tile->f, tile->count * sizeof(double));
+    }
+
+    for (size_t k = 0; k < tile->count; k++)
+    {
+        double x = NAN;
+
+        if (status[k] == INVERSE_PENDING)
+        {
+            if (exponent == 0.0)
+            {
+                if (f1[k] != f0[k])
+                {
+                    x = x0 + (targets[k] - f0[k]) * (x1 - x0) / (f1[k] - f0[k]);
+                }
+            }
+            else if (targets[k] / f0[k] > 0.0)
+            {
+                x = x0 * pow(targets[k] / f0[k], 1.0 / exponent);
+            }
+        }
+
+        // Cases with no candidate are evaluated at x0 and left pending.
+        tile->x[k] = isfinite(x) ? x : x0;
+        candidates[k] = x;
+    }
+
+    tileEvaluate(job, tile);
+
+    for (size_t k = 0; k < tile->count; k++)
+    {
+        if (status[k] == INVERSE_PENDING && isfinite(candidates[k]))
+        {
+            double scale = fmax(fabs(targets[k]), fabs(f0[k]));
+
+            if (exponent == 0.0)
+            {
+                scale = fmax(scale, fabs(f1[k]));
+            }
+
+            if (fabs(tile->f[k] - targets[k]) <= INVERSE_CLOSED_FORM_TOLERANCE * scale)
+            {
+                status[k] = InverseStatusConverged;
+                solutions[k] = candidates[k];
+            }
+        }
+    }
+}
+
+// Finds a sign change for every pending case, widening away from the end
+// nearer the target.
+static void brentBracket(const InverseJob *job, InverseTile *tile, const double *targets, uint8_t *status)
+{
+    BrentState *brent = tile->brent;
+    double low = isnan(job->options.low) ? job->function->parameters[job->unknown].low : job->options.low;
+    double high = isnan(job->options.high) ? job->function->parameters[job->unknown].high : job->options.high;
+
+    for (size_t k = 0; k < tile->count; k++)
+    {
+        brent[k].a = low;
+        brent[k].b = high;
+        tile->x[k] = low;
+    }
+
+    tileEvaluate(job, tile);
+
+    for (size_t k = 0; k < tile->count; k++)
+    {
+        brent[k].ga = tile->f[k] - targets[k];
+        tile->x[k] = high;
+    }
+
+    tileEvaluate(job, tile);
+
+    for (size_t k = 0; k < tile->count; k++)
+    {
+        brent[k].gb = tile->f[k] - targets[k];
+    }
+
+    for (size_t expansion = 0; ; expansion++)
+    {
+        size_t unbracketed = 0;
+
+        for (size_t k = 0; k < tile->count; k++)
+        {
+            BrentState *s = &brent[k];
+            tile->x[k] = s->b;
+
+            if (status[k] != INVERSE_PENDING)
+            {
+                continue;
+            }
+
+            if (isnan(s->ga) || isnan(s->gb))
+            {
+                status[k] = InverseStatusInvalid;
+            }
+            else if ((s->ga > 0.0) == (s->gb > 0.0) && s->ga != 0.0 && s->gb != 0.0)
+            {
+                if (expansion == job->options.maxExpansions)
+                {
+                    status[k] = InverseStatusNoBracket;
+                }
+                else
+                {
+                    tile->x[k] = fabs(s->ga) < fabs(s->gb) ? s->a + INVERSE_EXPANSION * (s->a - s->b)
+                                                           : s->b + INVERSE_EXPANSION * (s->b - s->a);
+                    unbracketed++;
+                }
+            }
+        }
+
+        if (unbracketed == 0)
+        {
+            break;
+        }
+
+        tileEvaluate(job, tile);
+
+        for (size_t k = 0; k < tile->count; k++)
+        {
+            BrentState *s = &brent[k];
+
+            if (status[k] == INVERSE_PENDING && tile->x[k] != s->b)
+            {
+                if (fabs(s->ga) < fabs(s->gb))
+                {
+                    s->a = tile->x[k];
+                    s->ga = tile->f[k] - targets[k];
+                }
+                else
+                {
+                    s->b = tile->x[k];
+                    s->gb = tile->f[k] - targets[k];
+                }
+            }
+        }
+    }
+
+    for (size_t k = 0; k < tile->count; k++)
+    {
+        BrentState *s = &brent[k];
+
+        s->c = s->b;
+        s->gc = s->gb;
+        s->d = s->b - s->a;
+        s->e = s->d;
+        s->scale = fmax(fabs(s->ga), fabs(s->gb));
+        s->span = fabs(s->b - s->a);
+    }
+}
+
+// One step of zeroin for one case. Returns 1 with the next point to try in
+// s->b, or 0 once s->b is the root. The tolerance is relative to the root,
+// or to the first bracket for a root near 0.
+static int brentStep(BrentState *s, double tolerance)
+{
+    if ((s->gb > 0.0) == (s->gc > 0.0))
+    {
+        s->c = s->a;
+        s->gc = s->ga;
+        s->d = s->b - s->a;
+        s->e = s->d;
+    }
+
+    if (fabs(s->gc) < fabs(s->gb))
+    {
+        s->a = s->b;
+        s->b = s->c;
+        s->c = s->a;
+        s->ga = s->gb;
+        s->gb = s->gc;
+        s->gc = s->ga;
+    }
+
+    double tol = 2.0 * DBL_EPSILON * fabs(s->b) + 0.5 * tolerance * fmax(fabs(s->b), DBL_EPSILON * s->span);
+    double middle = 0.5 * (s->c - s->b);
+
+    if (fabs(middle) <= tol || s->gb == 0.0)
+    {
+        return 0;
+    }
+
+    if (fabs(s->e) >= tol && fabs(s->ga) > fabs(s->gb))
+    {
+        // Secant or inverse quadratic interpolation
+        double ratio = s->gb / s->ga;
+        double p;
+        double q;
+
+        if (s->a == s->c)
+        {
+            p = 2.0 * middle * ratio;
+            q = 1.0 - ratio;
+        }
+        else
+        {
+            double qa = s->ga / s->gc;
+            double rb = s->gb / s->gc;
+            p = ratio * (2.0 * middle * qa * (qa - rb) - (s->b - s->a) * (rb - 1.0));
+            q = (qa - 1.0) * (rb - 1.0) * (ratio - 1.0);
+        }
+
+        if (p > 0.0)
+        {
+            q = -q;
+        }
+
+        p = fabs(p);
+
+        if (2.0 * p < fmin(3.0 * middle * q - fabs(tol * q), fabs(s->e * q)))
+        {
+            s->e = s->d;
+            s->d = p / q;
+        }
+        else
+        {
+            s->d = middle;
+            s->e = s->d;
+        }
+    }
+    else
+    {
+        // Bisection
+        s->d = middle;
+        s->e = s->d;
+    }
+
+    s->a = s->b;
+    s->ga = s->gb;
+    s->b += fabs(s->d) > tol ? s->d : copysign(tol, middle);
+
+    return 1;
+}
+
+static void solveBrent(const InverseJob *job, InverseTile *tile, const double *targets, double *solutions, uint8_t *status)
+{
+    BrentState *brent = tile->brent;
+
+    brentBracket(job, tile, targets, status);
+
+    for (size_t iteration = 0; ; iteration++)
+    {
+        size_t stepping = 0;
+
+        for (size_t k = 0; k < tile->count; k++)
+        {
+            BrentState *s = &brent[k];
+
+            if (status[k] != INVERSE_PENDING)
+            {
+                tile->x[k] = brent[k].b;
+                continue;
+            }
+
+            if (!brentStep(s, job->options.tolerance))
+            {
+                status[k] = fabs(s->gb) <= INVERSE_JUMP_TOLERANCE * s->scale ? InverseStatusConverged
+                                                                               : InverseStatusDiscontinuity;
+            }
+            else if (iteration == job->options.maxIterations)
+            {
+                status[k] = InverseStatusMaxIterations;
+            }
+            else
+            {
+                stepping++;
+            }
+
+            tile->x[k] = s->b;
+        }
+
+        if (stepping == 0)
+        {
+            break;
+        }
+
+        tileEvaluate(job, tile);
+
+        for (size_t k = 0; k < tile->count; k++)
+        {
+            if (status[k] == INVERSE_PENDING)
+            {
+                brent[k].gb = tile->f[k] - targets[k];
+            }
+        }
+    }
+
+    for (size_t k = 0; k < tile->count; k++)
+    {
+        if (status[k] != InverseStatusConverged || isnan(solutions[k]))
+        {
+            solutions[k] = status[k] == InverseStatusNoBracket || status[k] == InverseStatusInvalid ? NAN : brent[k].b;
+        }
+    }
+}
+
+static void inverseSolveTile(const InverseJob *job, size_t begin, size_t count)
+{
+    InverseTile tile;
+    const double *targets = job->targets + begin;
+    double *solutions = job->solutions + begin;
+    uint8_t *status = job->status + begin;
+    size_t pending = 0;
+
+    for (size_t i = 0; i < job->function->arity; i++)
+    {
+        tile.columns[i] = i == job->unknown ? tile.x : job->arguments[i] + begin;
+    }
+
+    tile.count = count;
+
+    for (size_t k = 0; k < count; k++)
+    {
+        status[k] = isnan(targets[k]) ? InverseStatusInvalid : INVERSE_PENDING;
+        solutions[k] = NAN;
+    }
+
+    if (job->form)
+    {
+        solveClosedForm(job, &tile, targets, solutions, status);
+    }
+
+    for (size_t k = 0; k < count; k++)
+    {
+        pending += status[k] == INVERSE_PENDING;
+    }
+
+    if (pending)
+    {
+        // Converged closed-form cases ride along; their solutions are kept.
+        solveBrent(job, &tile, targets, solutions, status);
+    }
+}
+
+static void inverseSolveRange(void *context, size_t begin, size_t end, size_t worker)
+{
+    const InverseJob *job = context;
+
+    (void)worker;
+
+    for (size_t tile = begin; tile < end; tile++)
+    {
+        size_t first = tile * INVERSE_TILE;
+        size_t count = job->count - first < INVERSE_TILE ? job->count - first : INVERSE_TILE;
+
+        inverseSolveTile(job, first, count);
+    }
+}
+
+size_t inverseSolveColumns(const CompulationFunction *function,
+                           size_t unknown,
+                           const double *const *arguments,
+                           const double *targets,
+                           double *solutions,
+                           uint8_t *status,
+                           size_t count,
+                           const InverseOptions *options,
+                           ThreadPool *pool)
+{
+    if (!function || unknown >= function->arity || count == 0)
+    {
+        return 0;
+    }
+
+    InverseJob job;
+    job.function = function;
+    job.unknown = unknown;
+    job.arguments = arguments;
+    job.targets = targets;
+    job.solutions = solutions;
+    job.status = status;
+    job.count = count;
+    job.form = inverseForm(function, unknown);
+
+    if (options)
+    {
+        job.options = *options;
+    }
+    else
+    {
+        inverseOptionsDefault(&job.options);
+    }
+
+    size_t tiles = (count + INVERSE_TILE - 1) / INVERSE_TILE;
+
+    if (pool)
+    {
+        threadPoolParallelFor(pool, tiles, 1, inverseSolveRange, &job);
+    }
+    else
+    {
+        inverseSolveRange(&job, 0, tiles, 0);
+    }
+
+    size_t converged = 0;
+
+    for (size_t k = 0; k < count; k++)
+    {
+        converged += status[k] == InverseStatusConverged;
+    }
+
+    return converged;
+}
+
+InverseStatus inverseSolve(const CompulationFunction *function,
+                           size_t unknown,
+                           const double *arguments,
+                           double target,
+                           double *solution,
+                           const InverseOptions *options)
+{
+    const double *columns[COMPULATION_MAX_ARITY];
+    uint8_t status = InverseStatusInvalid;
+
+    if (!function || unknown >= function->arity)
+    {
+        *solution = NAN;
+        return InverseStatusInvalid;
+    }
+
+    for (size_t i = 0; i < function->arity; i++)
+    {
+        columns[i] = &arguments[i];
+    }
+
+    inverseSolveColumns(function, unknown, columns, &target, solution, &status, 1, options, NULL);
+
+    return (InverseStatus)status;
+}
@@ -0,0 +1,107 @@
+//
+//  InverseSolver.h
+//
+//  Solves the functions in FunctionTable.h for any one of their parameters,
+//  e.g. the tank size that gives a pumpup time, over batches of cases.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef InverseSolver_h
+#define InverseSolver_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FunctionTable.h"
+#include "ThreadPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum InverseStatus
+{
+    InverseStatusConverged = 0,
+
+    // No sign change was found, even after widening the bracket
+    InverseStatusNoBracket,
+
+    // Out of iterations; the solution is the best estimate so far
+    InverseStatusMaxIterations,
+
+    // The bracket closed on a jump rather than a root, e.g. where
+    // leakRateCFM's wide-band correction switches on or where a function
+    // returns 0 outside its valid inputs. The solution is where the jump is.
+    InverseStatusDiscontinuity,
+
+    // The target is NaN, or the function is NaN at the bracket
+    InverseStatusInvalid
+} InverseStatus;
+
+typedef struct InverseOptions
+{
+    // Starting bracket. NaN uses the parameter's low and high from the
+    // function table. It is widened outward until the target is bracketed.
+    double low;
+    double high;
+
+    // Convergence, relative to the solution
+    double tolerance;
+    size_t maxIterations;
+    size_t maxExpansions;
+} InverseOptions;
+
+void inverseOptionsDefault(InverseOptions *options);
+
+// 1 if the function is a power law or affine in the parameter, so it is
+// solved directly from one or two evaluations instead of by iteration.
+int inverseHasClosedForm(const CompulationFunction *function, size_t unknown);
+
+// Solves function(arguments) == targets[k] for parameter unknown, for each
+// case k. arguments[i][k] is parameter i of case k, as for evaluateColumns;
+// arguments[unknown] is not read and may be NULL. status receives one
+// InverseStatus per case. Closed forms are used where they exist and their
+// results check out; other cases are solved by Brent's method, many cases
+// in step so each iteration is one evaluateColumns call. Cases are split
+// across pool, which may be NULL. options may be NULL for the defaults.
+// Returns the number of cases that converged.
+size_t inverseSolveColumns(const CompulationFunction *function,
+                           size_t unknown,
+                           const double *const *arguments,
+                           const double *targets,
+                           double *solutions,
+                           uint8_t *status,
+                           size_t count,
+                           const InverseOptions *options,
+                           ThreadPool *pool);
+
+// One case; arguments[i] is parameter i. Returns an InverseStatus.
+InverseStatus inverseSolve(const CompulationFunction *function,
+                           size_t unknown,
+                           const double *arguments,
+                           double target,
+                           double *solution,
+                           const InverseOptions *options);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* InverseSolver_h */
@@ -0,0 +1,169 @@
+//
+//  LeakRateEstimator.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LeakRateEstimator.h"
+#include "UnitConversion.h"
+
+#include <string.h>
+
+// Two-sided 95% Student t quantiles for 1-30 degrees of freedom
+static const double studentT95[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+static double studentTQuantile95(double degreesOfFreedom)
+{
+    if (degreesOfFreedom < 30.0)
+    {
+        int index = (int)degreesOfFreedom;
+        return studentT95[index < 1 ? 0 : index - 1];
+    }
+
+    // Cornish-Fisher expansion around z = 1.96
+    return 1.959964 + 2.372272 / degreesOfFreedom + 2.822305 / (degreesOfFreedom * degreesOfFreedom);
+}
+
+void leakRateEstimatorInit(LeakRateEstimator *estimator,
+                           double tankSizeGallons,
+                           double ambientPSIA,
+                           double forgetting)
+{
+    memset(estimator, 0, sizeof(*estimator));
+
+    estimator->tankSizeCF = cubicFeetFromGallons(tankSizeGallons);
+    estimator->ambientPSIA = ambientPSIA;
+    estimator->forgetting = forgetting;
+}
+
+void leakRateEstimatorReset(LeakRateEstimator *estimator)
+{
+    leakRateEstimatorInit(estimator, gallonsFromCubicFeet(estimator->tankSizeCF), estimator->ambientPSIA, estimator->forgetting);
+}
+
+void leakRateEstimatorAddSample(LeakRateEstimator *estimator,
+                                double timeSec,
+                                double psig)
+{
+    double psia = psig + estimator->ambientPSIA;
+
+    if (!(psia > 0.0))
+    {
+        return;
+    }
+
+    if (estimator->samples == 0)
+    {
+        estimator->originSec = timeSec;
+        estimator->originLogPSIA = log(psia);
+    }
+
+    double t = (timeSec - estimator->originSec) / 60.0;
+    double y = log(psia) - estimator->originLogPSIA;
+    double lambda = estimator->forgetting;
+
+    // Weighted Welford update of the means and co-moments
+    estimator->weight = lambda * estimator->weight + 1.0;
+    estimator->weightSquared = lambda * lambda * estimator->weightSquared + 1.0;
+
+    double dt = t - estimator->meanT;
+    double dy = y - estimator->meanY;
+    estimator->meanT += dt / estimator->weight;
+    estimator->meanY += dy / estimator->weight;
+
+    estimator->covTT = lambda * estimator->covTT + dt * (t - estimator->meanT);
+    estimator->covTY = lambda * estimator->covTY + dt * (y - estimator->meanY);
+    estimator->covYY = lambda * estimator->covYY + dy * (y - estimator->meanY);
+
+    estimator->lastT = t;
+    estimator->samples++;
+}
+
+void leakRateEstimatorAddSamples(LeakRateEstimator *estimators,
+                                 const double *timeSec,
+                                 const double *psig,
+                                 size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        leakRateEstimatorAddSample(&estimators[i], timeSec[i], psig[i]);
+    }
+}
+
+static int estimateAtPSIA(const LeakRateEstimator *estimator,
+                          double psia,
+                          LeakRateEstimate *estimate)
+{
+    memset(estimate, 0, sizeof(*estimate));
+
+    if (estimator->samples < 3 || estimator->covTT <= 0.0 || estimator->tankSizeCF <= 0.0 || estimator->ambientPSIA <= 0.0)
+    {
+        return 0;
+    }
+
+    double slope = estimator->covTY / estimator->covTT;
+    double residual = estimator->covYY - slope * estimator->covTY;
+    residual = residual > 0.0 ? residual : 0.0;
+
+    // Effective sample count under exponential weighting
+    double degreesOfFreedom = (estimator->weight * estimator->weight) / estimator->weightSquared - 2.0;
+    double slopeError = 0.0;
+
+    if (degreesOfFreedom > 0.0)
+    {
+        slopeError = sqrt(residual / (degreesOfFreedom * estimator->covTT));
+    }
+
+    double k = -slope;
+    double margin = studentTQuantile95(degreesOfFreedom) * slopeError;
+
+    // dP/dt = -k P, so the free air leaving is V * k * P / Pa per minute.
+    double cfmPerDecay = estimator->tankSizeCF * psia / estimator->ambientPSIA;
+
+    estimate->decayPerMinute = k;
+    estimate->leakCFM = k > 0.0 ? k * cfmPerDecay : 0.0;
+    estimate->lowerCFM = k - margin > 0.0 ? (k - margin) * cfmPerDecay : 0.0;
+    estimate->upperCFM = k + margin > 0.0 ? (k + margin) * cfmPerDecay : 0.0;
+    estimate->psig = psia - estimator->ambientPSIA;
+    estimate->samples = estimator->samples;
+
+    return 1;
+}
+
+int leakRateEstimatorEstimate(const LeakRateEstimator *estimator,
+                              LeakRateEstimate *estimate)
+{
+    double slope = estimator->covTT > 0.0 ? estimator->covTY / estimator->covTT : 0.0;
+    double fittedY = estimator->meanY + slope * (estimator->lastT - estimator->meanT);
+    double psia = exp(estimator->originLogPSIA + fittedY);
+
+    return estimateAtPSIA(estimator, psia, estimate);
+}
+
+int leakRateEstimatorEstimateAtPSIG(const LeakRateEstimator *estimator,
+                                    double psig,
+                                    LeakRateEstimate *estimate)
+{
+    return estimateAtPSIA(estimator, psig + estimator->ambientPSIA, estimate);
+}
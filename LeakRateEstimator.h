@@ -0,0 +1,107 @@
+//
+//  LeakRateEstimator.h
+//
+//  Online leak rate from a continuous pressure decay, the streaming form of
+//  leakRateCFM.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LeakRateEstimator_h
+#define LeakRateEstimator_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fits the decay P(t) = P0 * e^(-k t) in absolute pressure, a straight line
+// in ln(P), with exponentially weighted recursive least squares. The curve
+// takes the place of leakRateCFM's 1.25 wide-band correction. Every sample is
+// O(1) work and nothing is stored but running moments.
+typedef struct LeakRateEstimator
+{
+    double tankSizeCF;
+    double ambientPSIA;
+    double forgetting;
+
+    // Running weighted moments, with time in minutes since the first sample
+    // and ln(P) relative to the first sample
+    double originSec;
+    double originLogPSIA;
+    double weight;
+    double weightSquared;
+    double meanT;
+    double meanY;
+    double covTT;
+    double covTY;
+    double covYY;
+
+    double lastT;
+    size_t samples;
+} LeakRateEstimator;
+
+typedef struct LeakRateEstimate
+{
+    // Leak at the evaluation pressure, with a 95% confidence interval
+    double leakCFM;
+    double lowerCFM;
+    double upperCFM;
+
+    double decayPerMinute;
+    double psig;
+    size_t samples;
+} LeakRateEstimate;
+
+// forgetting is the weight kept by older samples at each new one: 1.0 fits
+// the whole test, values just below 1 track a changing leak.
+void leakRateEstimatorInit(LeakRateEstimator *estimator,
+                           double tankSizeGallons,
+                           double ambientPSIA,
+                           double forgetting);
+
+void leakRateEstimatorReset(LeakRateEstimator *estimator);
+
+void leakRateEstimatorAddSample(LeakRateEstimator *estimator,
+                                double timeSec,
+                                double psig);
+
+// Many tanks at once: sample i belongs to estimators[i].
+void leakRateEstimatorAddSamples(LeakRateEstimator *estimators,
+                                 const double *timeSec,
+                                 const double *psig,
+                                 size_t count);
+
+// Leak at the fitted pressure of the latest sample, or at a given pressure,
+// e.g. the normal operating pressure. Flows are never negative. Return 1 with
+// the estimate filled in, or 0 (and a zeroed estimate) before three samples
+// or for a non-positive tank size or ambient pressure.
+int leakRateEstimatorEstimate(const LeakRateEstimator *estimator,
+                              LeakRateEstimate *estimate);
+
+int leakRateEstimatorEstimateAtPSIG(const LeakRateEstimator *estimator,
+                                    double psig,
+                                    LeakRateEstimate *estimate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LeakRateEstimator_h */
@@ -0,0 +1,447 @@
+//
+//  MotorPowerAnalyzer.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MotorPowerAnalyzer.h"
+#include "BatchCompulations.h"
+#include "Compulations.h"
+#include "SIMDMath.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Accumulation kernels. Each adds samples start..count-1 to the sums it is
+// given; the caller counts the samples.
+
+static inline __attribute__((always_inline))
+void accumulateScalar(MotorPowerSums *sums,
+                      const double *const volts[MOTOR_PHASES],
+                      const double *const amps[MOTOR_PHASES],
+                      size_t start,
+                      size_t count,
+                      MotorVoltageWiring wiring)
+{
+    double va = 0.0, vb = 0.0, vc = 0.0;
+    double ia = 0.0, ib = 0.0, ic = 0.0;
+    double watts = 0.0;
+
+    for (size_t i = start; i < count; i++)
+    {
+        double v0 = volts[0][i], v1 = volts[1][i], v2 = volts[2][i];
+        double i0 = amps[0][i], i1 = amps[1][i], i2 = amps[2][i];
+
+        va += v0 * v0;
+        vb += v1 * v1;
+        vc += v2 * v2;
+        ia += i0 * i0;
+        ib += i1 * i1;
+        ic += i2 * i2;
+
+        if (wiring == MotorVoltageLineToLine)
+        {
+            watts += v0 * i0 - v1 * i2;
+        }
+        else
+        {
+            watts += v0 * i0 + v1 * i1 + v2 * i2;
+        }
+    }
+
+    sums->voltsSquared[0] += va;
+    sums->voltsSquared[1] += vb;
+    sums->voltsSquared[2] += vc;
+    sums->ampsSquared[0] += ia;
+    sums->ampsSquared[1] += ib;
+    sums->ampsSquared[2] += ic;
+    sums->watts += watts;
+}
+
+#if COMPULATIONS_HAVE_X86_SIMD
+
+COMPULATIONS_TARGET_AVX2
+static inline double laneSumAVX2(__m256d x)
+{
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+COMPULATIONS_TARGET_AVX2
+static inline __attribute__((always_inline))
+void accumulateAVX2(MotorPowerSums *sums,
+                    const double *const volts[MOTOR_PHASES],
+                    const double *const amps[MOTOR_PHASES],
+                    size_t count,
+                    MotorVoltageWiring wiring)
+{
+    __m256d va = _mm256_setzero_pd(), vb = _mm256_setzero_pd(), vc = _mm256_setzero_pd();
+    __m256d ia = _mm256_setzero_pd(), ib = _mm256_setzero_pd(), ic = _mm256_setzero_pd();
+    __m256d watts = _mm256_setzero_pd();
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d v0 = _mm256_loadu_pd(volts[0] + i);
+        __m256d v1 = _mm256_loadu_pd(volts[1] + i);
+        __m256d v2 = _mm256_loadu_pd(volts[2] + i);
+        __m256d i0 = _mm256_loadu_pd(amps[0] + i);
+        __m256d i1 = _mm256_loadu_pd(amps[1] + i);
+        __m256d i2 = _mm256_loadu_pd(amps[2] + i);
+
+        va = _mm256_fmadd_pd(v0, v0, va);
+        vb = _mm256_fmadd_pd(v1, v1, vb);
+        vc = _mm256_fmadd_pd(v2, v2, vc);
+        ia = _mm256_fmadd_pd(i0, i0, ia);
+        ib = _mm256_fmadd_pd(i1, i1, ib);
+        ic = _mm256_fmadd_pd(i2, i2, ic);
+
+        if (wiring == MotorVoltageLineToLine)
+        {
+            watts = _mm256_fnmadd_pd(v1, i2, _mm256_fmadd_pd(v0, i0, watts));
+        }
+        else
+        {
+            watts = _mm256_fmadd_pd(v2, i2, _mm256_fmadd_pd(v1, i1, _mm256_fmadd_pd(v0, i0, watts)));
+        }
+    }
+
+    sums->voltsSquared[0] += laneSumAVX2(va);
+    sums->voltsSquared[1] += laneSumAVX2(vb);
+    sums->voltsSquared[2] += laneSumAVX2(vc);
+    sums->ampsSquared[0] += laneSumAVX2(ia);
+    sums->ampsSquared[1] += laneSumAVX2(ib);
+    sums->ampsSquared[2] += laneSumAVX2(ic);
+    sums->watts += laneSumAVX2(watts);
+
+    accumulateScalar(sums, volts, amps, i, count, wiring);
+}
+
+COMPULATIONS_TARGET_AVX512
+static inline __attribute__((always_inline))
+void accumulateAVX512(MotorPowerSums *sums,
+                      const double *const volts[MOTOR_PHASES],
+                      const double *const amps[MOTOR_PHASES],
+                      size_t count,
+                      MotorVoltageWiring wiring)
+{
+    __m512d va = _mm512_setzero_pd(), vb = _mm512_setzero_pd(), vc = _mm512_setzero_pd();
+    __m512d ia = _mm512_setzero_pd(), ib = _mm512_setzero_pd(), ic = _mm512_setzero_pd();
+    __m512d watts = _mm512_setzero_pd();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m512d v0 = _mm512_loadu_pd(volts[0] + i);
+        __m512d v1 = _mm512_loadu_pd(volts[1] + i);
+        __m512d v2 = _mm512_loadu_pd(volts[2] + i);
+        __m512d i0 = _mm512_loadu_pd(amps[0] + i);
+        __m512d i1 = _mm512_loadu_pd(amps[1] + i);
+        __m512d i2 = _mm512_loadu_pd(amps[2] + i);
+
+        va = _mm512_fmadd_pd(v0, v0, va);
+        vb = _mm512_fmadd_pd(v1, v1, vb);
+        vc = _mm512_fmadd_pd(v2, v2, vc);
+        ia = _mm512_fmadd_pd(i0, i0, ia);
+        ib = _mm512_fmadd_pd(i1, i1, ib);
+        ic = _mm512_fmadd_pd(i2, i2, ic);
+
+        if (wiring == MotorVoltageLineToLine)
+        {
+            watts = _mm512_fnmadd_pd(v1, i2, _mm512_fmadd_pd(v0, i0, watts));
+        }
+        else
+        {
+            watts = _mm512_fmadd_pd(v2, i2, _mm512_fmadd_pd(v1, i1, _mm512_fmadd_pd(v0, i0, watts)));
+        }
+    }
+
+    sums->voltsSquared[0] += _mm512_reduce_add_pd(va);
+    sums->voltsSquared[1] += _mm512_reduce_add_pd(vb);
+    sums->voltsSquared[2] += _mm512_reduce_add_pd(vc);
+    sums->ampsSquared[0] += _mm512_reduce_add_pd(ia);
+    sums->ampsSquared[1] += _mm512_reduce_add_pd(ib);
+    sums->ampsSquared[2] += _mm512_reduce_add_pd(ic);
+    sums->watts += _mm512_reduce_add_pd(watts);
+
+    accumulateScalar(sums, volts, amps, i, count, wiring);
+}
+
+// One out-of-line kernel per ISA and wiring, so the wiring test folds away
+// inside each loop.
+
+COMPULATIONS_TARGET_AVX2
+static void accumulateLineToNeutralAVX2(MotorPowerSums *sums, const double *const volts[MOTOR_PHASES], const double *const amps[MOTOR_PHASES], size_t count)
+{
+    accumulateAVX2(sums, volts, amps, count, MotorVoltageLineToNeutral);
+}
+
+COMPULATIONS_TARGET_AVX2
+static void accumulateLineToLineAVX2(MotorPowerSums *sums, const double *const volts[MOTOR_PHASES], const double *const amps[MOTOR_PHASES], size_t count)
+{
+    accumulateAVX2(sums, volts, amps, count, MotorVoltageLineToLine);
+}
+
+COMPULATIONS_TARGET_AVX512
+static void accumulateLineToNeutralAVX512(MotorPowerSums *sums, const double *const volts[MOTOR_PHASES], const double *const amps[MOTOR_PHASES], size_t count)
+{
+    accumulateAVX512(sums, volts, amps, count, MotorVoltageLineToNeutral);
+}
+
+COMPULATIONS_TARGET_AVX512
+static void accumulateLineToLineAVX512(MotorPowerSums *sums, const double *const volts[MOTOR_PHASES], const double *const amps[MOTOR_PHASES], size_t count)
+{
+    accumulateAVX512(sums, volts, amps, count, MotorVoltageLineToLine);
+}
+
+#endif // COMPULATIONS_HAVE_X86_SIMD
+
+void motorPowerAccumulate(MotorPowerSums *sums,
+                          const double *const volts[MOTOR_PHASES],
+                          const double *const amps[MOTOR_PHASES],
+                          size_t count,
+                          MotorVoltageWiring wiring)
+{
+    int lineToLine = wiring == MotorVoltageLineToLine;
+
+    switch (compulationsSIMDLevel())
+    {
+#if COMPULATIONS_HAVE_X86_SIMD
+        case CompulationsSIMDLevelAVX512:
+            if (lineToLine)
+            {
+                accumulateLineToLineAVX512(sums, volts, amps, count);
+            }
+            else
+            {
+                accumulateLineToNeutralAVX512(sums, volts, amps, count);
+            }
+            break;
+
+        case CompulationsSIMDLevelAVX2:
+            if (lineToLine)
+            {
+                accumulateLineToLineAVX2(sums, volts, amps, count);
+            }
+            else
+            {
+                accumulateLineToNeutralAVX2(sums, volts, amps, count);
+            }
+            break;
+#endif
+        default:
+            if (lineToLine)
+            {
+                accumulateScalar(sums, volts, amps, 0, count, MotorVoltageLineToLine);
+            }
+            else
+            {
+                accumulateScalar(sums, volts, amps, 0, count, MotorVoltageLineToNeutral);
+            }
+            break;
+    }
+
+    sums->count += count;
+}
+
+// Window results
+
+static void resultFromSums(const MotorPowerSums *sums,
+                           MotorVoltageWiring wiring,
+                           double efficiency,
+                           MotorPowerResult *result)
+{
+    double n = (double)sums->count;
+    double voltAmps = 0.0;
+    double meanVolts = 0.0;
+    double meanAmps = 0.0;
+
+    for (int k = 0; k < MOTOR_PHASES; k++)
+    {
+        result->voltsRms[k] = sqrt(sums->voltsSquared[k] / n);
+        result->ampsRms[k] = sqrt(sums->ampsSquared[k] / n);
+
+        voltAmps += result->voltsRms[k] * result->ampsRms[k];
+        meanVolts += result->voltsRms[k] / MOTOR_PHASES;
+        meanAmps += result->ampsRms[k] / MOTOR_PHASES;
+    }
+
+    // Arithmetic apparent power; line-to-line channels are taken back to
+    // phase voltages as for a balanced supply.
+    if (wiring == MotorVoltageLineToLine)
+    {
+        voltAmps /= sqrt(3.0);
+        result->lineVoltsRms = meanVolts;
+    }
+    else
+    {
+        result->lineVoltsRms = meanVolts * sqrt(3.0);
+    }
+
+    double watts = sums->watts / n;
+
+    result->lineAmpsRms = meanAmps;
+    result->realPowerKW = watts / 1000.0;
+    result->apparentPowerKVA = voltAmps / 1000.0;
+    result->reactivePowerKVAR = sqrt(fmax(voltAmps * voltAmps - watts * watts, 0.0)) / 1000.0;
+    result->powerFactor = voltAmps > 0.0 ? watts / voltAmps : 0.0;
+
+    // Measured line values in place of nameplate ones
+    result->shaftPowerHP = threePhaseShaftPowerHP(result->lineVoltsRms, result->lineAmpsRms,
+                                                  efficiency, result->powerFactor);
+}
+
+int motorPowerFromWaveforms(const double *const volts[MOTOR_PHASES],
+                            const double *const amps[MOTOR_PHASES],
+                            size_t count,
+                            MotorVoltageWiring wiring,
+                            double efficiency,
+                            MotorPowerResult *result)
+{
+    if (count == 0)
+    {
+        return -1;
+    }
+
+    MotorPowerSums sums;
+    memset(&sums, 0, sizeof(sums));
+    motorPowerAccumulate(&sums, volts, amps, count, wiring);
+
+    memset(result, 0, sizeof(*result));
+    resultFromSums(&sums, wiring, efficiency, result);
+
+    return 0;
+}
+
+// Streaming
+
+int motorPowerAnalyzerInit(MotorPowerAnalyzer *analyzer,
+                           double sampleRateHz,
+                           size_t windowSamples,
+                           size_t hopSamples,
+                           MotorVoltageWiring wiring,
+                           double efficiency)
+{
+    memset(analyzer, 0, sizeof(*analyzer));
+
+    if (!(sampleRateHz > 0.0) || hopSamples == 0 || windowSamples == 0 || windowSamples % hopSamples != 0)
+    {
+        return -1;
+    }
+
+    analyzer->hopCount = windowSamples / hopSamples;
+    analyzer->hops = calloc(analyzer->hopCount, sizeof(MotorPowerSums));
+
+    if (!analyzer->hops)
+    {
+        return -1;
+    }
+
+    analyzer->sampleRateHz = sampleRateHz;
+    analyzer->windowSamples = windowSamples;
+    analyzer->hopSamples = hopSamples;
+    analyzer->wiring = wiring;
+    analyzer->efficiency = efficiency;
+
+    return 0;
+}
+
+void motorPowerAnalyzerFree(MotorPowerAnalyzer *analyzer)
+{
+    free(analyzer->hops);
+    analyzer->hops = NULL;
+}
+
+size_t motorPowerAnalyzerAddSamples(MotorPowerAnalyzer *analyzer,
+                                    const double *const volts[MOTOR_PHASES],
+                                    const double *const amps[MOTOR_PHASES],
+                                    size_t count,
+                                    MotorPowerCallback callback,
+                                    void *context)
+{
+    size_t completed = 0;
+    size_t i = 0;
+
+    while (i < count)
+    {
+        size_t run = analyzer->hopSamples - analyzer->current.count;
+        run = run < count - i ? run : count - i;
+
+        const double *v[MOTOR_PHASES] = { volts[0] + i, volts[1] + i, volts[2] + i };
+        const double *a[MOTOR_PHASES] = { amps[0] + i, amps[1] + i, amps[2] + i };
+        motorPowerAccumulate(&analyzer->current, v, a, run, analyzer->wiring);
+
+        i += run;
+        analyzer->samples += run;
+
+        if (analyzer->current.count < analyzer->hopSamples)
+        {
+            break;
+        }
+
+        // Hop complete
+        analyzer->hops[analyzer->hopNext] = analyzer->current;
+        analyzer->hopNext = (analyzer->hopNext + 1) % analyzer->hopCount;
+        memset(&analyzer->current, 0, sizeof(analyzer->current));
+
+        if (analyzer->hopsFilled < analyzer->hopCount)
+        {
+            analyzer->hopsFilled++;
+        }
+
+        if (analyzer->hopsFilled < analyzer->hopCount)
+        {
+            continue;
+        }
+
+        // Window sums are rebuilt from the hops, oldest first, so rounding
+        // never builds up the way it would in a running add and subtract.
+        MotorPowerSums window;
+        memset(&window, 0, sizeof(window));
+
+        for (size_t h = 0; h < analyzer->hopCount; h++)
+        {
+            const MotorPowerSums *hop = &analyzer->hops[(analyzer->hopNext + h) % analyzer->hopCount];
+
+            for (int k = 0; k < MOTOR_PHASES; k++)
+            {
+                window.voltsSquared[k] += hop->voltsSquared[k];
+                window.ampsSquared[k] += hop->ampsSquared[k];
+            }
+
+            window.watts += hop->watts;
+            window.count += hop->count;
+        }
+
+        resultFromSums(&window, analyzer->wiring, analyzer->efficiency, &analyzer->last);
+        analyzer->last.endTimeSec = analyzer->samples / analyzer->sampleRateHz;
+        analyzer->windows++;
+        completed++;
+
+        if (callback)
+        {
+            callback(context, &analyzer->last);
+        }
+    }
+
+    return completed;
+}
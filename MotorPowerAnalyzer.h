@@ -0,0 +1,139 @@
+//
+//  MotorPowerAnalyzer.h
+//
+//  Measured motor power from sampled three-phase voltage and current
+//  waveforms, over sliding windows.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MotorPowerAnalyzer_h
+#define MotorPowerAnalyzer_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOTOR_PHASES 3
+
+// How the voltage channels are connected. Line-to-neutral channels are
+// Van, Vbn, Vcn. Line-to-line channels are Vab, Vbc, Vca on a three-wire
+// supply, and real power comes from the two-wattmeter sum Vab Ia - Vbc Ic.
+typedef enum MotorVoltageWiring
+{
+    MotorVoltageLineToNeutral = 0,
+    MotorVoltageLineToLine
+} MotorVoltageWiring;
+
+// Running sums over a run of samples
+typedef struct MotorPowerSums
+{
+    double voltsSquared[MOTOR_PHASES];
+    double ampsSquared[MOTOR_PHASES];
+    double watts;
+    size_t count;
+} MotorPowerSums;
+
+typedef struct MotorPowerResult
+{
+    double endTimeSec;
+    double voltsRms[MOTOR_PHASES];
+    double ampsRms[MOTOR_PHASES];
+    double lineVoltsRms;
+    double lineAmpsRms;
+    double realPowerKW;
+    double reactivePowerKVAR;
+    double apparentPowerKVA;
+    double powerFactor;
+    double shaftPowerHP;
+} MotorPowerResult;
+
+typedef void (*MotorPowerCallback)(void *context, const MotorPowerResult *result);
+
+typedef struct MotorPowerAnalyzer
+{
+    // Configuration
+    double sampleRateHz;
+    size_t windowSamples;
+    size_t hopSamples;
+    MotorVoltageWiring wiring;
+    double efficiency;
+
+    // Sums for the last windowSamples / hopSamples hops, oldest overwritten
+    // first, and for the hop in progress
+    MotorPowerSums *hops;
+    size_t hopCount;
+    size_t hopNext;
+    size_t hopsFilled;
+    MotorPowerSums current;
+
+    // Results
+    uint64_t samples;
+    size_t windows;
+    MotorPowerResult last;
+} MotorPowerAnalyzer;
+
+// A window of windowSamples is reported every hopSamples, which must divide
+// it. Windows spanning whole line cycles keep the RMS values from rippling.
+// efficiency is the motor's at the expected load, and is passed with the
+// measured values to threePhaseShaftPowerHP. Returns 0, or -1 on bad
+// arguments or allocation failure.
+int motorPowerAnalyzerInit(MotorPowerAnalyzer *analyzer,
+                           double sampleRateHz,
+                           size_t windowSamples,
+                           size_t hopSamples,
+                           MotorVoltageWiring wiring,
+                           double efficiency);
+
+void motorPowerAnalyzerFree(MotorPowerAnalyzer *analyzer);
+
+// Feeds count samples from each of the three voltage and three current
+// channels, in volts and amps. callback, if not NULL, is called for every
+// completed window. Returns the number of completed windows.
+size_t motorPowerAnalyzerAddSamples(MotorPowerAnalyzer *analyzer,
+                                    const double *const volts[MOTOR_PHASES],
+                                    const double *const amps[MOTOR_PHASES],
+                                    size_t count,
+                                    MotorPowerCallback callback,
+                                    void *context);
+
+// Adds count samples to sums, at the current SIMD level.
+void motorPowerAccumulate(MotorPowerSums *sums,
+                          const double *const volts[MOTOR_PHASES],
+                          const double *const amps[MOTOR_PHASES],
+                          size_t count,
+                          MotorVoltageWiring wiring);
+
+// Power for one whole record; endTimeSec is left at 0. Returns 0, or -1 if
+// count is 0.
+int motorPowerFromWaveforms(const double *const volts[MOTOR_PHASES],
+                            const double *const amps[MOTOR_PHASES],
+                            size_t count,
+                            MotorVoltageWiring wiring,
+                            double efficiency,
+                            MotorPowerResult *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MotorPowerAnalyzer_h */
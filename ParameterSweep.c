@@ -0,0 +1,427 @@
+//
+//  ParameterSweep.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParameterSweep.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SWEEP_CACHE_LINE 64
+#define SWEEP_FEISTEL_ROUNDS 4
+
+static inline uint64_t mixBits(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+
+    return x;
+}
+
+void sweepSpaceInit(SweepSpace *space, const CompulationFunction *function)
+{
+    memset(space, 0, sizeof(*space));
+    space->function = function;
+    space->sampling = SweepSamplingCartesian;
+
+    for (size_t p = 0; p < function->arity; p++)
+    {
+        double middle = 0.5 * (function->parameters[p].low + function->parameters[p].high);
+
+        space->axes[p] = (SweepAxis){ middle, middle, 1 };
+    }
+}
+
+int sweepSpaceSetAxis(SweepSpace *space,
+                      const char *parameter,
+                      double low,
+                      double high,
+                      size_t points)
+{
+    for (size_t p = 0; p < space->function->arity; p++)
+    {
+        if (strcmp(space->function->parameters[p].name, parameter) == 0)
+        {
+            space->axes[p] = (SweepAxis){ low, high, points };
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+uint64_t sweepSpacePointCount(const SweepSpace *space)
+{
+    if (!space->function || space->function->arity == 0 || space->function->arity > COMPULATION_MAX_ARITY)
+    {
+        return 0;
+    }
+
+    if (space->sampling == SweepSamplingLatinHypercube)
+    {
+        return space->sampleCount;
+    }
+
+    uint64_t count = 1;
+
+    for (size_t p = 0; p < space->function->arity; p++)
+    {
+        uint64_t points = space->axes[p].points;
+
+        if (points == 0 || count > UINT64_MAX / points)
+        {
+            return 0;
+        }
+
+        count *= points;
+    }
+
+    return count;
+}
+
+// Latin hypercube
+
+// A keyed permutation of [0, count): a Feistel network over the smallest
+// power of 4 at least count, walking the cycle until it lands inside. Each
+// axis gets its own key, so strata never need to be stored.
+static uint64_t strataPermute(uint64_t index, uint64_t count, uint64_t key)
+{
+    unsigned halfBits = 1;
+
+    while (halfBits < 32 && (count - 1) >> (2 * halfBits))
+    {
+        halfBits++;
+    }
+
+    uint64_t mask = ((uint64_t)1 << halfBits) - 1;
+    uint64_t x = index;
+
+    do
+    {
+        uint64_t left = x >> halfBits;
+        uint64_t right = x & mask;
+
+        for (uint64_t round = 0; round < SWEEP_FEISTEL_ROUNDS; round++)
+        {
+            uint64_t next = left ^ (mixBits(right ^ (key + round * 0x9E3779B97F4A7C15ull)) & mask);
+
+            left = right;
+            right = next;
+        }
+
+        x = (left << halfBits) | right;
+    } while (x >= count);
+
+    return x;
+}
+
+static inline uint64_t axisKey(uint64_t seed, size_t parameter)
+{
+    return mixBits(seed + (parameter + 1) * 0x9E3779B97F4A7C15ull);
+}
+
+static inline double axisStep(const SweepAxis *axis)
+{
+    return axis->points > 1 ? (axis->high - axis->low) / (double)(axis->points - 1) : 0.0;
+}
+
+// The last point is high exactly.
+static inline double axisValue(const SweepAxis *axis, double step, uint64_t point)
+{
+    return point + 1 == axis->points && point > 0 ? axis->high : axis->low + step * (double)point;
+}
+
+// Arguments of points first to first + count - 1
+static void sweepFillPoints(const SweepSpace *space, uint64_t first, size_t count, double *const *columns)
+{
+    size_t arity = space->function->arity;
+
+    if (space->sampling == SweepSamplingLatinHypercube)
+    {
+        uint64_t strata = space->sampleCount;
+
+        for (size_t p = 0; p < arity; p++)
+        {
+            const SweepAxis *axis = &space->axes[p];
+            uint64_t key = axisKey(space->seed, p);
+
+            for (size_t k = 0; k < count; k++)
+            {
+                if (axis->low == axis->high)
+                {
+                    columns[p][k] = axis->low;
+                    continue;
+                }
+
+                uint64_t stratum = strataPermute(first + k, strata, key);
+                double jitter = (mixBits((first + k) ^ ~key) >> 11) * 0x1.0p-53;
+
+                columns[p][k] = axis->low + (axis->high - axis->low) * ((stratum + jitter) / (double)strata);
+            }
+        }
+
+        return;
+    }
+
+    uint64_t digits[COMPULATION_MAX_ARITY];
+    double steps[COMPULATION_MAX_ARITY];
+    double values[COMPULATION_MAX_ARITY];
+    uint64_t rest = first;
+
+    for (size_t p = arity; p-- > 0;)
+    {
+        digits[p] = rest % space->axes[p].points;
+        rest /= space->axes[p].points;
+        steps[p] = axisStep(&space->axes[p]);
+        values[p] = axisValue(&space->axes[p], steps[p], digits[p]);
+    }
+
+    for (size_t k = 0; k < count; k++)
+    {
+        for (size_t p = 0; p < arity; p++)
+        {
+            columns[p][k] = values[p];
+        }
+
+        // Odometer, last parameter fastest. Only the digits that turn over
+        // get new values.
+        for (size_t p = arity; p-- > 0;)
+        {
+            if (++digits[p] < space->axes[p].points)
+            {
+                values[p] = axisValue(&space->axes[p], steps[p], digits[p]);
+                break;
+            }
+
+            digits[p] = 0;
+            values[p] = space->axes[p].low;
+        }
+    }
+}
+
+int sweepSpacePoint(const SweepSpace *space, uint64_t index, double *arguments)
+{
+    double *columns[COMPULATION_MAX_ARITY];
+
+    if (index >= sweepSpacePointCount(space))
+    {
+        return -1;
+    }
+
+    for (size_t p = 0; p < space->function->arity; p++)
+    {
+        columns[p] = &arguments[p];
+    }
+
+    sweepFillPoints(space, index, 1, columns);
+
+    return 0;
+}
+
+// Sweeps
+
+typedef struct SweepPartial
+{
+    uint64_t count;
+    double min;
+    uint64_t argmin;
+    double max;
+    uint64_t argmax;
+
+    // Neumaier compensated
+    double sum;
+    double compensation;
+
+    char padding[SWEEP_CACHE_LINE];
+} SweepPartial;
+
+typedef struct SweepJob
+{
+    const SweepSpace *space;
+    uint64_t pointCount;
+    SweepCallback callback;
+    void *context;
+    SweepPartial *partials;
+} SweepJob;
+
+static inline void partialAdd(SweepPartial *partial, double value)
+{
+    double sum = partial->sum + value;
+
+    if (fabs(partial->sum) >= fabs(value))
+    {
+        partial->compensation += (partial->sum - sum) + value;
+    }
+    else
+    {
+        partial->compensation += (value - sum) + partial->sum;
+    }
+
+    partial->sum = sum;
+}
+
+// Lowest index wins ties, so the result doesn't depend on which worker ran
+// which tile.
+static inline void partialMinMax(SweepPartial *partial, double value, uint64_t index)
+{
+    if (partial->count == 0 || value < partial->min || (value == partial->min && index < partial->argmin))
+    {
+        partial->min = value;
+        partial->argmin = index;
+    }
+
+    if (partial->count == 0 || value > partial->max || (value == partial->max && index < partial->argmax))
+    {
+        partial->max = value;
+        partial->argmax = index;
+    }
+}
+
+static void partialMerge(SweepPartial *into, const SweepPartial *from)
+{
+    if (from->count == 0)
+    {
+        return;
+    }
+
+    if (into->count == 0 || from->min < into->min || (from->min == into->min && from->argmin < into->argmin))
+    {
+        into->min = from->min;
+        into->argmin = from->argmin;
+    }
+
+    if (into->count == 0 || from->max > into->max || (from->max == into->max && from->argmax < into->argmax))
+    {
+        into->max = from->max;
+        into->argmax = from->argmax;
+    }
+
+    into->count += from->count;
+    partialAdd(into, from->sum);
+    partialAdd(into, from->compensation);
+}
+
+static void sweepRange(void *context, size_t begin, size_t end, size_t worker)
+{
+    const SweepJob *job = context;
+    const CompulationFunction *function = job->space->function;
+    SweepPartial *partial = &job->partials[worker];
+    double columns[COMPULATION_MAX_ARITY][SWEEP_TILE];
+    double results[SWEEP_TILE];
+    double *arguments[COMPULATION_MAX_ARITY];
+
+    for (size_t p = 0; p < function->arity; p++)
+    {
+        arguments[p] = columns[p];
+    }
+
+    for (size_t tile = begin; tile < end; tile++)
+    {
+        uint64_t first = (uint64_t)tile * SWEEP_TILE;
+        size_t count = job->pointCount - first < SWEEP_TILE ? (size_t)(job->pointCount - first) : SWEEP_TILE;
+
+        sweepFillPoints(job->space, first, count, arguments);
+        function->evaluateColumns((const double *const *)arguments, results, count);
+
+        // Reduced locally first so the totals stay in registers
+        SweepPartial tileTotals;
+        memset(&tileTotals, 0, sizeof(tileTotals));
+
+        for (size_t k = 0; k < count; k++)
+        {
+            if (!isnan(results[k]))
+            {
+                partialMinMax(&tileTotals, results[k], first + k);
+                partialAdd(&tileTotals, results[k]);
+                tileTotals.count++;
+            }
+        }
+
+        partialMerge(partial, &tileTotals);
+
+        if (job->callback)
+        {
+            job->callback(job->context, first, (const double *const *)arguments, results, count, worker);
+        }
+    }
+}
+
+int parameterSweepRun(const SweepSpace *space,
+                      ThreadPool *pool,
+                      SweepCallback callback,
+                      void *context,
+                      SweepSummary *summary)
+{
+    uint64_t pointCount = sweepSpacePointCount(space);
+    uint64_t tiles = pointCount / SWEEP_TILE + (pointCount % SWEEP_TILE != 0);
+
+    if (pointCount == 0 || tiles > SIZE_MAX)
+    {
+        return -1;
+    }
+
+    size_t workers = pool ? threadPoolSize(pool) : 1;
+    SweepPartial *partials = calloc(workers, sizeof(SweepPartial));
+
+    if (!partials)
+    {
+        return -1;
+    }
+
+    SweepJob job = { space, pointCount, callback, context, partials };
+
+    if (pool)
+    {
+        threadPoolParallelFor(pool, (size_t)tiles, 1, sweepRange, &job);
+    }
+    else
+    {
+        sweepRange(&job, 0, (size_t)tiles, 0);
+    }
+
+    if (summary)
+    {
+        SweepPartial total;
+        memset(&total, 0, sizeof(total));
+
+        for (size_t w = 0; w < workers; w++)
+        {
+            partialMerge(&total, &partials[w]);
+        }
+
+        summary->count = total.count;
+        summary->min = total.count ? total.min : NAN;
+        summary->argmin = total.argmin;
+        summary->max = total.count ? total.max : NAN;
+        summary->argmax = total.argmax;
+        summary->sum = total.sum + total.compensation;
+        summary->mean = total.count ? summary->sum / (double)total.count : NAN;
+    }
+
+    free(partials);
+
+    return 0;
+}
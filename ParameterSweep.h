@@ -0,0 +1,130 @@
+//
+//  ParameterSweep.h
+//
+//  What-if sweeps of any function in FunctionTable.h over a grid or a Latin
+//  hypercube, in tiles across a thread pool, reduced as they go.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ParameterSweep_h
+#define ParameterSweep_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FunctionTable.h"
+#include "ThreadPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Points per tile. The arguments and results of a tile stay in L1/L2.
+#define SWEEP_TILE 512
+
+typedef enum SweepSampling
+{
+    // Every combination of every axis's points, numbered like nested loops
+    // with the last parameter innermost
+    SweepSamplingCartesian = 0,
+
+    // sampleCount points, each axis cut into sampleCount strata and each
+    // stratum used once, in a random order fixed by seed
+    SweepSamplingLatinHypercube
+} SweepSampling;
+
+// points evenly spaced from low to high inclusive. An axis with one point,
+// or low == high, holds the parameter at low.
+typedef struct SweepAxis
+{
+    double low;
+    double high;
+    size_t points;
+} SweepAxis;
+
+typedef struct SweepSpace
+{
+    const CompulationFunction *function;
+    SweepSampling sampling;
+    SweepAxis axes[COMPULATION_MAX_ARITY];
+
+    // Latin hypercube only
+    uint64_t sampleCount;
+    uint64_t seed;
+} SweepSpace;
+
+// Over the results that are not NaN. argmin and argmax are point indexes,
+// the lowest one on ties; sweepSpacePoint gives their arguments.
+typedef struct SweepSummary
+{
+    uint64_t count;
+    double min;
+    uint64_t argmin;
+    double max;
+    uint64_t argmax;
+    double sum;
+    double mean;
+} SweepSummary;
+
+// Called once per tile, on the worker that ran it, with the arguments and
+// results of points firstIndex to firstIndex + count - 1. arguments[i][k] is
+// parameter i of point firstIndex + k. Tiles arrive in no particular order;
+// worker is below threadPoolSize() for per-thread output.
+typedef void (*SweepCallback)(void *context,
+                              uint64_t firstIndex,
+                              const double *const *arguments,
+                              const double *results,
+                              size_t count,
+                              size_t worker);
+
+// Every parameter held at the middle of its field range, cartesian
+void sweepSpaceInit(SweepSpace *space, const CompulationFunction *function);
+
+// Sets the axis of the parameter with this name. Returns 0, or -1 if the
+// function has no such parameter.
+int sweepSpaceSetAxis(SweepSpace *space,
+                      const char *parameter,
+                      double low,
+                      double high,
+                      size_t points);
+
+// Number of points, or 0 if the space is empty or too big to count
+uint64_t sweepSpacePointCount(const SweepSpace *space);
+
+// Fills arguments, which has room for the function's arity, with point
+// index. Returns 0, or -1 if there is no such point.
+int sweepSpacePoint(const SweepSpace *space, uint64_t index, double *arguments);
+
+// Evaluates every point, tile by tile across pool (which may be NULL),
+// passing each tile to callback if it isn't NULL and reducing the results
+// into summary if it isn't NULL. The sum is compensated per worker, so it
+// may differ in the last bits between runs. Returns 0, or -1 on an empty or
+// uncountable space or allocation failure.
+int parameterSweepRun(const SweepSpace *space,
+                      ThreadPool *pool,
+                      SweepCallback callback,
+                      void *context,
+                      SweepSummary *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ParameterSweep_h */
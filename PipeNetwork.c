@@ -0,0 +1,782 @@
+//
+//  PipeNetwork.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PipeNetwork.h"
+#include "Compulations.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Velocity used to size the first linearization when there is no previous
+// solution, and the fraction of it below which a segment counts as stagnant.
+#define PIPE_NETWORK_NOMINAL_FPS 20.0
+#define PIPE_NETWORK_STAGNANT_FRACTION 1.0e-3
+
+// Density and velocity need a positive line pressure; a starved network is
+// evaluated as if just above atmosphere.
+#define PIPE_NETWORK_MIN_LINE_PSIG 0.1
+
+#define PIPE_NETWORK_NO_ENTRY ((size_t)-1)
+
+int pipeNetworkInit(PipeNetwork *network,
+                    const PipeSegment *segments,
+                    size_t segmentCount,
+                    size_t nodeCount,
+                    double ambientPSIA,
+                    double airTemperatureF)
+{
+    memset(network, 0, sizeof(*network));
+
+    for (size_t s = 0; s < segmentCount; s++)
+    {
+        const PipeSegment *segment = &segments[s];
+
+        if (segment->fromNode >= nodeCount || segment->toNode >= nodeCount || segment->diameterIn <= 0.0 ||
+            segment->lengthFt + segment->fittingsLengthFt <= 0.0)
+        {
+            return -1;
+        }
+    }
+
+    network->nodeCount = nodeCount;
+    network->segmentCount = segmentCount;
+    network->ambientPSIA = ambientPSIA;
+    network->airTemperatureF = airTemperatureF;
+
+    network->segments = malloc(segmentCount * sizeof(PipeSegment));
+    network->demandCFM = calloc(nodeCount, sizeof(double));
+    network->supplyPSIG = calloc(nodeCount, sizeof(double));
+    network->isSupply = calloc(nodeCount, sizeof(uint8_t));
+    network->pressurePSIG = calloc(nodeCount, sizeof(double));
+    network->flowCFM = calloc(segmentCount, sizeof(double));
+    network->velocityFPS = calloc(segmentCount, sizeof(double));
+    network->pressureDropPSI = calloc(segmentCount, sizeof(double));
+    network->conductance = malloc(segmentCount * sizeof(double));
+    network->flowTerm = malloc(segmentCount * sizeof(double));
+    network->segmentEntries = malloc(segmentCount * 4 * sizeof(size_t));
+    network->freeIndex = malloc(nodeCount * sizeof(int64_t));
+
+    if ((segmentCount && (!network->segments || !network->flowCFM || !network->velocityFPS || !network->pressureDropPSI ||
+                          !network->conductance || !network->flowTerm || !network->segmentEntries)) ||
+        (nodeCount && (!network->demandCFM || !network->supplyPSIG || !network->isSupply || !network->pressurePSIG ||
+                       !network->freeIndex)))
+    {
+        pipeNetworkFree(network);
+        return -1;
+    }
+
+    if (segmentCount)
+    {
+        memcpy(network->segments, segments, segmentCount * sizeof(PipeSegment));
+    }
+
+    return 0;
+}
+
+void pipeNetworkFree(PipeNetwork *network)
+{
+    free(network->segments);
+    free(network->demandCFM);
+    free(network->supplyPSIG);
+    free(network->isSupply);
+    free(network->pressurePSIG);
+    free(network->flowCFM);
+    free(network->velocityFPS);
+    free(network->pressureDropPSI);
+    free(network->freeIndex);
+    free(network->rowStart);
+    free(network->rowDiagonal);
+    free(network->column);
+    free(network->value);
+    free(network->factor);
+    free(network->segmentEntries);
+    free(network->conductance);
+    free(network->flowTerm);
+    free(network->work);
+
+    memset(network, 0, sizeof(*network));
+}
+
+void pipeNetworkSetDemand(PipeNetwork *network, size_t node, double demandCFM)
+{
+    if (node < network->nodeCount)
+    {
+        network->demandCFM[node] = demandCFM;
+    }
+}
+
+void pipeNetworkSetSupply(PipeNetwork *network, size_t node, double pressurePSIG)
+{
+    if (node < network->nodeCount)
+    {
+        network->structureValid &= network->isSupply[node];
+        network->isSupply[node] = 1;
+        network->supplyPSIG[node] = pressurePSIG;
+    }
+}
+
+void pipeNetworkClearSupply(PipeNetwork *network, size_t node)
+{
+    if (node < network->nodeCount)
+    {
+        network->structureValid &= !network->isSupply[node];
+        network->isSupply[node] = 0;
+    }
+}
+
+// Numbers the junctions in reverse breadth-first order from the supplies, so
+// branches come before the mains feeding them. Returns -1 if a junction has no
+// path to a supply, since its pressure would be undefined.
+static int orderJunctions(PipeNetwork *network)
+{
+    size_t nodeCount = network->nodeCount;
+    size_t *adjacencyStart = calloc(nodeCount + 1, sizeof(size_t));
+    uint32_t *adjacency = malloc(2 * network->segmentCount * sizeof(uint32_t) + 1);
+    uint32_t *queue = malloc(nodeCount * sizeof(uint32_t) + 1);
+    uint8_t *reached = calloc(nodeCount + 1, 1);
+    int status = -1;
+
+    if (adjacencyStart && adjacency && queue && reached)
+    {
+        for (size_t s = 0; s < network->segmentCount; s++)
+        {
+            adjacencyStart[network->segments[s].fromNode + 1]++;
+            adjacencyStart[network->segments[s].toNode + 1]++;
+        }
+
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            adjacencyStart[i + 1] += adjacencyStart[i];
+        }
+
+        for (size_t s = 0; s < network->segmentCount; s++)
+        {
+            uint32_t from = network->segments[s].fromNode;
+            uint32_t to = network->segments[s].toNode;
+
+            adjacency[adjacencyStart[from]++] = to;
+            adjacency[adjacencyStart[to]++] = from;
+        }
+
+        // The fill above moved each start to the next node's start
+        for (size_t i = nodeCount; i > 0; i--)
+        {
+            adjacencyStart[i] = adjacencyStart[i - 1];
+        }
+
+        adjacencyStart[0] = 0;
+
+        size_t head = 0, tail = 0;
+
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            if (network->isSupply[i])
+            {
+                reached[i] = 1;
+                queue[tail++] = (uint32_t)i;
+            }
+        }
+
+        while (head < tail)
+        {
+            uint32_t node = queue[head++];
+
+            for (size_t k = adjacencyStart[node]; k < adjacencyStart[node + 1]; k++)
+            {
+                if (!reached[adjacency[k]])
+                {
+                    reached[adjacency[k]] = 1;
+                    queue[tail++] = adjacency[k];
+                }
+            }
+        }
+
+        if (tail == nodeCount)
+        {
+            size_t freeCount = 0;
+
+            for (size_t i = nodeCount; i-- > 0;)
+            {
+                uint32_t node = queue[i];
+                network->freeIndex[node] = network->isSupply[node] ? -1 : (int64_t)freeCount++;
+            }
+
+            network->freeCount = freeCount;
+            status = 0;
+        }
+    }
+
+    free(adjacencyStart);
+    free(adjacency);
+    free(queue);
+    free(reached);
+
+    return status;
+}
+
+static int compareColumns(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static size_t findEntry(const PipeNetwork *network, size_t row, uint32_t column)
+{
+    size_t low = network->rowStart[row];
+    size_t high = network->rowStart[row + 1];
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (network->column[middle] < column)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+// Sparsity of the reduced nodal matrix: one row per junction with sorted
+// columns, parallel segments sharing an entry.
+static int buildStructure(PipeNetwork *network)
+{
+    if (orderJunctions(network) < 0)
+    {
+        return -1;
+    }
+
+    size_t freeCount = network->freeCount;
+
+    free(network->rowStart);
+    free(network->rowDiagonal);
+    free(network->column);
+    free(network->value);
+    free(network->factor);
+    free(network->work);
+
+    network->rowStart = calloc(freeCount + 1, sizeof(size_t));
+    network->rowDiagonal = malloc((freeCount + 1) * sizeof(size_t));
+    network->work = malloc((6 * freeCount + 1) * sizeof(double));
+    network->column = NULL;
+    network->value = NULL;
+    network->factor = NULL;
+
+    if (!network->rowStart || !network->rowDiagonal || !network->work)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < freeCount; i++)
+    {
+        network->rowStart[i + 1] = 1;
+    }
+
+    for (size_t s = 0; s < network->segmentCount; s++)
+    {
+        int64_t a = network->freeIndex[network->segments[s].fromNode];
+        int64_t b = network->freeIndex[network->segments[s].toNode];
+
+        if (a >= 0 && b >= 0 && a != b)
+        {
+            network->rowStart[a + 1]++;
+            network->rowStart[b + 1]++;
+        }
+    }
+
+    for (size_t i = 0; i < freeCount; i++)
+    {
+        network->rowStart[i + 1] += network->rowStart[i];
+    }
+
+    size_t entries = network->rowStart[freeCount];
+    size_t *fill = malloc((freeCount + 1) * sizeof(size_t));
+
+    network->column = malloc((entries + 1) * sizeof(uint32_t));
+
+    if (!fill || !network->column)
+    {
+        free(fill);
+        return -1;
+    }
+
+    for (size_t i = 0; i < freeCount; i++)
+    {
+        network->column[network->rowStart[i]] = (uint32_t)i;
+        fill[i] = network->rowStart[i] + 1;
+    }
+
+    for (size_t s = 0; s < network->segmentCount; s++)
+    {
+        int64_t a = network->freeIndex[network->segments[s].fromNode];
+        int64_t b = network->freeIndex[network->segments[s].toNode];
+
+        if (a >= 0 && b >= 0 && a != b)
+        {
+            network->column[fill[a]++] = (uint32_t)b;
+            network->column[fill[b]++] = (uint32_t)a;
+        }
+    }
+
+    free(fill);
+
+    // Sort each row and drop repeated columns
+    size_t kept = 0;
+
+    for (size_t i = 0; i < freeCount; i++)
+    {
+        size_t begin = network->rowStart[i];
+        size_t end = network->rowStart[i + 1];
+
+        qsort(&network->column[begin], end - begin, sizeof(uint32_t), compareColumns);
+        network->rowStart[i] = kept;
+
+        for (size_t k = begin; k < end; k++)
+        {
+            if (k == begin || network->column[k] != network->column[k - 1])
+            {
+                if (network->column[k] == i)
+                {
+                    network->rowDiagonal[i] = kept;
+                }
+
+                network->column[kept++] = network->column[k];
+            }
+        }
+    }
+
+    network->rowStart[freeCount] = kept;
+    network->value = malloc((kept + 1) * sizeof(double));
+    network->factor = malloc((kept + 1) * sizeof(double));
+
+    if (!network->value || !network->factor)
+    {
+        return -1;
+    }
+
+    for (size_t s = 0; s < network->segmentCount; s++)
+    {
+        int64_t a = network->freeIndex[network->segments[s].fromNode];
+        int64_t b = network->freeIndex[network->segments[s].toNode];
+        size_t *entry = &network->segmentEntries[4 * s];
+
+        entry[0] = a >= 0 ? network->rowDiagonal[a] : PIPE_NETWORK_NO_ENTRY;
+        entry[1] = b >= 0 ? network->rowDiagonal[b] : PIPE_NETWORK_NO_ENTRY;
+        entry[2] = PIPE_NETWORK_NO_ENTRY;
+        entry[3] = PIPE_NETWORK_NO_ENTRY;
+
+        if (a == b)
+        {
+            // A loop back to the same node carries no flow
+            entry[0] = entry[1] = PIPE_NETWORK_NO_ENTRY;
+        }
+        else if (a >= 0 && b >= 0)
+        {
+            entry[2] = findEntry(network, (size_t)a, (uint32_t)b);
+            entry[3] = findEntry(network, (size_t)b, (uint32_t)a);
+        }
+    }
+
+    network->structureValid = 1;
+
+    return 0;
+}
+
+static double nominalFlowCFM(double diameterIn, double linePressurePSIG, double ambientPSIA)
+{
+    double areaFt = M_PI * (diameterIn / 24.0) * (diameterIn / 24.0);
+    return PIPE_NETWORK_NOMINAL_FPS * 60.0 * areaFt * (linePressurePSIG + ambientPSIA) / ambientPSIA;
+}
+
+static void multiply(const PipeNetwork *network, const double *x, double *y)
+{
+    for (size_t i = 0; i < network->freeCount; i++)
+    {
+        double sum = 0.0;
+
+        for (size_t k = network->rowStart[i]; k < network->rowStart[i + 1]; k++)
+        {
+            sum += network->value[k] * x[network->column[k]];
+        }
+
+        y[i] = sum;
+    }
+}
+
+// Incomplete Cholesky with no fill, L kept in factor over the lower half of
+// the matrix pattern. With branches numbered first a tree factors exactly,
+// so only the loops in a network cost conjugate gradient iterations.
+static void factorIncomplete(PipeNetwork *network)
+{
+    const size_t *rowStart = network->rowStart;
+    const size_t *rowDiagonal = network->rowDiagonal;
+    const uint32_t *column = network->column;
+    double *factor = network->factor;
+
+    for (size_t i = 0; i < network->freeCount; i++)
+    {
+        double diagonal = network->value[rowDiagonal[i]];
+        double remaining = diagonal;
+
+        for (size_t ik = rowStart[i]; ik < rowDiagonal[i]; ik++)
+        {
+            uint32_t k = column[ik];
+            double sum = network->value[ik];
+
+            // Rows i and k share columns below k
+            size_t a = rowStart[i], b = rowStart[k];
+
+            while (a < ik && b < rowDiagonal[k])
+            {
+                if (column[a] == column[b])
+                {
+                    sum -= factor[a++] * factor[b++];
+                }
+                else if (column[a] < column[b])
+                {
+                    a++;
+                }
+                else
+                {
+                    b++;
+                }
+            }
+
+            factor[ik] = sum / factor[rowDiagonal[k]];
+            remaining -= factor[ik] * factor[ik];
+        }
+
+        // Fall back to the diagonal if dropped fill breaks the factorization
+        factor[rowDiagonal[i]] = sqrt(remaining > 1.0e-12 * diagonal ? remaining : diagonal);
+    }
+}
+
+// z = (L L^T)^-1 r
+static void precondition(const PipeNetwork *network, const double *r, double *z)
+{
+    const size_t *rowStart = network->rowStart;
+    const size_t *rowDiagonal = network->rowDiagonal;
+    const uint32_t *column = network->column;
+    const double *factor = network->factor;
+    size_t n = network->freeCount;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double sum = r[i];
+
+        for (size_t k = rowStart[i]; k < rowDiagonal[i]; k++)
+        {
+            sum -= factor[k] * z[column[k]];
+        }
+
+        z[i] = sum / factor[rowDiagonal[i]];
+    }
+
+    for (size_t i = n; i-- > 0;)
+    {
+        z[i] /= factor[rowDiagonal[i]];
+
+        for (size_t k = rowStart[i]; k < rowDiagonal[i]; k++)
+        {
+            z[column[k]] -= factor[k] * z[i];
+        }
+    }
+}
+
+// Preconditioned conjugate gradient from x, stopping once the residual has
+// fallen by reduction. Tight solves are wasted on early Newton steps.
+static void conjugateGradient(const PipeNetwork *network, const double *rhs, double *x, double *scratch, double reduction)
+{
+    size_t n = network->freeCount;
+    double *r = scratch;
+    double *z = r + n;
+    double *p = z + n;
+    double *q = p + n;
+
+    multiply(network, x, q);
+
+    double rr = 0.0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        r[i] = rhs[i] - q[i];
+        rr += r[i] * r[i];
+    }
+
+    precondition(network, r, z);
+
+    double rz = 0.0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        p[i] = z[i];
+        rz += r[i] * z[i];
+    }
+
+    double limit = reduction * reduction * rr;
+    size_t maxIterations = 4 * n + 100;
+
+    for (size_t iteration = 0; iteration < maxIterations && rr > limit && rz > 0.0; iteration++)
+    {
+        multiply(network, p, q);
+
+        double pq = 0.0;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            pq += p[i] * q[i];
+        }
+
+        double alpha = rz / pq;
+
+        rr = 0.0;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+            rr += r[i] * r[i];
+        }
+
+        precondition(network, r, z);
+
+        double rzNext = 0.0;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            rzNext += r[i] * z[i];
+        }
+
+        double beta = rzNext / rz;
+        rz = rzNext;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            p[i] = z[i] + beta * p[i];
+        }
+    }
+}
+
+// Linearizes every segment about its current flow. Head loss is R*Q*|Q|, so
+// Newton gives Q' = Q/2 + g*(Pfrom - Pto) with g = 1/(2*R*|Q|).
+static void linearize(PipeNetwork *network, int coldStart)
+{
+    for (size_t s = 0; s < network->segmentCount; s++)
+    {
+        const PipeSegment *segment = &network->segments[s];
+        double linePSIG = 0.5 * (network->pressurePSIG[segment->fromNode] + network->pressurePSIG[segment->toNode]);
+        linePSIG = linePSIG > PIPE_NETWORK_MIN_LINE_PSIG ? linePSIG : PIPE_NETWORK_MIN_LINE_PSIG;
+
+        double nominal = nominalFlowCFM(segment->diameterIn, linePSIG, network->ambientPSIA);
+        double flow = coldStart ? 0.0 : network->flowCFM[s];
+        double magnitude = coldStart ? nominal : fabs(flow);
+        double stagnant = PIPE_NETWORK_STAGNANT_FRACTION * nominal;
+        magnitude = magnitude > stagnant ? magnitude : stagnant;
+
+        double drop = pipePressureDropPSI(magnitude,
+                                          linePSIG,
+                                          network->ambientPSIA,
+                                          network->airTemperatureF,
+                                          segment->diameterIn,
+                                          segment->lengthFt + segment->fittingsLengthFt);
+
+        network->conductance[s] = magnitude / (2.0 * drop);
+        network->flowTerm[s] = 0.5 * flow;
+    }
+}
+
+static void assemble(PipeNetwork *network, double *rhs)
+{
+    size_t entries = network->rowStart[network->freeCount];
+
+    memset(network->value, 0, entries * sizeof(double));
+
+    for (size_t i = 0; i < network->nodeCount; i++)
+    {
+        if (network->freeIndex[i] >= 0)
+        {
+            rhs[network->freeIndex[i]] = -network->demandCFM[i];
+        }
+    }
+
+    for (size_t s = 0; s < network->segmentCount; s++)
+    {
+        const size_t *entry = &network->segmentEntries[4 * s];
+        uint32_t from = network->segments[s].fromNode;
+        uint32_t to = network->segments[s].toNode;
+        double g = network->conductance[s];
+        double term = network->flowTerm[s];
+
+        if (entry[0] != PIPE_NETWORK_NO_ENTRY)
+        {
+            int64_t row = network->freeIndex[from];
+
+            network->value[entry[0]] += g;
+            rhs[row] -= term;
+
+            if (entry[2] != PIPE_NETWORK_NO_ENTRY)
+            {
+                network->value[entry[2]] -= g;
+            }
+            else
+            {
+                rhs[row] += g * network->pressurePSIG[to];
+            }
+        }
+
+        if (entry[1] != PIPE_NETWORK_NO_ENTRY)
+        {
+            int64_t row = network->freeIndex[to];
+
+            network->value[entry[1]] += g;
+            rhs[row] += term;
+
+            if (entry[3] != PIPE_NETWORK_NO_ENTRY)
+            {
+                network->value[entry[3]] -= g;
+            }
+            else
+            {
+                rhs[row] += g * network->pressurePSIG[from];
+            }
+        }
+    }
+}
+
+static void finishSolution(PipeNetwork *network)
+{
+    for (size_t s = 0; s < network->segmentCount; s++)
+    {
+        const PipeSegment *segment = &network->segments[s];
+        double from = network->pressurePSIG[segment->fromNode];
+        double to = network->pressurePSIG[segment->toNode];
+        double linePSIG = 0.5 * (from + to);
+        linePSIG = linePSIG > PIPE_NETWORK_MIN_LINE_PSIG ? linePSIG : PIPE_NETWORK_MIN_LINE_PSIG;
+
+        network->velocityFPS[s] = velocityInPipeFPS(fabs(network->flowCFM[s]), linePSIG, network->ambientPSIA, segment->diameterIn);
+        network->pressureDropPSI[s] = fabs(from - to);
+    }
+}
+
+int pipeNetworkSolve(PipeNetwork *network, double tolerancePSI, int maxIterations)
+{
+    if (!network->structureValid)
+    {
+        network->solved = 0;
+
+        if (buildStructure(network) < 0)
+        {
+            return -1;
+        }
+    }
+
+    size_t n = network->freeCount;
+    double *x = network->work;
+    double *rhs = x + n;
+    double *scratch = rhs + n;
+
+    if (!network->solved)
+    {
+        double highest = 0.0;
+
+        for (size_t i = 0; i < network->nodeCount; i++)
+        {
+            if (network->isSupply[i] && network->supplyPSIG[i] > highest)
+            {
+                highest = network->supplyPSIG[i];
+            }
+        }
+
+        for (size_t i = 0; i < network->nodeCount; i++)
+        {
+            network->pressurePSIG[i] = highest;
+        }
+    }
+
+    for (size_t i = 0; i < network->nodeCount; i++)
+    {
+        if (network->isSupply[i])
+        {
+            network->pressurePSIG[i] = network->supplyPSIG[i];
+        }
+    }
+
+    for (int iteration = 1; iteration <= maxIterations; iteration++)
+    {
+        linearize(network, !network->solved && iteration == 1);
+        assemble(network, rhs);
+
+        for (size_t i = 0; i < network->nodeCount; i++)
+        {
+            if (network->freeIndex[i] >= 0)
+            {
+                x[network->freeIndex[i]] = network->pressurePSIG[i];
+            }
+        }
+
+        factorIncomplete(network);
+        conjugateGradient(network, rhs, x, scratch, 1.0e-4);
+
+        double largestChange = 0.0;
+
+        for (size_t i = 0; i < network->nodeCount; i++)
+        {
+            if (network->freeIndex[i] >= 0)
+            {
+                double next = x[network->freeIndex[i]];
+                double change = fabs(next - network->pressurePSIG[i]);
+
+                largestChange = change > largestChange ? change : largestChange;
+                network->pressurePSIG[i] = next;
+            }
+        }
+
+        for (size_t s = 0; s < network->segmentCount; s++)
+        {
+            const PipeSegment *segment = &network->segments[s];
+            double drop = network->pressurePSIG[segment->fromNode] - network->pressurePSIG[segment->toNode];
+
+            network->flowCFM[s] = network->flowTerm[s] + network->conductance[s] * drop;
+        }
+
+        if (largestChange <= tolerancePSI)
+        {
+            network->solved = 1;
+            finishSolution(network);
+
+            return iteration;
+        }
+    }
+
+    network->solved = 0;
+
+    return -1;
+}
@@ -0,0 +1,114 @@
+//
+//  PipeNetwork.h
+//
+//  Steady-state flow and pressure in a compressed air piping network.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PipeNetwork_h
+#define PipeNetwork_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A straight run between two nodes. Fittings are given as their equivalent
+// length of straight pipe.
+typedef struct PipeSegment
+{
+    uint32_t fromNode;
+    uint32_t toNode;
+    double diameterIn;
+    double lengthFt;
+    double fittingsLengthFt;
+} PipeSegment;
+
+// Flows are free air CFM at ambient, pressures are gauge. Results are valid
+// after a successful pipeNetworkSolve:
+//   pressurePSIG per node
+//   flowCFM per segment, positive from fromNode to toNode
+//   velocityFPS and pressureDropPSI per segment, along the flow
+typedef struct PipeNetwork
+{
+    size_t nodeCount;
+    size_t segmentCount;
+    double ambientPSIA;
+    double airTemperatureF;
+
+    PipeSegment *segments;
+    double *demandCFM;
+    double *supplyPSIG;
+    uint8_t *isSupply;
+
+    double *pressurePSIG;
+    double *flowCFM;
+    double *velocityFPS;
+    double *pressureDropPSI;
+
+    // Solver state, rebuilt when the set of supply nodes changes
+    int structureValid;
+    int solved;
+    size_t freeCount;
+    int64_t *freeIndex;
+    size_t *rowStart;
+    size_t *rowDiagonal;
+    uint32_t *column;
+    double *value;
+    double *factor;
+    size_t *segmentEntries;
+    double *conductance;
+    double *flowTerm;
+    double *work;
+} PipeNetwork;
+
+// Copies the segments. Every node starts as a junction with no demand.
+// Returns 0, or -1 if a segment names a node out of range or memory runs out.
+int pipeNetworkInit(PipeNetwork *network,
+                    const PipeSegment *segments,
+                    size_t segmentCount,
+                    size_t nodeCount,
+                    double ambientPSIA,
+                    double airTemperatureF);
+void pipeNetworkFree(PipeNetwork *network);
+
+// Demand drawn at a junction
+void pipeNetworkSetDemand(PipeNetwork *network, size_t node, double demandCFM);
+
+// Holds a node at a fixed pressure, e.g. a receiver or dryer outlet.
+void pipeNetworkSetSupply(PipeNetwork *network, size_t node, double pressurePSIG);
+void pipeNetworkClearSupply(PipeNetwork *network, size_t node);
+
+// Newton iteration on node pressures, each step a conjugate gradient solve
+// preconditioned by incomplete Cholesky. Branches are factored exactly, so
+// the iteration count depends on the loops in the network rather than its
+// size. A later call starts from the previous solution,
+// so changing one demand typically converges in a few steps. Returns the
+// Newton steps taken, or -1 if a junction has no path to a supply node or
+// the pressures do not settle to tolerancePSI within maxIterations.
+int pipeNetworkSolve(PipeNetwork *network, double tolerancePSI, int maxIterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PipeNetwork_h */
@@ -0,0 +1,234 @@
+//
+//  PipeSizing.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PipeSizing.h"
+#include "Compulations.h"
+
+#define PIPE_SIZES_PER_SCHEDULE 23
+
+// Branches per work-stealing chunk
+#define PIPE_SIZING_GRAIN 256
+
+static const PipeSize schedule40[PIPE_SIZES_PER_SCHEDULE] = {
+    { "1/8", 0.125, 0.269 },
+    { "1/4", 0.25, 0.364 },
+    { "3/8", 0.375, 0.493 },
+    { "1/2", 0.5, 0.622 },
+    { "3/4", 0.75, 0.824 },
+    { "1", 1.0, 1.049 },
+    { "1-1/4", 1.25, 1.380 },
+    { "1-1/2", 1.5, 1.610 },
+    { "2", 2.0, 2.067 },
+    { "2-1/2", 2.5, 2.469 },
+    { "3", 3.0, 3.068 },
+    { "3-1/2", 3.5, 3.548 },
+    { "4", 4.0, 4.026 },
+    { "5", 5.0, 5.047 },
+    { "6", 6.0, 6.065 },
+    { "8", 8.0, 7.981 },
+    { "10", 10.0, 10.020 },
+    { "12", 12.0, 11.938 },
+    { "14", 14.0, 13.124 },
+    { "16", 16.0, 15.000 },
+    { "18", 18.0, 16.876 },
+    { "20", 20.0, 18.812 },
+    { "24", 24.0, 22.624 },
+};
+
+static const PipeSize schedule80[PIPE_SIZES_PER_SCHEDULE] = {
+    { "1/8", 0.125, 0.215 },
+    { "1/4", 0.25, 0.302 },
+    { "3/8", 0.375, 0.423 },
+    { "1/2", 0.5, 0.546 },
+    { "3/4", 0.75, 0.742 },
+    { "1", 1.0, 0.957 },
+    { "1-1/4", 1.25, 1.278 },
+    { "1-1/2", 1.5, 1.500 },
+    { "2", 2.0, 1.939 },
+    { "2-1/2", 2.5, 2.323 },
+    { "3", 3.0, 2.900 },
+    { "3-1/2", 3.5, 3.364 },
+    { "4", 4.0, 3.826 },
+    { "5", 5.0, 4.813 },
+    { "6", 6.0, 5.761 },
+    { "8", 8.0, 7.625 },
+    { "10", 10.0, 9.562 },
+    { "12", 12.0, 11.374 },
+    { "14", 14.0, 12.500 },
+    { "16", 16.0, 14.312 },
+    { "18", 18.0, 16.124 },
+    { "20", 20.0, 17.938 },
+    { "24", 24.0, 21.562 },
+};
+
+size_t pipeScheduleSizes(PipeSchedule schedule, const PipeSize **sizes)
+{
+    *sizes = schedule == PipeSchedule80 ? schedule80 : schedule40;
+    return PIPE_SIZES_PER_SCHEDULE;
+}
+
+static int noSize(PipeSizingResult *result)
+{
+    result->sizeIndex = -1;
+    result->insideDiameterIn = 0.0;
+    result->velocityFPS = 0.0;
+    result->pressureDropPSI = 0.0;
+
+    return -1;
+}
+
+int pipeSizeBranch(const PipeBranch *branch,
+                   PipeSchedule schedule,
+                   double ambientPSIA,
+                   double airTemperatureF,
+                   PipeSizingResult *result)
+{
+    const PipeSize *sizes;
+    size_t count = pipeScheduleSizes(schedule, &sizes);
+    size_t low = 0, high = count;
+
+    // Without flow or pressure the velocity and drop are 0 at every size, so
+    // the smallest would look like it fits.
+    if (!(branch->flowRateCFM > 0.0) || !(branch->linePressurePSIG > 0.0))
+    {
+        return noSize(result);
+    }
+
+    // Velocity falls as the bore grows, so the continuous diameter gives the
+    // first candidate directly.
+    if (branch->maxVelocityFPS > 0.0)
+    {
+        double minimumIn = pipeDiameterInchesForVelocity(branch->flowRateCFM,
+                                                         branch->maxVelocityFPS,
+                                                         branch->linePressurePSIG,
+                                                         ambientPSIA);
+
+        while (low < high)
+        {
+            size_t middle = low + (high - low) / 2;
+
+            if (sizes[middle].insideDiameterIn < minimumIn)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+    }
+
+    // Pressure drop also falls with the bore; bisect the sizes that remain.
+    if (branch->maxPressureDropPSI > 0.0 && low < count)
+    {
+        high = count;
+
+        while (low < high)
+        {
+            size_t middle = low + (high - low) / 2;
+            double drop = pipePressureDropPSI(branch->flowRateCFM,
+                                              branch->linePressurePSIG,
+                                              ambientPSIA,
+                                              airTemperatureF,
+                                              sizes[middle].insideDiameterIn,
+                                              branch->lengthFt);
+
+            if (drop > branch->maxPressureDropPSI)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+    }
+
+    if (low >= count)
+    {
+        return noSize(result);
+    }
+
+    double diameterIn = sizes[low].insideDiameterIn;
+
+    result->sizeIndex = (int32_t)low;
+    result->insideDiameterIn = diameterIn;
+    result->velocityFPS = velocityInPipeFPS(branch->flowRateCFM, branch->linePressurePSIG, ambientPSIA, diameterIn);
+    result->pressureDropPSI = pipePressureDropPSI(branch->flowRateCFM,
+                                                  branch->linePressurePSIG,
+                                                  ambientPSIA,
+                                                  airTemperatureF,
+                                                  diameterIn,
+                                                  branch->lengthFt);
+
+    return 0;
+}
+
+typedef struct PipeSizingJob
+{
+    const PipeBranch *branches;
+    PipeSchedule schedule;
+    double ambientPSIA;
+    double airTemperatureF;
+    PipeSizingResult *results;
+} PipeSizingJob;
+
+static void sizeRange(void *context, size_t begin, size_t end, size_t worker)
+{
+    PipeSizingJob *job = context;
+    (void)worker;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        pipeSizeBranch(&job->branches[i], job->schedule, job->ambientPSIA, job->airTemperatureF, &job->results[i]);
+    }
+}
+
+size_t pipeSizeBranches(const PipeBranch *branches,
+                        size_t count,
+                        PipeSchedule schedule,
+                        double ambientPSIA,
+                        double airTemperatureF,
+                        ThreadPool *pool,
+                        PipeSizingResult *results)
+{
+    PipeSizingJob job = { branches, schedule, ambientPSIA, airTemperatureF, results };
+
+    if (pool)
+    {
+        threadPoolParallelFor(pool, count, PIPE_SIZING_GRAIN, sizeRange, &job);
+    }
+    else
+    {
+        sizeRange(&job, 0, count, 0);
+    }
+
+    size_t unsized = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        unsized += results[i].sizeIndex < 0;
+    }
+
+    return unsized;
+}
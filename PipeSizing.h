@@ -0,0 +1,99 @@
+//
+//  PipeSizing.h
+//
+//  Picks standard pipe sizes for branches against velocity and pressure-drop
+//  limits.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PipeSizing_h
+#define PipeSizing_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ThreadPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum PipeSchedule
+{
+    PipeSchedule40,
+    PipeSchedule80
+} PipeSchedule;
+
+// ASME B36.10 steel pipe, 1/8" through 24" nominal
+typedef struct PipeSize
+{
+    const char *nominal;
+    double nominalIn;
+    double insideDiameterIn;
+} PipeSize;
+
+// Sizes in a schedule, smallest first. Returns the count.
+size_t pipeScheduleSizes(PipeSchedule schedule, const PipeSize **sizes);
+
+// lengthFt includes the equivalent length of fittings. A limit of zero or
+// less is not checked.
+typedef struct PipeBranch
+{
+    double flowRateCFM;
+    double linePressurePSIG;
+    double lengthFt;
+    double maxVelocityFPS;
+    double maxPressureDropPSI;
+} PipeBranch;
+
+// sizeIndex is into pipeScheduleSizes, -1 when even the largest size fails
+// or the branch is invalid.
+typedef struct PipeSizingResult
+{
+    int32_t sizeIndex;
+    double insideDiameterIn;
+    double velocityFPS;
+    double pressureDropPSI;
+} PipeSizingResult;
+
+// Smallest size meeting both limits. Returns 0, or -1 if none does or the
+// branch has no flow or line pressure (flowRateCFM or linePressurePSIG zero
+// or less).
+int pipeSizeBranch(const PipeBranch *branch,
+                   PipeSchedule schedule,
+                   double ambientPSIA,
+                   double airTemperatureF,
+                   PipeSizingResult *result);
+
+// Sizes every branch, across pool when it is not NULL. Returns the number of
+// branches no size could satisfy, invalid ones included.
+size_t pipeSizeBranches(const PipeBranch *branches,
+                        size_t count,
+                        PipeSchedule schedule,
+                        double ambientPSIA,
+                        double airTemperatureF,
+                        ThreadPool *pool,
+                        PipeSizingResult *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PipeSizing_h */
@@ -0,0 +1,437 @@
+//
+//  PlantSimulator.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PlantSimulator.h"
+#include "Compulations.h"
+#include "UnitConversion.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PLANT_MAX_COMPRESSORS 64
+
+// Demand events still running, oldest first. Every event lasts the same
+// time, so they end in the order they started; one entry holds all the
+// events that started on the same step.
+typedef struct PlantEventQueue
+{
+    double *ends;
+    uint32_t *counts;
+    size_t capacity;
+    size_t first;
+    size_t length;
+    size_t active;
+} PlantEventQueue;
+
+// xoshiro256** seeded through splitmix64, one stream per scenario
+
+typedef struct PlantRandom
+{
+    uint64_t state[4];
+    double spareNormal;
+    int hasSpareNormal;
+} PlantRandom;
+
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void plantRandomSeed(PlantRandom *random, uint64_t seed, uint64_t scenario)
+{
+    uint64_t x = seed ^ (scenario * 0xD1342543DE82EF95ULL);
+
+    for (int i = 0; i < 4; i++)
+    {
+        random->state[i] = splitmix64(&x);
+    }
+
+    random->hasSpareNormal = 0;
+}
+
+static inline uint64_t rotateLeft(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t plantRandomNext(PlantRandom *random)
+{
+    uint64_t *s = random->state;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+
+    return result;
+}
+
+// Uniform on (0, 1)
+static inline double plantRandomUniform(PlantRandom *random)
+{
+    return ((plantRandomNext(random) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+static double plantRandomNormal(PlantRandom *random)
+{
+    if (random->hasSpareNormal)
+    {
+        random->hasSpareNormal = 0;
+        return random->spareNormal;
+    }
+
+    // Box-Muller
+    double radius = sqrt(-2.0 * log(plantRandomUniform(random)));
+    double angle = 2.0 * M_PI * plantRandomUniform(random);
+
+    random->spareNormal = radius * sin(angle);
+    random->hasSpareNormal = 1;
+
+    return radius * cos(angle);
+}
+
+// Poisson count by Knuth's product of uniforms, limit being e^-mean
+static uint32_t plantRandomPoisson(PlantRandom *random, double limit)
+{
+    uint32_t count = 0;
+    double product = plantRandomUniform(random);
+
+    while (product > limit)
+    {
+        count++;
+        product *= plantRandomUniform(random);
+    }
+
+    return count;
+}
+
+// Returns 0, or -1 if the queue could not grow
+static int plantEventsPush(PlantEventQueue *queue, double end, uint32_t count)
+{
+    if (queue->length == queue->capacity)
+    {
+        size_t capacity = queue->capacity ? 2 * queue->capacity : 16;
+        double *ends = malloc(capacity * sizeof(double));
+        uint32_t *counts = malloc(capacity * sizeof(uint32_t));
+
+        if (!ends || !counts)
+        {
+            free(ends);
+            free(counts);
+            return -1;
+        }
+
+        for (size_t i = 0; i < queue->length; i++)
+        {
+            size_t from = (queue->first + i) % queue->capacity;
+            ends[i] = queue->ends[from];
+            counts[i] = queue->counts[from];
+        }
+
+        free(queue->ends);
+        free(queue->counts);
+        queue->ends = ends;
+        queue->counts = counts;
+        queue->capacity = capacity;
+        queue->first = 0;
+    }
+
+    size_t last = (queue->first + queue->length) % queue->capacity;
+    queue->ends[last] = end;
+    queue->counts[last] = count;
+    queue->length++;
+    queue->active += count;
+
+    return 0;
+}
+
+static void plantEventsExpire(PlantEventQueue *queue, double now)
+{
+    while (queue->length > 0 && queue->ends[queue->first] <= now)
+    {
+        queue->active -= queue->counts[queue->first];
+        queue->first = (queue->first + 1) % queue->capacity;
+        queue->length--;
+    }
+}
+
+static int plantModelIsValid(const PlantModel *model)
+{
+    return model->storageCF > 0.0 && model->ambientPSIA > 0.0 && model->timeStepSec > 0.0 &&
+           model->durationSec > 0.0 && model->compressorCount <= PLANT_MAX_COMPRESSORS &&
+           (model->compressors || model->compressorCount == 0);
+}
+
+void plantSimulateScenario(const PlantModel *model,
+                           uint64_t seed,
+                           uint64_t scenario,
+                           PlantScenarioResult *result)
+{
+    memset(result, 0, sizeof(*result));
+
+    if (!plantModelIsValid(model))
+    {
+        return;
+    }
+
+    PlantRandom random;
+    plantRandomSeed(&random, seed, scenario);
+
+    const PlantDemandProfile *demand = &model->demand;
+    double dt = model->timeStepSec;
+    size_t steps = (size_t)(model->durationSec / dt);
+
+    // Seconds for 1 CFM to raise the receiver by 1 psi, straight from the
+    // pump-up relationship.
+    double secondsPerPSIPerCFM = pumpupTimeInSeconds(gallonsFromCubicFeet(model->storageCF), 1.0, 0.0, 1.0, model->ambientPSIA);
+    double psiPerCFMStep = dt / secondsPerPSIPerCFM;
+
+    // Ornstein-Uhlenbeck step for the random part of demand
+    double decay = demand->correlationTimeSec > 0.0 ? exp(-dt / demand->correlationTimeSec) : 0.0;
+    double innovation = demand->standardDeviationCFM * sqrt(1.0 - decay * decay);
+    double noise = demand->standardDeviationCFM * plantRandomNormal(&random);
+    // Arrivals per step are Poisson. Means over 16 are drawn as a sum of
+    // chunks of 16, so e^-mean cannot underflow; Poisson counts add.
+    double eventsPerStep = demand->eventsPerHour * dt / 3600.0;
+    double eventChunks = eventsPerStep > 0.0 ? floor(eventsPerStep / 16.0) : 0.0;
+    double chunkLimit = exp(-16.0);
+    double remainderLimit = exp(-(eventsPerStep - 16.0 * eventChunks));
+    PlantEventQueue events = { NULL, NULL, 0, 0, 0, 0 };
+
+    double pressure = model->initialPressurePSIG;
+    int loaded[PLANT_MAX_COMPRESSORS];
+    size_t loadedSteps = 0;
+    double demandTotal = 0.0;
+
+    for (size_t c = 0; c < model->compressorCount; c++)
+    {
+        loaded[c] = pressure <= model->compressors[c].loadPressurePSIG;
+    }
+
+    result->minPressurePSIG = pressure;
+    result->maxPressurePSIG = pressure;
+
+    for (size_t step = 0; step < steps; step++)
+    {
+        double now = step * dt;
+
+        // Demand
+        noise = decay * noise + innovation * plantRandomNormal(&random);
+
+        uint32_t arrivals = 0;
+
+        if (eventsPerStep > 0.0)
+        {
+            for (double chunk = 0.0; chunk < eventChunks; chunk++)
+            {
+                arrivals += plantRandomPoisson(&random, chunkLimit);
+            }
+
+            arrivals += plantRandomPoisson(&random, remainderLimit);
+        }
+
+        if (arrivals > 0 && plantEventsPush(&events, now + demand->eventDurationSec, arrivals) != 0)
+        {
+            result->droppedEvents += arrivals;
+        }
+
+        plantEventsExpire(&events, now);
+
+        double demandCFM = demand->meanCFM + noise + events.active * demand->eventCFM;
+        demandCFM = demandCFM > 0.0 ? demandCFM : 0.0;
+        demandTotal += demandCFM;
+
+        // Supply, with load/unload hysteresis per compressor
+        double supplyCFM = 0.0;
+
+        for (size_t c = 0; c < model->compressorCount; c++)
+        {
+            const PlantCompressor *compressor = &model->compressors[c];
+
+            if (!loaded[c] && pressure <= compressor->loadPressurePSIG)
+            {
+                loaded[c] = 1;
+                result->loadCycles++;
+            }
+            else if (loaded[c] && pressure >= compressor->unloadPressurePSIG)
+            {
+                loaded[c] = 0;
+            }
+
+            if (loaded[c])
+            {
+                supplyCFM += compressor->ratedFlowCFM;
+                loadedSteps++;
+            }
+        }
+
+        // The receiver cannot be drawn below atmosphere.
+        pressure += (supplyCFM - demandCFM) * psiPerCFMStep;
+        pressure = pressure > 0.0 ? pressure : 0.0;
+
+        result->minPressurePSIG = pressure < result->minPressurePSIG ? pressure : result->minPressurePSIG;
+        result->maxPressurePSIG = pressure > result->maxPressurePSIG ? pressure : result->maxPressurePSIG;
+    }
+
+    free(events.ends);
+    free(events.counts);
+
+    if (steps > 0)
+    {
+        result->averageDemandCFM = demandTotal / steps;
+
+        if (model->compressorCount > 0)
+        {
+            result->loadedFraction = (double)loadedSteps / ((double)steps * model->compressorCount);
+        }
+    }
+}
+
+// Parallel driver
+
+typedef struct PlantJob
+{
+    const PlantModel *model;
+    uint64_t seed;
+    PlantScenarioResult *results;
+} PlantJob;
+
+static void plantSimulateRange(void *context, size_t begin, size_t end, size_t worker)
+{
+    PlantJob *job = context;
+    (void)worker;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        plantSimulateScenario(job->model, job->seed, i, &job->results[i]);
+    }
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted values
+static double percentile(const double *sorted, size_t count, double fraction)
+{
+    size_t rank = (size_t)ceil(fraction * count);
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+int plantSimulate(const PlantModel *model,
+                  size_t scenarioCount,
+                  uint64_t seed,
+                  ThreadPool *pool,
+                  PlantScenarioResult *results,
+                  PlantSimulationSummary *summary)
+{
+    if (!plantModelIsValid(model) || scenarioCount == 0)
+    {
+        return -1;
+    }
+
+    PlantScenarioResult *ownedResults = NULL;
+
+    if (!results)
+    {
+        ownedResults = malloc(scenarioCount * sizeof(PlantScenarioResult));
+
+        if (!ownedResults)
+        {
+            return -1;
+        }
+
+        results = ownedResults;
+    }
+
+    PlantJob job = { model, seed, results };
+
+    if (pool)
+    {
+        threadPoolParallelFor(pool, scenarioCount, 1, plantSimulateRange, &job);
+    }
+    else
+    {
+        plantSimulateRange(&job, 0, scenarioCount, 0);
+    }
+
+    int status = 0;
+
+    if (summary)
+    {
+        double *minPressures = malloc(scenarioCount * sizeof(double));
+        double *cycles = malloc(scenarioCount * sizeof(double));
+
+        if (minPressures && cycles)
+        {
+            double pressureSum = 0.0, cycleSum = 0.0;
+
+            for (size_t i = 0; i < scenarioCount; i++)
+            {
+                minPressures[i] = results[i].minPressurePSIG;
+                cycles[i] = results[i].loadCycles;
+                pressureSum += minPressures[i];
+                cycleSum += cycles[i];
+            }
+
+            qsort(minPressures, scenarioCount, sizeof(double), compareDoubles);
+            qsort(cycles, scenarioCount, sizeof(double), compareDoubles);
+
+            summary->scenarios = scenarioCount;
+            summary->minPressureMeanPSIG = pressureSum / scenarioCount;
+            summary->minPressureP01PSIG = percentile(minPressures, scenarioCount, 0.01);
+            summary->minPressureP05PSIG = percentile(minPressures, scenarioCount, 0.05);
+            summary->minPressureP50PSIG = percentile(minPressures, scenarioCount, 0.50);
+            summary->minPressureP95PSIG = percentile(minPressures, scenarioCount, 0.95);
+            summary->minPressureWorstPSIG = minPressures[0];
+            summary->loadCyclesMean = cycleSum / scenarioCount;
+            summary->loadCyclesP50 = percentile(cycles, scenarioCount, 0.50);
+            summary->loadCyclesP95 = percentile(cycles, scenarioCount, 0.95);
+            summary->loadCyclesMax = cycles[scenarioCount - 1];
+            summary->loadCyclesPerHourMean = summary->loadCyclesMean * 3600.0 / model->durationSec;
+        }
+        else
+        {
+            status = -1;
+        }
+
+        free(minPressures);
+        free(cycles);
+    }
+
+    free(ownedResults);
+
+    return status;
+}
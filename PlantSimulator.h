@@ -0,0 +1,128 @@
+//
+//  PlantSimulator.h
+//
+//  Time-stepped Monte Carlo simulation of a compressed air plant, built on
+//  the pump-up and storage relationships.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PlantSimulator_h
+#define PlantSimulator_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ThreadPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A load/unload compressor. It loads at or below loadPressurePSIG and
+// unloads at or above unloadPressurePSIG; staggered setpoints give a cascade.
+typedef struct PlantCompressor
+{
+    double ratedFlowCFM;
+    double loadPressurePSIG;
+    double unloadPressurePSIG;
+} PlantCompressor;
+
+// Demand is a mean-reverting random flow (Ornstein-Uhlenbeck) plus events
+// arriving as a Poisson process, each adding eventCFM for eventDurationSec.
+// Each time step draws a Poisson count of arrivals, so several can start on
+// one step, and any number can overlap.
+typedef struct PlantDemandProfile
+{
+    double meanCFM;
+    double standardDeviationCFM;
+    double correlationTimeSec;
+
+    // Any rate; events are neither capped nor merged. Memory for the events
+    // running at once is the only limit, see droppedEvents.
+    double eventsPerHour;
+    double eventCFM;
+    double eventDurationSec;
+} PlantDemandProfile;
+
+// Up to 64 compressors per plant.
+typedef struct PlantModel
+{
+    double storageCF;
+    double ambientPSIA;
+    double initialPressurePSIG;
+    const PlantCompressor *compressors;
+    size_t compressorCount;
+    PlantDemandProfile demand;
+    double timeStepSec;
+    double durationSec;
+} PlantModel;
+
+typedef struct PlantScenarioResult
+{
+    double minPressurePSIG;
+    double maxPressurePSIG;
+    double averageDemandCFM;
+    double loadedFraction;
+    uint32_t loadCycles;
+
+    // Events left out of demand because memory for them ran out; 0 unless
+    // allocation failed
+    uint32_t droppedEvents;
+} PlantScenarioResult;
+
+// Distribution over all scenarios
+typedef struct PlantSimulationSummary
+{
+    size_t scenarios;
+    double minPressureMeanPSIG;
+    double minPressureP01PSIG;
+    double minPressureP05PSIG;
+    double minPressureP50PSIG;
+    double minPressureP95PSIG;
+    double minPressureWorstPSIG;
+    double loadCyclesMean;
+    double loadCyclesP50;
+    double loadCyclesP95;
+    double loadCyclesMax;
+    double loadCyclesPerHourMean;
+} PlantSimulationSummary;
+
+// Runs one scenario. Its random stream depends only on seed and scenario, so
+// results are the same for any thread count.
+void plantSimulateScenario(const PlantModel *model,
+                           uint64_t seed,
+                           uint64_t scenario,
+                           PlantScenarioResult *result);
+
+// Runs scenarios [0, scenarioCount) across pool. results, if not NULL, gets
+// one entry per scenario. Returns 0 on success, -1 for an invalid model or
+// if memory runs out.
+int plantSimulate(const PlantModel *model,
+                  size_t scenarioCount,
+                  uint64_t seed,
+                  ThreadPool *pool,
+                  PlantScenarioResult *results,
+                  PlantSimulationSummary *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PlantSimulator_h */
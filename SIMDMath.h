@@ -0,0 +1,257 @@
+//
+//  SIMDMath.h
+//
+//  Vector approximations of the libm routines used by the batch kernels.
+//  Internal to the library, not part of the public API.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMDMath_h
+#define SIMDMath_h
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define COMPULATIONS_HAVE_X86_SIMD 1
+#else
+#define COMPULATIONS_HAVE_X86_SIMD 0
+#endif
+
+#if COMPULATIONS_HAVE_X86_SIMD
+
+#include <immintrin.h>
+
+#define COMPULATIONS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define COMPULATIONS_TARGET_AVX512 __attribute__((target("avx512f")))
+
+// Cody-Waite split of log10(2) and ln(10), so 10^x keeps full precision
+// after range reduction.
+#define SIMD_LOG2_10        3.321928094887362
+#define SIMD_LOG10_2_HI     0.3010299956639812
+#define SIMD_LOG10_2_LO    -2.8037281277851704e-18
+#define SIMD_LN10_HI        2.302585092994046
+#define SIMD_LN10_LO       -2.1707562233822494e-16
+#define SIMD_LOG2_E         1.4426950408889634
+#define SIMD_LN2_HI         0.6931471805599453
+#define SIMD_LN2_LO         2.3190468138462996e-17
+
+// Adding 1.5 * 2^52 leaves a small integer in the low mantissa bits.
+#define SIMD_ROUND_MAGIC    6755399441055744.0
+
+// Taylor coefficients of e^t, 1/13! .. 1/2!. Degree 13 keeps the truncation
+// error below 5e-18 for |t| <= ln(2)/2.
+#define SIMD_EXP_C13 1.6059043836821613e-10
+#define SIMD_EXP_C12 2.08767569878681e-09
+#define SIMD_EXP_C11 2.505210838544172e-08
+#define SIMD_EXP_C10 2.755731922398589e-07
+#define SIMD_EXP_C9  2.7557319223985893e-06
+#define SIMD_EXP_C8  2.48015873015873e-05
+#define SIMD_EXP_C7  0.0001984126984126984
+#define SIMD_EXP_C6  0.001388888888888889
+#define SIMD_EXP_C5  0.008333333333333333
+#define SIMD_EXP_C4  0.041666666666666664
+#define SIMD_EXP_C3  0.16666666666666666
+#define SIMD_EXP_C2  0.5
+
+// fdlibm log kernel, log(1+f) = 2s + s*R(s^2) with s = f/(2+f)
+#define SIMD_LG1 6.666666666666735130e-01
+#define SIMD_LG2 3.999999999940941908e-01
+#define SIMD_LG3 2.857142874366239149e-01
+#define SIMD_LG4 2.222219843214978396e-01
+#define SIMD_LG5 1.818357216161805012e-01
+#define SIMD_LG6 1.531383769920937332e-01
+#define SIMD_LG7 1.479819860511658591e-01
+
+#define SIMD_SQRT_HALF 0.7071067811865476
+
+// AVX2 ------------------------------------------------------------------
+
+COMPULATIONS_TARGET_AVX2
+static inline __m256d simdExpReducedAVX2(__m256d t)
+{
+    __m256d p = _mm256_set1_pd(SIMD_EXP_C13);
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C12));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C11));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C10));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C9));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C8));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C7));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C6));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C5));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C4));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C3));
+    p = _mm256_fmadd_pd(p, t, _mm256_set1_pd(SIMD_EXP_C2));
+    p = _mm256_mul_pd(p, _mm256_mul_pd(t, t));
+    return _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_add_pd(t, p));
+}
+
+// 2^n for integral n in [-1022, 1023]
+COMPULATIONS_TARGET_AVX2
+static inline __m256d simdPow2AVX2(__m256d n)
+{
+    __m256d magic = _mm256_set1_pd(SIMD_ROUND_MAGIC);
+    __m256i k = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n, magic)), _mm256_castpd_si256(magic));
+    k = _mm256_slli_epi64(_mm256_add_epi64(k, _mm256_set1_epi64x(1023)), 52);
+    return _mm256_castsi256_pd(k);
+}
+
+COMPULATIONS_TARGET_AVX2
+static inline __m256d simdExp10AVX2(__m256d x)
+{
+    x = _mm256_max_pd(_mm256_min_pd(x, _mm256_set1_pd(307.0)), _mm256_set1_pd(-307.0));
+
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(SIMD_LOG2_10)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(SIMD_LOG10_2_HI), x);
+    r = _mm256_fnmadd_pd(n, _mm256_set1_pd(SIMD_LOG10_2_LO), r);
+    __m256d t = _mm256_fmadd_pd(r, _mm256_set1_pd(SIMD_LN10_HI), _mm256_mul_pd(r, _mm256_set1_pd(SIMD_LN10_LO)));
+
+    return _mm256_mul_pd(simdExpReducedAVX2(t), simdPow2AVX2(n));
+}
+
+COMPULATIONS_TARGET_AVX2
+static inline __m256d simdExpAVX2(__m256d x)
+{
+    x = _mm256_max_pd(_mm256_min_pd(x, _mm256_set1_pd(709.0)), _mm256_set1_pd(-708.0));
+
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(SIMD_LOG2_E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d t = _mm256_fnmadd_pd(n, _mm256_set1_pd(SIMD_LN2_HI), x);
+    t = _mm256_fnmadd_pd(n, _mm256_set1_pd(SIMD_LN2_LO), t);
+
+    return _mm256_mul_pd(simdExpReducedAVX2(t), simdPow2AVX2(n));
+}
+
+// Natural log for positive, normal x. Other inputs give unspecified results.
+COMPULATIONS_TARGET_AVX2
+static inline __m256d simdLogAVX2(__m256d x)
+{
+    __m256i bits = _mm256_castpd_si256(x);
+    __m256i exponentBits = _mm256_srli_epi64(bits, 52);
+    __m256d mantissa = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                                           _mm256_set1_epi64x(0x3FF0000000000000LL)));
+
+    // Exponent as a double: the biased exponent is small enough for the magic-number trick.
+    __m256d magic = _mm256_set1_pd(SIMD_ROUND_MAGIC);
+    __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(exponentBits, _mm256_castpd_si256(magic))), magic);
+    e = _mm256_sub_pd(e, _mm256_set1_pd(1023.0));
+
+    // Keep the mantissa in [sqrt(1/2), sqrt(2)) so f stays small.
+    __m256d big = _mm256_cmp_pd(mantissa, _mm256_set1_pd(2.0 * SIMD_SQRT_HALF), _CMP_GE_OQ);
+    mantissa = _mm256_blendv_pd(mantissa, _mm256_mul_pd(mantissa, _mm256_set1_pd(0.5)), big);
+    e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+
+    __m256d f = _mm256_sub_pd(mantissa, _mm256_set1_pd(1.0));
+    __m256d s = _mm256_div_pd(f, _mm256_add_pd(_mm256_set1_pd(2.0), f));
+    __m256d z = _mm256_mul_pd(s, s);
+    __m256d w = _mm256_mul_pd(z, z);
+    __m256d t1 = _mm256_mul_pd(w, _mm256_fmadd_pd(w, _mm256_fmadd_pd(w, _mm256_set1_pd(SIMD_LG6), _mm256_set1_pd(SIMD_LG4)), _mm256_set1_pd(SIMD_LG2)));
+    __m256d t2 = _mm256_mul_pd(z, _mm256_fmadd_pd(w, _mm256_fmadd_pd(w, _mm256_fmadd_pd(w, _mm256_set1_pd(SIMD_LG7), _mm256_set1_pd(SIMD_LG5)), _mm256_set1_pd(SIMD_LG3)), _mm256_set1_pd(SIMD_LG1)));
+    __m256d r = _mm256_add_pd(t1, t2);
+    __m256d hfsq = _mm256_mul_pd(_mm256_set1_pd(0.5), _mm256_mul_pd(f, f));
+
+    // log(x) = e*ln2 + f - (hfsq - s*(hfsq + R))
+    __m256d logm = _mm256_sub_pd(f, _mm256_fnmadd_pd(s, _mm256_add_pd(hfsq, r), hfsq));
+    return _mm256_fmadd_pd(e, _mm256_set1_pd(SIMD_LN2_HI), _mm256_fmadd_pd(e, _mm256_set1_pd(SIMD_LN2_LO), logm));
+}
+
+// AVX-512 ---------------------------------------------------------------
+
+COMPULATIONS_TARGET_AVX512
+static inline __m512d simdExpReducedAVX512(__m512d t)
+{
+    __m512d p = _mm512_set1_pd(SIMD_EXP_C13);
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C12));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C11));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C10));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C9));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C8));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C7));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C6));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C5));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C4));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C3));
+    p = _mm512_fmadd_pd(p, t, _mm512_set1_pd(SIMD_EXP_C2));
+    p = _mm512_mul_pd(p, _mm512_mul_pd(t, t));
+    return _mm512_add_pd(_mm512_set1_pd(1.0), _mm512_add_pd(t, p));
+}
+
+COMPULATIONS_TARGET_AVX512
+static inline __m512d simdPow2AVX512(__m512d n)
+{
+    __m512d magic = _mm512_set1_pd(SIMD_ROUND_MAGIC);
+    __m512i k = _mm512_sub_epi64(_mm512_castpd_si512(_mm512_add_pd(n, magic)), _mm512_castpd_si512(magic));
+    k = _mm512_slli_epi64(_mm512_add_epi64(k, _mm512_set1_epi64(1023)), 52);
+    return _mm512_castsi512_pd(k);
+}
+
+COMPULATIONS_TARGET_AVX512
+static inline __m512d simdExp10AVX512(__m512d x)
+{
+    x = _mm512_max_pd(_mm512_min_pd(x, _mm512_set1_pd(307.0)), _mm512_set1_pd(-307.0));
+
+    __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(SIMD_LOG2_10)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(SIMD_LOG10_2_HI), x);
+    r = _mm512_fnmadd_pd(n, _mm512_set1_pd(SIMD_LOG10_2_LO), r);
+    __m512d t = _mm512_fmadd_pd(r, _mm512_set1_pd(SIMD_LN10_HI), _mm512_mul_pd(r, _mm512_set1_pd(SIMD_LN10_LO)));
+
+    return _mm512_mul_pd(simdExpReducedAVX512(t), simdPow2AVX512(n));
+}
+
+COMPULATIONS_TARGET_AVX512
+static inline __m512d simdExpAVX512(__m512d x)
+{
+    x = _mm512_max_pd(_mm512_min_pd(x, _mm512_set1_pd(709.0)), _mm512_set1_pd(-708.0));
+
+    __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(SIMD_LOG2_E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d t = _mm512_fnmadd_pd(n, _mm512_set1_pd(SIMD_LN2_HI), x);
+    t = _mm512_fnmadd_pd(n, _mm512_set1_pd(SIMD_LN2_LO), t);
+
+    return _mm512_mul_pd(simdExpReducedAVX512(t), simdPow2AVX512(n));
+}
+
+COMPULATIONS_TARGET_AVX512
+static inline __m512d simdLogAVX512(__m512d x)
+{
+    __m512i bits = _mm512_castpd_si512(x);
+    __m512i exponentBits = _mm512_srli_epi64(bits, 52);
+    __m512d mantissa = _mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi64(0x000FFFFFFFFFFFFFLL)),
+                                                           _mm512_set1_epi64(0x3FF0000000000000LL)));
+
+    __m512d magic = _mm512_set1_pd(SIMD_ROUND_MAGIC);
+    __m512d e = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_add_epi64(exponentBits, _mm512_castpd_si512(magic))), magic);
+    e = _mm512_sub_pd(e, _mm512_set1_pd(1023.0));
+
+    __mmask8 big = _mm512_cmp_pd_mask(mantissa, _mm512_set1_pd(2.0 * SIMD_SQRT_HALF), _CMP_GE_OQ);
+    mantissa = _mm512_mask_mul_pd(mantissa, big, mantissa, _mm512_set1_pd(0.5));
+    e = _mm512_mask_add_pd(e, big, e, _mm512_set1_pd(1.0));
+
+    __m512d f = _mm512_sub_pd(mantissa, _mm512_set1_pd(1.0));
+    __m512d s = _mm512_div_pd(f, _mm512_add_pd(_mm512_set1_pd(2.0), f));
+    __m512d z = _mm512_mul_pd(s, s);
+    __m512d w = _mm512_mul_pd(z, z);
+    __m512d t1 = _mm512_mul_pd(w, _mm512_fmadd_pd(w, _mm512_fmadd_pd(w, _mm512_set1_pd(SIMD_LG6), _mm512_set1_pd(SIMD_LG4)), _mm512_set1_pd(SIMD_LG2)));
+    __m512d t2 = _mm512_mul_pd(z, _mm512_fmadd_pd(w, _mm512_fmadd_pd(w, _mm512_fmadd_pd(w, _mm512_set1_pd(SIMD_LG7), _mm512_set1_pd(SIMD_LG5)), _mm512_set1_pd(SIMD_LG3)), _mm512_set1_pd(SIMD_LG1)));
+    __m512d r = _mm512_add_pd(t1, t2);
+    __m512d hfsq = _mm512_mul_pd(_mm512_set1_pd(0.5), _mm512_mul_pd(f, f));
+
+    __m512d logm = _mm512_sub_pd(f, _mm512_fnmadd_pd(s, _mm512_add_pd(hfsq, r), hfsq));
+    return _mm512_fmadd_pd(e, _mm512_set1_pd(SIMD_LN2_HI), _mm512_fmadd_pd(e, _mm512_set1_pd(SIMD_LN2_LO), logm));
+}
+
+#endif // COMPULATIONS_HAVE_X86_SIMD
+
+#endif /* SIMDMath_h */
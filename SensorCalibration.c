@@ -0,0 +1,454 @@
+//
+//  SensorCalibration.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SensorCalibration.h"
+#include "BatchCompulations.h"
+#include "SIMDMath.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void sensorChannelInit(SensorChannel *channel,
+                       double inputMin,
+                       double inputMax,
+                       double outputMin,
+                       double outputMax)
+{
+    // Same slope as mappedValue, folded into scale and offset
+    channel->scale = 1.0 * (outputMax - outputMin) / (inputMax - inputMin);
+    channel->offset = outputMin - channel->scale * inputMin;
+
+    channel->lowLimit = outputMin < outputMax ? outputMin : outputMax;
+    channel->highLimit = outputMin < outputMax ? outputMax : outputMin;
+    channel->clamp = 0;
+}
+
+void sensorChannelSetLimits(SensorChannel *channel,
+                            double lowLimit,
+                            double highLimit,
+                            int clamp)
+{
+    channel->lowLimit = lowLimit;
+    channel->highLimit = highLimit;
+    channel->clamp = clamp;
+}
+
+// Buffer conversions
+
+// Spreads a 4-bit lane mask into one 0/1 byte per lane. The shifted copies of
+// the mask land on disjoint bit ranges, so the multiply cannot carry.
+static inline uint32_t laneMaskBytes(uint32_t mask)
+{
+    return (mask * 0x00204081u) & 0x01010101u;
+}
+
+static inline __attribute__((always_inline))
+double rawSample(const void *raw, size_t i, SensorSampleType type)
+{
+    switch (type)
+    {
+        case SensorSampleTypeU16:
+            return ((const uint16_t *)raw)[i];
+        case SensorSampleTypeI16:
+            return ((const int16_t *)raw)[i];
+        default:
+            return ((const int32_t *)raw)[i];
+    }
+}
+
+static inline __attribute__((always_inline))
+size_t convertScalar(const SensorChannel *channel,
+                     const void *raw,
+                     double *values,
+                     uint8_t *flags,
+                     size_t start,
+                     size_t count,
+                     SensorSampleType type)
+{
+    size_t outOfRange = 0;
+
+    for (size_t i = start; i < count; i++)
+    {
+        // fma like the vector bodies, so every level rounds the same
+        double value = fma(rawSample(raw, i, type), channel->scale, channel->offset);
+        int below = value < channel->lowLimit;
+        int above = value > channel->highLimit;
+
+        if (channel->clamp)
+        {
+            value = below ? channel->lowLimit : value;
+            value = above ? channel->highLimit : value;
+        }
+
+        values[i] = value;
+        outOfRange += below | above;
+
+        if (flags)
+        {
+            flags[i] = (uint8_t)(below * SensorSampleBelowRange + above * SensorSampleAboveRange);
+        }
+    }
+
+    return outOfRange;
+}
+
+#if COMPULATIONS_HAVE_X86_SIMD
+
+COMPULATIONS_TARGET_AVX2
+static inline __attribute__((always_inline))
+__m256d rawSamplesAVX2(const void *raw, size_t i, SensorSampleType type)
+{
+    __m128i integers;
+
+    switch (type)
+    {
+        case SensorSampleTypeU16:
+            integers = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)((const uint16_t *)raw + i)));
+            break;
+        case SensorSampleTypeI16:
+            integers = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)((const int16_t *)raw + i)));
+            break;
+        default:
+            integers = _mm_loadu_si128((const __m128i *)((const int32_t *)raw + i));
+            break;
+    }
+
+    return _mm256_cvtepi32_pd(integers);
+}
+
+COMPULATIONS_TARGET_AVX2
+static inline __attribute__((always_inline))
+size_t convertAVX2(const SensorChannel *channel,
+                   const void *raw,
+                   double *values,
+                   uint8_t *flags,
+                   size_t count,
+                   SensorSampleType type)
+{
+    __m256d scale = _mm256_set1_pd(channel->scale);
+    __m256d offset = _mm256_set1_pd(channel->offset);
+    __m256d lowLimit = _mm256_set1_pd(channel->lowLimit);
+    __m256d highLimit = _mm256_set1_pd(channel->highLimit);
+    size_t outOfRange = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d value = _mm256_fmadd_pd(rawSamplesAVX2(raw, i, type), scale, offset);
+        int below = _mm256_movemask_pd(_mm256_cmp_pd(value, lowLimit, _CMP_LT_OQ));
+        int above = _mm256_movemask_pd(_mm256_cmp_pd(value, highLimit, _CMP_GT_OQ));
+
+        if (channel->clamp)
+        {
+            value = _mm256_min_pd(_mm256_max_pd(value, lowLimit), highLimit);
+        }
+
+        _mm256_storeu_pd(values + i, value);
+        outOfRange += __builtin_popcount(below | above);
+
+        if (flags)
+        {
+            uint32_t packed = laneMaskBytes(below) * SensorSampleBelowRange + laneMaskBytes(above) * SensorSampleAboveRange;
+            memcpy(flags + i, &packed, sizeof(packed));
+        }
+    }
+
+    return outOfRange + convertScalar(channel, raw, values, flags, i, count, type);
+}
+
+COMPULATIONS_TARGET_AVX512
+static inline __attribute__((always_inline))
+__m512d rawSamplesAVX512(const void *raw, size_t i, SensorSampleType type)
+{
+    __m256i integers;
+
+    switch (type)
+    {
+        case SensorSampleTypeU16:
+            integers = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)((const uint16_t *)raw + i)));
+            break;
+        case SensorSampleTypeI16:
+            integers = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)((const int16_t *)raw + i)));
+            break;
+        default:
+            integers = _mm256_loadu_si256((const __m256i *)((const int32_t *)raw + i));
+            break;
+    }
+
+    return _mm512_cvtepi32_pd(integers);
+}
+
+COMPULATIONS_TARGET_AVX512
+static inline __attribute__((always_inline))
+size_t convertAVX512(const SensorChannel *channel,
+                     const void *raw,
+                     double *values,
+                     uint8_t *flags,
+                     size_t count,
+                     SensorSampleType type)
+{
+    __m512d scale = _mm512_set1_pd(channel->scale);
+    __m512d offset = _mm512_set1_pd(channel->offset);
+    __m512d lowLimit = _mm512_set1_pd(channel->lowLimit);
+    __m512d highLimit = _mm512_set1_pd(channel->highLimit);
+    size_t outOfRange = 0;
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m512d value = _mm512_fmadd_pd(rawSamplesAVX512(raw, i, type), scale, offset);
+        __mmask8 below = _mm512_cmp_pd_mask(value, lowLimit, _CMP_LT_OQ);
+        __mmask8 above = _mm512_cmp_pd_mask(value, highLimit, _CMP_GT_OQ);
+
+        if (channel->clamp)
+        {
+            value = _mm512_min_pd(_mm512_max_pd(value, lowLimit), highLimit);
+        }
+
+        _mm512_storeu_pd(values + i, value);
+        outOfRange += __builtin_popcount(below | above);
+
+        if (flags)
+        {
+            uint64_t belowBytes = laneMaskBytes(below & 0xF) | ((uint64_t)laneMaskBytes(below >> 4) << 32);
+            uint64_t aboveBytes = laneMaskBytes(above & 0xF) | ((uint64_t)laneMaskBytes(above >> 4) << 32);
+            uint64_t packed = belowBytes * SensorSampleBelowRange + aboveBytes * SensorSampleAboveRange;
+            memcpy(flags + i, &packed, sizeof(packed));
+        }
+    }
+
+    return outOfRange + convertScalar(channel, raw, values, flags, i, count, type);
+}
+
+// One out-of-line kernel per ISA and sample type, so the type switch above
+// folds away inside each loop.
+
+COMPULATIONS_TARGET_AVX2
+static size_t convertU16AVX2(const SensorChannel *channel, const void *raw, double *values, uint8_t *flags, size_t count)
+{
+    return convertAVX2(channel, raw, values, flags, count, SensorSampleTypeU16);
+}
+
+COMPULATIONS_TARGET_AVX2
+static size_t convertI16AVX2(const SensorChannel *channel, const void *raw, double *values, uint8_t *flags, size_t count)
+{
+    return convertAVX2(channel, raw, values, flags, count, SensorSampleTypeI16);
+}
+
+COMPULATIONS_TARGET_AVX2
+static size_t convertI32AVX2(const SensorChannel *channel, const void *raw, double *values, uint8_t *flags, size_t count)
+{
+    return convertAVX2(channel, raw, values, flags, count, SensorSampleTypeI32);
+}
+
+COMPULATIONS_TARGET_AVX512
+static size_t convertU16AVX512(const SensorChannel *channel, const void *raw, double *values, uint8_t *flags, size_t count)
+{
+    return convertAVX512(channel, raw, values, flags, count, SensorSampleTypeU16);
+}
+
+COMPULATIONS_TARGET_AVX512
+static size_t convertI16AVX512(const SensorChannel *channel, const void *raw, double *values, uint8_t *flags, size_t count)
+{
+    return convertAVX512(channel, raw, values, flags, count, SensorSampleTypeI16);
+}
+
+COMPULATIONS_TARGET_AVX512
+static size_t convertI32AVX512(const SensorChannel *channel, const void *raw, double *values, uint8_t *flags, size_t count)
+{
+    return convertAVX512(channel, raw, values, flags, count, SensorSampleTypeI32);
+}
+
+#endif // COMPULATIONS_HAVE_X86_SIMD
+
+static size_t convert(const SensorChannel *channel,
+                      const void *raw,
+                      double *values,
+                      uint8_t *flags,
+                      size_t count,
+                      SensorSampleType type)
+{
+    switch (compulationsSIMDLevel())
+    {
+#if COMPULATIONS_HAVE_X86_SIMD
+        case CompulationsSIMDLevelAVX512:
+            switch (type)
+            {
+                case SensorSampleTypeU16:
+                    return convertU16AVX512(channel, raw, values, flags, count);
+                case SensorSampleTypeI16:
+                    return convertI16AVX512(channel, raw, values, flags, count);
+                default:
+                    return convertI32AVX512(channel, raw, values, flags, count);
+            }
+
+        case CompulationsSIMDLevelAVX2:
+            switch (type)
+            {
+                case SensorSampleTypeU16:
+                    return convertU16AVX2(channel, raw, values, flags, count);
+                case SensorSampleTypeI16:
+                    return convertI16AVX2(channel, raw, values, flags, count);
+                default:
+                    return convertI32AVX2(channel, raw, values, flags, count);
+            }
+#endif
+        default:
+            switch (type)
+            {
+                case SensorSampleTypeU16:
+                    return convertScalar(channel, raw, values, flags, 0, count, SensorSampleTypeU16);
+                case SensorSampleTypeI16:
+                    return convertScalar(channel, raw, values, flags, 0, count, SensorSampleTypeI16);
+                default:
+                    return convertScalar(channel, raw, values, flags, 0, count, SensorSampleTypeI32);
+            }
+    }
+}
+
+size_t sensorChannelConvertU16(const SensorChannel *channel,
+                               const uint16_t *raw,
+                               double *values,
+                               uint8_t *flags,
+                               size_t count)
+{
+    return convert(channel, raw, values, flags, count, SensorSampleTypeU16);
+}
+
+size_t sensorChannelConvertI16(const SensorChannel *channel,
+                               const int16_t *raw,
+                               double *values,
+                               uint8_t *flags,
+                               size_t count)
+{
+    return convert(channel, raw, values, flags, count, SensorSampleTypeI16);
+}
+
+size_t sensorChannelConvertI32(const SensorChannel *channel,
+                               const int32_t *raw,
+                               double *values,
+                               uint8_t *flags,
+                               size_t count)
+{
+    return convert(channel, raw, values, flags, count, SensorSampleTypeI32);
+}
+
+// Lock-free ring
+
+static size_t sampleSize(SensorSampleType type)
+{
+    return type == SensorSampleTypeI32 ? sizeof(int32_t) : sizeof(uint16_t);
+}
+
+int sensorRingInit(SensorRing *ring, SensorSampleType type, size_t capacity)
+{
+    size_t rounded = 1;
+
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->storage = malloc(rounded * sampleSize(type));
+
+    if (!ring->storage)
+    {
+        return -1;
+    }
+
+    ring->capacity = rounded;
+    ring->mask = rounded - 1;
+    ring->type = type;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    return 0;
+}
+
+void sensorRingFree(SensorRing *ring)
+{
+    free(ring->storage);
+    ring->storage = NULL;
+}
+
+size_t sensorRingWrite(SensorRing *ring, const void *samples, size_t count)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t space = ring->capacity - (head - tail);
+
+    count = count < space ? count : space;
+
+    // At most two spans, before and after the wrap
+    size_t elementSize = sampleSize(ring->type);
+    size_t start = head & ring->mask;
+    size_t firstSpan = ring->capacity - start < count ? ring->capacity - start : count;
+
+    memcpy((char *)ring->storage + start * elementSize, samples, firstSpan * elementSize);
+    memcpy(ring->storage, (const char *)samples + firstSpan * elementSize, (count - firstSpan) * elementSize);
+
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+
+    return count;
+}
+
+size_t sensorRingAvailable(SensorRing *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    return head - tail;
+}
+
+size_t sensorRingConvert(SensorRing *ring,
+                         const SensorChannel *channel,
+                         double *values,
+                         uint8_t *flags,
+                         size_t maxCount,
+                         size_t *outOfRange)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t count = head - tail < maxCount ? head - tail : maxCount;
+
+    size_t elementSize = sampleSize(ring->type);
+    size_t start = tail & ring->mask;
+    size_t firstSpan = ring->capacity - start < count ? ring->capacity - start : count;
+    size_t flagged = 0;
+
+    flagged += convert(channel, (const char *)ring->storage + start * elementSize,
+                       values, flags, firstSpan, ring->type);
+    flagged += convert(channel, ring->storage,
+                       values + firstSpan, flags ? flags + firstSpan : NULL, count - firstSpan, ring->type);
+
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+
+    if (outOfRange)
+    {
+        *outOfRange = flagged;
+    }
+
+    return count;
+}
@@ -0,0 +1,146 @@
+//
+//  SensorCalibration.h
+//
+//  Raw ADC counts to engineering units, the streaming form of mappedValue.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SensorCalibration_h
+#define SensorCalibration_h
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-channel calibration. value = fma(raw, scale, offset), rounded once and
+// identical at every SIMD level. It is the same line as mappedValue(raw,
+// inputMin, inputMax, outputMin, outputMax) with the slope division done
+// once; results can differ from mappedValue in the last bit.
+typedef struct SensorChannel
+{
+    double scale;
+    double offset;
+
+    // Engineering values outside [lowLimit, highLimit] are flagged, and
+    // clamped to the limit when clamp is set.
+    double lowLimit;
+    double highLimit;
+    int clamp;
+} SensorChannel;
+
+// Per-sample result of the range check
+typedef enum SensorSampleFlag
+{
+    SensorSampleInRange = 0,
+    SensorSampleBelowRange = 1,
+    SensorSampleAboveRange = 2
+} SensorSampleFlag;
+
+// Limits default to the output range, without clamping.
+void sensorChannelInit(SensorChannel *channel,
+                       double inputMin,
+                       double inputMax,
+                       double outputMin,
+                       double outputMax);
+
+void sensorChannelSetLimits(SensorChannel *channel,
+                            double lowLimit,
+                            double highLimit,
+                            int clamp);
+
+// Buffer conversions. flags may be NULL; otherwise it receives one
+// SensorSampleFlag per sample. Each returns the number of samples outside
+// the limits.
+size_t sensorChannelConvertU16(const SensorChannel *channel,
+                               const uint16_t *raw,
+                               double *values,
+                               uint8_t *flags,
+                               size_t count);
+
+size_t sensorChannelConvertI16(const SensorChannel *channel,
+                               const int16_t *raw,
+                               double *values,
+                               uint8_t *flags,
+                               size_t count);
+
+size_t sensorChannelConvertI32(const SensorChannel *channel,
+                               const int32_t *raw,
+                               double *values,
+                               uint8_t *flags,
+                               size_t count);
+
+// Single-producer single-consumer lock-free ring of raw samples, one per
+// channel. The DAQ thread writes, the consumer converts straight out of the
+// ring storage without an intermediate copy.
+typedef enum SensorSampleType
+{
+    SensorSampleTypeU16 = 0,
+    SensorSampleTypeI16,
+    SensorSampleTypeI32
+} SensorSampleType;
+
+#define SENSOR_RING_CACHE_LINE 64
+
+typedef struct SensorRing
+{
+    void *storage;
+    size_t capacity;
+    size_t mask;
+    SensorSampleType type;
+
+    // The read-only fields, the producer index and the consumer index each
+    // get their own cache line.
+    char configPadding[SENSOR_RING_CACHE_LINE];
+    atomic_size_t head;
+    char headPadding[SENSOR_RING_CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_size_t tail;
+    char tailPadding[SENSOR_RING_CACHE_LINE - sizeof(atomic_size_t)];
+} SensorRing;
+
+// Capacity is rounded up to a power of two. Returns 0 on success, -1 if the
+// storage cannot be allocated.
+int sensorRingInit(SensorRing *ring, SensorSampleType type, size_t capacity);
+void sensorRingFree(SensorRing *ring);
+
+// Producer side. Copies up to count samples of the ring's type and returns
+// how many fit.
+size_t sensorRingWrite(SensorRing *ring, const void *samples, size_t count);
+
+// Consumer side
+size_t sensorRingAvailable(SensorRing *ring);
+
+// Converts and consumes up to maxCount samples, returning the number
+// consumed. outOfRange, if not NULL, receives the number of flagged samples.
+size_t sensorRingConvert(SensorRing *ring,
+                         const SensorChannel *channel,
+                         double *values,
+                         uint8_t *flags,
+                         size_t maxCount,
+                         size_t *outOfRange);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SensorCalibration_h */
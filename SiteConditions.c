@@ -0,0 +1,161 @@
+//
+//  SiteConditions.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SiteConditions.h"
+#include "Compulations.h"
+#include "UnitConversion.h"
+
+// Same terms as scfmFromACFM/acfmFromSCFM, split by the inputs they depend on.
+
+static void updateFlowFactors(SiteConditions *conditions)
+{
+    conditions->acfmPerSCFM = conditions->rhMultiplier * conditions->tempMultiplier * conditions->inletPressureMultiplier;
+    conditions->scfmPerACFM = 1.0 / conditions->acfmPerSCFM;
+}
+
+static void updateRHMultiplier(SiteConditions *conditions)
+{
+    double rhNumerator = conditions->standardAmbientPressurePSI - (conditions->standardAmbientRH * conditions->standardVaporPressurePSI);
+    double rhDenominator = conditions->siteAmbientPressurePSI - (conditions->siteAmbientRH * conditions->siteVaporPressurePSI);
+    conditions->rhMultiplier = rhNumerator / rhDenominator;
+}
+
+static void updateTempMultiplier(SiteConditions *conditions)
+{
+    conditions->tempMultiplier = rankineFromFahrenheit(conditions->siteAmbientTempF) / rankineFromFahrenheit(conditions->standardAmbientTempF);
+}
+
+static void updateInletPressureMultiplier(SiteConditions *conditions)
+{
+    conditions->inletPressureMultiplier = conditions->siteAmbientPressurePSI / conditions->inletPressurePSI;
+}
+
+void siteConditionsInit(SiteConditions *conditions,
+                        double standardAmbientPressurePSI,
+                        double standardAmbientTempF,
+                        double standardAmbientRH,
+                        double siteAmbientPressurePSI,
+                        double siteAmbientTempF,
+                        double siteAmbientRH,
+                        double inletPressurePSI)
+{
+    conditions->standardAmbientPressurePSI = standardAmbientPressurePSI;
+    conditions->standardAmbientTempF = standardAmbientTempF;
+    conditions->standardAmbientRH = standardAmbientRH;
+    conditions->siteAmbientPressurePSI = siteAmbientPressurePSI;
+    conditions->siteAmbientTempF = siteAmbientTempF;
+    conditions->siteAmbientRH = siteAmbientRH;
+    conditions->inletPressurePSI = inletPressurePSI;
+
+    conditions->standardVaporPressurePSI = vaporPressureOfWaterInPsiForTemp(standardAmbientTempF);
+    conditions->siteVaporPressurePSI = vaporPressureOfWaterInPsiForTemp(siteAmbientTempF);
+
+    updateRHMultiplier(conditions);
+    updateTempMultiplier(conditions);
+    updateInletPressureMultiplier(conditions);
+    updateFlowFactors(conditions);
+}
+
+// Incremental updates
+
+void siteConditionsSetStandardAmbientPressurePSI(SiteConditions *conditions, double psi)
+{
+    conditions->standardAmbientPressurePSI = psi;
+    updateRHMultiplier(conditions);
+    updateFlowFactors(conditions);
+}
+
+void siteConditionsSetStandardAmbientTempF(SiteConditions *conditions, double degreesFahrenheit)
+{
+    conditions->standardAmbientTempF = degreesFahrenheit;
+    conditions->standardVaporPressurePSI = vaporPressureOfWaterInPsiForTemp(degreesFahrenheit);
+    updateRHMultiplier(conditions);
+    updateTempMultiplier(conditions);
+    updateFlowFactors(conditions);
+}
+
+void siteConditionsSetStandardAmbientRH(SiteConditions *conditions, double rh)
+{
+    conditions->standardAmbientRH = rh;
+    updateRHMultiplier(conditions);
+    updateFlowFactors(conditions);
+}
+
+void siteConditionsSetSiteAmbientPressurePSI(SiteConditions *conditions, double psi)
+{
+    conditions->siteAmbientPressurePSI = psi;
+    updateRHMultiplier(conditions);
+    updateInletPressureMultiplier(conditions);
+    updateFlowFactors(conditions);
+}
+
+void siteConditionsSetSiteAmbientTempF(SiteConditions *conditions, double degreesFahrenheit)
+{
+    conditions->siteAmbientTempF = degreesFahrenheit;
+    conditions->siteVaporPressurePSI = vaporPressureOfWaterInPsiForTemp(degreesFahrenheit);
+    updateRHMultiplier(conditions);
+    updateTempMultiplier(conditions);
+    updateFlowFactors(conditions);
+}
+
+void siteConditionsSetSiteAmbientRH(SiteConditions *conditions, double rh)
+{
+    conditions->siteAmbientRH = rh;
+    updateRHMultiplier(conditions);
+    updateFlowFactors(conditions);
+}
+
+void siteConditionsSetInletPressurePSI(SiteConditions *conditions, double psi)
+{
+    conditions->inletPressurePSI = psi;
+    updateInletPressureMultiplier(conditions);
+    updateFlowFactors(conditions);
+}
+
+// ACFM SCFM conversions
+
+void scfmFromACFMArrayForSiteConditions(const SiteConditions *conditions,
+                                        const double *acfm,
+                                        double *scfm,
+                                        size_t count)
+{
+    double factor = conditions->scfmPerACFM;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        scfm[i] = acfm[i] * factor;
+    }
+}
+
+void acfmFromSCFMArrayForSiteConditions(const SiteConditions *conditions,
+                                        const double *scfm,
+                                        double *acfm,
+                                        size_t count)
+{
+    double factor = conditions->acfmPerSCFM;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        acfm[i] = scfm[i] * factor;
+    }
+}
@@ -0,0 +1,96 @@
+//
+//  SiteConditions.h
+//
+//  Precomputed standard and site conditions for repeated ACFM SCFM conversions.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SiteConditions_h
+#define SiteConditions_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Inputs of scfmFromACFM/acfmFromSCFM other than the flow, plus everything
+// derived from them. Treat the derived fields as read only and change inputs
+// through the setters, which only redo the work that depends on the input.
+typedef struct SiteConditions
+{
+    // Inputs
+    double standardAmbientPressurePSI;
+    double standardAmbientTempF;
+    double standardAmbientRH;
+    double siteAmbientPressurePSI;
+    double siteAmbientTempF;
+    double siteAmbientRH;
+    double inletPressurePSI;
+
+    // Derived
+    double standardVaporPressurePSI;
+    double siteVaporPressurePSI;
+    double rhMultiplier;
+    double tempMultiplier;
+    double inletPressureMultiplier;
+    double acfmPerSCFM;
+    double scfmPerACFM;
+} SiteConditions;
+
+void siteConditionsInit(SiteConditions *conditions,
+                        double standardAmbientPressurePSI,
+                        double standardAmbientTempF,
+                        double standardAmbientRH,
+                        double siteAmbientPressurePSI,
+                        double siteAmbientTempF,
+                        double siteAmbientRH,
+                        double inletPressurePSI);
+
+// Incremental updates
+void siteConditionsSetStandardAmbientPressurePSI(SiteConditions *conditions, double psi);
+void siteConditionsSetStandardAmbientTempF(SiteConditions *conditions, double degreesFahrenheit);
+void siteConditionsSetStandardAmbientRH(SiteConditions *conditions, double rh);
+void siteConditionsSetSiteAmbientPressurePSI(SiteConditions *conditions, double psi);
+void siteConditionsSetSiteAmbientTempF(SiteConditions *conditions, double degreesFahrenheit);
+void siteConditionsSetSiteAmbientRH(SiteConditions *conditions, double rh);
+void siteConditionsSetInletPressurePSI(SiteConditions *conditions, double psi);
+
+// ACFM SCFM conversions, one multiply per value. Results can differ from
+// scfmFromACFM/acfmFromSCFM by a few ULP because the three multipliers are
+// folded into one factor.
+static inline double scfmFromACFMForSiteConditions(const SiteConditions *conditions, double acfm){return acfm * conditions->scfmPerACFM;};
+static inline double acfmFromSCFMForSiteConditions(const SiteConditions *conditions, double scfm){return scfm * conditions->acfmPerSCFM;};
+
+void scfmFromACFMArrayForSiteConditions(const SiteConditions *conditions,
+                                        const double *acfm,
+                                        double *scfm,
+                                        size_t count);
+
+void acfmFromSCFMArrayForSiteConditions(const SiteConditions *conditions,
+                                        const double *scfm,
+                                        double *acfm,
+                                        size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SiteConditions_h */
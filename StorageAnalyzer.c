@@ -0,0 +1,240 @@
+//
+//  StorageAnalyzer.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StorageAnalyzer.h"
+#include "Compulations.h"
+
+#include <string.h>
+
+// Receiver for a deficit: eventStorageCubicFeet with the whole deficit
+// drawn in one minute
+static double volumeForDeficit(const StorageAnalyzer *analyzer, double deficitCF)
+{
+    return eventStorageCubicFeet(1.0, deficitCF, 0.0, analyzer->ambientPSIA,
+                                 analyzer->initialPressurePSIG, analyzer->minPressurePSIG);
+}
+
+// Keeps the capacity largest events in a min-heap on deficitCF
+static void keepEvent(StorageEvent *heap, size_t *size, size_t capacity, const StorageEvent *event)
+{
+    size_t i;
+
+    if (*size < capacity)
+    {
+        i = (*size)++;
+
+        while (i > 0 && heap[(i - 1) / 2].deficitCF > event->deficitCF)
+        {
+            heap[i] = heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+
+        heap[i] = *event;
+        return;
+    }
+
+    if (capacity == 0 || event->deficitCF <= heap[0].deficitCF)
+    {
+        return;
+    }
+
+    i = 0;
+
+    for (;;)
+    {
+        size_t child = 2 * i + 1;
+
+        if (child >= *size)
+        {
+            break;
+        }
+
+        if (child + 1 < *size && heap[child + 1].deficitCF < heap[child].deficitCF)
+        {
+            child++;
+        }
+
+        if (heap[child].deficitCF >= event->deficitCF)
+        {
+            break;
+        }
+
+        heap[i] = heap[child];
+        i = child;
+    }
+
+    heap[i] = *event;
+}
+
+void storageAnalyzerInit(StorageAnalyzer *analyzer,
+                         double supplyCFM,
+                         double ambientPSIA,
+                         double initialPressurePSIG,
+                         double minPressurePSIG,
+                         double maxGapSec,
+                         size_t topCount)
+{
+    memset(analyzer, 0, sizeof(*analyzer));
+
+    analyzer->supplyCFM = supplyCFM;
+    analyzer->ambientPSIA = ambientPSIA;
+    analyzer->initialPressurePSIG = initialPressurePSIG;
+    analyzer->minPressurePSIG = minPressurePSIG;
+    analyzer->maxGapSec = maxGapSec;
+    analyzer->topCount = topCount < STORAGE_TOP_EVENTS_MAX ? topCount : STORAGE_TOP_EVENTS_MAX;
+}
+
+void storageAnalyzerReset(StorageAnalyzer *analyzer)
+{
+    storageAnalyzerInit(analyzer, analyzer->supplyCFM, analyzer->ambientPSIA, analyzer->initialPressurePSIG,
+                        analyzer->minPressurePSIG, analyzer->maxGapSec, analyzer->topCount);
+}
+
+// Adds the imbalance over [startSec, endSec], in free air cubic feet
+static void addInterval(StorageAnalyzer *analyzer, double startSec, double endSec, double imbalanceCF)
+{
+    double deficit = analyzer->deficitCF + imbalanceCF;
+
+    if (deficit > 0.0)
+    {
+        if (analyzer->deficitCF <= 0.0)
+        {
+            analyzer->current = (StorageEvent){ startSec, endSec, 0.0, 0.0, 0.0 };
+            analyzer->events++;
+        }
+
+        if (deficit > analyzer->current.deficitCF)
+        {
+            analyzer->current.deficitCF = deficit;
+            analyzer->current.peakSec = endSec;
+        }
+
+        if (deficit > analyzer->maxDeficitCF)
+        {
+            analyzer->maxDeficitCF = deficit;
+            analyzer->windowStartSec = analyzer->current.startSec;
+            analyzer->windowEndSec = endSec;
+        }
+
+        analyzer->deficitCF = deficit;
+        return;
+    }
+
+    // Paid back part way through the interval
+    if (analyzer->deficitCF > 0.0)
+    {
+        analyzer->current.endSec = startSec + (endSec - startSec) * (analyzer->deficitCF / -imbalanceCF);
+        analyzer->current.volumeCF = volumeForDeficit(analyzer, analyzer->current.deficitCF);
+        keepEvent(analyzer->top, &analyzer->topSize, analyzer->topCount, &analyzer->current);
+    }
+
+    analyzer->deficitCF = 0.0;
+}
+
+void storageAnalyzerAddSample(StorageAnalyzer *analyzer,
+                              double timeSec,
+                              double demandCFM,
+                              double supplyCFM)
+{
+    if (analyzer->samples > 0)
+    {
+        double dt = timeSec - analyzer->lastSec;
+
+        if (dt <= 0.0)
+        {
+            analyzer->lastImbalanceCFM = demandCFM - supplyCFM;
+            analyzer->samples++;
+            return;
+        }
+
+        if (analyzer->maxGapSec <= 0.0 || dt <= analyzer->maxGapSec)
+        {
+            addInterval(analyzer, analyzer->lastSec, timeSec, analyzer->lastImbalanceCFM * dt / 60.0);
+        }
+    }
+
+    analyzer->lastSec = timeSec;
+    analyzer->lastImbalanceCFM = demandCFM - supplyCFM;
+    analyzer->samples++;
+}
+
+void storageAnalyzerAddSamples(StorageAnalyzer *analyzer,
+                               const double *timeSec,
+                               const double *demandCFM,
+                               const double *supplyCFM,
+                               size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        storageAnalyzerAddSample(analyzer, timeSec[i], demandCFM[i], supplyCFM ? supplyCFM[i] : analyzer->supplyCFM);
+    }
+}
+
+void storageAnalyzerResult(const StorageAnalyzer *analyzer,
+                           StorageResult *result)
+{
+    result->maxDeficitCF = analyzer->maxDeficitCF;
+    result->requiredVolumeCF = volumeForDeficit(analyzer, analyzer->maxDeficitCF);
+    result->windowStartSec = analyzer->windowStartSec;
+    result->windowEndSec = analyzer->windowEndSec;
+    result->currentDeficitCF = analyzer->deficitCF;
+    result->samples = analyzer->samples;
+    result->events = analyzer->events;
+}
+
+size_t storageAnalyzerTopEvents(const StorageAnalyzer *analyzer,
+                                StorageEvent *events,
+                                size_t capacity)
+{
+    StorageEvent sorted[STORAGE_TOP_EVENTS_MAX];
+    size_t size = analyzer->topSize;
+
+    memcpy(sorted, analyzer->top, size * sizeof(StorageEvent));
+
+    if (analyzer->deficitCF > 0.0)
+    {
+        StorageEvent open = analyzer->current;
+
+        open.volumeCF = volumeForDeficit(analyzer, open.deficitCF);
+        keepEvent(sorted, &size, analyzer->topCount, &open);
+    }
+
+    // Insertion sort, largest first; there are at most STORAGE_TOP_EVENTS_MAX
+    for (size_t i = 1; i < size; i++)
+    {
+        StorageEvent event = sorted[i];
+        size_t j = i;
+
+        for (; j > 0 && sorted[j - 1].deficitCF < event.deficitCF; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+
+        sorted[j] = event;
+    }
+
+    size = size < capacity ? size : capacity;
+    memcpy(events, sorted, size * sizeof(StorageEvent));
+
+    return size;
+}
@@ -0,0 +1,145 @@
+//
+//  StorageAnalyzer.h
+//
+//  Streaming storage sizing from demand and supply time series, the
+//  general case of eventStorageCubicFeet's single rectangular event.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef StorageAnalyzer_h
+#define StorageAnalyzer_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STORAGE_TOP_EVENTS_MAX 32
+
+// A drawdown: from the first sample where demand exceeded supply until the
+// surplus after it had paid the deficit back. deficitCF is the free air the
+// receiver had to supply, at its largest, and volumeCF the receiver that
+// covers it between the initial and minimum pressures.
+typedef struct StorageEvent
+{
+    double startSec;
+    double peakSec;
+
+    // 0.0 while the deficit hasn't been paid back
+    double endSec;
+
+    double deficitCF;
+    double volumeCF;
+} StorageEvent;
+
+typedef struct StorageResult
+{
+    // Worst cumulative deficit over any window, and the receiver that
+    // covers it, as eventStorageCubicFeet would size it
+    double maxDeficitCF;
+    double requiredVolumeCF;
+    double windowStartSec;
+    double windowEndSec;
+
+    // Deficit at the latest sample
+    double currentDeficitCF;
+
+    size_t samples;
+    size_t events;
+} StorageResult;
+
+// The deficit follows D = max(0, D + (demand - supply) * dt) from sample to
+// sample, each sample's rates holding until the next one. Its maximum is the
+// maximum subarray sum of the flow imbalance, found in one pass. The top
+// events live in a fixed heap, so each site costs O(1) memory and each
+// sample O(1) work.
+typedef struct StorageAnalyzer
+{
+    // Configuration
+    double supplyCFM;
+    double ambientPSIA;
+    double initialPressurePSIG;
+    double minPressurePSIG;
+    double maxGapSec;
+    size_t topCount;
+
+    // Previous sample
+    double lastSec;
+    double lastImbalanceCFM;
+
+    // Current event
+    double deficitCF;
+    StorageEvent current;
+
+    // Results
+    size_t samples;
+    size_t events;
+    double maxDeficitCF;
+    double windowStartSec;
+    double windowEndSec;
+
+    // Largest finished events, a min-heap on deficitCF
+    StorageEvent top[STORAGE_TOP_EVENTS_MAX];
+    size_t topSize;
+} StorageAnalyzer;
+
+// supplyCFM is the supply used when a sample gives none, e.g. the rated
+// flow of the trim compressors. Intervals longer than maxGapSec, e.g. logger
+// outages, count as balanced; 0 accepts any gap. topCount is clamped to
+// STORAGE_TOP_EVENTS_MAX.
+void storageAnalyzerInit(StorageAnalyzer *analyzer,
+                         double supplyCFM,
+                         double ambientPSIA,
+                         double initialPressurePSIG,
+                         double minPressurePSIG,
+                         double maxGapSec,
+                         size_t topCount);
+
+void storageAnalyzerReset(StorageAnalyzer *analyzer);
+
+// Samples must come in time order; a sample at or before the previous one
+// only replaces its rates.
+void storageAnalyzerAddSample(StorageAnalyzer *analyzer,
+                              double timeSec,
+                              double demandCFM,
+                              double supplyCFM);
+
+// Columns for one site. supplyCFM may be NULL for the configured supply.
+void storageAnalyzerAddSamples(StorageAnalyzer *analyzer,
+                               const double *timeSec,
+                               const double *demandCFM,
+                               const double *supplyCFM,
+                               size_t count);
+
+void storageAnalyzerResult(const StorageAnalyzer *analyzer,
+                           StorageResult *result);
+
+// The largest events, the one still open included, largest first. Returns
+// how many were written, at most capacity and topCount.
+size_t storageAnalyzerTopEvents(const StorageAnalyzer *analyzer,
+                                StorageEvent *events,
+                                size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* StorageAnalyzer_h */
@@ -0,0 +1,699 @@
+//
+//  TelemetryStore.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TelemetryStore.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_BYTE_ORDER 0x01020304u
+
+static const char telemetryMagic[8] = { 'C', 'M', 'P', 'L', 'T', 'L', 'M', '\n' };
+
+size_t telemetryTypeSize(TelemetryType type)
+{
+    switch (type)
+    {
+        case TelemetryTypeF64:
+            return sizeof(double);
+        case TelemetryTypeF32:
+            return sizeof(float);
+        case TelemetryTypeI32:
+            return sizeof(int32_t);
+        case TelemetryTypeI16:
+            return sizeof(int16_t);
+        case TelemetryTypeU16:
+            return sizeof(uint16_t);
+        case TelemetryTypeU8:
+            return sizeof(uint8_t);
+        default:
+            return 0;
+    }
+}
+
+static inline uint64_t alignedOffset(uint64_t offset)
+{
+    return (offset + TELEMETRY_ALIGNMENT - 1) & ~(uint64_t)(TELEMETRY_ALIGNMENT - 1);
+}
+
+static inline double telemetryValueAt(TelemetryType type, const void *values, size_t i)
+{
+    switch (type)
+    {
+        case TelemetryTypeF64:
+            return ((const double *)values)[i];
+        case TelemetryTypeF32:
+            return ((const float *)values)[i];
+        case TelemetryTypeI32:
+            return ((const int32_t *)values)[i];
+        case TelemetryTypeI16:
+            return ((const int16_t *)values)[i];
+        case TelemetryTypeU16:
+            return ((const uint16_t *)values)[i];
+        case TelemetryTypeU8:
+            return ((const uint8_t *)values)[i];
+        default:
+            return NAN;
+    }
+}
+
+static void chunkStatistics(TelemetryType type, const void *values, size_t count, double *min, double *max)
+{
+    double low = INFINITY;
+    double high = -INFINITY;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double value = telemetryValueAt(type, values, i);
+
+        if (value < low)
+        {
+            low = value;
+        }
+
+        if (value > high)
+        {
+            high = value;
+        }
+    }
+
+    // NaNs fail both comparisons, so an all-NaN chunk is left inverted.
+    if (low > high)
+    {
+        low = NAN;
+        high = NAN;
+    }
+
+    *min = low;
+    *max = high;
+}
+
+// Writer
+
+static int telemetryWrite(TelemetryWriter *writer, const void *bytes, size_t size)
+{
+    if (size && fwrite(bytes, 1, size, writer->file) != size)
+    {
+        writer->status = -1;
+        return -1;
+    }
+
+    writer->offset += size;
+
+    return 0;
+}
+
+static int telemetryPad(TelemetryWriter *writer)
+{
+    static const uint8_t zeros[TELEMETRY_ALIGNMENT];
+
+    return telemetryWrite(writer, zeros, (size_t)(alignedOffset(writer->offset) - writer->offset));
+}
+
+static int telemetryIndexGrow(TelemetryWriter *writer)
+{
+    size_t capacity = writer->blockCapacity ? writer->blockCapacity * 2 : 64;
+    TelemetryBlockInfo *blocks = realloc(writer->blocks, capacity * sizeof(TelemetryBlockInfo));
+
+    if (!blocks)
+    {
+        return -1;
+    }
+
+    writer->blocks = blocks;
+
+    TelemetryChunkInfo *chunks = realloc(writer->chunks, capacity * writer->columnCount * sizeof(TelemetryChunkInfo));
+
+    if (!chunks)
+    {
+        return -1;
+    }
+
+    writer->chunks = chunks;
+    writer->blockCapacity = capacity;
+
+    return 0;
+}
+
+static int telemetryWriterFlush(TelemetryWriter *writer)
+{
+    size_t rows = writer->buffered;
+
+    if (rows == 0)
+    {
+        return 0;
+    }
+
+    if (writer->blockCount == writer->blockCapacity && telemetryIndexGrow(writer) != 0)
+    {
+        writer->status = -1;
+        return -1;
+    }
+
+    TelemetryBlockInfo *block = &writer->blocks[writer->blockCount];
+    TelemetryChunkInfo *chunks = &writer->chunks[writer->blockCount * writer->columnCount];
+
+    block->firstRow = writer->rowCount;
+    block->rows = rows;
+
+    for (size_t c = 0; c < writer->columnCount; c++)
+    {
+        TelemetryType type = (TelemetryType)writer->columns[c].type;
+
+        if (telemetryPad(writer) != 0)
+        {
+            return -1;
+        }
+
+        chunks[c].offset = writer->offset;
+        chunkStatistics(type, writer->buffers[c], rows, &chunks[c].min, &chunks[c].max);
+
+        if (telemetryWrite(writer, writer->buffers[c], rows * telemetryTypeSize(type)) != 0)
+        {
+            return -1;
+        }
+    }
+
+    writer->blockCount++;
+    writer->rowCount += rows;
+    writer->buffered = 0;
+
+    return 0;
+}
+
+static void telemetryWriterRelease(TelemetryWriter *writer)
+{
+    for (size_t c = 0; c < writer->columnCount; c++)
+    {
+        free(writer->buffers[c]);
+        writer->buffers[c] = NULL;
+    }
+
+    free(writer->blocks);
+    free(writer->chunks);
+    writer->blocks = NULL;
+    writer->chunks = NULL;
+    writer->blockCount = 0;
+    writer->blockCapacity = 0;
+}
+
+int telemetryWriterOpen(TelemetryWriter *writer,
+                        const char *path,
+                        const TelemetryColumnSpec *columns,
+                        size_t columnCount,
+                        size_t blockRows)
+{
+    memset(writer, 0, sizeof(*writer));
+
+    if (blockRows == 0)
+    {
+        blockRows = TELEMETRY_DEFAULT_BLOCK_ROWS;
+    }
+
+    if (!path || !columns || columnCount == 0 || columnCount > TELEMETRY_MAX_COLUMNS ||
+        blockRows > UINT32_MAX || columns[0].type != TelemetryTypeF64)
+    {
+        return -1;
+    }
+
+    for (size_t c = 0; c < columnCount; c++)
+    {
+        if (!columns[c].name || strlen(columns[c].name) >= TELEMETRY_NAME_SIZE ||
+            (unsigned)columns[c].type >= TelemetryTypeCount)
+        {
+            return -1;
+        }
+
+        strcpy(writer->columns[c].name, columns[c].name);
+        writer->columns[c].type = (uint32_t)columns[c].type;
+    }
+
+    writer->columnCount = columnCount;
+    writer->blockRows = blockRows;
+    writer->lastTimeSec = -INFINITY;
+
+    for (size_t c = 0; c < columnCount; c++)
+    {
+        writer->buffers[c] = malloc(blockRows * telemetryTypeSize(columns[c].type));
+
+        if (!writer->buffers[c])
+        {
+            telemetryWriterRelease(writer);
+            return -1;
+        }
+    }
+
+    writer->file = fopen(path, "wb");
+
+    if (!writer->file)
+    {
+        telemetryWriterRelease(writer);
+        return -1;
+    }
+
+    // The header is a placeholder until telemetryWriterClose fills in the
+    // counts and index.
+    TelemetryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, telemetryMagic, sizeof(header.magic));
+
+    telemetryWrite(writer, &header, sizeof(header));
+    telemetryWrite(writer, writer->columns, columnCount * sizeof(TelemetryColumnInfo));
+
+    if (writer->status != 0)
+    {
+        fclose(writer->file);
+        writer->file = NULL;
+        telemetryWriterRelease(writer);
+    }
+
+    return writer->status;
+}
+
+int telemetryWriterAppend(TelemetryWriter *writer,
+                          const void *const *columns,
+                          size_t count)
+{
+    if (!writer->file || writer->status != 0)
+    {
+        return -1;
+    }
+
+    const double *timeSec = columns[0];
+    double lastTimeSec = writer->lastTimeSec;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!(timeSec[i] >= lastTimeSec))
+        {
+            return -1;
+        }
+
+        lastTimeSec = timeSec[i];
+    }
+
+    writer->lastTimeSec = lastTimeSec;
+
+    size_t row = 0;
+
+    while (row < count)
+    {
+        size_t span = writer->blockRows - writer->buffered;
+
+        if (span > count - row)
+        {
+            span = count - row;
+        }
+
+        for (size_t c = 0; c < writer->columnCount; c++)
+        {
+            size_t size = telemetryTypeSize((TelemetryType)writer->columns[c].type);
+
+            memcpy((uint8_t *)writer->buffers[c] + writer->buffered * size,
+                   (const uint8_t *)columns[c] + row * size,
+                   span * size);
+        }
+
+        writer->buffered += span;
+        row += span;
+
+        if (writer->buffered == writer->blockRows && telemetryWriterFlush(writer) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int telemetryWriterClose(TelemetryWriter *writer)
+{
+    if (!writer->file)
+    {
+        return -1;
+    }
+
+    telemetryWriterFlush(writer);
+    telemetryPad(writer);
+
+    TelemetryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, telemetryMagic, sizeof(header.magic));
+    header.version = TELEMETRY_VERSION;
+    header.byteOrder = TELEMETRY_BYTE_ORDER;
+    header.columnCount = (uint32_t)writer->columnCount;
+    header.blockRows = (uint32_t)writer->blockRows;
+    header.rowCount = writer->rowCount;
+    header.blockCount = writer->blockCount;
+    header.indexOffset = writer->offset;
+
+    telemetryWrite(writer, writer->blocks, writer->blockCount * sizeof(TelemetryBlockInfo));
+    telemetryWrite(writer, writer->chunks, writer->blockCount * writer->columnCount * sizeof(TelemetryChunkInfo));
+
+    // Only a file whose blocks and index all made it gets a real header.
+    if (writer->status == 0 &&
+        (fseek(writer->file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, writer->file) != 1))
+    {
+        writer->status = -1;
+    }
+
+    if (fclose(writer->file) != 0)
+    {
+        writer->status = -1;
+    }
+
+    writer->file = NULL;
+    telemetryWriterRelease(writer);
+
+    return writer->status;
+}
+
+// Reader
+
+static int telemetryStoreValidate(TelemetryStore *store)
+{
+    const TelemetryFileHeader *header = (const TelemetryFileHeader *)store->map;
+    size_t size = store->mapSize;
+
+    if (memcmp(header->magic, telemetryMagic, sizeof(header->magic)) != 0 ||
+        header->version != TELEMETRY_VERSION || header->byteOrder != TELEMETRY_BYTE_ORDER ||
+        header->columnCount == 0 || header->columnCount > TELEMETRY_MAX_COLUMNS || header->blockRows == 0)
+    {
+        return -1;
+    }
+
+    size_t columnCount = header->columnCount;
+
+    if (sizeof(TelemetryFileHeader) + columnCount * sizeof(TelemetryColumnInfo) > size)
+    {
+        return -1;
+    }
+
+    const TelemetryColumnInfo *columns = (const TelemetryColumnInfo *)(store->map + sizeof(TelemetryFileHeader));
+
+    for (size_t c = 0; c < columnCount; c++)
+    {
+        if (columns[c].type >= TelemetryTypeCount || !memchr(columns[c].name, '\0', TELEMETRY_NAME_SIZE))
+        {
+            return -1;
+        }
+    }
+
+    if (columns[0].type != TelemetryTypeF64)
+    {
+        return -1;
+    }
+
+    // The index runs from indexOffset to the end of the file.
+    uint64_t indexOffset = header->indexOffset;
+    uint64_t blockSize = sizeof(TelemetryBlockInfo) + columnCount * sizeof(TelemetryChunkInfo);
+
+    if (indexOffset == 0 || indexOffset % TELEMETRY_ALIGNMENT != 0 || indexOffset > size ||
+        header->blockCount > (size - indexOffset) / blockSize)
+    {
+        return -1;
+    }
+
+    size_t blockCount = (size_t)header->blockCount;
+    const TelemetryBlockInfo *blocks = (const TelemetryBlockInfo *)(store->map + indexOffset);
+    const TelemetryChunkInfo *chunks = (const TelemetryChunkInfo *)(blocks + blockCount);
+    uint64_t rows = 0;
+
+    for (size_t b = 0; b < blockCount; b++)
+    {
+        if (blocks[b].firstRow != rows || blocks[b].rows == 0 || blocks[b].rows > header->blockRows)
+        {
+            return -1;
+        }
+
+        for (size_t c = 0; c < columnCount; c++)
+        {
+            uint64_t offset = chunks[b * columnCount + c].offset;
+            uint64_t bytes = blocks[b].rows * telemetryTypeSize((TelemetryType)columns[c].type);
+
+            if (offset % TELEMETRY_ALIGNMENT != 0 || offset > indexOffset || bytes > indexOffset - offset)
+            {
+                return -1;
+            }
+        }
+
+        rows += blocks[b].rows;
+    }
+
+    if (rows != header->rowCount)
+    {
+        return -1;
+    }
+
+    store->columns = columns;
+    store->blocks = blocks;
+    store->chunks = chunks;
+    store->columnCount = columnCount;
+    store->blockCount = blockCount;
+    store->blockRows = header->blockRows;
+    store->rowCount = header->rowCount;
+
+    return 0;
+}
+
+int telemetryStoreOpen(TelemetryStore *store, const char *path)
+{
+    memset(store, 0, sizeof(*store));
+
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat status;
+
+    if (fstat(fd, &status) != 0 || status.st_size < (off_t)sizeof(TelemetryFileHeader))
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps the file open.
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    store->map = map;
+    store->mapSize = (size_t)status.st_size;
+
+    if (telemetryStoreValidate(store) != 0)
+    {
+        telemetryStoreClose(store);
+        return -1;
+    }
+
+    return 0;
+}
+
+void telemetryStoreClose(TelemetryStore *store)
+{
+    if (store->map)
+    {
+        munmap((void *)store->map, store->mapSize);
+    }
+
+    memset(store, 0, sizeof(*store));
+}
+
+int telemetryStoreColumnIndex(const TelemetryStore *store, const char *name)
+{
+    for (size_t c = 0; c < store->columnCount; c++)
+    {
+        if (strcmp(store->columns[c].name, name) == 0)
+        {
+            return (int)c;
+        }
+    }
+
+    return -1;
+}
+
+size_t telemetryStoreBlockRows(const TelemetryStore *store, size_t block)
+{
+    return block < store->blockCount ? (size_t)store->blocks[block].rows : 0;
+}
+
+const TelemetryChunkInfo *telemetryStoreChunkInfo(const TelemetryStore *store,
+                                                  size_t block,
+                                                  size_t column)
+{
+    if (block >= store->blockCount || column >= store->columnCount)
+    {
+        return NULL;
+    }
+
+    return &store->chunks[block * store->columnCount + column];
+}
+
+const void *telemetryStoreChunk(const TelemetryStore *store,
+                                size_t block,
+                                size_t column)
+{
+    const TelemetryChunkInfo *chunk = telemetryStoreChunkInfo(store, block, column);
+
+    return chunk ? store->map + chunk->offset : NULL;
+}
+
+const double *telemetryStoreChunkF64(const TelemetryStore *store,
+                                     size_t block,
+                                     size_t column)
+{
+    if (column >= store->columnCount || store->columns[column].type != TelemetryTypeF64)
+    {
+        return NULL;
+    }
+
+    return telemetryStoreChunk(store, block, column);
+}
+
+int telemetryStoreBlockMayMatch(const TelemetryStore *store,
+                                size_t block,
+                                const TelemetryRange *ranges,
+                                size_t rangeCount)
+{
+    for (size_t r = 0; r < rangeCount; r++)
+    {
+        const TelemetryChunkInfo *chunk = telemetryStoreChunkInfo(store, block, ranges[r].column);
+
+        // All-NaN chunks have NaN bounds and never match.
+        if (!chunk || !(chunk->max >= ranges[r].min && chunk->min <= ranges[r].max))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+size_t telemetryStoreSelectBlocks(const TelemetryStore *store,
+                                  const TelemetryRange *ranges,
+                                  size_t rangeCount,
+                                  size_t *blocks)
+{
+    size_t count = 0;
+
+    for (size_t b = 0; b < store->blockCount; b++)
+    {
+        if (telemetryStoreBlockMayMatch(store, b, ranges, rangeCount))
+        {
+            blocks[count++] = b;
+        }
+    }
+
+    return count;
+}
+
+// First row with a timestamp of at least timeSec
+static size_t timeLowerBound(const double *timeSec, size_t count, double value)
+{
+    size_t low = 0;
+    size_t high = count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (timeSec[middle] < value)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+void telemetryStoreTimeRows(const TelemetryStore *store,
+                            size_t block,
+                            double startSec,
+                            double endSec,
+                            size_t *firstRow,
+                            size_t *rowCount)
+{
+    const double *timeSec = telemetryStoreChunkF64(store, block, 0);
+    size_t rows = telemetryStoreBlockRows(store, block);
+
+    *firstRow = 0;
+    *rowCount = 0;
+
+    if (!timeSec || !(startSec < endSec))
+    {
+        return;
+    }
+
+    size_t first = timeLowerBound(timeSec, rows, startSec);
+    size_t last = timeLowerBound(timeSec + first, rows - first, endSec) + first;
+
+    *firstRow = first;
+    *rowCount = last - first;
+}
+
+size_t telemetryStoreEvaluate(const TelemetryStore *store,
+                              const CompulationFunction *function,
+                              const size_t *columns,
+                              size_t block,
+                              double *results)
+{
+    const double *arguments[COMPULATION_MAX_ARITY];
+
+    if (!function || function->arity > COMPULATION_MAX_ARITY || block >= store->blockCount)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < function->arity; i++)
+    {
+        arguments[i] = telemetryStoreChunkF64(store, block, columns[i]);
+
+        if (!arguments[i])
+        {
+            return 0;
+        }
+    }
+
+    size_t rows = telemetryStoreBlockRows(store, block);
+    function->evaluateColumns(arguments, results, rows);
+
+    return rows;
+}
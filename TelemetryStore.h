@@ -0,0 +1,240 @@
+//
+//  TelemetryStore.h
+//
+//  Columnar compressor telemetry on disk, memory-mapped so the batch
+//  calculations read it in place.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TelemetryStore_h
+#define TelemetryStore_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "FunctionTable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRY_MAX_COLUMNS 32
+#define TELEMETRY_NAME_SIZE 32
+#define TELEMETRY_DEFAULT_BLOCK_ROWS 65536
+
+// Every chunk starts on this boundary, so mapped columns are as aligned as
+// malloc'd ones for the SIMD kernels.
+#define TELEMETRY_ALIGNMENT 64
+
+// Column 0 is always the timestamp: Unix time in seconds, F64, never
+// decreasing. The integer types hold raw counts for sensorChannelConvert*.
+typedef enum TelemetryType
+{
+    TelemetryTypeF64 = 0,
+    TelemetryTypeF32,
+    TelemetryTypeI32,
+    TelemetryTypeI16,
+    TelemetryTypeU16,
+    TelemetryTypeU8,
+    TelemetryTypeCount
+} TelemetryType;
+
+// File layout, in the byte order of the machine that wrote it:
+//
+//   TelemetryFileHeader
+//   TelemetryColumnInfo[columnCount]
+//   Blocks of up to blockRows rows, each one chunk per column
+//   TelemetryBlockInfo[blockCount]
+//   TelemetryChunkInfo[blockCount * columnCount], block by block
+//
+// The header is written again on close; a file that was never closed has an
+// indexOffset of 0 and is refused.
+typedef struct TelemetryFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t columnCount;
+    uint32_t blockRows;
+    uint64_t rowCount;
+    uint64_t blockCount;
+    uint64_t indexOffset;
+    uint8_t reserved[16];
+} TelemetryFileHeader;
+
+typedef struct TelemetryColumnInfo
+{
+    char name[TELEMETRY_NAME_SIZE];
+    uint32_t type;
+    uint32_t reserved;
+} TelemetryColumnInfo;
+
+typedef struct TelemetryBlockInfo
+{
+    uint64_t firstRow;
+    uint64_t rows;
+} TelemetryBlockInfo;
+
+// min and max skip NaNs, and are both NaN if every value is.
+typedef struct TelemetryChunkInfo
+{
+    uint64_t offset;
+    double min;
+    double max;
+} TelemetryChunkInfo;
+
+typedef struct TelemetryColumnSpec
+{
+    const char *name;
+    TelemetryType type;
+} TelemetryColumnSpec;
+
+typedef struct TelemetryWriter
+{
+    FILE *file;
+    uint64_t offset;
+    size_t columnCount;
+    size_t blockRows;
+    TelemetryColumnInfo columns[TELEMETRY_MAX_COLUMNS];
+
+    // The block being filled
+    void *buffers[TELEMETRY_MAX_COLUMNS];
+    size_t buffered;
+    double lastTimeSec;
+
+    // Index of the blocks written so far
+    TelemetryBlockInfo *blocks;
+    TelemetryChunkInfo *chunks;
+    size_t blockCount;
+    size_t blockCapacity;
+    uint64_t rowCount;
+    int status;
+} TelemetryWriter;
+
+typedef struct TelemetryStore
+{
+    const uint8_t *map;
+    size_t mapSize;
+
+    // Point into the map
+    const TelemetryColumnInfo *columns;
+    const TelemetryBlockInfo *blocks;
+    const TelemetryChunkInfo *chunks;
+
+    size_t columnCount;
+    size_t blockCount;
+    size_t blockRows;
+    uint64_t rowCount;
+} TelemetryStore;
+
+// Inclusive bounds on one column, for skipping blocks by their statistics
+typedef struct TelemetryRange
+{
+    size_t column;
+    double min;
+    double max;
+} TelemetryRange;
+
+size_t telemetryTypeSize(TelemetryType type);
+
+// Creates path, replacing any file there. columns[0] must be an F64
+// timestamp. blockRows of 0 picks TELEMETRY_DEFAULT_BLOCK_ROWS. Returns 0,
+// or -1 on bad arguments or if the file can't be created.
+int telemetryWriterOpen(TelemetryWriter *writer,
+                        const char *path,
+                        const TelemetryColumnSpec *columns,
+                        size_t columnCount,
+                        size_t blockRows);
+
+// Appends count rows; columns[c] points at count values of column c's type.
+// Returns 0, or -1 if a timestamp goes backwards or is NaN (nothing is
+// appended) or writing failed.
+int telemetryWriterAppend(TelemetryWriter *writer,
+                          const void *const *columns,
+                          size_t count);
+
+// Writes the last block and the index, and frees the writer. Returns 0, or
+// -1 if anything since telemetryWriterOpen failed.
+int telemetryWriterClose(TelemetryWriter *writer);
+
+// Maps path read-only. Returns 0, or -1 if it can't be mapped or isn't a
+// complete telemetry file from a machine of the same byte order.
+int telemetryStoreOpen(TelemetryStore *store, const char *path);
+
+void telemetryStoreClose(TelemetryStore *store);
+
+// -1 if there is no such column
+int telemetryStoreColumnIndex(const TelemetryStore *store, const char *name);
+
+size_t telemetryStoreBlockRows(const TelemetryStore *store, size_t block);
+
+const TelemetryChunkInfo *telemetryStoreChunkInfo(const TelemetryStore *store,
+                                                  size_t block,
+                                                  size_t column);
+
+// Values of one column in one block, in the mapped file. Cast to the
+// column's type. NULL if block or column is out of range.
+const void *telemetryStoreChunk(const TelemetryStore *store,
+                                size_t block,
+                                size_t column);
+
+// Same as telemetryStoreChunk, but NULL unless the column is F64
+const double *telemetryStoreChunkF64(const TelemetryStore *store,
+                                     size_t block,
+                                     size_t column);
+
+// 1 if the block's min/max say some row may have every column within its
+// range, 0 if no row can.
+int telemetryStoreBlockMayMatch(const TelemetryStore *store,
+                                size_t block,
+                                const TelemetryRange *ranges,
+                                size_t rangeCount);
+
+// Fills blocks, which has room for blockCount entries, with the blocks that
+// may match, in order, and returns how many there are.
+size_t telemetryStoreSelectBlocks(const TelemetryStore *store,
+                                  const TelemetryRange *ranges,
+                                  size_t rangeCount,
+                                  size_t *blocks);
+
+// The rows of block with timestamps in [startSec, endSec), by binary search
+// of column 0.
+void telemetryStoreTimeRows(const TelemetryStore *store,
+                            size_t block,
+                            double startSec,
+                            double endSec,
+                            size_t *firstRow,
+                            size_t *rowCount);
+
+// Runs function->evaluateColumns on one block with no copy; argument i is
+// column columns[i], which must be F64. results has room for
+// telemetryStoreBlockRows. Returns the number of rows, or 0 on bad arguments.
+size_t telemetryStoreEvaluate(const TelemetryStore *store,
+                              const CompulationFunction *function,
+                              const size_t *columns,
+                              size_t block,
+                              double *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TelemetryStore_h */
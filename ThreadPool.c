@@ -0,0 +1,345 @@
+//
+//  ThreadPool.c
+//
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPool.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// A worker's share of the chunks, [begin, end) packed into one word so the
+// owner and thieves can both update it with a single compare-and-swap.
+typedef struct WorkerRange
+{
+    _Atomic uint64_t range;
+    char padding[64 - sizeof(uint64_t)];
+} WorkerRange;
+
+typedef struct WorkerStart
+{
+    ThreadPool *pool;
+    size_t worker;
+} WorkerStart;
+
+struct ThreadPool
+{
+    size_t size;
+    pthread_t *threads;
+    WorkerStart *starts;
+    WorkerRange *ranges;
+
+    pthread_mutex_t callLock;
+    pthread_mutex_t lock;
+    pthread_cond_t startCondition;
+    pthread_cond_t doneCondition;
+    unsigned long generation;
+    size_t busyWorkers;
+    int shutdown;
+
+    // Current job
+    ThreadPoolBody body;
+    void *context;
+    size_t count;
+    size_t grain;
+    atomic_size_t remainingChunks;
+};
+
+static inline uint64_t packRange(uint32_t begin, uint32_t end)
+{
+    return ((uint64_t)end << 32) | begin;
+}
+
+static inline uint32_t rangeBegin(uint64_t range)
+{
+    return (uint32_t)range;
+}
+
+static inline uint32_t rangeEnd(uint64_t range)
+{
+    return (uint32_t)(range >> 32);
+}
+
+static void runChunk(ThreadPool *pool, uint32_t chunk, size_t worker)
+{
+    size_t begin = (size_t)chunk * pool->grain;
+    size_t end = begin + pool->grain < pool->count ? begin + pool->grain : pool->count;
+
+    pool->body(pool->context, begin, end, worker);
+    atomic_fetch_sub_explicit(&pool->remainingChunks, 1, memory_order_acq_rel);
+}
+
+static void runJob(ThreadPool *pool, size_t worker)
+{
+    WorkerRange *own = &pool->ranges[worker];
+
+    for (;;)
+    {
+        uint64_t range = atomic_load_explicit(&own->range, memory_order_acquire);
+        uint32_t begin = rangeBegin(range);
+        uint32_t end = rangeEnd(range);
+
+        // Own work first, from the front
+        if (begin < end)
+        {
+            if (atomic_compare_exchange_weak_explicit(&own->range, &range, packRange(begin + 1, end),
+                                                      memory_order_acq_rel, memory_order_acquire))
+            {
+                runChunk(pool, begin, worker);
+            }
+
+            continue;
+        }
+
+        if (atomic_load_explicit(&pool->remainingChunks, memory_order_acquire) == 0)
+        {
+            return;
+        }
+
+        // Steal the back half of the largest share
+        size_t victim = worker;
+        uint32_t largest = 0;
+
+        for (size_t i = 0; i < pool->size; i++)
+        {
+            uint64_t other = atomic_load_explicit(&pool->ranges[i].range, memory_order_relaxed);
+            uint32_t size = rangeEnd(other) > rangeBegin(other) ? rangeEnd(other) - rangeBegin(other) : 0;
+
+            if (i != worker && size > largest)
+            {
+                largest = size;
+                victim = i;
+            }
+        }
+
+        if (largest == 0)
+        {
+            // The last chunks are running elsewhere
+            sched_yield();
+            continue;
+        }
+
+        range = atomic_load_explicit(&pool->ranges[victim].range, memory_order_acquire);
+        begin = rangeBegin(range);
+        end = rangeEnd(range);
+
+        if (begin >= end)
+        {
+            continue;
+        }
+
+        uint32_t middle = begin + (end - begin) / 2;
+
+        if (atomic_compare_exchange_strong_explicit(&pool->ranges[victim].range, &range, packRange(begin, middle),
+                                                    memory_order_acq_rel, memory_order_acquire))
+        {
+            atomic_store_explicit(&own->range, packRange(middle, end), memory_order_release);
+        }
+    }
+}
+
+static void *workerMain(void *argument)
+{
+    WorkerStart *start = argument;
+    ThreadPool *pool = start->pool;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (;;)
+    {
+        while (!pool->shutdown && pool->generation == seen)
+        {
+            pthread_cond_wait(&pool->startCondition, &pool->lock);
+        }
+
+        if (pool->shutdown)
+        {
+            break;
+        }
+
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        runJob(pool, start->worker);
+
+        pthread_mutex_lock(&pool->lock);
+
+        if (--pool->busyWorkers == 0)
+        {
+            pthread_cond_signal(&pool->doneCondition);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+ThreadPool *threadPoolCreate(size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = online > 0 ? (size_t)online : 1;
+    }
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    pool->size = threadCount;
+    pool->threads = calloc(threadCount, sizeof(pthread_t));
+    pool->starts = calloc(threadCount, sizeof(WorkerStart));
+    pool->ranges = calloc(threadCount, sizeof(WorkerRange));
+
+    if (!pool->threads || !pool->starts || !pool->ranges)
+    {
+        free(pool->threads);
+        free(pool->starts);
+        free(pool->ranges);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->callLock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->startCondition, NULL);
+    pthread_cond_init(&pool->doneCondition, NULL);
+
+    // Worker 0 is the calling thread
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        pool->starts[i].pool = pool;
+        pool->starts[i].worker = i;
+
+        if (pthread_create(&pool->threads[i], NULL, workerMain, &pool->starts[i]) != 0)
+        {
+            pool->size = i;
+            threadPoolDestroy(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void threadPoolDestroy(ThreadPool *pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->startCondition);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 1; i < pool->size; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->doneCondition);
+    pthread_cond_destroy(&pool->startCondition);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->callLock);
+
+    free(pool->threads);
+    free(pool->starts);
+    free(pool->ranges);
+    free(pool);
+}
+
+size_t threadPoolSize(const ThreadPool *pool)
+{
+    return pool->size;
+}
+
+void threadPoolParallelFor(ThreadPool *pool,
+                           size_t count,
+                           size_t grain,
+                           ThreadPoolBody body,
+                           void *context)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    grain = grain < 1 ? 1 : grain;
+
+    // Chunk indices have to fit the packed 32-bit ranges.
+    if ((count - 1) / grain >= UINT32_MAX)
+    {
+        grain = count / UINT32_MAX + 1;
+    }
+
+    if (pool->size == 1)
+    {
+        body(context, 0, count, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->callLock);
+
+    size_t chunks = (count + grain - 1) / grain;
+
+    pool->body = body;
+    pool->context = context;
+    pool->count = count;
+    pool->grain = grain;
+    atomic_store_explicit(&pool->remainingChunks, chunks, memory_order_relaxed);
+
+    for (size_t i = 0; i < pool->size; i++)
+    {
+        uint32_t begin = (uint32_t)(chunks * i / pool->size);
+        uint32_t end = (uint32_t)(chunks * (i + 1) / pool->size);
+        atomic_store_explicit(&pool->ranges[i].range, packRange(begin, end), memory_order_relaxed);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->busyWorkers = pool->size - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->startCondition);
+    pthread_mutex_unlock(&pool->lock);
+
+    runJob(pool, 0);
+
+    // Workers may still be leaving runJob; the job fields stay valid until then.
+    pthread_mutex_lock(&pool->lock);
+
+    while (pool->busyWorkers > 0)
+    {
+        pthread_cond_wait(&pool->doneCondition, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->callLock);
+}
@@ -0,0 +1,63 @@
+//
+//  ThreadPool.h
+//
+//  Work-stealing parallel-for used by the multi-threaded engines.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ThreadPool ThreadPool;
+
+// Runs items [begin, end) on worker number worker, which is below
+// threadPoolSize() and stable for the duration of the call, so it can index
+// per-thread state.
+typedef void (*ThreadPoolBody)(void *context, size_t begin, size_t end, size_t worker);
+
+// threadCount 0 means one thread per online CPU. The calling thread counts as
+// worker 0, so a pool of one thread runs everything inline. Returns NULL if
+// the threads cannot be started.
+ThreadPool *threadPoolCreate(size_t threadCount);
+void threadPoolDestroy(ThreadPool *pool);
+
+size_t threadPoolSize(const ThreadPool *pool);
+
+// Splits [0, count) into chunks of grain items. Each worker starts on its own
+// contiguous share of the chunks and, once that is done, steals half of the
+// largest remaining share it finds. Returns when every item has run. Calls
+// from different threads on one pool are serialized.
+void threadPoolParallelFor(ThreadPool *pool,
+                           size_t count,
+                           size_t grain,
+                           ThreadPoolBody body,
+                           void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ThreadPool_h */
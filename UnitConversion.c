@@ -21,4 +21,4 @@
  along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#import "UnitConversion.h"
+#include "UnitConversion.h"
@@ -21,7 +21,10 @@
  along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "math.h"
+#ifndef UnitConversion_h
+#define UnitConversion_h
+
+#include <math.h>
 
 // Motor speed
 static inline double frequencyFromSynchronousSpeedAndPoles(double speed, int poles){return (poles * speed) / 120.0;};
@@ -89,3 +92,5 @@ static inline double m3MinuteFromCFM(double cfm){return cfm / 35.3146667;};
 // Force
 static inline double newtonsFromPounds(double pounds){return pounds * 4.44822162825;};
 static inline double poundsFromNewtons(double newtons){return newtons / 4.44822162825;};
+
+#endif /* UnitConversion_h */
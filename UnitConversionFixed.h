@@ -0,0 +1,81 @@
+//
+//  UnitConversionFixed.h
+//
+//  Q16.16 fixed point versions of the pressure conversions in
+//  UnitConversion.h, named with a Q16 suffix, for controllers without an FPU.
+//  Integer arithmetic only, apart from the q16FromDouble and q16ToDouble
+//  helpers for the host side.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UnitConversionFixed_h
+#define UnitConversionFixed_h
+
+#include <stdint.h>
+
+// Signed Q16.16: value * 65536 in an int32_t. Covers -32768 to just under
+// 32768 in steps of 1/65536 (1.5e-5).
+typedef int32_t Q16;
+
+#define Q16_ONE ((Q16)0x00010000)
+#define Q16_MAX ((Q16)INT32_MAX)
+#define Q16_MIN ((Q16)INT32_MIN)
+
+// Results outside the Q16 range saturate to Q16_MAX or Q16_MIN rather than
+// wrapping.
+static inline Q16 q16Saturate(int64_t value){return value > Q16_MAX ? Q16_MAX : (value < Q16_MIN ? Q16_MIN : (Q16)value);};
+
+// Host side; rounds to nearest and saturates, NaN gives 0.
+static inline Q16 q16FromDouble(double value){double scaled = value * 65536.0; return scaled != scaled ? 0 : (scaled >= 2147483647.0 ? Q16_MAX : (scaled <= -2147483648.0 ? Q16_MIN : (Q16)(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5)));};
+static inline double q16ToDouble(Q16 value){return value / 65536.0;};
+
+// x * multiplier / 2^shift, rounded half up. Each conversion factor is
+// stored with 31 significant bits, within 5e-10 of the double constant, so
+// results are the double result rounded to Q16, give or take one step.
+// Assumes >> on a negative int64_t is arithmetic, as it is on GCC, Clang and
+// every ARM compiler.
+static inline Q16 q16MultiplyConstant(Q16 x, int32_t multiplier, int shift){return q16Saturate(((int64_t)x * multiplier + ((int64_t)1 << (shift - 1))) >> shift);};
+
+// Pressure. Results beyond +/-32768 saturate, which happens for inputs
+// beyond +/-8,161 kPa in inH20FromkPa, 321 kPa in mmH2OFromkPa, 1,290 inHg in
+// mmHgFromInHg, 4,368 kPa in mmHgFromkPa, 2,259 bar in psiFromBar, 9,676 inHg
+// in kPaFromInHg, 4,752 psi in kPaFromPSI and 16,094 psi in inHgFromPSI. The
+// rest cover the whole Q16 range.
+static inline Q16 barFromPSIQ16(Q16 psi){return q16MultiplyConstant(psi, 1184510284, 34);};
+static inline Q16 inH20FromkPaQ16(Q16 kPa){return q16MultiplyConstant(kPa, 1077699135, 28);};
+static inline Q16 inHgFromMmHgQ16(Q16 mmHg){return q16MultiplyConstant(mmHg, 1352745621, 35);};
+static inline Q16 inHgFromkPaQ16(Q16 kPa){return q16MultiplyConstant(kPa, 1268302992, 32);};
+static inline Q16 inHgFromPSIQ16(Q16 psi){return q16MultiplyConstant(psi, 1093082599, 29);};
+static inline Q16 kPaFromInH2OQ16(Q16 inH2O){return q16MultiplyConstant(inH2O, 2139598088, 33);};
+static inline Q16 kPaFromInHgQ16(Q16 inHg){return q16MultiplyConstant(inHg, 1818053749, 29);};
+static inline Q16 kPaFromMmH2OQ16(Q16 mmH2O){return q16MultiplyConstant(mmH2O, 1347815713, 37);};
+static inline Q16 kPaFromMmHgQ16(Q16 mmHg){return q16MultiplyConstant(mmHg, 1145230199, 33);};
+static inline Q16 kPaFromPSIQ16(Q16 PSI){return q16MultiplyConstant(PSI, 1850797318, 28);};
+static inline Q16 mmH2OFromkPaQ16(Q16 kPa){return q16MultiplyConstant(kPa, 1710799916, 24);};
+static inline Q16 mmHgFromInHgQ16(Q16 inHg){return q16MultiplyConstant(inHg, 1704565126, 26);};
+static inline Q16 mmHgFromkPaQ16(Q16 kPa){return q16MultiplyConstant(kPa, 2013431894, 28);};
+static inline Q16 psiFromBarQ16(Q16 bar){return q16MultiplyConstant(bar, 1946663563, 27);};
+static inline Q16 psiFromInHgQ16(Q16 inHg){return q16MultiplyConstant(inHg, 2109486522, 32);};
+static inline Q16 psiFromkPaQ16(Q16 kPa){return q16MultiplyConstant(kPa, 1245864680, 33);};
+
+// Volume, for leakRateCFMQ16
+static inline Q16 cubicFeetFromGallonsQ16(Q16 gal){return q16MultiplyConstant(gal, 1148307229, 33);};
+
+#endif /* UnitConversionFixed_h */
@@ -0,0 +1,97 @@
+//
+//  UnitConversionFloat.h
+//
+//  Single precision versions of UnitConversion.h, named with an f suffix.
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+ 
+ This file is part of Compulations.
+ 
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UnitConversionFloat_h
+#define UnitConversionFloat_h
+
+#include <math.h>
+
+// Motor speed
+static inline float frequencyFromSynchronousSpeedAndPolesf(float speed, int poles){return (poles * speed) / 120.0f;};
+static inline int numberOfPolesFromSynchronousSpeedAndFrequencyf(float speed, float hz){return (int)(120.0f * hz) / speed;};
+static inline float synchronousMotorSpeedForFrequencyAndPolesf(float hz, int poles){return (120.0f * hz) / poles;};
+
+// Temperature
+static inline float celsiusFromFahrenheitf(float f){return (f - 32.0f) * (5.0f / 9.0f);};
+static inline float celsiusFromKelvinf(float k){return k - 273.15f;};
+static inline float fahrenheitFromCelsiusf(float c){return  (c * 1.8f) + 32.0f;};
+static inline float fahrenheitFromKelvinf(float k){return (k - 273.15f) * 1.8f + 32.0f;};
+static inline float fahrenheitFromRankinef(float r){return r - 459.67f;};
+static inline float kelvinFromCelsiusf(float c){return c + 273.15f;};
+static inline float kelvinFromFahrenheitf(float f){return ((f - 32.0f) * (5.0f / 9.0f)) + 273.15f;};
+static inline float rankineFromFahrenheitf(float f){return f + 459.67f;};
+
+// Pressure
+static inline float barFromPSIf(float psi){return psi / 14.503773773020923f;};
+static inline float inH20FromkPaf(float kPa){return kPa * 4.01474213311f;};
+static inline float inHgFromMmHgf(float mmHg){return mmHg / 25.399999705f;};
+static inline float inHgFromkPaf(float kPa){return kPa * 0.295299802f;};
+static inline float inHgFromPSIf(float psi){return psi * 2.036025f;};
+static inline float kPaFromInH2Of(float inH2O){return inH2O / 4.01474213311f;};
+static inline float kPaFromInHgf(float inHg){return inHg / 0.295299802f;};
+static inline float kPaFromMmH2Of(float mmH2O){return mmH2O / 101.971621298f;};
+static inline float kPaFromMmHgf(float mmHg){return mmHg / 7.5006183f;};
+static inline float kPaFromPSIf(float PSI){return PSI / 0.14503773773020923f;};
+static inline float mmH2OFromkPaf(float kPa){return kPa * 101.971621298f;};
+static inline float mmHgFromInHgf(float inHg){return inHg * 25.399999705f;};
+static inline float mmHgFromkPaf(float kPa){return kPa * 7.5006183f;};
+static inline float psiFromBarf(float bar){return bar * 14.503773773020923f;};
+static inline float psiFromInHgf(float inHg){return inHg / 2.036025f;};
+static inline float psiFromkPaf(float kPa){return kPa * 0.14503773773020923f;};
+
+// Length
+static inline float inFromMillimeterf(float mm){return mm / 25.4f;};
+static inline float feetFromMetersf(float meters){return meters * 3.2808399f;};
+static inline float metersFromFeetf(float feet){return feet / 3.2808399f;};
+static inline float mmFromInchf(float inch){return inch * 25.4f;};
+
+// Volume
+static inline float cubicFeetFromGallonsf(float gal){return gal / 7.48051948f;};
+static inline float cubicFeetFromCubicMetersf(float m){return m * 35.3146667f;};
+static inline float cubicMetersFromCubicFeetf(float ft){return ft / 35.3146667f;};
+static inline float gallonsFromCubicFeetf(float ft){return ft * 7.48051948f;};
+static inline float gallonsFromLitersf(float liters){return liters / 3.78541178f;};
+static inline float litersFromGallonsf(float gallons){return gallons * 3.78541178f;};
+
+// Power
+static inline float hpFromKwf(float kw){return kw / 0.745699872f;};
+static inline float kwFromHPf(float hp){return hp * 0.745699872f;};
+
+// Voltage
+static inline float voltsPeakFromVoltsRmsf(float vrms){return vrms * sqrtf(2.0f);};
+static inline float voltsRmsFromVoltsPeakf(float vp){return vp / sqrtf(2.0f);};
+
+// Amps
+static inline float ampsFLAFromWyeDeltaf(float wda){return wda * sqrtf(3.0f);};
+static inline float ampsWyeDeltaFromFLAf(float fla){return fla / sqrtf(3.0f);};
+
+// Flow
+static inline float cfmFromM3minutef(float m3m){return m3m * 35.3146667f;};
+static inline float m3MinuteFromCFMf(float cfm){return cfm / 35.3146667f;};
+
+// Force
+static inline float newtonsFromPoundsf(float pounds){return pounds * 4.44822162825f;};
+static inline float poundsFromNewtonsf(float newtons){return newtons / 4.44822162825f;};
+
+#endif /* UnitConversionFloat_h */
@@ -0,0 +1,287 @@
+//
+//  Units.hpp
+//
+//  Strongly typed pressure, temperature, flow, volume and power for the
+//  C++ build. A Quantity carries its unit in its type, so passing a flow
+//  where a pressure belongs does not compile. Converting between two units
+//  of the same kind is one multiply and, for temperatures, one add, using
+//  a factor and offset the compiler works out from the two unit definitions.
+//
+//  Quantity<Celsius> t = Quantity<Fahrenheit>(68.0);
+//  Quantity<CFM> scfm = units::scfmFromACFM(Quantity<CubicMetersPerMinute>(20.0), ...);
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Units_hpp
+#define Units_hpp
+
+#include "Compulations.hpp"
+
+#include <type_traits>
+
+namespace compulations
+{
+namespace units
+{
+
+// Kinds of quantity. Units of different kinds never convert.
+struct PressureDimension {};
+struct TemperatureDimension {};
+struct FlowDimension {};
+struct VolumeDimension {};
+struct PowerDimension {};
+
+// Each unit maps onto its kind's base unit as base = value * scale + offset.
+// The bases are psi, degrees Fahrenheit, cfm, cubic feet and horsepower,
+// and the factors are the ones in UnitConversion.h; inches and millimeters
+// of mercury go through its kPa factors, which agree with each other where
+// 2.036025 inHg/psi does not. Temperatures use 1.8 in double throughout,
+// not the float 5/9 in celsiusFromFahrenheit. Gauge and absolute pressures
+// share units.
+#define COMPULATIONS_UNIT(Name, Dimension, Scale, Offset)   \
+    struct Name                                             \
+    {                                                       \
+        using dimension = Dimension;                        \
+        static constexpr double scale = (Scale);            \
+        static constexpr double offset = (Offset);          \
+    }
+
+COMPULATIONS_UNIT(PSI, PressureDimension, 1.0, 0.0);
+COMPULATIONS_UNIT(Bar, PressureDimension, 14.503773773020923, 0.0);
+COMPULATIONS_UNIT(KPa, PressureDimension, 0.14503773773020923, 0.0);
+COMPULATIONS_UNIT(InHg, PressureDimension, 0.14503773773020923 / 0.295299802, 0.0);
+COMPULATIONS_UNIT(MmHg, PressureDimension, 0.14503773773020923 / 7.5006183, 0.0);
+COMPULATIONS_UNIT(InH2O, PressureDimension, 0.14503773773020923 / 4.01474213311, 0.0);
+COMPULATIONS_UNIT(MmH2O, PressureDimension, 0.14503773773020923 / 101.971621298, 0.0);
+
+COMPULATIONS_UNIT(Fahrenheit, TemperatureDimension, 1.0, 0.0);
+COMPULATIONS_UNIT(Celsius, TemperatureDimension, 1.8, 32.0);
+COMPULATIONS_UNIT(Kelvin, TemperatureDimension, 1.8, -459.67);
+COMPULATIONS_UNIT(Rankine, TemperatureDimension, 1.0, -459.67);
+
+COMPULATIONS_UNIT(CFM, FlowDimension, 1.0, 0.0);
+COMPULATIONS_UNIT(CubicMetersPerMinute, FlowDimension, 35.3146667, 0.0);
+COMPULATIONS_UNIT(CubicMetersPerHour, FlowDimension, 35.3146667 / 60.0, 0.0);
+COMPULATIONS_UNIT(LitersPerSecond, FlowDimension, 35.3146667 * 0.06, 0.0);
+
+COMPULATIONS_UNIT(CubicFeet, VolumeDimension, 1.0, 0.0);
+COMPULATIONS_UNIT(CubicMeters, VolumeDimension, 35.3146667, 0.0);
+COMPULATIONS_UNIT(Gallons, VolumeDimension, 1.0 / 7.48051948, 0.0);
+COMPULATIONS_UNIT(Liters, VolumeDimension, 1.0 / (3.78541178 * 7.48051948), 0.0);
+
+COMPULATIONS_UNIT(Horsepower, PowerDimension, 1.0, 0.0);
+COMPULATIONS_UNIT(Kilowatts, PowerDimension, 1.0 / 0.745699872, 0.0);
+COMPULATIONS_UNIT(Watts, PowerDimension, 1.0 / 745.699872, 0.0);
+
+#undef COMPULATIONS_UNIT
+
+template <typename From, typename To>
+constexpr bool sameDimension = std::is_same<typename From::dimension, typename To::dimension>::value;
+
+// From one unit straight to another. A chain of conversions written by hand
+// collapses to this single factor and offset, both folded at compile time.
+template <typename From, typename To>
+struct Conversion
+{
+    static_assert(sameDimension<From, To>, "Units measure different quantities");
+
+    static constexpr double factor = From::scale / To::scale;
+    static constexpr double offset = (From::offset - To::offset) / To::scale;
+
+    static constexpr double apply(double value) noexcept
+    {
+        if constexpr (std::is_same<From, To>::value)
+        {
+            return value;
+        }
+        else if constexpr (offset == 0.0)
+        {
+            return value * factor;
+        }
+        else if constexpr (factor == 1.0)
+        {
+            return value + offset;
+        }
+        else
+        {
+            return value * factor + offset;
+        }
+    }
+};
+
+template <typename Unit>
+class Quantity
+{
+public:
+    using unit = Unit;
+    using dimension = typename Unit::dimension;
+
+    constexpr Quantity() noexcept = default;
+    constexpr explicit Quantity(double value) noexcept : value_(value) {}
+
+    // Implicit between units of the same kind only
+    template <typename Other, typename = std::enable_if_t<sameDimension<Other, Unit>>>
+    constexpr Quantity(Quantity<Other> other) noexcept : value_(Conversion<Other, Unit>::apply(other.value())) {}
+
+    constexpr double value() const noexcept { return value_; }
+
+    template <typename Other>
+    constexpr Quantity<Other> to() const noexcept { return Quantity<Other>(*this); }
+
+    constexpr Quantity operator-() const noexcept { return Quantity(-value_); }
+    constexpr Quantity &operator+=(Quantity other) noexcept { value_ += other.value_; return *this; }
+    constexpr Quantity &operator-=(Quantity other) noexcept { value_ -= other.value_; return *this; }
+    constexpr Quantity &operator*=(double scalar) noexcept { value_ *= scalar; return *this; }
+    constexpr Quantity &operator/=(double scalar) noexcept { value_ /= scalar; return *this; }
+
+    // Both sides in the same unit; convert one first with to<>()
+    friend constexpr Quantity operator+(Quantity a, Quantity b) noexcept { return Quantity(a.value_ + b.value_); }
+    friend constexpr Quantity operator-(Quantity a, Quantity b) noexcept { return Quantity(a.value_ - b.value_); }
+    friend constexpr Quantity operator*(Quantity a, double scalar) noexcept { return Quantity(a.value_ * scalar); }
+    friend constexpr Quantity operator*(double scalar, Quantity a) noexcept { return Quantity(scalar * a.value_); }
+    friend constexpr Quantity operator/(Quantity a, double scalar) noexcept { return Quantity(a.value_ / scalar); }
+    friend constexpr double operator/(Quantity a, Quantity b) noexcept { return a.value_ / b.value_; }
+
+    friend constexpr bool operator==(Quantity a, Quantity b) noexcept { return a.value_ == b.value_; }
+    friend constexpr bool operator!=(Quantity a, Quantity b) noexcept { return a.value_ != b.value_; }
+    friend constexpr bool operator<(Quantity a, Quantity b) noexcept { return a.value_ < b.value_; }
+    friend constexpr bool operator<=(Quantity a, Quantity b) noexcept { return a.value_ <= b.value_; }
+    friend constexpr bool operator>(Quantity a, Quantity b) noexcept { return a.value_ > b.value_; }
+    friend constexpr bool operator>=(Quantity a, Quantity b) noexcept { return a.value_ >= b.value_; }
+
+private:
+    double value_ = 0.0;
+};
+
+// Typed versions of the Compulations.h functions that mix several kinds of
+// quantity. Arguments in any unit of the right kind convert on the way in.
+
+// Pumpup Time in seconds
+constexpr double pumpupTimeInSeconds(Quantity<Gallons> tankSize,
+                                     Quantity<CFM> flowRate,
+                                     Quantity<PSI> startPressure,
+                                     Quantity<PSI> endPressure,
+                                     Quantity<PSI> ambientPressure) noexcept
+{
+    return compulations::pumpupTimeInSeconds(tankSize.value(), flowRate.value(), startPressure.value(),
+                                             endPressure.value(), ambientPressure.value());
+}
+
+// Leak Rate
+constexpr Quantity<CFM> leakRateCFM(Quantity<Gallons> tankSize,
+                                    Quantity<PSI> startPressure,
+                                    Quantity<PSI> endPressure,
+                                    Quantity<PSI> ambientPressure,
+                                    double decayTimeMins) noexcept
+{
+    return Quantity<CFM>(compulations::leakRateCFM(tankSize.value(), startPressure.value(), endPressure.value(),
+                                                   ambientPressure.value(), decayTimeMins));
+}
+
+// Refill Rate
+constexpr Quantity<CFM> refillRateCFM(Quantity<CubicFeet> storage,
+                                      Quantity<PSI> startPressure,
+                                      Quantity<PSI> endPressure,
+                                      double refillTimeMins,
+                                      Quantity<PSI> ambientPressure) noexcept
+{
+    return Quantity<CFM>(compulations::refillRateCFM(storage.value(), startPressure.value(), endPressure.value(),
+                                                     refillTimeMins, ambientPressure.value()));
+}
+
+// Secondary storage
+constexpr Quantity<CubicFeet> eventStorageCubicFeet(double eventDurationMins,
+                                                    Quantity<CFM> requiredForEvent,
+                                                    Quantity<CFM> meteredSupply,
+                                                    Quantity<PSI> ambientPressure,
+                                                    Quantity<PSI> initialPressure,
+                                                    Quantity<PSI> minPressureForEvent) noexcept
+{
+    return Quantity<CubicFeet>(compulations::eventStorageCubicFeet(eventDurationMins, requiredForEvent.value(),
+                                                                   meteredSupply.value(), ambientPressure.value(),
+                                                                   initialPressure.value(), minPressureForEvent.value()));
+}
+
+// Vapor pressure of water
+constexpr Quantity<PSI> vaporPressureOfWater(Quantity<Fahrenheit> temperature) noexcept
+{
+    return Quantity<PSI>(compulations::vaporPressureOfWaterInPsiForTemp(temperature.value()));
+}
+
+// ACFM SCFM conversions
+constexpr Quantity<CFM> scfmFromACFM(Quantity<CFM> acfm,
+                                     Quantity<PSI> standardAmbientPressure,
+                                     Quantity<Fahrenheit> standardAmbientTemp,
+                                     double standardAmbientRH,
+                                     Quantity<PSI> siteAmbientPressure,
+                                     Quantity<Fahrenheit> siteAmbientTemp,
+                                     double siteAmbientRH,
+                                     Quantity<PSI> inletPressure) noexcept
+{
+    return Quantity<CFM>(compulations::scfmFromACFM(acfm.value(), standardAmbientPressure.value(), standardAmbientTemp.value(),
+                                                    standardAmbientRH, siteAmbientPressure.value(), siteAmbientTemp.value(),
+                                                    siteAmbientRH, inletPressure.value()));
+}
+
+constexpr Quantity<CFM> acfmFromSCFM(Quantity<CFM> scfm,
+                                     Quantity<PSI> standardAmbientPressure,
+                                     Quantity<Fahrenheit> standardAmbientTemp,
+                                     double standardAmbientRH,
+                                     Quantity<PSI> siteAmbientPressure,
+                                     Quantity<Fahrenheit> siteAmbientTemp,
+                                     double siteAmbientRH,
+                                     Quantity<PSI> inletPressure) noexcept
+{
+    return Quantity<CFM>(compulations::acfmFromSCFM(scfm.value(), standardAmbientPressure.value(), standardAmbientTemp.value(),
+                                                    standardAmbientRH, siteAmbientPressure.value(), siteAmbientTemp.value(),
+                                                    siteAmbientRH, inletPressure.value()));
+}
+
+// Power
+constexpr Quantity<Kilowatts> threePhaseMotorInputPower(double volts,
+                                                        double amps,
+                                                        double powerFactor) noexcept
+{
+    return Quantity<Kilowatts>(compulations::threePhaseMotorInputPowerKW(volts, amps, powerFactor));
+}
+
+// Shaft Power
+constexpr Quantity<Horsepower> threePhaseShaftPower(double volts,
+                                                    double amps,
+                                                    double efficiency,
+                                                    double powerFactor) noexcept
+{
+    return Quantity<Horsepower>(compulations::threePhaseShaftPowerHP(volts, amps, efficiency, powerFactor));
+}
+
+// Oil Carryover Volume
+constexpr Quantity<Gallons> oilCarryover(Quantity<CFM> flowRate,
+                                         double concentrationPPM,
+                                         double operatingHours,
+                                         double oilSpecificGravity) noexcept
+{
+    return Quantity<Gallons>(compulations::oilCarryoverGallons(flowRate.value(), concentrationPPM,
+                                                               operatingHours, oilSpecificGravity));
+}
+
+} // namespace units
+} // namespace compulations
+
+#endif /* Units_hpp */
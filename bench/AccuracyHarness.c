@@ -0,0 +1,327 @@
+//
+//  AccuracyHarness.c
+//
+//  Maximum error of the float and mixed precision columns of every function
+//  in FunctionTable.h against the double ones, over a Latin hypercube of each
+//  function's field ranges plus every corner, with ns/call for all three.
+//  Exits 1 if any float version is off by more than the tolerance.
+//
+//  compulations_accuracy [--samples N] [--tolerance relative] [--filter text]
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FunctionTable.h"
+#include "ParameterSweep.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Each timing is the fastest of this many passes.
+#define RUNS 5
+
+// Results within this fraction of the largest result are measured against it
+// instead, so conversions that cross zero, e.g. celsiusFromFahrenheit at 32 F,
+// don't report huge relative errors from one rounding.
+#define RELATIVE_FLOOR 1e-3
+
+typedef struct Samples
+{
+    size_t count;
+    size_t arity;
+    float *floatColumns[COMPULATION_MAX_ARITY];
+    double *doubleColumns[COMPULATION_MAX_ARITY];
+} Samples;
+
+typedef struct ErrorStats
+{
+    double maxAbsolute;
+    double maxRelative;
+    size_t worst;
+} ErrorStats;
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Arguments are rounded to float first, so all three versions see the same
+// inputs and only the arithmetic differs.
+static void storeSamples(void *context,
+                         uint64_t firstIndex,
+                         const double *const *arguments,
+                         const double *results,
+                         size_t count,
+                         size_t worker)
+{
+    Samples *samples = context;
+
+    (void)results;
+    (void)worker;
+
+    for (size_t p = 0; p < samples->arity; p++)
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            float value = (float)arguments[p][k];
+
+            samples->floatColumns[p][firstIndex + k] = value;
+            samples->doubleColumns[p][firstIndex + k] = value;
+        }
+    }
+}
+
+// latinCount hypercube points, then the 2^arity corners of the ranges
+static int fillSamples(const CompulationFunction *function, size_t latinCount, Samples *samples)
+{
+    size_t corners = (size_t)1 << function->arity;
+
+    memset(samples, 0, sizeof(*samples));
+    samples->count = latinCount + corners;
+    samples->arity = function->arity;
+
+    for (size_t p = 0; p < function->arity; p++)
+    {
+        samples->floatColumns[p] = malloc(samples->count * sizeof(float));
+        samples->doubleColumns[p] = malloc(samples->count * sizeof(double));
+
+        if (!samples->floatColumns[p] || !samples->doubleColumns[p])
+        {
+            return -1;
+        }
+    }
+
+    SweepSpace space;
+    sweepSpaceInit(&space, function);
+    space.sampling = SweepSamplingLatinHypercube;
+    space.sampleCount = latinCount;
+    space.seed = 2016;
+
+    for (size_t p = 0; p < function->arity; p++)
+    {
+        space.axes[p] = (SweepAxis){ function->parameters[p].low, function->parameters[p].high, 2 };
+    }
+
+    if (parameterSweepRun(&space, NULL, storeSamples, samples, NULL) != 0)
+    {
+        return -1;
+    }
+
+    for (size_t c = 0; c < corners; c++)
+    {
+        for (size_t p = 0; p < function->arity; p++)
+        {
+            const CompulationParameter *parameter = &function->parameters[p];
+            float value = (float)((c >> p) & 1 ? parameter->high : parameter->low);
+
+            samples->floatColumns[p][latinCount + c] = value;
+            samples->doubleColumns[p][latinCount + c] = value;
+        }
+    }
+
+    return 0;
+}
+
+static void freeSamples(Samples *samples)
+{
+    for (size_t p = 0; p < samples->arity; p++)
+    {
+        free(samples->floatColumns[p]);
+        free(samples->doubleColumns[p]);
+    }
+}
+
+static ErrorStats compareResults(const double *reference, const float *results, size_t count)
+{
+    ErrorStats stats = { 0.0, 0.0, 0 };
+    double largest = 0.0;
+
+    for (size_t k = 0; k < count; k++)
+    {
+        largest = fabs(reference[k]) > largest ? fabs(reference[k]) : largest;
+    }
+
+    double floor = RELATIVE_FLOOR * largest;
+
+    for (size_t k = 0; k < count; k++)
+    {
+        double absolute = fabs((double)results[k] - reference[k]);
+        double scale = fabs(reference[k]) > floor ? fabs(reference[k]) : floor;
+        double relative = scale > 0.0 ? absolute / scale : absolute;
+
+        // NaN where the double version isn't, or the reverse, counts as
+        // infinitely wrong.
+        if (isnan(results[k]) != isnan(reference[k]))
+        {
+            absolute = INFINITY;
+            relative = INFINITY;
+        }
+        else if (isnan(reference[k]))
+        {
+            continue;
+        }
+
+        stats.maxAbsolute = absolute > stats.maxAbsolute ? absolute : stats.maxAbsolute;
+
+        if (relative > stats.maxRelative)
+        {
+            stats.maxRelative = relative;
+            stats.worst = k;
+        }
+    }
+
+    return stats;
+}
+
+// Fastest of RUNS passes, in ns per call
+static double timeDoubleColumns(const CompulationFunction *function, const Samples *samples, double *results)
+{
+    double best = INFINITY;
+
+    for (int run = 0; run < RUNS; run++)
+    {
+        double start = secondsNow();
+        function->evaluateColumns((const double *const *)samples->doubleColumns, results, samples->count);
+        double elapsed = secondsNow() - start;
+
+        best = elapsed < best ? elapsed : best;
+    }
+
+    return best * 1e9 / samples->count;
+}
+
+static double timeFloatColumns(CompulationColumnsFloat columns, const Samples *samples, float *results)
+{
+    double best = INFINITY;
+
+    for (int run = 0; run < RUNS; run++)
+    {
+        double start = secondsNow();
+        columns((const float *const *)samples->floatColumns, results, samples->count);
+        double elapsed = secondsNow() - start;
+
+        best = elapsed < best ? elapsed : best;
+    }
+
+    return best * 1e9 / samples->count;
+}
+
+int main(int argc, char **argv)
+{
+    size_t latinCount = 100000;
+    double tolerance = 1e-3;
+    const char *filter = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            latinCount = (size_t)atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+        {
+            tolerance = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--samples N] [--tolerance relative] [--filter text]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (latinCount == 0)
+    {
+        latinCount = 1;
+    }
+
+    printf("%-46s %10s %10s %10s %10s %8s %8s %8s\n", "function", "float abs", "float rel", "mixed abs",
+           "mixed rel", "double", "float", "mixed");
+
+    int failures = 0;
+
+    for (size_t i = 0; i < compulationFunctionCount(); i++)
+    {
+        const CompulationFunction *function = compulationFunctionAt(i);
+
+        if (filter && !strstr(function->name, filter))
+        {
+            continue;
+        }
+
+        Samples samples;
+        double *reference = NULL;
+        float *floatResults = NULL;
+        float *mixedResults = NULL;
+
+        if (fillSamples(function, latinCount, &samples) != 0 ||
+            !(reference = malloc(samples.count * sizeof(double))) ||
+            !(floatResults = malloc(samples.count * sizeof(float))) ||
+            !(mixedResults = malloc(samples.count * sizeof(float))))
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+
+        double doubleNs = timeDoubleColumns(function, &samples, reference);
+        double floatNs = timeFloatColumns(function->evaluateColumnsFloat, &samples, floatResults);
+        double mixedNs = timeFloatColumns(function->evaluateColumnsMixed, &samples, mixedResults);
+
+        ErrorStats floatErrors = compareResults(reference, floatResults, samples.count);
+        ErrorStats mixedErrors = compareResults(reference, mixedResults, samples.count);
+        int failed = !(floatErrors.maxRelative <= tolerance) || !(mixedErrors.maxRelative <= tolerance);
+
+        printf("%-46s %10.2e %10.2e %10.2e %10.2e %8.2f %8.2f %8.2f%s\n", function->name,
+               floatErrors.maxAbsolute, floatErrors.maxRelative, mixedErrors.maxAbsolute,
+               mixedErrors.maxRelative, doubleNs, floatNs, mixedNs, failed ? "  FAIL" : "");
+
+        // Where the float version is furthest off
+        if (failed)
+        {
+            printf("    worst at");
+
+            for (size_t p = 0; p < function->arity; p++)
+            {
+                printf(" %s=%.9g", function->parameters[p].name, samples.doubleColumns[p][floatErrors.worst]);
+            }
+
+            printf(": double %.9g float %.9g\n", reference[floatErrors.worst], floatResults[floatErrors.worst]);
+        }
+
+        failures += failed;
+
+        free(reference);
+        free(floatResults);
+        free(mixedResults);
+        freeSamples(&samples);
+    }
+
+    printf("errors are max absolute and max relative against double, times are ns/call\n");
+    printf("%d function%s over the %.0e tolerance\n", failures, failures == 1 ? "" : "s", tolerance);
+
+    return failures ? 1 : 0;
+}
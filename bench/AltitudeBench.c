@@ -0,0 +1,144 @@
+//
+//  AltitudeBench.c
+//
+//  Benchmark and accuracy check for the interpolated pressure-altitude
+//  tables against the pow() versions. Exits 1 if either table is outside
+//  its documented bound.
+//
+//  cc -O2 -I.. AltitudeBench.c ../Compulations.c ../BatchCompulations.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+#include "BatchCompulations.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SAMPLE_COUNT 1000000
+#define REPEATS 20
+
+// Documented in Compulations.h
+#define PSIA_BOUND 3e-11
+#define FEET_BOUND 2e-6
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Keeps the optimizer from dropping the timed loops
+static volatile double sink;
+
+static void timeScalar(const char *name, double (*function)(double), const double *input)
+{
+    double sum = 0.0;
+    double start = secondsNow();
+
+    for (int r = 0; r < REPEATS; r++)
+    {
+        for (int i = 0; i < SAMPLE_COUNT; i++)
+        {
+            sum += function(input[i]);
+        }
+    }
+
+    double ns = (secondsNow() - start) * 1e9 / ((double)SAMPLE_COUNT * REPEATS);
+    sink = sum;
+    printf("%-36s %8.2f ns/call\n", name, ns);
+}
+
+static void timeArray(const char *name, void (*function)(const double *, double *, size_t), const double *input, double *output)
+{
+    double start = secondsNow();
+
+    for (int r = 0; r < REPEATS; r++)
+    {
+        function(input, output, SAMPLE_COUNT);
+    }
+
+    double ns = (secondsNow() - start) * 1e9 / ((double)SAMPLE_COUNT * REPEATS);
+    sink = output[SAMPLE_COUNT / 2];
+    printf("%-36s %8.2f ns/call\n", name, ns);
+}
+
+int main(void)
+{
+    double *altitude = malloc(SAMPLE_COUNT * sizeof(double));
+    double *psia = malloc(SAMPLE_COUNT * sizeof(double));
+    double *output = malloc(SAMPLE_COUNT * sizeof(double));
+
+    // Site altitudes are spread over the table range; barometer readings
+    // follow from them.
+    srand(5);
+
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        altitude[i] = -1000.0 + 31000.0 * (rand() / (double)RAND_MAX);
+        psia[i] = ambientPSIAForAltitudeInFeet(altitude[i]);
+    }
+
+    printf("Speed\n");
+    timeScalar("ambientPSIAForAltitudeInFeet", ambientPSIAForAltitudeInFeet, altitude);
+    timeScalar("ambientPSIAForAltitudeInFeetFast", ambientPSIAForAltitudeInFeetFast, altitude);
+    timeArray("ambientPSIAForAltitudeInFeetArray", ambientPSIAForAltitudeInFeetArray, altitude, output);
+    timeScalar("altitudeFeetFromPSIA", altitudeFeetFromPSIA, psia);
+    timeScalar("altitudeFeetFromPSIAFast", altitudeFeetFromPSIAFast, psia);
+    timeArray("altitudeFeetFromPSIAArray", altitudeFeetFromPSIAArray, psia, output);
+
+    // Dense sweeps over the whole table range
+    double maxPSIAError = 0.0, maxPSIARelative = 0.0, maxFeetError = 0.0;
+
+    for (double feet = -1000.0; feet <= 30000.0; feet += 0.25)
+    {
+        double exact = ambientPSIAForAltitudeInFeet(feet);
+        double error = fabs(ambientPSIAForAltitudeInFeetFast(feet) - exact);
+        // Written so a NaN result counts as a failure rather than vanishing
+        maxPSIAError = error <= maxPSIAError ? maxPSIAError : error;
+        maxPSIARelative = error / exact <= maxPSIARelative ? maxPSIARelative : error / exact;
+    }
+
+    double psiaMin = ambientPSIAForAltitudeInFeet(30000.0);
+    double psiaMax = ambientPSIAForAltitudeInFeet(-1000.0);
+
+    for (double p = psiaMin; p <= psiaMax; p += 0.00001)
+    {
+        double error = fabs(altitudeFeetFromPSIAFast(p) - altitudeFeetFromPSIA(p));
+        maxFeetError = error <= maxFeetError ? maxFeetError : error;
+    }
+
+    int failed = !(maxPSIAError <= PSIA_BOUND) || !(maxFeetError <= FEET_BOUND);
+
+    printf("\nAccuracy, -1000 to 30000 ft\n");
+    printf("ambientPSIAForAltitudeInFeetFast     max error %.3g psia (relative %.3g, bound %.3g)\n",
+           maxPSIAError, maxPSIARelative, PSIA_BOUND);
+    printf("altitudeFeetFromPSIAFast             max error %.3g ft (bound %.3g)\n", maxFeetError, FEET_BOUND);
+    printf("%s\n", failed ? "FAIL" : "ok");
+
+    free(altitude);
+    free(psia);
+    free(output);
+
+    return failed;
+}
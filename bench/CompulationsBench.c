@@ -0,0 +1,636 @@
+//
+//  CompulationsBench.c
+//
+//  ns/call and calls/s for every function in Compulations.h and
+//  UnitConversion.h, and for the batch paths at each SIMD level, written as
+//  JSON so runs can be compared over time.
+//
+//  compulations_bench [--min-time-ms N] [--filter text] [--output file]
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchCompulations.h"
+#include "Compulations.h"
+#include "FunctionTable.h"
+#include "InverseSolver.h"
+#include "MotorPowerAnalyzer.h"
+#include "SensorCalibration.h"
+#include "SiteConditions.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Inputs per timed pass; small enough to stay in cache so the numbers are
+// about the arithmetic, not memory.
+#define SAMPLE_COUNT 4096
+
+// Each result is the fastest of this many timed runs.
+#define RUNS 5
+
+typedef struct BenchOptions
+{
+    double minSecondsPerRun;
+    const char *filter;
+    FILE *output;
+} BenchOptions;
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+
+// Keeps the optimizer from dropping the timed loops
+static volatile double sink;
+
+typedef void (*BenchPass)(void *context);
+
+// Grows the repeat count until one run takes minSecondsPerRun, then keeps the
+// fastest of RUNS runs. Returns ns per call.
+static double timePasses(BenchPass pass, void *context, const BenchOptions *options)
+{
+    size_t repeats = 1;
+
+    for (;;)
+    {
+        double start = secondsNow();
+
+        for (size_t r = 0; r < repeats; r++)
+        {
+            pass(context);
+        }
+
+        double elapsed = secondsNow() - start;
+
+        if (elapsed >= options->minSecondsPerRun || repeats >= ((size_t)1 << 30))
+        {
+            break;
+        }
+
+        repeats = elapsed > 0.0 ? (size_t)(repeats * 1.2 * options->minSecondsPerRun / elapsed) + 1 : repeats * 16;
+    }
+
+    double best = 0.0;
+
+    for (int run = 0; run < RUNS; run++)
+    {
+        double start = secondsNow();
+
+        for (size_t r = 0; r < repeats; r++)
+        {
+            pass(context);
+        }
+
+        double elapsed = secondsNow() - start;
+        best = run == 0 || elapsed < best ? elapsed : best;
+    }
+
+    return best * 1e9 / ((double)repeats * SAMPLE_COUNT);
+}
+
+static int firstResult = 1;
+
+static void writeResult(const BenchOptions *options,
+                        const char *name,
+                        const char *header,
+                        const char *path,
+                        const char *simd,
+                        double nsPerCall)
+{
+    fprintf(options->output,
+            "%s\n    {\"name\": \"%s\", \"header\": \"%s\", \"path\": \"%s\", \"simd\": \"%s\", "
+            "\"nsPerCall\": %.4f, \"callsPerSecond\": %.6g}",
+            firstResult ? "" : ",",
+            name,
+            header,
+            path,
+            simd,
+            nsPerCall,
+            1e9 / nsPerCall);
+    firstResult = 0;
+
+    fprintf(stderr, "%-48s %-8s %-7s %9.3f ns/call\n", name, path, simd, nsPerCall);
+}
+
+static int selected(const BenchOptions *options, const char *name)
+{
+    return !options->filter || strstr(name, options->filter) != NULL;
+}
+
+// Scalar functions, through the table's direct-call column loops
+
+typedef struct ScalarCase
+{
+    const CompulationFunction *function;
+    const double *columns[COMPULATION_MAX_ARITY];
+    double *results;
+} ScalarCase;
+
+static void scalarPass(void *context)
+{
+    ScalarCase *bench = context;
+
+    bench->function->evaluateColumns(bench->columns, bench->results, SAMPLE_COUNT);
+    sink = bench->results[SAMPLE_COUNT - 1];
+}
+
+static void benchScalarFunctions(const BenchOptions *options)
+{
+    double *storage = malloc(COMPULATION_MAX_ARITY * SAMPLE_COUNT * sizeof(double));
+    double *results = malloc(SAMPLE_COUNT * sizeof(double));
+
+    for (size_t f = 0; f < compulationFunctionCount(); f++)
+    {
+        const CompulationFunction *function = compulationFunctionAt(f);
+
+        if (!selected(options, function->name))
+        {
+            continue;
+        }
+
+        ScalarCase bench = { function, { NULL }, results };
+
+        // Each argument uniform over the range seen in the field
+        srand(17 + (unsigned)f);
+
+        for (size_t p = 0; p < function->arity; p++)
+        {
+            double *column = storage + p * SAMPLE_COUNT;
+
+            for (size_t k = 0; k < SAMPLE_COUNT; k++)
+            {
+                column[k] = uniform(function->parameters[p].low, function->parameters[p].high);
+            }
+
+            bench.columns[p] = column;
+        }
+
+        writeResult(options, function->name, function->header, "scalar", "none", timePasses(scalarPass, &bench, options));
+    }
+
+    free(storage);
+    free(results);
+}
+
+// Batch paths
+
+typedef struct BatchData
+{
+    double *columns[8];
+    FlowConversionArrays arrays;
+    FlowConversionRecord *records;
+    double *altitude;
+    double *psia;
+    double *inletTempF;
+    double *dischargePSIG;
+    double *ambientPSIA;
+    double *results;
+    double *extra;
+    SiteConditions conditions;
+    SensorChannel channel;
+    uint16_t *rawU16;
+    int16_t *rawI16;
+    int32_t *rawI32;
+    uint8_t *flags;
+
+    // Forward results of the functions the inverse cases solve
+    double *pumpupColumns[5];
+    double *pumpupTargets;
+    double *capacityColumns[6];
+    double *capacityTargets;
+    uint8_t *inverseStatus;
+
+    // Inputs to the masked versions of the guarded functions
+    double *refillColumns[5];
+    double *eventColumns[6];
+    double *carryoverColumns[4];
+    double *velocityColumns[4];
+    uint64_t *valid;
+} BatchData;
+
+static void scfmArraysPass(void *context)
+{
+    BatchData *data = context;
+    scfmFromACFMArrays(&data->arrays, data->results, SAMPLE_COUNT);
+}
+
+static void acfmArraysPass(void *context)
+{
+    BatchData *data = context;
+    acfmFromSCFMArrays(&data->arrays, data->results, SAMPLE_COUNT);
+}
+
+static void scfmRecordsPass(void *context)
+{
+    BatchData *data = context;
+    scfmFromACFMRecords(data->records, data->results, SAMPLE_COUNT);
+}
+
+static void acfmRecordsPass(void *context)
+{
+    BatchData *data = context;
+    acfmFromSCFMRecords(data->records, data->results, SAMPLE_COUNT);
+}
+
+static void altitudeArrayPass(void *context)
+{
+    BatchData *data = context;
+    ambientPSIAForAltitudeInFeetArray(data->altitude, data->results, SAMPLE_COUNT);
+}
+
+static void psiaArrayPass(void *context)
+{
+    BatchData *data = context;
+    altitudeFeetFromPSIAArray(data->psia, data->results, SAMPLE_COUNT);
+}
+
+static void operatingTempArrayPass(void *context)
+{
+    BatchData *data = context;
+    oilFloodedScrewOperatingTempFArray(data->inletTempF, data->dischargePSIG, data->ambientPSIA, data->results, data->extra, SAMPLE_COUNT);
+}
+
+static void siteScfmArrayPass(void *context)
+{
+    BatchData *data = context;
+    scfmFromACFMArrayForSiteConditions(&data->conditions, data->columns[0], data->results, SAMPLE_COUNT);
+}
+
+static void siteAcfmArrayPass(void *context)
+{
+    BatchData *data = context;
+    acfmFromSCFMArrayForSiteConditions(&data->conditions, data->columns[0], data->results, SAMPLE_COUNT);
+}
+
+static void sensorU16Pass(void *context)
+{
+    BatchData *data = context;
+    sensorChannelConvertU16(&data->channel, data->rawU16, data->results, data->flags, SAMPLE_COUNT);
+}
+
+static void sensorI16Pass(void *context)
+{
+    BatchData *data = context;
+    sensorChannelConvertI16(&data->channel, data->rawI16, data->results, data->flags, SAMPLE_COUNT);
+}
+
+static void sensorI32Pass(void *context)
+{
+    BatchData *data = context;
+    sensorChannelConvertI32(&data->channel, data->rawI32, data->results, data->flags, SAMPLE_COUNT);
+}
+
+static void motorPowerPass(void *context)
+{
+    BatchData *data = context;
+    MotorPowerSums sums;
+    const double *volts[MOTOR_PHASES] = { data->columns[0], data->columns[1], data->columns[2] };
+    const double *amps[MOTOR_PHASES] = { data->columns[3], data->columns[4], data->columns[5] };
+
+    memset(&sums, 0, sizeof(sums));
+    motorPowerAccumulate(&sums, volts, amps, SAMPLE_COUNT, MotorVoltageLineToNeutral);
+    data->results[0] = sums.watts;
+}
+
+// Closed form
+static void inversePumpupPass(void *context)
+{
+    BatchData *data = context;
+    inverseSolveColumns(compulationFunctionNamed("pumpupTimeInSeconds"), 0, (const double *const *)data->pumpupColumns,
+                        data->pumpupTargets, data->results, data->inverseStatus, SAMPLE_COUNT, NULL, NULL);
+}
+
+// Brent's method, for the loaded time
+static void inverseCapacityPass(void *context)
+{
+    BatchData *data = context;
+    inverseSolveColumns(compulationFunctionNamed("systemCapacityCubicFeetByCycleTime"), 1, (const double *const *)data->capacityColumns,
+                        data->capacityTargets, data->results, data->inverseStatus, SAMPLE_COUNT, NULL, NULL);
+}
+
+static void refillArrayPass(void *context)
+{
+    BatchData *data = context;
+    double **a = data->refillColumns;
+    refillRateCFMArray(a[0], a[1], a[2], a[3], a[4], data->results, data->valid, SAMPLE_COUNT);
+}
+
+static void eventStorageArrayPass(void *context)
+{
+    BatchData *data = context;
+    double **a = data->eventColumns;
+    eventStorageCubicFeetArray(a[0], a[1], a[2], a[3], a[4], a[5], data->results, data->valid, SAMPLE_COUNT);
+}
+
+static void carryoverArrayPass(void *context)
+{
+    BatchData *data = context;
+    double **a = data->carryoverColumns;
+    oilCarryoverGallonsArray(a[0], a[1], a[2], a[3], data->results, data->valid, SAMPLE_COUNT);
+}
+
+static void velocityArrayPass(void *context)
+{
+    BatchData *data = context;
+    double **a = data->velocityColumns;
+    velocityInPipeFPSArray(a[0], a[1], a[2], a[3], data->results, data->valid, SAMPLE_COUNT);
+}
+
+typedef struct BatchCase
+{
+    const char *name;
+    const char *header;
+    int usesSIMD;
+    BenchPass pass;
+} BatchCase;
+
+static const BatchCase batchCases[] = {
+    { "scfmFromACFMArrays", "BatchCompulations.h", 1, scfmArraysPass },
+    { "acfmFromSCFMArrays", "BatchCompulations.h", 1, acfmArraysPass },
+    { "scfmFromACFMRecords", "BatchCompulations.h", 1, scfmRecordsPass },
+    { "acfmFromSCFMRecords", "BatchCompulations.h", 1, acfmRecordsPass },
+    { "ambientPSIAForAltitudeInFeetArray", "BatchCompulations.h", 0, altitudeArrayPass },
+    { "altitudeFeetFromPSIAArray", "BatchCompulations.h", 0, psiaArrayPass },
+    { "oilFloodedScrewOperatingTempFArray", "BatchCompulations.h", 1, operatingTempArrayPass },
+    { "refillRateCFMArray", "BatchCompulations.h", 1, refillArrayPass },
+    { "eventStorageCubicFeetArray", "BatchCompulations.h", 1, eventStorageArrayPass },
+    { "oilCarryoverGallonsArray", "BatchCompulations.h", 1, carryoverArrayPass },
+    { "velocityInPipeFPSArray", "BatchCompulations.h", 1, velocityArrayPass },
+    { "scfmFromACFMArrayForSiteConditions", "SiteConditions.h", 0, siteScfmArrayPass },
+    { "acfmFromSCFMArrayForSiteConditions", "SiteConditions.h", 0, siteAcfmArrayPass },
+    { "sensorChannelConvertU16", "SensorCalibration.h", 1, sensorU16Pass },
+    { "sensorChannelConvertI16", "SensorCalibration.h", 1, sensorI16Pass },
+    { "sensorChannelConvertI32", "SensorCalibration.h", 1, sensorI32Pass },
+    { "motorPowerAccumulate", "MotorPowerAnalyzer.h", 1, motorPowerPass },
+    { "inverseSolveColumns(pumpupTimeInSeconds)", "InverseSolver.h", 0, inversePumpupPass },
+    { "inverseSolveColumns(systemCapacityCubicFeetByCycleTime)", "InverseSolver.h", 0, inverseCapacityPass },
+};
+
+static const char *simdName(CompulationsSIMDLevel level)
+{
+    switch (level)
+    {
+        case CompulationsSIMDLevelAVX2:
+            return "avx2";
+        case CompulationsSIMDLevelAVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+// Random arguments over the function's field ranges, and its results
+static void fillForwardCases(const CompulationFunction *function, double **columns, double **results)
+{
+    for (size_t p = 0; p < function->arity; p++)
+    {
+        columns[p] = malloc(SAMPLE_COUNT * sizeof(double));
+
+        for (size_t k = 0; k < SAMPLE_COUNT; k++)
+        {
+            columns[p][k] = uniform(function->parameters[p].low, function->parameters[p].high);
+        }
+    }
+
+    *results = malloc(SAMPLE_COUNT * sizeof(double));
+    function->evaluateColumns((const double *const *)columns, *results, SAMPLE_COUNT);
+}
+
+// Random arguments over the function's field ranges, with one call in 16
+// given a zero argument so some fail the guard
+static void fillGuardedCases(const CompulationFunction *function, double **columns)
+{
+    for (size_t p = 0; p < function->arity; p++)
+    {
+        columns[p] = malloc(SAMPLE_COUNT * sizeof(double));
+
+        for (size_t k = 0; k < SAMPLE_COUNT; k++)
+        {
+            columns[p][k] = uniform(function->parameters[p].low, function->parameters[p].high);
+        }
+    }
+
+    for (size_t k = 0; k < SAMPLE_COUNT; k += 16)
+    {
+        columns[(size_t)rand() % function->arity][k] = 0.0;
+    }
+}
+
+static void benchBatchPaths(const BenchOptions *options)
+{
+    BatchData data;
+    const CompulationFunction *scfm = compulationFunctionNamed("scfmFromACFM");
+
+    memset(&data, 0, sizeof(data));
+    srand(29);
+
+    for (int p = 0; p < 8; p++)
+    {
+        data.columns[p] = malloc(SAMPLE_COUNT * sizeof(double));
+
+        for (size_t k = 0; k < SAMPLE_COUNT; k++)
+        {
+            data.columns[p][k] = uniform(scfm->parameters[p].low, scfm->parameters[p].high);
+        }
+    }
+
+    data.arrays = (FlowConversionArrays){ data.columns[0], data.columns[1], data.columns[2], data.columns[3],
+                                          data.columns[4], data.columns[5], data.columns[6], data.columns[7] };
+    data.records = malloc(SAMPLE_COUNT * sizeof(FlowConversionRecord));
+    data.altitude = malloc(SAMPLE_COUNT * sizeof(double));
+    data.psia = malloc(SAMPLE_COUNT * sizeof(double));
+    data.inletTempF = malloc(SAMPLE_COUNT * sizeof(double));
+    data.dischargePSIG = malloc(SAMPLE_COUNT * sizeof(double));
+    data.ambientPSIA = malloc(SAMPLE_COUNT * sizeof(double));
+    data.results = malloc(SAMPLE_COUNT * sizeof(double));
+    data.extra = malloc(SAMPLE_COUNT * sizeof(double));
+    data.rawU16 = malloc(SAMPLE_COUNT * sizeof(uint16_t));
+    data.rawI16 = malloc(SAMPLE_COUNT * sizeof(int16_t));
+    data.rawI32 = malloc(SAMPLE_COUNT * sizeof(int32_t));
+    data.flags = malloc(SAMPLE_COUNT);
+
+    for (size_t k = 0; k < SAMPLE_COUNT; k++)
+    {
+        data.records[k] = (FlowConversionRecord){ data.columns[0][k], data.columns[1][k], data.columns[2][k], data.columns[3][k],
+                                                  data.columns[4][k], data.columns[5][k], data.columns[6][k], data.columns[7][k] };
+        data.altitude[k] = uniform(-200.0, 10000.0);
+        data.psia[k] = uniform(10.1, 14.8);
+        data.inletTempF[k] = uniform(40.0, 115.0);
+        data.dischargePSIG[k] = uniform(90.0, 175.0);
+        data.ambientPSIA[k] = uniform(11.0, 14.9);
+
+        // 4-20 mA on a 16-bit converter, a few samples out of range
+        data.rawU16[k] = (uint16_t)(rand() & 0xffff);
+        data.rawI16[k] = (int16_t)(rand() & 0xffff);
+        data.rawI32[k] = (int32_t)(rand() & 0xffffff) - 0x800000;
+    }
+
+    fillForwardCases(compulationFunctionNamed("pumpupTimeInSeconds"), data.pumpupColumns, &data.pumpupTargets);
+    fillForwardCases(compulationFunctionNamed("systemCapacityCubicFeetByCycleTime"), data.capacityColumns, &data.capacityTargets);
+    data.inverseStatus = malloc(SAMPLE_COUNT);
+
+    fillGuardedCases(compulationFunctionNamed("refillRateCFM"), data.refillColumns);
+    fillGuardedCases(compulationFunctionNamed("eventStorageCubicFeet"), data.eventColumns);
+    fillGuardedCases(compulationFunctionNamed("oilCarryoverGallons"), data.carryoverColumns);
+    fillGuardedCases(compulationFunctionNamed("velocityInPipeFPS"), data.velocityColumns);
+    data.valid = malloc((SAMPLE_COUNT + 63) / 64 * sizeof(uint64_t));
+
+    siteConditionsInit(&data.conditions, 14.7, 68.0, 0.36, 14.2, 95.0, 0.8, 14.0);
+    sensorChannelInit(&data.channel, 0.0, 65535.0, 0.0, 200.0);
+    sensorChannelSetLimits(&data.channel, 5.0, 195.0, 1);
+
+    CompulationsSIMDLevel detected = compulationsDetectedSIMDLevel();
+
+    for (size_t c = 0; c < sizeof(batchCases) / sizeof(batchCases[0]); c++)
+    {
+        const BatchCase *bench = &batchCases[c];
+
+        if (!selected(options, bench->name))
+        {
+            continue;
+        }
+
+        if (!bench->usesSIMD)
+        {
+            writeResult(options, bench->name, bench->header, "batch", "none", timePasses(bench->pass, &data, options));
+            continue;
+        }
+
+        for (int level = CompulationsSIMDLevelScalar; level <= (int)detected; level++)
+        {
+            compulationsSetSIMDLevel((CompulationsSIMDLevel)level);
+            writeResult(options, bench->name, bench->header, "batch", simdName((CompulationsSIMDLevel)level),
+                        timePasses(bench->pass, &data, options));
+        }
+
+        compulationsSetSIMDLevel(detected);
+    }
+
+    for (int p = 0; p < 8; p++)
+    {
+        free(data.columns[p]);
+    }
+
+    free(data.records);
+    free(data.altitude);
+    free(data.psia);
+    free(data.inletTempF);
+    free(data.dischargePSIG);
+    free(data.ambientPSIA);
+    free(data.results);
+    free(data.extra);
+    free(data.rawU16);
+    free(data.rawI16);
+    free(data.rawI32);
+    free(data.flags);
+
+    for (int p = 0; p < 5; p++)
+    {
+        free(data.pumpupColumns[p]);
+    }
+
+    for (int p = 0; p < 6; p++)
+    {
+        free(data.capacityColumns[p]);
+    }
+
+    for (int p = 0; p < 6; p++)
+    {
+        free(data.eventColumns[p]);
+    }
+
+    for (int p = 0; p < 4; p++)
+    {
+        free(data.carryoverColumns[p]);
+        free(data.velocityColumns[p]);
+    }
+
+    for (int p = 0; p < 5; p++)
+    {
+        free(data.refillColumns[p]);
+    }
+
+    free(data.pumpupTargets);
+    free(data.capacityTargets);
+    free(data.inverseStatus);
+    free(data.valid);
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options = { 0.01, NULL, stdout };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc)
+        {
+            options.minSecondsPerRun = atof(argv[++i]) / 1000.0;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            options.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            options.output = fopen(argv[++i], "w");
+
+            if (!options.output)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--min-time-ms N] [--filter text] [--output file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    fprintf(options.output, "{\n  \"suite\": \"compulations_bench\",\n");
+#ifdef __VERSION__
+    fprintf(options.output, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(options.output, "  \"detectedSIMD\": \"%s\",\n", simdName(compulationsDetectedSIMDLevel()));
+    fprintf(options.output, "  \"samplesPerPass\": %d,\n", SAMPLE_COUNT);
+    fprintf(options.output, "  \"timestamp\": %lld,\n", (long long)time(NULL));
+    fprintf(options.output, "  \"results\": [");
+
+    benchScalarFunctions(&options);
+    benchBatchPaths(&options);
+
+    fprintf(options.output, "\n  ]\n}\n");
+
+    if (options.output != stdout)
+    {
+        fclose(options.output);
+    }
+
+    return 0;
+}
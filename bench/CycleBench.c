@@ -0,0 +1,225 @@
+//
+//  CycleBench.c
+//
+//  Replays a synthetic log of load/unload sawtooths through a CycleAnalyzer
+//  per machine and reports events/s. Every machine has its own whole-second
+//  loaded and unloaded times and a phase offset, so each complete cycle and
+//  the number of them are known exactly. Exits 1 if a cycle differs.
+//
+//  compulations_cycle_bench [--machines N] [--seconds N]
+//
+//  cc -O2 -I.. CycleBench.c ../CycleAnalyzer.c ../Compulations.c ../CompulationsInstrumentation.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+#include "CycleAnalyzer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOAD_PSIG 100.0
+#define UNLOAD_PSIG 110.0
+#define DEADBAND_PSI 0.2
+#define RATED_CFM 500.0
+#define AMBIENT_PSIA 14.7
+#define REPEATS 5
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Loaded 20-40 s and unloaded 35-45 s. Under 50 s each, the samples either
+// side of a switch stay outside the deadband.
+static int loadedSec(uint32_t machine)
+{
+    return 20 + 5 * (int)(machine % 5);
+}
+
+static int unloadedSec(uint32_t machine)
+{
+    return 45 - 5 * (int)(machine % 3);
+}
+
+// Seconds into the machine's cycle, which starts as it loads at LOAD_PSIG
+static int phaseAt(uint32_t machine, size_t second)
+{
+    int period = loadedSec(machine) + unloadedSec(machine);
+
+    return (int)((second + machine * 7) % (size_t)period);
+}
+
+// Rises from LOAD_PSIG to UNLOAD_PSIG while loaded, falls back while unloaded
+static double pressureAt(uint32_t machine, size_t second)
+{
+    int phase = phaseAt(machine, second);
+    int loaded = loadedSec(machine);
+
+    if (phase < loaded)
+    {
+        return LOAD_PSIG + (UNLOAD_PSIG - LOAD_PSIG) * phase / loaded;
+    }
+
+    return UNLOAD_PSIG - (UNLOAD_PSIG - LOAD_PSIG) * (phase - loaded) / unloadedSec(machine);
+}
+
+// The first switch puts the analyzer in a known state. A cycle completes at
+// each later load whose loaded phase started after that switch.
+static size_t expectedCycles(uint32_t machine, size_t seconds)
+{
+    int period = loadedSec(machine) + unloadedSec(machine);
+    long firstSwitch = -1;
+    size_t cycles = 0;
+
+    for (size_t t = 0; t < seconds; t++)
+    {
+        int phase = phaseAt(machine, t);
+
+        if (firstSwitch < 0 && (phase == 0 || phase == loadedSec(machine)))
+        {
+            firstSwitch = (long)t;
+        }
+        else if (firstSwitch >= 0 && phase == 0 && (long)t - period > firstSwitch)
+        {
+            cycles++;
+        }
+    }
+
+    return cycles;
+}
+
+typedef struct Check
+{
+    size_t *cycles;
+    size_t mismatches;
+} Check;
+
+static void checkCycle(void *context, uint32_t machine, const CycleResult *cycle)
+{
+    Check *check = context;
+    double expected = systemCapacityCubicFeetByCycleTime(unloadedSec(machine),
+                                                         loadedSec(machine),
+                                                         UNLOAD_PSIG,
+                                                         LOAD_PSIG,
+                                                         RATED_CFM,
+                                                         AMBIENT_PSIA);
+
+    check->cycles[machine]++;
+
+    if (cycle->loadedSec != loadedSec(machine) || cycle->unloadedSec != unloadedSec(machine) ||
+        cycle->unloadPressurePSIG != UNLOAD_PSIG || cycle->loadPressurePSIG != LOAD_PSIG ||
+        !(fabs(cycle->capacityCF - expected) <= 1e-12 * expected))
+    {
+        if (check->mismatches++ == 0)
+        {
+            printf("MISMATCH machine %u: loaded %g s, unloaded %g s, %g-%g psig, %g CF, expected %d s, %d s, %g CF\n",
+                   machine, cycle->loadedSec, cycle->unloadedSec, cycle->loadPressurePSIG, cycle->unloadPressurePSIG,
+                   cycle->capacityCF, loadedSec(machine), unloadedSec(machine), expected);
+        }
+    }
+}
+
+static void initAnalyzers(CycleAnalyzer *analyzers, size_t machineCount)
+{
+    for (size_t m = 0; m < machineCount; m++)
+    {
+        cycleAnalyzerInit(&analyzers[m], LOAD_PSIG, UNLOAD_PSIG, DEADBAND_PSI, RATED_CFM, AMBIENT_PSIA, 0.1, 16);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t machineCount = 1000;
+    size_t seconds = 3600;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--machines") == 0 && i + 1 < argc)
+        {
+            machineCount = (size_t)atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+        {
+            seconds = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--machines N] [--seconds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    machineCount = machineCount ? machineCount : 1;
+
+    size_t count = machineCount * seconds;
+    CycleEvent *events = malloc((count ? count : 1) * sizeof(CycleEvent));
+    CycleAnalyzer *analyzers = malloc(machineCount * sizeof(CycleAnalyzer));
+    Check check = { calloc(machineCount, sizeof(size_t)), 0 };
+
+    // One pressure reading per machine per second, interleaved as a plant
+    // historian would log them
+    for (size_t t = 0; t < seconds; t++)
+    {
+        for (size_t m = 0; m < machineCount; m++)
+        {
+            events[t * machineCount + m] = (CycleEvent){ (double)t, pressureAt((uint32_t)m, t), (uint32_t)m, CycleEventPressure };
+        }
+    }
+
+    initAnalyzers(analyzers, machineCount);
+    size_t completed = cycleAnalyzerProcessEvents(analyzers, machineCount, events, count, checkCycle, &check);
+    size_t wrongCounts = 0;
+
+    for (size_t m = 0; m < machineCount; m++)
+    {
+        wrongCounts += check.cycles[m] != expectedCycles((uint32_t)m, seconds);
+    }
+
+    double best = INFINITY;
+
+    for (int r = 0; r < REPEATS; r++)
+    {
+        initAnalyzers(analyzers, machineCount);
+
+        double start = secondsNow();
+        cycleAnalyzerProcessEvents(analyzers, machineCount, events, count, NULL, NULL);
+        double elapsed = secondsNow() - start;
+
+        best = elapsed < best ? elapsed : best;
+    }
+
+    printf("%zu machines, %zu s at 1 Hz, %zu events\n", machineCount, seconds, count);
+    printf("%-28s %10zu\n", "cycles", completed);
+    printf("%-28s %10zu\n", "cycles not as generated", check.mismatches);
+    printf("%-28s %10zu\n", "machines with wrong count", wrongCounts);
+    printf("%-28s %10.1f M events/s\n", "cycleAnalyzerProcessEvents", count / best * 1e-6);
+
+    free(events);
+    free(analyzers);
+    free(check.cycles);
+
+    return check.mismatches || wrongCounts;
+}
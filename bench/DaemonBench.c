@@ -0,0 +1,272 @@
+//
+//  DaemonBench.c
+//
+//  Runs a CalculationDaemon in-process and drives it over its socket at
+//  several batch sizes and pipeline depths, through a shared region and
+//  inline. Reports throughput and client and server p50/p99 latency, and
+//  checks every result against evaluateColumns.
+//
+//  cc -O2 -I.. DaemonBench.c ../CalculationDaemon.c ../BatchCompulations.c ../FunctionTable.c ../ThreadPool.c ../Compulations.c ../CompulationsFloat.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CalculationDaemon.h"
+#include "FunctionTable.h"
+#include "ThreadPool.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// Values per run, whatever the batch size
+#define VALUES_PER_RUN (1 << 21)
+#define MAX_DEPTH 64
+
+typedef struct BenchRun
+{
+    const char *functionName;
+    size_t batch;
+    size_t depth;
+    int shared;
+} BenchRun;
+
+static const BenchRun runs[] = {
+    { "pumpupTimeInSeconds", 1, 1, 1 },
+    { "pumpupTimeInSeconds", 1, 64, 1 },
+    { "pumpupTimeInSeconds", 64, 1, 1 },
+    { "pumpupTimeInSeconds", 64, 64, 1 },
+    { "pumpupTimeInSeconds", 4096, 1, 1 },
+    { "pumpupTimeInSeconds", 4096, 8, 1 },
+    { "pumpupTimeInSeconds", 4096, 8, 0 },
+    { "scfmFromACFM", 4096, 8, 1 },
+    { "scfmFromACFM", 4096, 8, 0 },
+};
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void *serve(void *context)
+{
+    calculationDaemonRun(context);
+    return NULL;
+}
+
+// Region layout per pipeline slot: arity argument columns, then results
+static int benchRun(const char *socketPath, const BenchRun *run)
+{
+    const CompulationFunction *function = compulationFunctionNamed(run->functionName);
+    CalculationClient *client = calculationClientConnect(socketPath);
+    size_t arity = 0;
+    int index = client ? calculationClientLookup(client, run->functionName, &arity) : -1;
+
+    if (index < 0 || arity != function->arity)
+    {
+        fprintf(stderr, "lookup of %s failed\n", run->functionName);
+        calculationClientClose(client);
+        return 1;
+    }
+
+    size_t slotBytes = (arity + 1) * run->batch * sizeof(double);
+    size_t regionBytes = slotBytes * run->depth;
+    int fd = calculationRegionCreate(regionBytes);
+    uint8_t *region = fd >= 0 ? mmap(NULL, regionBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    int regionNumber = region != MAP_FAILED ? calculationClientMapRegion(client, fd, regionBytes) : -1;
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (regionNumber < 0)
+    {
+        fprintf(stderr, "shared region failed\n");
+        calculationClientClose(client);
+        return 1;
+    }
+
+    // Each slot gets its own arguments, and the expected results
+    double *expected = malloc(run->depth * run->batch * sizeof(double));
+    double *inlineResults = malloc(run->batch * sizeof(double));
+    size_t batches = VALUES_PER_RUN / run->batch;
+    batches = batches < 20000 ? batches : 20000;
+    double *latencies = malloc(batches * sizeof(double));
+    double submitted[MAX_DEPTH];
+
+    for (size_t slot = 0; slot < run->depth; slot++)
+    {
+        double *columns = (double *)(region + slot * slotBytes);
+        const double *arguments[COMPULATION_MAX_ARITY];
+
+        for (size_t p = 0; p < arity; p++)
+        {
+            for (size_t k = 0; k < run->batch; k++)
+            {
+                columns[p * run->batch + k] = uniform(function->parameters[p].low, function->parameters[p].high);
+            }
+
+            arguments[p] = columns + p * run->batch;
+        }
+
+        function->evaluateColumns(arguments, expected + slot * run->batch, run->batch);
+    }
+
+    size_t sent = 0;
+    size_t received = 0;
+    size_t mismatches = 0;
+    int failed = 0;
+    double start = secondsNow();
+
+    while (received < batches && !failed)
+    {
+        // Keep depth batches in flight
+        while (sent < batches && sent - received < run->depth)
+        {
+            size_t slot = sent % run->depth;
+            uint64_t offsets[COMPULATION_MAX_ARITY];
+            const double *arguments[COMPULATION_MAX_ARITY];
+
+            for (size_t p = 0; p < arity; p++)
+            {
+                offsets[p] = slot * slotBytes + p * run->batch * sizeof(double);
+                arguments[p] = (const double *)(region + offsets[p]);
+            }
+
+            submitted[slot] = secondsNow();
+            failed |= run->shared ? calculationClientSubmit(client, sent, index, (uint32_t)regionNumber, offsets, arity,
+                                                            slot * slotBytes + arity * run->batch * sizeof(double), run->batch)
+                                  : calculationClientSubmitInline(client, sent, index, arguments, arity, run->batch);
+            sent++;
+        }
+
+        uint64_t tag;
+        DaemonEvaluateReply reply;
+
+        if (failed || calculationClientReceive(client, &tag, &reply, inlineResults, run->batch) != 0 ||
+            reply.status != DaemonStatusOK || tag != received)
+        {
+            failed = 1;
+            break;
+        }
+
+        size_t slot = tag % run->depth;
+        const double *results = run->shared ? (const double *)(region + slot * slotBytes) + arity * run->batch : inlineResults;
+
+        latencies[received] = secondsNow() - submitted[slot];
+
+        // The SIMD kernels are within a few ULP of the scalar functions
+        for (size_t k = 0; k < run->batch; k++)
+        {
+            double want = expected[slot * run->batch + k];
+            mismatches += !(fabs(results[k] - want) <= 1e-12 * fabs(want));
+        }
+
+        received++;
+    }
+
+    double seconds = secondsNow() - start;
+    DaemonStatsReply stats;
+
+    if (failed || calculationClientStats(client, &stats) != 0)
+    {
+        fprintf(stderr, "%s: connection failed\n", run->functionName);
+        failed = 1;
+    }
+    else
+    {
+        qsort(latencies, received, sizeof(double), compareDoubles);
+
+        printf("%-20s %-6s %6zu %6zu %10.0f %8.1f %9.1f %9.1f %9.1f%s\n", run->functionName,
+               run->shared ? "shared" : "inline", run->batch, run->depth, batches / seconds,
+               batches * run->batch / seconds * 1e-6, latencies[received / 2] * 1e6,
+               latencies[(size_t)(received * 0.99)] * 1e6, stats.p99Microseconds, mismatches ? "  MISMATCH" : "");
+    }
+
+    munmap(region, regionBytes);
+    free(expected);
+    free(inlineResults);
+    free(latencies);
+    calculationClientClose(client);
+
+    return failed || mismatches;
+}
+
+int main(void)
+{
+    char socketPath[64];
+    snprintf(socketPath, sizeof(socketPath), "/tmp/compulations-bench-%ld.sock", (long)getpid());
+
+    ThreadPool *pool = threadPoolCreate(0);
+    CalculationDaemon *daemon = pool ? calculationDaemonCreate(socketPath, pool) : NULL;
+    pthread_t server;
+
+    if (!daemon || pthread_create(&server, NULL, serve, daemon) != 0)
+    {
+        perror(socketPath);
+        return 1;
+    }
+
+    srand(2016);
+
+    printf("%zu daemon threads; client latency is submit to receive, server p99 is cumulative\n", threadPoolSize(pool));
+    printf("%-20s %-6s %6s %6s %10s %8s %9s %9s %9s\n", "function", "path", "batch", "depth", "batches/s",
+           "M val/s", "p50 us", "p99 us", "srv p99");
+
+    int failures = 0;
+
+    for (size_t r = 0; r < sizeof(runs) / sizeof(runs[0]); r++)
+    {
+        failures += benchRun(socketPath, &runs[r]);
+    }
+
+    calculationDaemonStop(daemon);
+    pthread_join(server, NULL);
+
+    DaemonStatsReply stats;
+    calculationDaemonStats(daemon, &stats);
+    printf("server: %llu batches, p50 %.1f us, p99 %.1f us, max %.1f us\n", (unsigned long long)stats.requests,
+           stats.p50Microseconds, stats.p99Microseconds, stats.maxMicroseconds);
+
+    calculationDaemonDestroy(daemon);
+    threadPoolDestroy(pool);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,360 @@
+//
+//  FixedPointBench.c
+//
+//  Checks the Q16.16 functions in CompulationsFixed.h and
+//  UnitConversionFixed.h bit for bit against reference vectors, then against
+//  the double versions over their field ranges, and times both. The times are
+//  for this host; on a part without an FPU the double versions are emulated
+//  and far slower. Exits 1 on any mismatch.
+//
+//  cc -O2 -I.. FixedPointBench.c ../CompulationsFixed.c ../FunctionTable.c ../Compulations.c ../CompulationsFloat.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+#include "CompulationsFixed.h"
+#include "FunctionTable.h"
+#include "UnitConversionFixed.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Random inputs per function for the comparison with double
+#define COMPARE_COUNT 1000000
+
+// Inputs per timed pass, and passes
+#define SAMPLE_COUNT 4096
+#define TIMED_PASSES 200
+
+typedef struct FixedConversion
+{
+    const char *name;
+    Q16 (*fixed)(Q16);
+} FixedConversion;
+
+typedef struct ConversionVector
+{
+    const char *name;
+    Q16 input;
+    Q16 expected;
+} ConversionVector;
+
+typedef struct FixedVector
+{
+    Q16 arguments[5];
+    Q16 expected;
+} FixedVector;
+
+static const FixedConversion conversions[] = {
+    { "barFromPSI", barFromPSIQ16 },
+    { "inH20FromkPa", inH20FromkPaQ16 },
+    { "inHgFromMmHg", inHgFromMmHgQ16 },
+    { "inHgFromkPa", inHgFromkPaQ16 },
+    { "inHgFromPSI", inHgFromPSIQ16 },
+    { "kPaFromInH2O", kPaFromInH2OQ16 },
+    { "kPaFromInHg", kPaFromInHgQ16 },
+    { "kPaFromMmH2O", kPaFromMmH2OQ16 },
+    { "kPaFromMmHg", kPaFromMmHgQ16 },
+    { "kPaFromPSI", kPaFromPSIQ16 },
+    { "mmH2OFromkPa", mmH2OFromkPaQ16 },
+    { "mmHgFromInHg", mmHgFromInHgQ16 },
+    { "mmHgFromkPa", mmHgFromkPaQ16 },
+    { "psiFromBar", psiFromBarQ16 },
+    { "psiFromInHg", psiFromInHgQ16 },
+    { "psiFromkPa", psiFromkPaQ16 },
+};
+
+#define CONVERSION_COUNT (sizeof(conversions) / sizeof(conversions[0]))
+
+// Raw Q16 values. Includes saturation, negative inputs, empty input ranges,
+// halves rounding away from zero and invalid leak tests.
+static const ConversionVector conversionVectors[] = {
+    { "barFromPSI", 8192000, 564819 },
+    { "barFromPSI", -963379, -66423 },
+    { "barFromPSI", 0, 0 },
+    { "inH20FromkPa", 163840, 657775 },
+    { "inH20FromkPa", 589824000, 2147483647 },
+    { "inHgFromMmHg", 49807360, 1960920 },
+    { "inHgFromkPa", 6640435, 1960919 },
+    { "inHgFromPSI", 963117, 1960930 },
+    { "inHgFromPSI", -1310720000, -2147483648 },
+    { "kPaFromInH2O", 1815347, 452170 },
+    { "kPaFromInHg", 1960837, 6640157 },
+    { "kPaFromMmH2O", 32768000, 321344 },
+    { "kPaFromMmHg", 49807360, 6640434 },
+    { "kPaFromPSI", 6553600, 45185481 },
+    { "kPaFromPSI", 327680000, 2147483647 },
+    { "kPaFromPSI", -327680000, -2147483648 },
+    { "mmH2OFromkPa", 209715, 21384979 },
+    { "mmH2OFromkPa", 26214400, 2147483647 },
+    { "mmHgFromInHg", 1960837, 49805259 },
+    { "mmHgFromkPa", 6640435, 49807368 },
+    { "psiFromBar", 458752, 6653635 },
+    { "psiFromBar", -66388, -962877 },
+    { "psiFromInHg", 1960837, 963071 },
+    { "psiFromkPa", 45185499, 6553603 },
+    { "psiFromkPa", 2147418112, 311456665 },
+};
+
+static const FixedVector mappedValueVectors[] = {
+    { { 786432, 262144, 1310720, 0, 16384000 }, 8192000 },
+    { { 262144, 262144, 1310720, 0, 16384000 }, 0 },
+    { { 1310720, 262144, 1310720, 0, 16384000 }, 16384000 },
+    { { 131072, 262144, 1310720, -963379, 13107200 }, -2722201 },
+    { { 216269, 0, 327680, 9830400, -2621440 }, 1612178 },
+    { { 65536, 65536, 65536, 458752, 524288 }, 458752 },
+    { { 1966080000, 0, 65536, 0, 131072 }, 2147483647 },
+    { { -1966080000, 0, 66, 0, 65536 }, -2147483648 },
+    { { 32768, 0, 65536, -2147483648, 2147418112 }, -32768 },
+    { { 2, 0, 3, 0, 1 }, 1 },
+};
+
+static const FixedVector leakRateVectors[] = {
+    { { 69468160, 8192000, 6225920, 963379, 163840 }, 7580852 },
+    { { 13107200, 6553600, 3932160, 851968, 1966080 }, 179711 },
+    { { 655360000, 8192000, 3276800, 963379, 65536 }, 558730275 },
+    { { 32768000, 7208960, 7536640, 963379, 196608 }, -496649 },
+    { { 0, 8192000, 6225920, 963379, 163840 }, 0 },
+    { { 32768000, 8192000, 6225920, 963379, 0 }, 0 },
+    { { 1966080000, 2097152000, 0, 65536, 66 }, 2147483647 },
+    { { 327680000, 8192000, 4096000, 963117, 475136 }, 32119670 },
+};
+
+// Ties: one half of a step rounds away from zero
+static const FixedVector roundingVectors[] = {
+    { { 1, 0, 2, 0, 1 }, 1 },
+    { { 1, 0, 2, 0, -1 }, -1 },
+    { { -1, 0, 2, 0, 1 }, -1 },
+};
+
+// Keeps the optimizer from dropping the timed loops
+static volatile int64_t sink;
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+
+static Q16 fixedMappedValue(const Q16 *a)
+{
+    return mappedValueQ16(a[0], a[1], a[2], a[3], a[4]);
+}
+
+static Q16 fixedLeakRate(const Q16 *a)
+{
+    return leakRateCFMQ16(a[0], a[1], a[2], a[3], a[4]);
+}
+
+static int checkVectors(const char *name, Q16 (*fixed)(const Q16 *), const FixedVector *vectors, size_t count)
+{
+    int failures = 0;
+
+    for (size_t v = 0; v < count; v++)
+    {
+        Q16 result = fixed(vectors[v].arguments);
+
+        if (result != vectors[v].expected)
+        {
+            printf("MISMATCH %s vector %zu: got %d, expected %d\n", name, v, result, vectors[v].expected);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+static int checkConversionVectors(void)
+{
+    int failures = 0;
+
+    for (size_t v = 0; v < sizeof(conversionVectors) / sizeof(conversionVectors[0]); v++)
+    {
+        for (size_t c = 0; c < CONVERSION_COUNT; c++)
+        {
+            if (strcmp(conversions[c].name, conversionVectors[v].name) != 0)
+            {
+                continue;
+            }
+
+            Q16 result = conversions[c].fixed(conversionVectors[v].input);
+
+            if (result != conversionVectors[v].expected)
+            {
+                printf("MISMATCH %s(%d): got %d, expected %d\n", conversionVectors[v].name,
+                       conversionVectors[v].input, result, conversionVectors[v].expected);
+                failures++;
+            }
+        }
+    }
+
+    return failures;
+}
+
+// Distance in Q16 steps from the double result, rounded to Q16, of the same
+// (already quantized) inputs
+static int64_t stepsFromDouble(Q16 fixed, double exact)
+{
+    int64_t steps = (int64_t)fixed - q16FromDouble(exact);
+
+    return steps < 0 ? -steps : steps;
+}
+
+// Max error in steps over COMPARE_COUNT random inputs in the function
+// table's field ranges, and the fraction exact
+static int64_t compareWithDouble(const CompulationFunction *function,
+                                 Q16 (*fixed)(const Q16 *),
+                                 Q16 (*fixedConversion)(Q16),
+                                 double *exactFraction)
+{
+    int64_t worst = 0;
+    size_t exact = 0;
+
+    for (size_t k = 0; k < COMPARE_COUNT; k++)
+    {
+        Q16 arguments[5];
+        double values[5];
+
+        for (size_t p = 0; p < function->arity; p++)
+        {
+            arguments[p] = q16FromDouble(uniform(function->parameters[p].low, function->parameters[p].high));
+            values[p] = q16ToDouble(arguments[p]);
+        }
+
+        Q16 result = fixedConversion ? fixedConversion(arguments[0]) : fixed(arguments);
+        int64_t steps = stepsFromDouble(result, function->evaluate(values));
+
+        worst = steps > worst ? steps : worst;
+        exact += steps == 0;
+    }
+
+    *exactFraction = exact / (double)COMPARE_COUNT;
+
+    return worst;
+}
+
+static void timeFunction(const CompulationFunction *function,
+                         Q16 (*fixed)(const Q16 *),
+                         Q16 (*fixedConversion)(Q16),
+                         double *fixedNs,
+                         double *doubleNs)
+{
+    static Q16 arguments[SAMPLE_COUNT][5];
+    static double values[SAMPLE_COUNT][5];
+
+    for (size_t k = 0; k < SAMPLE_COUNT; k++)
+    {
+        for (size_t p = 0; p < function->arity; p++)
+        {
+            arguments[k][p] = q16FromDouble(uniform(function->parameters[p].low, function->parameters[p].high));
+            values[k][p] = q16ToDouble(arguments[k][p]);
+        }
+    }
+
+    int64_t fixedSum = 0;
+    double start = secondsNow();
+
+    for (int pass = 0; pass < TIMED_PASSES; pass++)
+    {
+        for (size_t k = 0; k < SAMPLE_COUNT; k++)
+        {
+            fixedSum += fixedConversion ? fixedConversion(arguments[k][0]) : fixed(arguments[k]);
+        }
+    }
+
+    *fixedNs = (secondsNow() - start) * 1e9 / ((double)SAMPLE_COUNT * TIMED_PASSES);
+
+    double doubleSum = 0.0;
+    start = secondsNow();
+
+    for (int pass = 0; pass < TIMED_PASSES; pass++)
+    {
+        for (size_t k = 0; k < SAMPLE_COUNT; k++)
+        {
+            doubleSum += function->evaluate(values[k]);
+        }
+    }
+
+    *doubleNs = (secondsNow() - start) * 1e9 / ((double)SAMPLE_COUNT * TIMED_PASSES);
+
+    sink = fixedSum + (int64_t)doubleSum;
+}
+
+static int report(const char *name, Q16 (*fixed)(const Q16 *), Q16 (*fixedConversion)(Q16), int64_t allowedSteps)
+{
+    const CompulationFunction *function = compulationFunctionNamed(name);
+    double exactFraction = 0.0;
+    double fixedNs = 0.0;
+    double doubleNs = 0.0;
+
+    int64_t worst = compareWithDouble(function, fixed, fixedConversion, &exactFraction);
+    timeFunction(function, fixed, fixedConversion, &fixedNs, &doubleNs);
+
+    printf("%-16s %10lld %9.4f%% %10.2f %10.2f%s\n", name, (long long)worst, exactFraction * 100.0, fixedNs,
+           doubleNs, worst > allowedSteps ? "  MISMATCH" : "");
+
+    return worst > allowedSteps;
+}
+
+int main(void)
+{
+    int failures = 0;
+    size_t vectorCount = sizeof(conversionVectors) / sizeof(conversionVectors[0]) +
+                         sizeof(mappedValueVectors) / sizeof(mappedValueVectors[0]) +
+                         sizeof(roundingVectors) / sizeof(roundingVectors[0]) +
+                         sizeof(leakRateVectors) / sizeof(leakRateVectors[0]);
+
+    srand(2016);
+
+    failures += checkConversionVectors();
+    failures += checkVectors("mappedValueQ16", fixedMappedValue, mappedValueVectors,
+                             sizeof(mappedValueVectors) / sizeof(mappedValueVectors[0]));
+    failures += checkVectors("mappedValueQ16", fixedMappedValue, roundingVectors,
+                             sizeof(roundingVectors) / sizeof(roundingVectors[0]));
+    failures += checkVectors("leakRateCFMQ16", fixedLeakRate, leakRateVectors,
+                             sizeof(leakRateVectors) / sizeof(leakRateVectors[0]));
+
+    printf("%zu reference vectors, %d mismatched\n\n", vectorCount, failures);
+
+    // Conversions and mappedValue are one rounding from the double result;
+    // the leak rate also carries the rounding of the tank volume.
+    printf("%-16s %10s %10s %10s %10s\n", "function", "max steps", "exact", "Q16 ns", "double ns");
+
+    for (size_t c = 0; c < CONVERSION_COUNT; c++)
+    {
+        failures += report(conversions[c].name, NULL, conversions[c].fixed, 1);
+    }
+
+    failures += report("mappedValue", fixedMappedValue, NULL, 1);
+    failures += report("leakRateCFM", fixedLeakRate, NULL, 3);
+
+    printf("one step is 1/65536\n");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+//
+//  FleetEnergyBench.c
+//
+//  Aggregates a month of one-minute samples from a synthetic fleet at
+//  increasing thread counts, against a single loop summing
+//  threePhaseMotorInputPowerKW, and checks the totals agree.
+//
+//  cc -O2 -I.. FleetEnergyBench.c ../FleetEnergy.c ../ThreadPool.c ../Compulations.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+#include "FleetEnergy.h"
+#include "ThreadPool.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MACHINE_COUNT 100
+#define SAMPLES_PER_MACHINE (31 * 24 * 60)
+#define SAMPLE_INTERVAL_SEC 60.0
+
+// 2026-01-15 00:00 UTC, so the month spans a month boundary
+#define START_TIME_SEC 1768435200.0
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+
+static double fleetEnergyKWh(const FleetEnergy *fleet)
+{
+    const FleetBucket *buckets;
+    size_t count = fleetEnergyBuckets(fleet, FleetPeriodMonth, &buckets);
+    double energy = 0.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (buckets[i].machine == FLEET_ALL_MACHINES)
+        {
+            energy += buckets[i].energyKWh;
+        }
+    }
+
+    return energy;
+}
+
+int main(void)
+{
+    size_t count = (size_t)MACHINE_COUNT * SAMPLES_PER_MACHINE;
+    FleetSample *samples = malloc(count * sizeof(FleetSample));
+
+    if (!samples)
+    {
+        return 1;
+    }
+
+    // Load/unload machines, loaded two thirds of the time
+    srand(13);
+
+    for (size_t m = 0; m < MACHINE_COUNT; m++)
+    {
+        for (size_t k = 0; k < SAMPLES_PER_MACHINE; k++)
+        {
+            FleetSample *sample = &samples[m * SAMPLES_PER_MACHINE + k];
+            int loaded = rand() % 3 != 0;
+
+            sample->timeSec = START_TIME_SEC + k * SAMPLE_INTERVAL_SEC;
+            sample->machine = (uint32_t)m;
+            sample->loaded = (uint32_t)loaded;
+            sample->volts = uniform(455.0, 485.0);
+            sample->amps = loaded ? uniform(80.0, 120.0) : uniform(28.0, 35.0);
+            sample->powerFactor = loaded ? 0.86 : 0.4;
+            sample->flowCFM = loaded ? uniform(380.0, 500.0) : 0.0;
+        }
+    }
+
+    // One thread, one running total
+    double start = secondsNow();
+    double naiveKW = 0.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        naiveKW += threePhaseMotorInputPowerKW(samples[i].volts, samples[i].amps, samples[i].powerFactor);
+    }
+
+    double naiveSeconds = secondsNow() - start;
+    double naiveKWh = naiveKW * SAMPLE_INTERVAL_SEC / 3600.0;
+
+    printf("%zu machines, %zu samples\n", (size_t)MACHINE_COUNT, count);
+    printf("%-26s %9.3f s %8.1f M samples/s   %.6f kWh\n", "single loop, total only", naiveSeconds, count / naiveSeconds * 1e-6, naiveKWh);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    double oneThreadSeconds = 0.0;
+    double referenceKWh = 0.0;
+
+    for (long threads = 1; threads <= (cpus > 1 ? cpus : 1); threads *= 2)
+    {
+        ThreadPool *pool = threadPoolCreate((size_t)threads);
+        FleetEnergy fleet;
+
+        if (!pool || fleetEnergyInit(&fleet, threadPoolSize(pool), SAMPLE_INTERVAL_SEC) != 0)
+        {
+            return 1;
+        }
+
+        start = secondsNow();
+        int status = fleetEnergyAddSamplesParallel(&fleet, pool, samples, count);
+        double addSeconds = secondsNow() - start;
+
+        start = secondsNow();
+        status |= fleetEnergyRollup(&fleet, pool);
+        double rollupSeconds = secondsNow() - start;
+
+        double seconds = addSeconds + rollupSeconds;
+        double energy = fleetEnergyKWh(&fleet);
+
+        if (threads == 1)
+        {
+            oneThreadSeconds = seconds;
+            referenceKWh = energy;
+        }
+
+        printf("%2ld thread%s %-16s %9.3f s %8.1f M samples/s   %.6f kWh  rollup %.3f s  speedup %.2f%s\n",
+               threads, threads == 1 ? " " : "s", "", seconds, count / seconds * 1e-6, energy, rollupSeconds,
+               oneThreadSeconds / seconds, status || energy != referenceKWh ? "  MISMATCH" : "");
+
+        fleetEnergyFree(&fleet);
+        threadPoolDestroy(pool);
+    }
+
+    free(samples);
+
+    return 0;
+}
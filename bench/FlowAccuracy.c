@@ -0,0 +1,202 @@
+//
+//  FlowAccuracy.c
+//
+//  Compares scfmFromACFMArrays, acfmFromSCFMArrays and the record versions
+//  with scfmFromACFM and acfmFromSCFM at every SIMD level the CPU supports,
+//  over the range BatchCompulations.h documents: ambient temperatures up to
+//  180 F and pressures of 10 psia or more. Reports the largest error in ULP
+//  and exits 1 if any level is more than 8 ULP off, or the scalar level is
+//  not exact.
+//
+//  compulations_flow_accuracy [--samples N]
+//
+//  cc -O2 -I.. FlowAccuracy.c ../BatchCompulations.c ../Compulations.c ../CompulationsInstrumentation.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchCompulations.h"
+#include "Compulations.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ULP 8
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+
+static const char *levelName(CompulationsSIMDLevel level)
+{
+    switch (level)
+    {
+        case CompulationsSIMDLevelAVX512:
+            return "avx512";
+        case CompulationsSIMDLevelAVX2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+// Distance in representable doubles, for results of either sign
+static uint64_t ulpDistance(double a, double b)
+{
+    int64_t x, y;
+    memcpy(&x, &a, sizeof(x));
+    memcpy(&y, &b, sizeof(y));
+
+    x = x < 0 ? INT64_MIN - x : x;
+    y = y < 0 ? INT64_MIN - y : y;
+
+    return x > y ? (uint64_t)x - (uint64_t)y : (uint64_t)y - (uint64_t)x;
+}
+
+static uint64_t worstDistance(const double *results, const double *reference, size_t count)
+{
+    uint64_t worst = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t distance = ulpDistance(results[i], reference[i]);
+        worst = distance > worst ? distance : worst;
+    }
+
+    return worst;
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = 1000000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            count = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--samples N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    count = count ? count : 1;
+
+    double *columns[8];
+    FlowConversionRecord *records = malloc(count * sizeof(FlowConversionRecord));
+    double *scfm = malloc(count * sizeof(double));
+    double *acfm = malloc(count * sizeof(double));
+    double *results = malloc(count * sizeof(double));
+
+    for (int c = 0; c < 8; c++)
+    {
+        columns[c] = malloc(count * sizeof(double));
+    }
+
+    // The first samples sit on the corners of the range, RH 1 at 180 F and
+    // 10 psia being the worst case for the RH correction.
+    srand(17);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int corner = i < 64;
+
+        FlowConversionRecord *record = &records[i];
+        record->flowCFM = uniform(1.0, 5000.0);
+        record->standardAmbientPressurePSI = corner ? (i & 1 ? 10.0 : 15.0) : uniform(10.0, 15.0);
+        record->standardAmbientTempF = corner ? (i & 2 ? -40.0 : 180.0) : uniform(-40.0, 180.0);
+        record->standardAmbientRH = corner ? (i & 4 ? 0.0 : 1.0) : uniform(0.0, 1.0);
+        record->siteAmbientPressurePSI = corner ? (i & 8 ? 10.0 : 15.0) : uniform(10.0, 15.0);
+        record->siteAmbientTempF = corner ? (i & 16 ? -40.0 : 180.0) : uniform(-40.0, 180.0);
+        record->siteAmbientRH = corner ? (i & 32 ? 0.0 : 1.0) : uniform(0.0, 1.0);
+        record->inletPressurePSI = uniform(10.0, 15.0);
+
+        columns[0][i] = record->flowCFM;
+        columns[1][i] = record->standardAmbientPressurePSI;
+        columns[2][i] = record->standardAmbientTempF;
+        columns[3][i] = record->standardAmbientRH;
+        columns[4][i] = record->siteAmbientPressurePSI;
+        columns[5][i] = record->siteAmbientTempF;
+        columns[6][i] = record->siteAmbientRH;
+        columns[7][i] = record->inletPressurePSI;
+
+        scfm[i] = scfmFromACFM(record->flowCFM, record->standardAmbientPressurePSI, record->standardAmbientTempF,
+                               record->standardAmbientRH, record->siteAmbientPressurePSI, record->siteAmbientTempF,
+                               record->siteAmbientRH, record->inletPressurePSI);
+        acfm[i] = acfmFromSCFM(record->flowCFM, record->standardAmbientPressurePSI, record->standardAmbientTempF,
+                               record->standardAmbientRH, record->siteAmbientPressurePSI, record->siteAmbientTempF,
+                               record->siteAmbientRH, record->inletPressurePSI);
+    }
+
+    FlowConversionArrays arrays = { columns[0], columns[1], columns[2], columns[3],
+                                    columns[4], columns[5], columns[6], columns[7] };
+    CompulationsSIMDLevel detected = compulationsDetectedSIMDLevel();
+    int failed = 0;
+
+    printf("%zu conversions, max error in ULP against the scalar functions\n", count);
+    printf("%-8s %12s %12s %12s %12s\n", "level", "scfmArrays", "acfmArrays", "scfmRecords", "acfmRecords");
+
+    for (int level = CompulationsSIMDLevelScalar; level <= (int)detected; level++)
+    {
+        compulationsSetSIMDLevel((CompulationsSIMDLevel)level);
+
+        uint64_t worst[4];
+        scfmFromACFMArrays(&arrays, results, count);
+        worst[0] = worstDistance(results, scfm, count);
+        acfmFromSCFMArrays(&arrays, results, count);
+        worst[1] = worstDistance(results, acfm, count);
+        scfmFromACFMRecords(records, results, count);
+        worst[2] = worstDistance(results, scfm, count);
+        acfmFromSCFMRecords(records, results, count);
+        worst[3] = worstDistance(results, acfm, count);
+
+        uint64_t allowed = level == CompulationsSIMDLevelScalar ? 0 : MAX_ULP;
+        int levelFailed = 0;
+
+        for (int k = 0; k < 4; k++)
+        {
+            levelFailed |= worst[k] > allowed;
+        }
+
+        printf("%-8s %12llu %12llu %12llu %12llu%s\n", levelName((CompulationsSIMDLevel)level),
+               (unsigned long long)worst[0], (unsigned long long)worst[1],
+               (unsigned long long)worst[2], (unsigned long long)worst[3], levelFailed ? "  FAIL" : "");
+        failed |= levelFailed;
+    }
+
+    compulationsSetSIMDLevel(detected);
+
+    for (int c = 0; c < 8; c++)
+    {
+        free(columns[c]);
+    }
+
+    free(records);
+    free(scfm);
+    free(acfm);
+    free(results);
+
+    return failed;
+}
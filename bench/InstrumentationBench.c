@@ -0,0 +1,201 @@
+//
+//  InstrumentationBench.c
+//
+//  Runs every function in Compulations.h over random field-range inputs on
+//  four threads, with one call in ten given a zero argument, then prints
+//  the instrumentation counters: calls, rejections by guard, non-finite
+//  results and sampled latency. Build the library with and without
+//  -DCOMPULATIONS_INSTRUMENTATION=ON to compare the ns/call. Exits 1 if the
+//  counters miss calls.
+//
+//  compulations_instrumentation_bench [--count N]
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CompulationsInstrumentation.h"
+#include "FunctionTable.h"
+#include "ThreadPool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define THREADS 4
+#define GRAIN 4096
+
+typedef struct Batch
+{
+    const CompulationFunction *function;
+    const double *columns[COMPULATION_MAX_ARITY];
+    double *results;
+} Batch;
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void evaluateRange(void *context, size_t begin, size_t end, size_t worker)
+{
+    Batch *batch = context;
+    const double *columns[COMPULATION_MAX_ARITY];
+
+    (void)worker;
+
+    for (size_t p = 0; p < batch->function->arity; p++)
+    {
+        columns[p] = batch->columns[p] + begin;
+    }
+
+    batch->function->evaluateColumns(columns, batch->results + begin, end - begin);
+}
+
+static void printStats(const CompulationCallStats *stats)
+{
+    printf("%-38s %10llu %9llu %8.0f %8.0f", stats->name, (unsigned long long)stats->calls,
+           (unsigned long long)stats->nonFinite, compulationLatencyPercentile(stats, 0.5),
+           compulationLatencyPercentile(stats, 0.99));
+
+    for (size_t g = 0; g < stats->guardCount; g++)
+    {
+        printf("%s%s: %llu", g == 0 ? "   " : ", ", stats->guards[g], (unsigned long long)stats->rejections[g]);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = 1000000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+        {
+            count = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--count N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    ThreadPool *pool = threadPoolCreate(THREADS);
+    double *storage = malloc((COMPULATION_MAX_ARITY + 1) * count * sizeof(double));
+
+    if (!pool || !storage || count == 0)
+    {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    printf("instrumentation %s\n", compulationsInstrumentationEnabled() ? "on" : "off");
+    printf("%-38s %8s\n", "function", "ns/call");
+
+    srand(2016);
+    compulationsInstrumentationReset();
+
+    size_t functionsRun = 0;
+
+    for (size_t i = 0; i < compulationFunctionCount(); i++)
+    {
+        const CompulationFunction *function = compulationFunctionAt(i);
+
+        if (strcmp(function->header, "Compulations.h") != 0)
+        {
+            continue;
+        }
+
+        Batch batch = { function, { NULL }, storage + COMPULATION_MAX_ARITY * count };
+
+        for (size_t p = 0; p < function->arity; p++)
+        {
+            const CompulationParameter *parameter = &function->parameters[p];
+            double *column = storage + p * count;
+
+            for (size_t k = 0; k < count; k++)
+            {
+                column[k] = parameter->low + (parameter->high - parameter->low) * (rand() / (double)RAND_MAX);
+            }
+
+            batch.columns[p] = column;
+        }
+
+        for (size_t k = 0; k < count; k += 10)
+        {
+            storage[(size_t)rand() % function->arity * count + k] = 0.0;
+        }
+
+        double start = secondsNow();
+        threadPoolParallelFor(pool, count, GRAIN, evaluateRange, &batch);
+        double seconds = secondsNow() - start;
+
+        printf("%-38s %8.2f\n", function->name, seconds * 1e9 / count);
+        functionsRun++;
+    }
+
+    // Counters from exited threads are kept
+    threadPoolDestroy(pool);
+
+    CompulationsSnapshot *snapshot = malloc(sizeof(*snapshot));
+
+    if (!snapshot)
+    {
+        return 1;
+    }
+
+    compulationsInstrumentationSnapshot(snapshot);
+
+    int failed = 0;
+
+    if (compulationsInstrumentationEnabled())
+    {
+        printf("\n%-38s %10s %9s %8s %8s   rejections by guard\n", "function", "calls", "nonfinite", "p50 ns",
+               "p99 ns");
+
+        for (size_t f = 0; f < InstrumentedFunctionCount; f++)
+        {
+            const CompulationCallStats *stats = &snapshot->functions[f];
+
+            printStats(stats);
+
+            // Nested calls only add to the count
+            if (stats->calls < count)
+            {
+                printf("    MISSING CALLS\n");
+                failed = 1;
+            }
+        }
+
+        printf("latency is sampled one call in %d and includes reading the clock\n",
+               COMPULATIONS_LATENCY_SAMPLE_INTERVAL);
+    }
+
+    printf("%zu functions, %zu calls each\n", functionsRun, count);
+
+    free(snapshot);
+    free(storage);
+
+    return failed;
+}
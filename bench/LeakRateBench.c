@@ -0,0 +1,179 @@
+//
+//  LeakRateBench.c
+//
+//  Runs synthetic leak-down tests with a known leak and gaussian gauge noise
+//  through LeakRateEstimator. Checks that the mean estimate is close to the
+//  true leak and that the 95% interval covers it in about 95% of the tests,
+//  exiting 1 if not. Then times a fleet of tanks fed a sample each per pass.
+//
+//  compulations_leak_rate_bench [--trials N]
+//
+//  cc -O2 -I.. LeakRateBench.c ../LeakRateEstimator.c -lm
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LeakRateEstimator.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TANK_GALLONS 1060.0
+#define AMBIENT_PSIA 14.7
+#define START_PSIG 110.0
+#define EVALUATION_PSIG 100.0
+#define DECAY_PER_MINUTE 0.01
+#define NOISE_PSI 0.05
+
+// A ten minute test read once a second
+#define TEST_SAMPLES 600
+
+#define FLEET_TANKS 10000
+#define FLEET_PASSES 600
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Box-Muller
+static double gaussian(void)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = rand() / (RAND_MAX + 1.0);
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static double decayPSIG(double seconds)
+{
+    return (START_PSIG + AMBIENT_PSIA) * exp(-DECAY_PER_MINUTE * seconds / 60.0) - AMBIENT_PSIA;
+}
+
+int main(int argc, char **argv)
+{
+    size_t trials = 1000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc)
+        {
+            trials = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--trials N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (trials < 100)
+    {
+        trials = 100;
+    }
+
+    // dP/dt = -k P, so the free air leaving is V * k * P / Pa per minute
+    double trueCFM = (TANK_GALLONS / 7.48052) * DECAY_PER_MINUTE * (EVALUATION_PSIG + AMBIENT_PSIA) / AMBIENT_PSIA;
+    double sumCFM = 0.0, sumWidth = 0.0;
+    size_t covered = 0;
+
+    srand(7);
+
+    for (size_t t = 0; t < trials; t++)
+    {
+        LeakRateEstimator estimator;
+        LeakRateEstimate estimate;
+
+        leakRateEstimatorInit(&estimator, TANK_GALLONS, AMBIENT_PSIA, 1.0);
+
+        for (int s = 0; s < TEST_SAMPLES; s++)
+        {
+            leakRateEstimatorAddSample(&estimator, s, decayPSIG(s) + NOISE_PSI * gaussian());
+        }
+
+        leakRateEstimatorEstimateAtPSIG(&estimator, EVALUATION_PSIG, &estimate);
+
+        sumCFM += estimate.leakCFM;
+        sumWidth += estimate.upperCFM - estimate.lowerCFM;
+        covered += estimate.lowerCFM <= trueCFM && trueCFM <= estimate.upperCFM;
+    }
+
+    double meanCFM = sumCFM / trials;
+    double coverage = (double)covered / trials;
+
+    // Coverage of a true 95% interval is binomial; allow three standard
+    // deviations either side.
+    double allowed = 3.0 * sqrt(0.95 * 0.05 / trials);
+    int failed = !(fabs(meanCFM - trueCFM) <= 0.01 * trueCFM) || !(fabs(coverage - 0.95) <= allowed);
+
+    printf("%zu tests, %d s at 1 Hz, %.2f psi noise\n", trials, TEST_SAMPLES, NOISE_PSI);
+    printf("%-28s %10.3f CFM at %.0f psig\n", "true leak", trueCFM, EVALUATION_PSIG);
+    printf("%-28s %10.3f CFM\n", "mean estimate", meanCFM);
+    printf("%-28s %10.3f CFM\n", "mean 95% interval width", sumWidth / trials);
+    printf("%-28s %10.3f (0.95 +/- %.3f)\n", "interval coverage", coverage, allowed);
+
+    if (failed)
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    // One sample per tank per pass, as from a fleet's telemetry
+    LeakRateEstimator *fleet = malloc(FLEET_TANKS * sizeof(LeakRateEstimator));
+    double *timeSec = malloc(FLEET_TANKS * sizeof(double));
+    double *psig = malloc(FLEET_TANKS * sizeof(double));
+
+    for (size_t i = 0; i < FLEET_TANKS; i++)
+    {
+        leakRateEstimatorInit(&fleet[i], 200.0 + i % 2000, AMBIENT_PSIA, 0.999);
+    }
+
+    double elapsed = 0.0;
+
+    for (int pass = 0; pass < FLEET_PASSES; pass++)
+    {
+        for (size_t i = 0; i < FLEET_TANKS; i++)
+        {
+            timeSec[i] = pass;
+            psig[i] = decayPSIG(pass) + NOISE_PSI * gaussian();
+        }
+
+        double start = secondsNow();
+        leakRateEstimatorAddSamples(fleet, timeSec, psig, FLEET_TANKS);
+        elapsed += secondsNow() - start;
+    }
+
+    LeakRateEstimate estimate;
+    leakRateEstimatorEstimateAtPSIG(&fleet[0], EVALUATION_PSIG, &estimate);
+
+    printf("\n%d tanks, %d passes\n", FLEET_TANKS, FLEET_PASSES);
+    printf("%-28s %10.1f M samples/s\n", "leakRateEstimatorAddSamples", FLEET_TANKS * (double)FLEET_PASSES / elapsed * 1e-6);
+    printf("%-28s %10.3f CFM\n", "first tank", estimate.leakCFM);
+
+    free(fleet);
+    free(timeSec);
+    free(psig);
+
+    return 0;
+}
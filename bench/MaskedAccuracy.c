@@ -0,0 +1,371 @@
+//
+//  MaskedAccuracy.c
+//
+//  Checks refillRateCFMArray, eventStorageCubicFeetArray,
+//  oilCarryoverGallonsArray and velocityInPipeFPSArray against the scalar
+//  functions at every SIMD level the CPU supports. Inputs mix ordinary
+//  values with NaN, signed zeros, negatives, infinities and denormals.
+//  Results must match bit for bit, the returned count and every mask bit
+//  must match the scalar guard, and mask bits past count must stay clear.
+//  Exits 1 on any mismatch.
+//
+//  compulations_masked_accuracy [--samples N]
+//
+//  cc -O2 -I.. MaskedAccuracy.c ../BatchCompulations.c ../Compulations.c ../CompulationsInstrumentation.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchCompulations.h"
+#include "Compulations.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ARGUMENTS 6
+
+// Poisons output and mask words so unwritten ones show up
+#define POISON_BITS 0xA5A5A5A5A5A5A5A5ull
+
+typedef size_t (*MaskedArrayFunction)(const double *const *columns, double *results, uint64_t *valid, size_t count);
+typedef double (*ScalarFunction)(const double *arguments);
+typedef int (*GuardFunction)(const double *arguments);
+
+typedef struct
+{
+    const char *name;
+    int arguments;
+    double low[MAX_ARGUMENTS];
+    double high[MAX_ARGUMENTS];
+    MaskedArrayFunction array;
+    ScalarFunction scalar;
+    GuardFunction guard;
+} MaskedCase;
+
+static size_t refillRateArray(const double *const *c, double *results, uint64_t *valid, size_t count)
+{
+    return refillRateCFMArray(c[0], c[1], c[2], c[3], c[4], results, valid, count);
+}
+
+static double refillRateOne(const double *a)
+{
+    return refillRateCFM(a[0], a[1], a[2], a[3], a[4]);
+}
+
+static int refillRateGuard(const double *a)
+{
+    return a[2] - a[1] > 0.0 && a[0] > 0.0 && a[3] > 0.0 && a[4] > 0.0;
+}
+
+static size_t eventStorageArray(const double *const *c, double *results, uint64_t *valid, size_t count)
+{
+    return eventStorageCubicFeetArray(c[0], c[1], c[2], c[3], c[4], c[5], results, valid, count);
+}
+
+static double eventStorageOne(const double *a)
+{
+    return eventStorageCubicFeet(a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+static int eventStorageGuard(const double *a)
+{
+    return a[0] > 0.0 && a[1] - a[2] > 0.0 && a[4] - a[5] > 0.0 && a[3] > 0.0;
+}
+
+static size_t oilCarryoverArray(const double *const *c, double *results, uint64_t *valid, size_t count)
+{
+    return oilCarryoverGallonsArray(c[0], c[1], c[2], c[3], results, valid, count);
+}
+
+static double oilCarryoverOne(const double *a)
+{
+    return oilCarryoverGallons(a[0], a[1], a[2], a[3]);
+}
+
+static int oilCarryoverGuard(const double *a)
+{
+    return a[0] > 0.0 && a[1] > 0.0 && a[2] > 0.0 && a[3] > 0.0;
+}
+
+static size_t velocityArray(const double *const *c, double *results, uint64_t *valid, size_t count)
+{
+    return velocityInPipeFPSArray(c[0], c[1], c[2], c[3], results, valid, count);
+}
+
+static double velocityOne(const double *a)
+{
+    return velocityInPipeFPS(a[0], a[1], a[2], a[3]);
+}
+
+static int velocityGuard(const double *a)
+{
+    return a[0] > 0.0 && a[1] > 0.0 && a[2] > 0.0 && a[3] > 0.0;
+}
+
+static const MaskedCase cases[] =
+{
+    { "refillRate", 5, { 1.0, 50.0, 75.0, 0.1, 10.0 }, { 5000.0, 125.0, 150.0, 60.0, 15.0 },
+      refillRateArray, refillRateOne, refillRateGuard },
+    { "eventStorage", 6, { 0.1, 50.0, 0.0, 10.0, 90.0, 60.0 }, { 30.0, 2000.0, 1500.0, 15.0, 150.0, 120.0 },
+      eventStorageArray, eventStorageOne, eventStorageGuard },
+    { "oilCarryover", 4, { 1.0, 0.5, 1.0, 0.8 }, { 5000.0, 20.0, 8760.0, 0.95 },
+      oilCarryoverArray, oilCarryoverOne, oilCarryoverGuard },
+    { "velocity", 4, { 1.0, 50.0, 10.0, 0.5 }, { 5000.0, 150.0, 15.0, 12.0 },
+      velocityArray, velocityOne, velocityGuard },
+};
+
+#define CASE_COUNT (sizeof(cases) / sizeof(cases[0]))
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+
+// A quarter of the inputs are values the guards have to cope with, and
+// some of the rest are negated
+static double sample(double low, double high)
+{
+    static const double special[] = { NAN, -NAN, 0.0, -0.0, INFINITY, -INFINITY, DBL_MAX, -DBL_MAX,
+                                      DBL_MIN, 4.9e-324, -4.9e-324, 1e-310, -1e-310, -1.0 };
+
+    if (rand() % 4 == 0)
+    {
+        return special[rand() % (int)(sizeof(special) / sizeof(special[0]))];
+    }
+
+    double value = uniform(low, high);
+
+    return rand() % 16 == 0 ? -value : value;
+}
+
+static const char *levelName(CompulationsSIMDLevel level)
+{
+    switch (level)
+    {
+        case CompulationsSIMDLevelAVX512:
+            return "avx512";
+        case CompulationsSIMDLevelAVX2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+// Runs one case on count calls starting at offset, with and without a mask,
+// and returns the number of mismatches
+static size_t checkRun(const MaskedCase *test, double *const *columns, const double *reference,
+                       const uint64_t *expected, size_t offset, size_t count, double *results, uint64_t *valid)
+{
+    const double *shifted[MAX_ARGUMENTS];
+    size_t words = (count + 63) / 64;
+    size_t expectedValid = 0;
+    size_t mismatches = 0;
+
+    for (int a = 0; a < test->arguments; a++)
+    {
+        shifted[a] = columns[a] + offset;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        expectedValid += (expected[(offset + i) / 64] >> ((offset + i) % 64)) & 1;
+    }
+
+    // One word past the end checks nothing writes beyond (count + 63) / 64
+    for (size_t w = 0; w <= words; w++)
+    {
+        valid[w] = POISON_BITS;
+    }
+
+    memset(results, 0xA5, (count + 1) * sizeof(double));
+
+    size_t returned = test->array(shifted, results, valid, count);
+    mismatches += returned != expectedValid;
+    mismatches += valid[words] != POISON_BITS;
+    mismatches += memcmp(&results[count], &(uint64_t){ POISON_BITS }, sizeof(double)) != 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int bit = (valid[i / 64] >> (i % 64)) & 1;
+        int wanted = (expected[(offset + i) / 64] >> ((offset + i) % 64)) & 1;
+
+        mismatches += bit != wanted;
+        mismatches += memcmp(&results[i], &reference[offset + i], sizeof(double)) != 0;
+    }
+
+    if (count % 64)
+    {
+        mismatches += (valid[count / 64] >> (count % 64)) != 0;
+    }
+
+    // A NULL mask must not change the results or the count
+    memset(results, 0xA5, count * sizeof(double));
+    mismatches += test->array(shifted, results, NULL, count) != expectedValid;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        mismatches += memcmp(&results[i], &reference[offset + i], sizeof(double)) != 0;
+    }
+
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    size_t samples = 100037;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            samples = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--samples N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Short counts end inside the first vector, the first mask word and
+    // the second; none of the fixed ones is a multiple of 64
+    size_t counts[] = { 1, 3, 7, 63, 65, 127, 129, 1001, samples };
+    size_t countCount = sizeof(counts) / sizeof(counts[0]);
+    size_t offsets[] = { 0, 1, 5 };
+    size_t offsetCount = sizeof(offsets) / sizeof(offsets[0]);
+    size_t capacity = samples + offsets[offsetCount - 1];
+
+    for (size_t c = 0; c < countCount; c++)
+    {
+        counts[c] = counts[c] < samples ? counts[c] : samples;
+    }
+
+    double *columns[MAX_ARGUMENTS];
+    double *reference = malloc(capacity * sizeof(double));
+    uint64_t *expected = calloc((capacity + 63) / 64, sizeof(uint64_t));
+    double *results = malloc((capacity + 1) * sizeof(double));
+    uint64_t *valid = malloc(((capacity + 63) / 64 + 1) * sizeof(uint64_t));
+
+    for (int a = 0; a < MAX_ARGUMENTS; a++)
+    {
+        columns[a] = malloc(capacity * sizeof(double));
+    }
+
+    CompulationsSIMDLevel detected = compulationsDetectedSIMDLevel();
+    size_t mismatches[CASE_COUNT][3] = { { 0 } };
+    size_t validCalls[CASE_COUNT];
+
+    srand(29);
+
+    for (size_t t = 0; t < CASE_COUNT; t++)
+    {
+        const MaskedCase *test = &cases[t];
+
+        memset(expected, 0, (capacity + 63) / 64 * sizeof(uint64_t));
+        validCalls[t] = 0;
+
+        for (size_t i = 0; i < capacity; i++)
+        {
+            double arguments[MAX_ARGUMENTS];
+
+            for (int a = 0; a < test->arguments; a++)
+            {
+                arguments[a] = columns[a][i] = sample(test->low[a], test->high[a]);
+            }
+
+            reference[i] = test->scalar(arguments);
+
+            if (test->guard(arguments))
+            {
+                expected[i / 64] |= 1ull << (i % 64);
+                validCalls[t] += i < samples;
+            }
+        }
+
+        for (int level = CompulationsSIMDLevelScalar; level <= (int)detected; level++)
+        {
+            compulationsSetSIMDLevel((CompulationsSIMDLevel)level);
+
+            for (size_t c = 0; c < countCount; c++)
+            {
+                for (size_t o = 0; o < offsetCount; o++)
+                {
+                    mismatches[t][level] += checkRun(test, columns, reference, expected, offsets[o], counts[c],
+                                                     results, valid);
+                }
+            }
+        }
+    }
+
+    compulationsSetSIMDLevel(detected);
+
+    int failed = 0;
+
+    printf("%zu calls, %zu counts from 1 to %zu at offsets 0, 1 and 5, mismatches against the scalar functions\n",
+           samples, countCount, samples);
+    printf("%-8s", "level");
+
+    for (size_t t = 0; t < CASE_COUNT; t++)
+    {
+        printf(" %14s", cases[t].name);
+    }
+
+    printf("\n");
+
+    for (int level = CompulationsSIMDLevelScalar; level <= (int)detected; level++)
+    {
+        int levelFailed = 0;
+
+        printf("%-8s", levelName((CompulationsSIMDLevel)level));
+
+        for (size_t t = 0; t < CASE_COUNT; t++)
+        {
+            printf(" %14zu", mismatches[t][level]);
+            levelFailed |= mismatches[t][level] != 0;
+        }
+
+        printf("%s\n", levelFailed ? "  MISMATCH" : "");
+        failed |= levelFailed;
+    }
+
+    printf("%-8s", "valid");
+
+    for (size_t t = 0; t < CASE_COUNT; t++)
+    {
+        printf(" %14zu", validCalls[t]);
+    }
+
+    printf("\n");
+
+    for (int a = 0; a < MAX_ARGUMENTS; a++)
+    {
+        free(columns[a]);
+    }
+
+    free(reference);
+    free(expected);
+    free(results);
+    free(valid);
+
+    return failed;
+}
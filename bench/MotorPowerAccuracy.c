@@ -0,0 +1,320 @@
+//
+//  MotorPowerAccuracy.c
+//
+//  Checks MotorPowerAnalyzer against balanced three-phase sinusoids with a
+//  known power factor, for both voltage wirings at every SIMD level the CPU
+//  supports. Windows span whole line cycles, so every RMS and power value
+//  is known exactly. The record is fed in uneven chunks, and each window
+//  must also match motorPowerFromWaveforms over the same samples. Exits 1
+//  on any mismatch.
+//
+//  compulations_motor_accuracy [--cycles N] [--pf PF]
+//
+//  cc -O2 -I.. MotorPowerAccuracy.c ../MotorPowerAnalyzer.c ../BatchCompulations.c ../Compulations.c ../CompulationsInstrumentation.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MotorPowerAnalyzer.h"
+#include "BatchCompulations.h"
+#include "Compulations.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_HZ 60.0
+#define SAMPLES_PER_CYCLE 128
+#define WINDOW_CYCLES 12
+#define HOP_CYCLES 2
+
+#define LINE_VOLTS 480.0
+#define PHASE_AMPS 50.0
+#define EFFICIENCY 0.93
+
+// Against the exact values, and against a whole-record call on the same
+// samples, which only differs in summation order
+#define EXPECTED_TOLERANCE 1e-9
+#define WINDOW_TOLERANCE 1e-12
+
+typedef struct
+{
+    const double *volts[MOTOR_PHASES];
+    const double *amps[MOTOR_PHASES];
+    MotorVoltageWiring wiring;
+    const MotorPowerResult *expected;
+    size_t windowSamples;
+    size_t hopSamples;
+    double sampleRateHz;
+
+    size_t windows;
+    size_t badEndTimes;
+    double worstExpected;
+    double worstWhole;
+} WindowCheck;
+
+static const char *levelName(CompulationsSIMDLevel level)
+{
+    switch (level)
+    {
+        case CompulationsSIMDLevelAVX512:
+            return "avx512";
+        case CompulationsSIMDLevelAVX2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+// Largest relative difference over every reported value; a NaN anywhere
+// comes back as infinity. Reactive power is sqrt(S^2 - P^2), which loses
+// half its digits as the power factor nears 1, so it is compared by the
+// difference in Q^2 / S^2 instead.
+static double worstRelative(const MotorPowerResult *result, const MotorPowerResult *reference)
+{
+    double apparentSquared = reference->apparentPowerKVA * reference->apparentPowerKVA;
+    double reactiveSquared[2] = { result->reactivePowerKVAR * result->reactivePowerKVAR / apparentSquared,
+                                  reference->reactivePowerKVAR * reference->reactivePowerKVAR / apparentSquared };
+
+    double values[][2] =
+    {
+        { result->voltsRms[0], reference->voltsRms[0] },
+        { result->voltsRms[1], reference->voltsRms[1] },
+        { result->voltsRms[2], reference->voltsRms[2] },
+        { result->ampsRms[0], reference->ampsRms[0] },
+        { result->ampsRms[1], reference->ampsRms[1] },
+        { result->ampsRms[2], reference->ampsRms[2] },
+        { result->lineVoltsRms, reference->lineVoltsRms },
+        { result->lineAmpsRms, reference->lineAmpsRms },
+        { result->realPowerKW, reference->realPowerKW },
+        { 1.0 + reactiveSquared[0], 1.0 + reactiveSquared[1] },
+        { result->apparentPowerKVA, reference->apparentPowerKVA },
+        { result->powerFactor, reference->powerFactor },
+        { result->shaftPowerHP, reference->shaftPowerHP },
+    };
+    double worst = 0.0;
+
+    for (size_t k = 0; k < sizeof(values) / sizeof(values[0]); k++)
+    {
+        double error = fabs(values[k][0] - values[k][1]) / fabs(values[k][1]);
+
+        if (!(error <= worst))
+        {
+            worst = error == error ? error : INFINITY;
+        }
+    }
+
+    return worst;
+}
+
+static void checkWindow(void *context, const MotorPowerResult *result)
+{
+    WindowCheck *check = context;
+    size_t end = check->windowSamples + check->windows * check->hopSamples;
+    size_t start = end - check->windowSamples;
+
+    check->badEndTimes += result->endTimeSec != end / check->sampleRateHz;
+
+    const double *v[MOTOR_PHASES] = { check->volts[0] + start, check->volts[1] + start, check->volts[2] + start };
+    const double *a[MOTOR_PHASES] = { check->amps[0] + start, check->amps[1] + start, check->amps[2] + start };
+    MotorPowerResult whole;
+
+    motorPowerFromWaveforms(v, a, check->windowSamples, check->wiring, EFFICIENCY, &whole);
+
+    double expectedError = worstRelative(result, check->expected);
+    double wholeError = worstRelative(result, &whole);
+
+    check->worstExpected = expectedError <= check->worstExpected ? check->worstExpected : expectedError;
+    check->worstWhole = wholeError <= check->worstWhole ? check->worstWhole : wholeError;
+    check->windows++;
+}
+
+int main(int argc, char **argv)
+{
+    size_t cycles = 60;
+    double powerFactor = 0.85;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc)
+        {
+            cycles = (size_t)atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--pf") == 0 && i + 1 < argc)
+        {
+            powerFactor = atof(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--cycles N] [--pf PF]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (cycles < WINDOW_CYCLES || !(powerFactor > 0.0 && powerFactor <= 1.0))
+    {
+        fprintf(stderr, "need at least %d cycles and a power factor in (0, 1]\n", WINDOW_CYCLES);
+        return 1;
+    }
+
+    double sampleRateHz = LINE_HZ * SAMPLES_PER_CYCLE;
+    size_t count = cycles * SAMPLES_PER_CYCLE;
+    size_t windowSamples = WINDOW_CYCLES * SAMPLES_PER_CYCLE;
+    size_t hopSamples = HOP_CYCLES * SAMPLES_PER_CYCLE;
+    double phaseVolts = LINE_VOLTS / sqrt(3.0);
+    double lag = acos(powerFactor);
+
+    // Phase voltages and currents, b lagging a by 120 degrees, and the
+    // line-to-line channels Vab, Vbc, Vca formed from them
+    double *phase[MOTOR_PHASES], *line[MOTOR_PHASES], *amps[MOTOR_PHASES];
+
+    for (int k = 0; k < MOTOR_PHASES; k++)
+    {
+        phase[k] = malloc(count * sizeof(double));
+        line[k] = malloc(count * sizeof(double));
+        amps[k] = malloc(count * sizeof(double));
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double angle = 2.0 * M_PI * (double)(i % SAMPLES_PER_CYCLE) / SAMPLES_PER_CYCLE;
+
+        for (int k = 0; k < MOTOR_PHASES; k++)
+        {
+            double shift = -2.0 * M_PI * k / MOTOR_PHASES;
+            phase[k][i] = phaseVolts * sqrt(2.0) * sin(angle + shift);
+            amps[k][i] = PHASE_AMPS * sqrt(2.0) * sin(angle + shift - lag);
+        }
+
+        for (int k = 0; k < MOTOR_PHASES; k++)
+        {
+            line[k][i] = phase[k][i] - phase[(k + 1) % MOTOR_PHASES][i];
+        }
+    }
+
+    // Exact values for a balanced load
+    MotorPowerResult expected;
+    memset(&expected, 0, sizeof(expected));
+
+    for (int k = 0; k < MOTOR_PHASES; k++)
+    {
+        expected.ampsRms[k] = PHASE_AMPS;
+    }
+
+    expected.lineVoltsRms = LINE_VOLTS;
+    expected.lineAmpsRms = PHASE_AMPS;
+    expected.apparentPowerKVA = sqrt(3.0) * LINE_VOLTS * PHASE_AMPS / 1000.0;
+    expected.realPowerKW = expected.apparentPowerKVA * powerFactor;
+    expected.reactivePowerKVAR = expected.apparentPowerKVA * sin(lag);
+    expected.powerFactor = powerFactor;
+    expected.shaftPowerHP = threePhaseShaftPowerHP(LINE_VOLTS, PHASE_AMPS, EFFICIENCY, powerFactor);
+
+    CompulationsSIMDLevel detected = compulationsDetectedSIMDLevel();
+    size_t expectedWindows = (count - windowSamples) / hopSamples + 1;
+    int failed = 0;
+
+    printf("%zu cycles at %.0f Hz, PF %.3f, %d cycle windows every %d cycles\n",
+           cycles, sampleRateHz, powerFactor, WINDOW_CYCLES, HOP_CYCLES);
+    printf("%-8s %-14s %8s %14s %14s %14s\n", "level", "wiring", "windows", "vs exact", "vs whole", "record");
+
+    for (int level = CompulationsSIMDLevelScalar; level <= (int)detected; level++)
+    {
+        compulationsSetSIMDLevel((CompulationsSIMDLevel)level);
+
+        for (int w = MotorVoltageLineToNeutral; w <= MotorVoltageLineToLine; w++)
+        {
+            MotorVoltageWiring wiring = (MotorVoltageWiring)w;
+            double *const *volts = wiring == MotorVoltageLineToLine ? line : phase;
+
+            for (int k = 0; k < MOTOR_PHASES; k++)
+            {
+                expected.voltsRms[k] = wiring == MotorVoltageLineToLine ? LINE_VOLTS : phaseVolts;
+            }
+
+            WindowCheck check;
+            memset(&check, 0, sizeof(check));
+
+            for (int k = 0; k < MOTOR_PHASES; k++)
+            {
+                check.volts[k] = volts[k];
+                check.amps[k] = amps[k];
+            }
+
+            check.wiring = wiring;
+            check.expected = &expected;
+            check.windowSamples = windowSamples;
+            check.hopSamples = hopSamples;
+            check.sampleRateHz = sampleRateHz;
+
+            MotorPowerAnalyzer analyzer;
+
+            if (motorPowerAnalyzerInit(&analyzer, sampleRateHz, windowSamples, hopSamples, wiring, EFFICIENCY) != 0)
+            {
+                fprintf(stderr, "motorPowerAnalyzerInit failed\n");
+                return 1;
+            }
+
+            // Chunks from 1 sample to several hops, so hops and windows
+            // close in the middle of calls as well as at their ends
+            srand(11);
+            size_t completed = 0;
+
+            for (size_t i = 0; i < count;)
+            {
+                size_t chunk = 1 + (size_t)rand() % (2 * hopSamples + 37);
+                chunk = chunk < count - i ? chunk : count - i;
+
+                const double *v[MOTOR_PHASES] = { volts[0] + i, volts[1] + i, volts[2] + i };
+                const double *a[MOTOR_PHASES] = { amps[0] + i, amps[1] + i, amps[2] + i };
+                completed += motorPowerAnalyzerAddSamples(&analyzer, v, a, chunk, checkWindow, &check);
+                i += chunk;
+            }
+
+            motorPowerAnalyzerFree(&analyzer);
+
+            MotorPowerResult record;
+            motorPowerFromWaveforms((const double *const *)volts, (const double *const *)amps, count,
+                                    wiring, EFFICIENCY, &record);
+            double recordError = worstRelative(&record, &expected);
+
+            int caseFailed = completed != expectedWindows || check.windows != expectedWindows ||
+                             check.badEndTimes != 0 ||
+                             !(check.worstExpected <= EXPECTED_TOLERANCE) ||
+                             !(check.worstWhole <= WINDOW_TOLERANCE) ||
+                             !(recordError <= EXPECTED_TOLERANCE);
+
+            printf("%-8s %-14s %8zu %14.3g %14.3g %14.3g%s\n", levelName((CompulationsSIMDLevel)level),
+                   wiring == MotorVoltageLineToLine ? "line-to-line" : "line-to-neutral", check.windows,
+                   check.worstExpected, check.worstWhole, recordError, caseFailed ? "  MISMATCH" : "");
+            failed |= caseFailed;
+        }
+    }
+
+    compulationsSetSIMDLevel(detected);
+
+    for (int k = 0; k < MOTOR_PHASES; k++)
+    {
+        free(phase[k]);
+        free(line[k]);
+        free(amps[k]);
+    }
+
+    return failed;
+}
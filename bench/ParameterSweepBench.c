@@ -0,0 +1,149 @@
+//
+//  ParameterSweepBench.c
+//
+//  Sweeps a 20 million point pumpup time grid with nested loops calling
+//  pumpupTimeInSeconds, then with parameterSweepRun at increasing thread
+//  counts, and checks the min, max and argmin agree.
+//
+//  cc -O2 -I.. ParameterSweepBench.c ../ParameterSweep.c ../FunctionTable.c ../ThreadPool.c ../Compulations.c ../UnitConversion.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+#include "FunctionTable.h"
+#include "ParameterSweep.h"
+#include "ThreadPool.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TANK_POINTS 100
+#define FLOW_POINTS 100
+#define START_POINTS 20
+#define END_POINTS 20
+#define AMBIENT_POINTS 5
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Same spacing as the sweep
+static inline double axisValue(const SweepAxis *axis, int point)
+{
+    double step = (axis->high - axis->low) / (double)(axis->points - 1);
+
+    return point + 1 == (int)axis->points ? axis->high : axis->low + step * point;
+}
+
+int main(void)
+{
+    SweepSpace space;
+    sweepSpaceInit(&space, compulationFunctionNamed("pumpupTimeInSeconds"));
+    sweepSpaceSetAxis(&space, "tankSizeGallons", 60.0, 5000.0, TANK_POINTS);
+    sweepSpaceSetAxis(&space, "flowRateCFM", 20.0, 2000.0, FLOW_POINTS);
+    sweepSpaceSetAxis(&space, "startPressurePSIG", 0.0, 90.0, START_POINTS);
+    sweepSpaceSetAxis(&space, "endPressurePSIG", 100.0, 150.0, END_POINTS);
+    sweepSpaceSetAxis(&space, "ambientAtmosphericPressurePSIA", 13.0, 14.7, AMBIENT_POINTS);
+
+    uint64_t count = sweepSpacePointCount(&space);
+
+    // The scripting-loop way, one call per point
+    double start = secondsNow();
+    double min = 0.0;
+    double max = 0.0;
+    uint64_t argmin = 0;
+    uint64_t index = 0;
+
+    for (int t = 0; t < TANK_POINTS; t++)
+    {
+        for (int f = 0; f < FLOW_POINTS; f++)
+        {
+            for (int s = 0; s < START_POINTS; s++)
+            {
+                for (int e = 0; e < END_POINTS; e++)
+                {
+                    for (int a = 0; a < AMBIENT_POINTS; a++, index++)
+                    {
+                        double seconds = pumpupTimeInSeconds(axisValue(&space.axes[0], t),
+                                                             axisValue(&space.axes[1], f),
+                                                             axisValue(&space.axes[2], s),
+                                                             axisValue(&space.axes[3], e),
+                                                             axisValue(&space.axes[4], a));
+
+                        if (index == 0 || seconds < min)
+                        {
+                            min = seconds;
+                            argmin = index;
+                        }
+
+                        if (index == 0 || seconds > max)
+                        {
+                            max = seconds;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    double loopSeconds = secondsNow() - start;
+
+    printf("%llu points\n", (unsigned long long)count);
+    printf("%-22s %8.3f s %8.1f M points/s   min %.6f s at %llu\n", "nested loops", loopSeconds,
+           count / loopSeconds * 1e-6, min, (unsigned long long)argmin);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    double oneThreadSeconds = 0.0;
+
+    for (long threads = 1; threads <= (cpus > 1 ? cpus : 1); threads *= 2)
+    {
+        ThreadPool *pool = threadPoolCreate((size_t)threads);
+        SweepSummary summary;
+
+        if (!pool)
+        {
+            return 1;
+        }
+
+        start = secondsNow();
+        int status = parameterSweepRun(&space, pool, NULL, NULL, &summary);
+        double seconds = secondsNow() - start;
+
+        if (threads == 1)
+        {
+            oneThreadSeconds = seconds;
+        }
+
+        int agree = status == 0 && summary.count == count && summary.min == min && summary.max == max &&
+                    summary.argmin == argmin;
+
+        printf("%2ld thread%s %-12s %8.3f s %8.1f M points/s   min %.6f s at %llu  speedup %.2f%s\n",
+               threads, threads == 1 ? " " : "s", "", seconds, count / seconds * 1e-6, summary.min,
+               (unsigned long long)summary.argmin, oneThreadSeconds / seconds, agree ? "" : "  MISMATCH");
+
+        threadPoolDestroy(pool);
+    }
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+//
+//  PipeNetworkBench.c
+//
+//  Solves a square grid of branch lines with a 6" main every 50 rows and
+//  columns, fed from two opposite corners, with demand at one junction in
+//  twenty. Times a cold solve and a warm restart after one demand changes,
+//  and checks both solutions: flow must balance at every junction and each
+//  segment's drop must match pipePressureDropPSI at its flow and mean line
+//  pressure. Exits 1 if a check fails.
+//
+//  compulations_pipe_network_bench [--size N]
+//
+//  cc -O2 -I.. PipeNetworkBench.c ../PipeNetwork.c ../Compulations.c ../CompulationsInstrumentation.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+#include "PipeNetwork.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define AMBIENT_PSIA 14.7
+#define AIR_TEMPERATURE_F 68.0
+#define SUPPLY_PSIG 115.0
+#define TOLERANCE_PSI 1e-6
+#define MAX_ITERATIONS 100
+
+// Imbalance allowed as a fraction of the total demand. A drop may be off by
+// a fraction of itself plus what the pressure tolerance leaves unsettled.
+// Segments under 1 CFM are left out of the drop check: the solver floors
+// their flow to stay well conditioned.
+#define BALANCE_TOLERANCE 1e-6
+#define DROP_TOLERANCE 1e-3
+#define DROP_SLACK_PSI (10.0 * TOLERANCE_PSI)
+#define DROP_MIN_CFM 1.0
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int checkSolution(const char *name, const PipeNetwork *network)
+{
+    double *inflow = calloc(network->nodeCount, sizeof(double));
+    double totalDemand = 0.0, worstImbalance = 0.0, worstDrop = 0.0;
+    int dropFailed = 0;
+
+    for (size_t s = 0; s < network->segmentCount; s++)
+    {
+        const PipeSegment *segment = &network->segments[s];
+        inflow[segment->fromNode] -= network->flowCFM[s];
+        inflow[segment->toNode] += network->flowCFM[s];
+
+        double flow = fabs(network->flowCFM[s]);
+
+        if (flow >= DROP_MIN_CFM)
+        {
+            double linePSIG = 0.5 * (network->pressurePSIG[segment->fromNode] + network->pressurePSIG[segment->toNode]);
+            double expected = pipePressureDropPSI(flow,
+                                                  linePSIG,
+                                                  network->ambientPSIA,
+                                                  network->airTemperatureF,
+                                                  segment->diameterIn,
+                                                  segment->lengthFt + segment->fittingsLengthFt);
+            double error = fabs(network->pressureDropPSI[s] - expected);
+            worstDrop = error > worstDrop ? error : worstDrop;
+            dropFailed |= !(error <= DROP_TOLERANCE * expected + DROP_SLACK_PSI);
+        }
+    }
+
+    for (size_t i = 0; i < network->nodeCount; i++)
+    {
+        if (!network->isSupply[i])
+        {
+            double imbalance = fabs(inflow[i] - network->demandCFM[i]);
+            worstImbalance = imbalance > worstImbalance ? imbalance : worstImbalance;
+            totalDemand += network->demandCFM[i];
+        }
+    }
+
+    free(inflow);
+
+    int failed = !(worstImbalance <= BALANCE_TOLERANCE * totalDemand) || dropFailed;
+
+    printf("%-12s worst imbalance %.3g CFM, worst drop error %.3g psi%s\n",
+           name, worstImbalance, worstDrop, failed ? "  FAIL" : "");
+
+    return failed ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t side = 200;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            side = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--size N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (side < 2)
+    {
+        side = 2;
+    }
+
+    size_t nodeCount = side * side;
+    PipeSegment *segments = malloc(2 * nodeCount * sizeof(PipeSegment));
+    size_t segmentCount = 0;
+
+    // 1-1/2" branches, 30 ft between junctions plus 5 ft of fittings
+    for (size_t y = 0; y < side; y++)
+    {
+        for (size_t x = 0; x < side; x++)
+        {
+            uint32_t node = (uint32_t)(y * side + x);
+
+            if (x + 1 < side)
+            {
+                segments[segmentCount++] = (PipeSegment){ node, node + 1, y % 50 == 0 ? 6.065 : 1.61, 30.0, 5.0 };
+            }
+
+            if (y + 1 < side)
+            {
+                segments[segmentCount++] = (PipeSegment){ node, node + (uint32_t)side, x % 50 == 0 ? 6.065 : 1.61, 30.0, 5.0 };
+            }
+        }
+    }
+
+    PipeNetwork network;
+
+    if (pipeNetworkInit(&network, segments, segmentCount, nodeCount, AMBIENT_PSIA, AIR_TEMPERATURE_F) != 0)
+    {
+        fprintf(stderr, "setup failed\n");
+        free(segments);
+        return 1;
+    }
+
+    pipeNetworkSetSupply(&network, 0, SUPPLY_PSIG);
+    pipeNetworkSetSupply(&network, nodeCount - 1, SUPPLY_PSIG);
+
+    srand(1);
+    double totalDemand = 0.0;
+
+    for (size_t i = 1; i + 1 < nodeCount; i++)
+    {
+        if (rand() % 20 == 0)
+        {
+            double demand = rand() % 30;
+            pipeNetworkSetDemand(&network, i, demand);
+            totalDemand += demand;
+        }
+    }
+
+    double start = secondsNow();
+    int coldIterations = pipeNetworkSolve(&network, TOLERANCE_PSI, MAX_ITERATIONS);
+    double coldSeconds = secondsNow() - start;
+
+    printf("%zu nodes, %zu segments, %.0f CFM demand\n", nodeCount, segmentCount, totalDemand);
+    printf("%-12s %3d Newton steps %10.3f ms\n", "cold solve", coldIterations, coldSeconds * 1e3);
+
+    int failed = coldIterations < 0 || checkSolution("cold solve", &network) != 0;
+
+    // One machine starting up mid-grid
+    pipeNetworkSetDemand(&network, nodeCount / 2 + side / 2, 50.0);
+
+    start = secondsNow();
+    int warmIterations = pipeNetworkSolve(&network, TOLERANCE_PSI, MAX_ITERATIONS);
+    double warmSeconds = secondsNow() - start;
+
+    printf("%-12s %3d Newton steps %10.3f ms\n", "warm restart", warmIterations, warmSeconds * 1e3);
+
+    failed |= warmIterations < 0 || checkSolution("warm restart", &network) != 0;
+
+    pipeNetworkFree(&network);
+    free(segments);
+
+    return failed;
+}
@@ -0,0 +1,221 @@
+//
+//  PipeSizingBench.c
+//
+//  Sizes a synthetic 50,000 branch project and compares the sizing engine
+//  with a scan over the schedule from the smallest size up. First checks
+//  pipePressureDropPSI at trickle flows against Hagen-Poiseuille.
+//
+//  cc -O2 -I.. PipeSizingBench.c ../PipeSizing.c ../ThreadPool.c ../Compulations.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+#include "PipeSizing.h"
+#include "ThreadPool.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BRANCH_COUNT 50000
+#define REPEATS 20
+#define AMBIENT_PSIA 14.5
+#define AIR_TEMPERATURE_F 90.0
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+
+// What the spreadsheets do: try each size in turn until both limits pass
+static int32_t scanSchedule(const PipeBranch *branch, PipeSchedule schedule)
+{
+    const PipeSize *sizes;
+    size_t count = pipeScheduleSizes(schedule, &sizes);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double diameterIn = sizes[i].insideDiameterIn;
+        double fps = velocityInPipeFPS(branch->flowRateCFM, branch->linePressurePSIG, AMBIENT_PSIA, diameterIn);
+        double drop = pipePressureDropPSI(branch->flowRateCFM,
+                                          branch->linePressurePSIG,
+                                          AMBIENT_PSIA,
+                                          AIR_TEMPERATURE_F,
+                                          diameterIn,
+                                          branch->lengthFt);
+
+        if (fps <= branch->maxVelocityFPS && drop <= branch->maxPressureDropPSI)
+        {
+            return (int32_t)i;
+        }
+    }
+
+    return -1;
+}
+
+// Drop in a 2" line, 55 ft at 109.55 psig, where the flow is laminar, must
+// match Hagen-Poiseuille, and the drop must rise with flow through the
+// transition into turbulence.
+static int checkLowFlow(void)
+{
+    const double flows[] = { 0.005, 0.0089, 0.02 };
+    const double linePSIG = 109.55;
+    const double diameterIn = 2.0;
+    const double lengthFt = 55.0;
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(flows) / sizeof(flows[0]); i++)
+    {
+        double fps = velocityInPipeFPS(flows[i], linePSIG, AMBIENT_PSIA, diameterIn);
+        double diameterFt = diameterIn / 12.0;
+        double expected = 32.0 * 1.22e-5 * lengthFt * fps / (diameterFt * diameterFt * 32.174 * 144.0);
+        double drop = pipePressureDropPSI(flows[i], linePSIG, AMBIENT_PSIA, AIR_TEMPERATURE_F, diameterIn, lengthFt);
+
+        printf("%-28s %6.4f CFM %12.4e psi\n", "low flow drop", flows[i], drop);
+
+        if (!(fabs(drop - expected) <= 1e-9 * expected))
+        {
+            printf("MISMATCH at %g CFM: %.6e psi, Hagen-Poiseuille %.6e\n", flows[i], drop, expected);
+            failures++;
+        }
+    }
+
+    double previous = 0.0;
+
+    for (double flow = 0.001; flow < 5000.0; flow *= 1.01)
+    {
+        double drop = pipePressureDropPSI(flow, linePSIG, AMBIENT_PSIA, AIR_TEMPERATURE_F, diameterIn, lengthFt);
+
+        if (!(drop > previous) || !isfinite(drop))
+        {
+            printf("MISMATCH at %g CFM: drop %.6e after %.6e\n", flow, drop, previous);
+            failures++;
+            break;
+        }
+
+        previous = drop;
+    }
+
+    return failures;
+}
+
+int main(void)
+{
+    if (checkLowFlow() != 0)
+    {
+        return 1;
+    }
+
+    PipeBranch *branches = malloc(BRANCH_COUNT * sizeof(PipeBranch));
+    PipeSizingResult *results = malloc(BRANCH_COUNT * sizeof(PipeSizingResult));
+    int32_t *scanned = malloc(BRANCH_COUNT * sizeof(int32_t));
+
+    // Mostly drops and small branches, some headers and mains. Flow is
+    // log-uniform from 2 to 5000 CFM.
+    srand(11);
+
+    for (int i = 0; i < BRANCH_COUNT; i++)
+    {
+        branches[i].flowRateCFM = exp(uniform(log(2.0), log(5000.0)));
+        branches[i].linePressurePSIG = uniform(80.0, 125.0);
+        branches[i].lengthFt = uniform(10.0, 600.0);
+        branches[i].maxVelocityFPS = rand() % 2 ? 20.0 : 30.0;
+        branches[i].maxPressureDropPSI = uniform(0.5, 3.0);
+    }
+
+    // Reference sizes
+    double start = secondsNow();
+
+    for (int i = 0; i < BRANCH_COUNT; i++)
+    {
+        scanned[i] = scanSchedule(&branches[i], PipeSchedule40);
+    }
+
+    double scanSeconds = secondsNow() - start;
+
+    start = secondsNow();
+
+    for (int r = 0; r < REPEATS; r++)
+    {
+        pipeSizeBranches(branches, BRANCH_COUNT, PipeSchedule40, AMBIENT_PSIA, AIR_TEMPERATURE_F, NULL, results);
+    }
+
+    double serialSeconds = (secondsNow() - start) / REPEATS;
+
+    ThreadPool *pool = threadPoolCreate(0);
+    size_t unsized = 0;
+
+    start = secondsNow();
+
+    for (int r = 0; r < REPEATS; r++)
+    {
+        unsized = pipeSizeBranches(branches, BRANCH_COUNT, PipeSchedule40, AMBIENT_PSIA, AIR_TEMPERATURE_F, pool, results);
+    }
+
+    double poolSeconds = (secondsNow() - start) / REPEATS;
+
+    size_t mismatches = 0;
+    size_t histogram[32] = { 0 };
+
+    for (int i = 0; i < BRANCH_COUNT; i++)
+    {
+        mismatches += results[i].sizeIndex != scanned[i];
+
+        if (results[i].sizeIndex >= 0)
+        {
+            histogram[results[i].sizeIndex]++;
+        }
+    }
+
+    printf("%d branches, schedule 40\n", BRANCH_COUNT);
+    printf("%-28s %10.3f ms\n", "scan from smallest", scanSeconds * 1e3);
+    printf("%-28s %10.3f ms\n", "pipeSizeBranches", serialSeconds * 1e3);
+    printf("%-28s %10.3f ms (%zu threads)\n", "pipeSizeBranches, pool", poolSeconds * 1e3, threadPoolSize(pool));
+    printf("%-28s %10zu\n", "differences from scan", mismatches);
+    printf("%-28s %10zu\n", "no size fits", unsized);
+
+    const PipeSize *sizes;
+    size_t sizeCount = pipeScheduleSizes(PipeSchedule40, &sizes);
+
+    printf("\nNominal size   branches\n");
+
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        if (histogram[i])
+        {
+            printf("%-12s %10zu\n", sizes[i].nominal, histogram[i]);
+        }
+    }
+
+    threadPoolDestroy(pool);
+    free(branches);
+    free(results);
+    free(scanned);
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+//
+//  PlantBench.c
+//
+//  Runs Monte Carlo scenarios of an eight hour shift on a three compressor
+//  plant on a one thread pool and on a k thread pool, reports scenarios/s
+//  for each, and checks that every scenario result and the summary are bit
+//  for bit the same. Exits 1 if they differ.
+//
+//  compulations_plant_bench [--scenarios N] [--threads K]
+//
+//  cc -O2 -I.. PlantBench.c ../PlantSimulator.c ../ThreadPool.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PlantSimulator.h"
+#include "ThreadPool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SEED 42
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int runOn(const PlantModel *model,
+                 size_t scenarios,
+                 size_t threads,
+                 PlantScenarioResult *results,
+                 PlantSimulationSummary *summary)
+{
+    ThreadPool *pool = threadPoolCreate(threads);
+
+    if (!pool)
+    {
+        return -1;
+    }
+
+    double start = secondsNow();
+    int status = plantSimulate(model, scenarios, SEED, pool, results, summary);
+    double elapsed = secondsNow() - start;
+
+    if (status == 0)
+    {
+        printf("%zu thread%s %12.1f scenarios/s\n", threadPoolSize(pool), threadPoolSize(pool) == 1 ? " " : "s",
+               scenarios / elapsed);
+    }
+
+    threadPoolDestroy(pool);
+
+    return status;
+}
+
+int main(int argc, char **argv)
+{
+    size_t scenarios = 400;
+    size_t threads = 4;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--scenarios") == 0 && i + 1 < argc)
+        {
+            scenarios = (size_t)atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--scenarios N] [--threads K]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    scenarios = scenarios ? scenarios : 1;
+
+    // A cascade of two 500 CFM machines and a 300 CFM trim behind 4000
+    // gallons of storage
+    const PlantCompressor compressors[] = {
+        { 500.0, 100.0, 110.0 },
+        { 500.0, 98.0, 108.0 },
+        { 300.0, 95.0, 105.0 },
+    };
+
+    PlantModel model;
+    memset(&model, 0, sizeof(model));
+    model.storageCF = 4000.0 / 7.48052;
+    model.ambientPSIA = 14.7;
+    model.initialPressurePSIG = 105.0;
+    model.compressors = compressors;
+    model.compressorCount = sizeof(compressors) / sizeof(compressors[0]);
+    model.demand = (PlantDemandProfile){ 900.0, 80.0, 300.0, 2.0, 400.0, 120.0 };
+    model.timeStepSec = 1.0;
+    model.durationSec = 8.0 * 3600.0;
+
+    PlantScenarioResult *serial = calloc(scenarios, sizeof(PlantScenarioResult));
+    PlantScenarioResult *parallel = calloc(scenarios, sizeof(PlantScenarioResult));
+    PlantSimulationSummary serialSummary, parallelSummary;
+
+    // Zeroed so padding compares equal too
+    memset(&serialSummary, 0, sizeof(serialSummary));
+    memset(&parallelSummary, 0, sizeof(parallelSummary));
+
+    printf("%zu scenarios, 8 h at 1 s steps\n", scenarios);
+
+    if (!serial || !parallel || runOn(&model, scenarios, 1, serial, &serialSummary) != 0 ||
+        runOn(&model, scenarios, threads, parallel, &parallelSummary) != 0)
+    {
+        fprintf(stderr, "simulation failed\n");
+        free(serial);
+        free(parallel);
+        return 1;
+    }
+
+    size_t differences = 0;
+
+    for (size_t i = 0; i < scenarios; i++)
+    {
+        differences += memcmp(&serial[i], &parallel[i], sizeof(PlantScenarioResult)) != 0;
+    }
+
+    int summaryDiffers = memcmp(&serialSummary, &parallelSummary, sizeof(serialSummary)) != 0;
+
+    printf("%-28s %10zu\n", "scenarios that differ", differences);
+    printf("%-28s %10s\n", "summary", summaryDiffers ? "differs" : "same");
+    printf("%-28s %10.2f psig\n", "min pressure, p05", serialSummary.minPressureP05PSIG);
+    printf("%-28s %10.2f psig\n", "min pressure, worst", serialSummary.minPressureWorstPSIG);
+    printf("%-28s %10.2f\n", "load cycles per hour", serialSummary.loadCyclesPerHourMean);
+
+    free(serial);
+    free(parallel);
+
+    if (differences || summaryDiffers)
+    {
+        printf("MISMATCH\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,287 @@
+//
+//  SensorBench.c
+//
+//  Times the sensor buffer conversions at each SIMD level the CPU supports
+//  and checks that every level gives the same values and flags, bit for bit.
+//  Then streams samples from a producer thread through a SensorRing to a
+//  converting consumer and checks every value. Exits 1 on any mismatch.
+//
+//  compulations_sensor_bench [--samples N]
+//
+//  cc -O2 -I.. SensorBench.c ../SensorCalibration.c ../BatchCompulations.c ../Compulations.c ../CompulationsInstrumentation.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchCompulations.h"
+#include "SensorCalibration.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BUFFER_SAMPLES 100003
+#define REPEATS 200
+#define RING_CAPACITY 4096
+#define PRODUCER_BLOCK 257
+#define CONSUMER_BLOCK 1024
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const char *levelName(CompulationsSIMDLevel level)
+{
+    switch (level)
+    {
+        case CompulationsSIMDLevelAVX512:
+            return "avx512";
+        case CompulationsSIMDLevelAVX2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+// A 4-20 mA transmitter on a 16 bit input, 0-200 psig, clamped. Raw values
+// span the whole input, so some fall on each side of the limits.
+static void initChannel(SensorChannel *channel)
+{
+    sensorChannelInit(channel, 6553.6, 32768.0, 0.0, 200.0);
+    sensorChannelSetLimits(channel, 0.0, 200.0, 1);
+}
+
+static double expectedValue(const SensorChannel *channel, double raw)
+{
+    double value = fma(raw, channel->scale, channel->offset);
+
+    return value < channel->lowLimit ? channel->lowLimit : (value > channel->highLimit ? channel->highLimit : value);
+}
+
+static int checkLevels(const SensorChannel *channel)
+{
+    uint16_t *u16 = malloc(BUFFER_SAMPLES * sizeof(uint16_t));
+    int16_t *i16 = malloc(BUFFER_SAMPLES * sizeof(int16_t));
+    int32_t *i32 = malloc(BUFFER_SAMPLES * sizeof(int32_t));
+    double *values = malloc(BUFFER_SAMPLES * sizeof(double));
+    double *reference = malloc(BUFFER_SAMPLES * sizeof(double));
+    uint8_t *flags = malloc(BUFFER_SAMPLES);
+    uint8_t *referenceFlags = malloc(BUFFER_SAMPLES);
+    int failed = 0;
+
+    srand(9);
+
+    for (size_t i = 0; i < BUFFER_SAMPLES; i++)
+    {
+        u16[i] = (uint16_t)(rand() & 0xFFFF);
+        i16[i] = (int16_t)(u16[i] - 16384);
+        i32[i] = rand() % 80000 - 20000;
+    }
+
+    CompulationsSIMDLevel detected = compulationsDetectedSIMDLevel();
+
+    for (int type = SensorSampleTypeU16; type <= SensorSampleTypeI32; type++)
+    {
+        static const char *typeNames[] = { "sensorChannelConvertU16", "sensorChannelConvertI16", "sensorChannelConvertI32" };
+
+        for (int level = CompulationsSIMDLevelScalar; level <= (int)detected; level++)
+        {
+            compulationsSetSIMDLevel((CompulationsSIMDLevel)level);
+
+            double start = secondsNow();
+
+            for (int r = 0; r < REPEATS; r++)
+            {
+                switch (type)
+                {
+                    case SensorSampleTypeU16:
+                        sensorChannelConvertU16(channel, u16, values, flags, BUFFER_SAMPLES);
+                        break;
+                    case SensorSampleTypeI16:
+                        sensorChannelConvertI16(channel, i16, values, flags, BUFFER_SAMPLES);
+                        break;
+                    default:
+                        sensorChannelConvertI32(channel, i32, values, flags, BUFFER_SAMPLES);
+                        break;
+                }
+            }
+
+            double ns = (secondsNow() - start) * 1e9 / ((double)BUFFER_SAMPLES * REPEATS);
+
+            if (level == CompulationsSIMDLevelScalar)
+            {
+                memcpy(reference, values, BUFFER_SAMPLES * sizeof(double));
+                memcpy(referenceFlags, flags, BUFFER_SAMPLES);
+            }
+
+            int same = memcmp(values, reference, BUFFER_SAMPLES * sizeof(double)) == 0 &&
+                       memcmp(flags, referenceFlags, BUFFER_SAMPLES) == 0;
+
+            printf("%-28s %-8s %8.3f ns/sample%s\n", typeNames[type], levelName((CompulationsSIMDLevel)level), ns,
+                   same ? "" : "  MISMATCH");
+            failed |= !same;
+        }
+    }
+
+    compulationsSetSIMDLevel(detected);
+
+    free(u16);
+    free(i16);
+    free(i32);
+    free(values);
+    free(reference);
+    free(flags);
+    free(referenceFlags);
+
+    return failed ? -1 : 0;
+}
+
+typedef struct Producer
+{
+    SensorRing *ring;
+    size_t samples;
+} Producer;
+
+// The raw stream is a function of the sample number, so the consumer can
+// check it without sharing anything but the ring.
+static uint16_t rawAt(size_t sample)
+{
+    return (uint16_t)(sample * 7919u);
+}
+
+static void *produce(void *context)
+{
+    Producer *producer = context;
+    uint16_t block[PRODUCER_BLOCK];
+    size_t sent = 0;
+
+    while (sent < producer->samples)
+    {
+        size_t count = producer->samples - sent < PRODUCER_BLOCK ? producer->samples - sent : PRODUCER_BLOCK;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            block[i] = rawAt(sent + i);
+        }
+
+        // Yield when full, so the consumer gets a turn on a single core
+        for (size_t written = 0; written < count;)
+        {
+            size_t accepted = sensorRingWrite(producer->ring, block + written, count - written);
+            written += accepted;
+
+            if (accepted == 0)
+            {
+                sched_yield();
+            }
+        }
+
+        sent += count;
+    }
+
+    return NULL;
+}
+
+static int checkRing(const SensorChannel *channel, size_t samples)
+{
+    SensorRing ring;
+
+    if (sensorRingInit(&ring, SensorSampleTypeU16, RING_CAPACITY) != 0)
+    {
+        fprintf(stderr, "ring setup failed\n");
+        return -1;
+    }
+
+    Producer producer = { &ring, samples };
+    double values[CONSUMER_BLOCK];
+    size_t received = 0, wrong = 0, flagged = 0;
+    pthread_t thread;
+    double start = secondsNow();
+
+    if (pthread_create(&thread, NULL, produce, &producer) != 0)
+    {
+        sensorRingFree(&ring);
+        return -1;
+    }
+
+    while (received < samples)
+    {
+        size_t outOfRange;
+        size_t count = sensorRingConvert(&ring, channel, values, NULL, CONSUMER_BLOCK, &outOfRange);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            wrong += values[i] != expectedValue(channel, rawAt(received + i));
+        }
+
+        received += count;
+        flagged += outOfRange;
+
+        if (count == 0)
+        {
+            sched_yield();
+        }
+    }
+
+    pthread_join(thread, NULL);
+    double elapsed = secondsNow() - start;
+
+    printf("\nSensorRing, producer and consumer threads, capacity %d\n", RING_CAPACITY);
+    printf("%-28s %10zu\n", "samples", received);
+    printf("%-28s %10zu\n", "out of range", flagged);
+    printf("%-28s %10zu%s\n", "wrong values", wrong, wrong ? "  MISMATCH" : "");
+    printf("%-28s %10.1f M samples/s\n", "throughput", received / elapsed * 1e-6);
+
+    sensorRingFree(&ring);
+
+    return wrong ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t samples = 20000000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            samples = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--samples N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SensorChannel channel;
+    initChannel(&channel);
+
+    int failed = checkLevels(&channel) != 0;
+    failed |= checkRing(&channel, samples) != 0;
+
+    return failed;
+}
@@ -0,0 +1,277 @@
+//
+//  StorageBench.c
+//
+//  Streams a year of synthetic 1 Hz demand per plant through a
+//  StorageAnalyzer, one plant per pool thread, and reports samples/s, the
+//  storage each plant needs and its worst events. First checks the maximum
+//  deficit against a brute force search over every window of a short
+//  series, and exits 1 if they disagree.
+//
+//  compulations_storage_bench [--plants N] [--days N]
+//
+//  cc -O2 -I.. StorageBench.c ../StorageAnalyzer.c ../ThreadPool.c ../Compulations.c ../UnitConversion.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StorageAnalyzer.h"
+#include "ThreadPool.h"
+#include "UnitConversion.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHUNK 65536
+#define TOP_EVENTS 5
+#define CHECK_SAMPLES 20000
+
+#define SUPPLY_CFM 1000.0
+#define AMBIENT_PSIA 14.7
+#define INITIAL_PSIG 110.0
+#define MIN_PSIG 90.0
+
+typedef struct Plant
+{
+    uint64_t seed;
+    size_t samples;
+    StorageAnalyzer analyzer;
+} Plant;
+
+// Demand generator state: shift load, noise and random high-demand events
+// such as sandblasting or a purge
+typedef struct Demand
+{
+    uint64_t state;
+    double eventCFM;
+    double eventLeftSec;
+} Demand;
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// xorshift64*, so each plant's series is its own and reproducible
+static double nextUniform(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+
+    return (double)((*state * 2685821657736338717ull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double nextDemand(Demand *demand, size_t second)
+{
+    size_t hour = second / 3600 % 24;
+    size_t day = second / 86400 % 7;
+    double base = day < 5 && hour >= 6 && hour < 22 ? 800.0 : 300.0;
+
+    if (demand->eventLeftSec <= 0.0 && nextUniform(&demand->state) < 1.0 / 7200.0)
+    {
+        demand->eventCFM = 400.0 + 500.0 * nextUniform(&demand->state);
+        demand->eventLeftSec = 60.0 + 840.0 * nextUniform(&demand->state);
+    }
+
+    double event = demand->eventLeftSec > 0.0 ? demand->eventCFM : 0.0;
+    demand->eventLeftSec -= 1.0;
+
+    return base + event + 100.0 * (nextUniform(&demand->state) - 0.5);
+}
+
+static void runPlants(void *context, size_t begin, size_t end, size_t worker)
+{
+    Plant *plants = context;
+    double timeSec[CHUNK];
+    double demandCFM[CHUNK];
+
+    (void)worker;
+
+    for (size_t p = begin; p < end; p++)
+    {
+        Plant *plant = &plants[p];
+        Demand demand = { plant->seed, 0.0, 0.0 };
+
+        for (size_t start = 0; start < plant->samples; start += CHUNK)
+        {
+            size_t count = plant->samples - start < CHUNK ? plant->samples - start : CHUNK;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                timeSec[i] = (double)(start + i);
+                demandCFM[i] = nextDemand(&demand, start + i);
+            }
+
+            storageAnalyzerAddSamples(&plant->analyzer, timeSec, demandCFM, NULL, count);
+        }
+    }
+}
+
+// Largest sum of the imbalance over any window, trying every one
+static double bruteForceMaxDeficit(const double *demandCFM, size_t count)
+{
+    double best = 0.0;
+
+    for (size_t i = 0; i + 1 < count; i++)
+    {
+        double sum = 0.0;
+
+        // Each sample's rate holds for the second up to the next sample
+        for (size_t j = i; j + 1 < count; j++)
+        {
+            sum += (demandCFM[j] - SUPPLY_CFM) / 60.0;
+            best = sum > best ? sum : best;
+        }
+    }
+
+    return best;
+}
+
+static int checkAgainstBruteForce(void)
+{
+    double *timeSec = malloc(CHECK_SAMPLES * sizeof(double));
+    double *demandCFM = malloc(CHECK_SAMPLES * sizeof(double));
+    Demand demand = { 88172645463325252ull, 0.0, 0.0 };
+    StorageAnalyzer analyzer;
+    StorageResult result;
+    StorageEvent top[2];
+
+    if (!timeSec || !demandCFM)
+    {
+        return -1;
+    }
+
+    // A weekday afternoon, raised so demand crosses the supply often, with
+    // two ten minute events far enough apart to be paid back in between
+    for (size_t i = 0; i < CHECK_SAMPLES; i++)
+    {
+        timeSec[i] = 50400.0 + i;
+        demandCFM[i] = nextDemand(&demand, 50400 + i) + 160.0;
+
+        if ((i >= 2000 && i < 2600) || (i >= 12000 && i < 12600))
+        {
+            demandCFM[i] += i < 10000 ? 500.0 : 650.0;
+        }
+    }
+
+    storageAnalyzerInit(&analyzer, SUPPLY_CFM, AMBIENT_PSIA, INITIAL_PSIG, MIN_PSIG, 0.0, 2);
+    storageAnalyzerAddSamples(&analyzer, timeSec, demandCFM, NULL, CHECK_SAMPLES);
+    storageAnalyzerResult(&analyzer, &result);
+
+    double expected = bruteForceMaxDeficit(demandCFM, CHECK_SAMPLES);
+    int agree = fabs(result.maxDeficitCF - expected) <= 1e-9 * (expected > 1.0 ? expected : 1.0) &&
+                storageAnalyzerTopEvents(&analyzer, top, 2) == 2 && top[0].deficitCF == result.maxDeficitCF &&
+                top[0].peakSec >= 50400.0 + 12000 && top[0].peakSec <= 50400.0 + 12660 &&
+                top[1].peakSec >= 50400.0 + 2000 && top[1].peakSec <= 50400.0 + 2660;
+
+    printf("check over %d samples, %zu events: max deficit %.3f CF, brute force %.3f CF%s\n", CHECK_SAMPLES,
+           result.events, result.maxDeficitCF, expected, agree ? "" : "  MISMATCH");
+
+    free(timeSec);
+    free(demandCFM);
+
+    return agree ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    size_t plantCount = 8;
+    size_t days = 365;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--plants") == 0 && i + 1 < argc)
+        {
+            plantCount = (size_t)atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--days") == 0 && i + 1 < argc)
+        {
+            days = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--plants N] [--days N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (checkAgainstBruteForce() != 0)
+    {
+        return 1;
+    }
+
+    Plant *plants = calloc(plantCount ? plantCount : 1, sizeof(Plant));
+    ThreadPool *pool = threadPoolCreate(0);
+
+    if (!plants || !pool)
+    {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    for (size_t p = 0; p < plantCount; p++)
+    {
+        plants[p].seed = 0x9e3779b97f4a7c15ull * (p + 1);
+        plants[p].samples = days * 86400;
+        storageAnalyzerInit(&plants[p].analyzer, SUPPLY_CFM, AMBIENT_PSIA, INITIAL_PSIG, MIN_PSIG, 10.0, TOP_EVENTS);
+    }
+
+    double start = secondsNow();
+    threadPoolParallelFor(pool, plantCount, 1, runPlants, plants);
+    double seconds = secondsNow() - start;
+
+    double totalSamples = (double)plantCount * days * 86400.0;
+
+    printf("%zu plants x %zu days at 1 Hz on %zu threads: %.2f s, %.1f M samples/s\n", plantCount, days,
+           threadPoolSize(pool), seconds, totalSamples / seconds * 1e-6);
+    printf("%-6s %10s %12s %10s %8s   largest events, deficit CF at day hh:mm\n", "plant", "deficit CF",
+           "receiver gal", "window s", "events");
+
+    for (size_t p = 0; p < plantCount; p++)
+    {
+        StorageResult result;
+        StorageEvent top[TOP_EVENTS];
+
+        storageAnalyzerResult(&plants[p].analyzer, &result);
+        size_t count = storageAnalyzerTopEvents(&plants[p].analyzer, top, TOP_EVENTS);
+
+        printf("%-6zu %10.1f %12.0f %10.0f %8zu  ", p, result.maxDeficitCF, gallonsFromCubicFeet(result.requiredVolumeCF),
+               result.windowEndSec - result.windowStartSec, result.events);
+
+        for (size_t e = 0; e < count; e++)
+        {
+            size_t minute = (size_t)(top[e].startSec / 60.0);
+
+            printf(" %.0f@%zu %02zu:%02zu", top[e].deficitCF, minute / 1440, minute / 60 % 24, minute % 60);
+        }
+
+        printf("\n");
+    }
+
+    threadPoolDestroy(pool);
+    free(plants);
+
+    return 0;
+}
@@ -0,0 +1,302 @@
+//
+//  TelemetryBench.c
+//
+//  Writes a year of ten-second telemetry for one compressor as CSV and as a
+//  TelemetryStore file, then times the same energy, air and low-pressure
+//  analyses parsing the CSV and reading the mapped columns in place.
+//
+//  cc -O2 -I.. TelemetryBench.c ../TelemetryStore.c ../FunctionTable.c ../Compulations.c ../UnitConversion.c ../BatchCompulations.c -lm
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+#include "FunctionTable.h"
+#include "TelemetryStore.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROW_COUNT (365 * 24 * 360)
+#define SAMPLE_INTERVAL_SEC 10.0
+#define START_TIME_SEC 1767225600.0
+#define LOW_PRESSURE_PSIG 95.0
+
+enum
+{
+    ColumnTime = 0,
+    ColumnPSIG,
+    ColumnVolts,
+    ColumnAmps,
+    ColumnPowerFactor,
+    ColumnFlowCFM,
+    ColumnLoaded,
+    ColumnCount
+};
+
+static const TelemetryColumnSpec columnSpecs[ColumnCount] = {
+    { "timeSec", TelemetryTypeF64 },
+    { "psig", TelemetryTypeF64 },
+    { "volts", TelemetryTypeF64 },
+    { "amps", TelemetryTypeF64 },
+    { "powerFactor", TelemetryTypeF64 },
+    { "flowCFM", TelemetryTypeF64 },
+    { "loaded", TelemetryTypeU8 }
+};
+
+typedef struct Analysis
+{
+    double energyKWh;
+    double airCubicFeet;
+    size_t lowPressureRows;
+    double firstLowPressureSec;
+} Analysis;
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double uniform(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+
+static void analysisAddRow(Analysis *analysis, double timeSec, double psig, double kw, double flowCFM)
+{
+    analysis->energyKWh += kw * SAMPLE_INTERVAL_SEC / 3600.0;
+    analysis->airCubicFeet += flowCFM * SAMPLE_INTERVAL_SEC / 60.0;
+
+    if (psig < LOW_PRESSURE_PSIG)
+    {
+        if (analysis->lowPressureRows++ == 0)
+        {
+            analysis->firstLowPressureSec = timeSec;
+        }
+    }
+}
+
+static int writeFiles(const char *csvPath, const char *storePath)
+{
+    double *values[ColumnCount - 1];
+    uint8_t *loaded = malloc(ROW_COUNT);
+    FILE *csv = fopen(csvPath, "w");
+    TelemetryWriter writer;
+    int status = 0;
+
+    for (size_t c = 0; c < ColumnCount - 1; c++)
+    {
+        values[c] = malloc(ROW_COUNT * sizeof(double));
+        status |= values[c] ? 0 : -1;
+    }
+
+    if (!loaded || !csv || status != 0 ||
+        telemetryWriterOpen(&writer, storePath, columnSpecs, ColumnCount, 0) != 0)
+    {
+        return -1;
+    }
+
+    // Load/unload around 100 psig, with a sag below 95 psig on one day in
+    // every thirty.
+    srand(17);
+    fprintf(csv, "timeSec,psig,volts,amps,powerFactor,flowCFM,loaded\n");
+
+    for (size_t i = 0; i < ROW_COUNT; i++)
+    {
+        int isLoaded = rand() % 3 != 0;
+        int sag = (i / (24 * 360)) % 30 == 29;
+
+        values[ColumnTime][i] = START_TIME_SEC + i * SAMPLE_INTERVAL_SEC;
+        values[ColumnPSIG][i] = (sag ? uniform(88.0, 97.0) : uniform(98.0, 110.0));
+        values[ColumnVolts][i] = uniform(455.0, 485.0);
+        values[ColumnAmps][i] = isLoaded ? uniform(80.0, 120.0) : uniform(28.0, 35.0);
+        values[ColumnPowerFactor][i] = isLoaded ? 0.86 : 0.4;
+        values[ColumnFlowCFM][i] = isLoaded ? uniform(380.0, 500.0) : 0.0;
+        loaded[i] = (uint8_t)isLoaded;
+
+        fprintf(csv, "%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%d\n",
+                values[ColumnTime][i], values[ColumnPSIG][i], values[ColumnVolts][i], values[ColumnAmps][i],
+                values[ColumnPowerFactor][i], values[ColumnFlowCFM][i], isLoaded);
+    }
+
+    const void *columns[ColumnCount] = {
+        values[ColumnTime], values[ColumnPSIG], values[ColumnVolts], values[ColumnAmps],
+        values[ColumnPowerFactor], values[ColumnFlowCFM], loaded
+    };
+
+    status |= telemetryWriterAppend(&writer, columns, ROW_COUNT);
+    status |= telemetryWriterClose(&writer);
+    status |= fclose(csv) == 0 ? 0 : -1;
+
+    for (size_t c = 0; c < ColumnCount - 1; c++)
+    {
+        free(values[c]);
+    }
+
+    free(loaded);
+
+    return status;
+}
+
+// Parses every field, then calls the scalar function row by row
+static int analyzeCSV(const char *path, Analysis *analysis)
+{
+    FILE *csv = fopen(path, "r");
+    char line[512];
+
+    if (!csv || !fgets(line, sizeof(line), csv))
+    {
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), csv))
+    {
+        double fields[ColumnCount];
+        char *cursor = line;
+
+        for (size_t c = 0; c < ColumnCount; c++)
+        {
+            fields[c] = strtod(cursor, &cursor);
+            cursor++;
+        }
+
+        double kw = threePhaseMotorInputPowerKW(fields[ColumnVolts], fields[ColumnAmps], fields[ColumnPowerFactor]);
+
+        analysisAddRow(analysis, fields[ColumnTime], fields[ColumnPSIG], kw, fields[ColumnFlowCFM]);
+    }
+
+    fclose(csv);
+
+    return 0;
+}
+
+// Evaluates power over the mapped columns a block at a time. The pressure
+// scan only visits blocks whose minimum is below the threshold.
+static int analyzeStore(const char *path, Analysis *analysis, size_t *scannedBlocks)
+{
+    TelemetryStore store;
+    const CompulationFunction *power = compulationFunctionNamed("threePhaseMotorInputPowerKW");
+    const size_t powerColumns[3] = { ColumnVolts, ColumnAmps, ColumnPowerFactor };
+
+    if (!power || telemetryStoreOpen(&store, path) != 0)
+    {
+        return -1;
+    }
+
+    double *kw = malloc(store.blockRows * sizeof(double));
+    size_t *blocks = malloc(store.blockCount * sizeof(size_t));
+
+    if (!kw || !blocks)
+    {
+        return -1;
+    }
+
+    for (size_t b = 0; b < store.blockCount; b++)
+    {
+        size_t rows = telemetryStoreEvaluate(&store, power, powerColumns, b, kw);
+        const double *flowCFM = telemetryStoreChunkF64(&store, b, ColumnFlowCFM);
+
+        for (size_t i = 0; i < rows; i++)
+        {
+            analysis->energyKWh += kw[i] * SAMPLE_INTERVAL_SEC / 3600.0;
+            analysis->airCubicFeet += flowCFM[i] * SAMPLE_INTERVAL_SEC / 60.0;
+        }
+    }
+
+    TelemetryRange lowPressure = { ColumnPSIG, -INFINITY, nextafter(LOW_PRESSURE_PSIG, 0.0) };
+    size_t blockCount = telemetryStoreSelectBlocks(&store, &lowPressure, 1, blocks);
+
+    for (size_t k = 0; k < blockCount; k++)
+    {
+        const double *timeSec = telemetryStoreChunkF64(&store, blocks[k], ColumnTime);
+        const double *psig = telemetryStoreChunkF64(&store, blocks[k], ColumnPSIG);
+        size_t rows = telemetryStoreBlockRows(&store, blocks[k]);
+
+        for (size_t i = 0; i < rows; i++)
+        {
+            if (psig[i] < LOW_PRESSURE_PSIG && analysis->lowPressureRows++ == 0)
+            {
+                analysis->firstLowPressureSec = timeSec[i];
+            }
+        }
+    }
+
+    *scannedBlocks = blockCount;
+
+    free(kw);
+    free(blocks);
+    telemetryStoreClose(&store);
+
+    return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+    const char *directory = argc > 1 ? argv[1] : ".";
+    char csvPath[1024];
+    char storePath[1024];
+
+    snprintf(csvPath, sizeof(csvPath), "%s/telemetry_bench.csv", directory);
+    snprintf(storePath, sizeof(storePath), "%s/telemetry_bench.ctl", directory);
+
+    if (writeFiles(csvPath, storePath) != 0)
+    {
+        fprintf(stderr, "could not write %s and %s\n", csvPath, storePath);
+        return 1;
+    }
+
+    Analysis csv = { 0 };
+    Analysis mapped = { 0 };
+    size_t scannedBlocks = 0;
+
+    double start = secondsNow();
+    int status = analyzeCSV(csvPath, &csv);
+    double csvSeconds = secondsNow() - start;
+
+    start = secondsNow();
+    status |= analyzeStore(storePath, &mapped, &scannedBlocks);
+    double storeSeconds = secondsNow() - start;
+
+    TelemetryStore store;
+    size_t blockCount = telemetryStoreOpen(&store, storePath) == 0 ? store.blockCount : 0;
+    telemetryStoreClose(&store);
+
+    int agree = status == 0 &&
+                fabs(csv.energyKWh - mapped.energyKWh) <= 1e-9 * csv.energyKWh &&
+                fabs(csv.airCubicFeet - mapped.airCubicFeet) <= 1e-9 * csv.airCubicFeet &&
+                csv.lowPressureRows == mapped.lowPressureRows &&
+                csv.firstLowPressureSec == mapped.firstLowPressureSec;
+
+    printf("%d rows, %zu blocks, low pressure scan read %zu\n", ROW_COUNT, blockCount, scannedBlocks);
+    printf("%-14s %8.3f s %8.1f M rows/s   %.3f kWh  %.0f ft3  %zu low\n", "CSV", csvSeconds,
+           ROW_COUNT / csvSeconds * 1e-6, csv.energyKWh, csv.airCubicFeet, csv.lowPressureRows);
+    printf("%-14s %8.3f s %8.1f M rows/s   %.3f kWh  %.0f ft3  %zu low  speedup %.1f%s\n", "TelemetryStore",
+           storeSeconds, ROW_COUNT / storeSeconds * 1e-6, mapped.energyKWh, mapped.airCubicFeet,
+           mapped.lowPressureRows, csvSeconds / storeSeconds, agree ? "" : "  MISMATCH");
+
+    remove(csvPath);
+    remove(storePath);
+
+    return agree ? 0 : 1;
+}
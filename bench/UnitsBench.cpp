@@ -0,0 +1,225 @@
+//
+//  UnitsBench.cpp
+//
+//  Typed unit conversions from Units.hpp against the same conversion
+//  written by hand as one multiply-add, and against chaining the helpers
+//  in UnitConversion.h. Typed and hand-written kernels should time the
+//  same and give identical results; each kernel is kept out of line so
+//  objdump -dC shows them side by side.
+//
+//  c++ -std=c++17 -O2 -I.. UnitsBench.cpp
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Units.hpp"
+#include "UnitConversion.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#define SAMPLE_COUNT 1000000
+#define REPEATS 50
+
+#if defined(__GNUC__) || defined(__clang__)
+#define KERNEL __attribute__((noinline)) static void
+#else
+#define KERNEL static void
+#endif
+
+using namespace compulations::units;
+
+typedef void (*Kernel)(const double *, double *, size_t);
+
+// Fahrenheit to Celsius
+KERNEL celsiusTyped(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = Quantity<Celsius>(Quantity<Fahrenheit>(input[i])).value();
+    }
+}
+
+KERNEL celsiusHand(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = input[i] * (1.0 / 1.8) + (-32.0 / 1.8);
+    }
+}
+
+KERNEL celsiusChained(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = celsiusFromFahrenheit(input[i]);
+    }
+}
+
+// Kelvin to Fahrenheit
+KERNEL fahrenheitTyped(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = Quantity<Fahrenheit>(Quantity<Kelvin>(input[i])).value();
+    }
+}
+
+KERNEL fahrenheitHand(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = input[i] * 1.8 + -459.67;
+    }
+}
+
+KERNEL fahrenheitChained(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = fahrenheitFromCelsius(celsiusFromKelvin(input[i]));
+    }
+}
+
+// Bar to kPa
+KERNEL kPaTyped(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = Quantity<KPa>(Quantity<Bar>(input[i])).value();
+    }
+}
+
+KERNEL kPaHand(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = input[i] * (14.503773773020923 / 0.14503773773020923);
+    }
+}
+
+KERNEL kPaChained(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = kPaFromPSI(psiFromBar(input[i]));
+    }
+}
+
+// Liters to cubic feet
+KERNEL cubicFeetTyped(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = Quantity<CubicFeet>(Quantity<Liters>(input[i])).value();
+    }
+}
+
+KERNEL cubicFeetHand(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = input[i] * (1.0 / (3.78541178 * 7.48051948));
+    }
+}
+
+KERNEL cubicFeetChained(const double *input, double *output, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = cubicFeetFromGallons(gallonsFromLiters(input[i]));
+    }
+}
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double timeKernel(Kernel kernel, const double *input, double *output)
+{
+    double best = 1e30;
+
+    for (int r = 0; r < REPEATS; r++)
+    {
+        double start = secondsNow();
+        kernel(input, output, SAMPLE_COUNT);
+        double elapsed = secondsNow() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+
+    return best * 1e9 / SAMPLE_COUNT;
+}
+
+static void compare(const char *name, Kernel typed, Kernel hand, Kernel chained, const double *input,
+                    double *typedOutput, double *handOutput, double *chainedOutput)
+{
+    double typedNS = timeKernel(typed, input, typedOutput);
+    double handNS = timeKernel(hand, input, handOutput);
+    double chainedNS = timeKernel(chained, input, chainedOutput);
+
+    int identical = memcmp(typedOutput, handOutput, SAMPLE_COUNT * sizeof(double)) == 0;
+    double maxRelative = 0.0;
+
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        if (chainedOutput[i] != 0.0)
+        {
+            maxRelative = fmax(maxRelative, fabs(typedOutput[i] - chainedOutput[i]) / fabs(chainedOutput[i]));
+        }
+    }
+
+    printf("%-20s %8.3f %8.3f %8.3f   %-9s %10.3g\n", name, typedNS, handNS, chainedNS,
+           identical ? "yes" : "NO", maxRelative);
+}
+
+int main(void)
+{
+    double *input = (double *)malloc(SAMPLE_COUNT * sizeof(double));
+    double *typedOutput = (double *)malloc(SAMPLE_COUNT * sizeof(double));
+    double *handOutput = (double *)malloc(SAMPLE_COUNT * sizeof(double));
+    double *chainedOutput = (double *)malloc(SAMPLE_COUNT * sizeof(double));
+
+    // Readings from sub-zero ambient to hot discharge, in each source unit's
+    // own scale; the spread matters more than the exact range.
+    srand(7);
+
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        input[i] = 1.0 + 400.0 * (rand() / (double)RAND_MAX);
+    }
+
+    printf("ns/value             typed     hand  chained   identical  vs chained\n");
+    compare("fahrenheit->celsius", celsiusTyped, celsiusHand, celsiusChained, input, typedOutput, handOutput, chainedOutput);
+    compare("kelvin->fahrenheit", fahrenheitTyped, fahrenheitHand, fahrenheitChained, input, typedOutput, handOutput, chainedOutput);
+    compare("bar->kPa", kPaTyped, kPaHand, kPaChained, input, typedOutput, handOutput, chainedOutput);
+    compare("liters->cubic feet", cubicFeetTyped, cubicFeetHand, cubicFeetChained, input, typedOutput, handOutput, chainedOutput);
+
+    free(input);
+    free(typedOutput);
+    free(handOutput);
+    free(chainedOutput);
+
+    return 0;
+}
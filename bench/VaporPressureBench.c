@@ -0,0 +1,124 @@
+//
+//  VaporPressureBench.c
+//
+//  Sweeps vaporPressureOfWaterInPsiForTempFast against the Antoine version
+//  from -40 to 374 C, checks the documented error bounds and times both.
+//  Exits 1 if a bound is exceeded.
+//
+//  cc -O2 -I.. VaporPressureBench.c ../Compulations.c ../CompulationsInstrumentation.c -lm -lpthread
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Compulations.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SAMPLE_COUNT 1000000
+#define REPEATS 20
+
+// Sweep step in C, well under the table's 1 C segments
+#define SWEEP_STEP_C 0.0005
+
+// Documented in Compulations.h
+#define WARM_BOUND 4e-9
+#define COLD_BOUND 2.2e-8
+
+static double secondsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Keeps the optimizer from dropping the timed loops
+static volatile double sink;
+
+static void timeScalar(const char *name, double (*function)(double), const double *input)
+{
+    double sum = 0.0;
+    double start = secondsNow();
+
+    for (int r = 0; r < REPEATS; r++)
+    {
+        for (int i = 0; i < SAMPLE_COUNT; i++)
+        {
+            sum += function(input[i]);
+        }
+    }
+
+    double ns = (secondsNow() - start) * 1e9 / ((double)SAMPLE_COUNT * REPEATS);
+    sink = sum;
+    printf("%-36s %8.2f ns/call\n", name, ns);
+}
+
+int main(void)
+{
+    double *fahrenheit = malloc(SAMPLE_COUNT * sizeof(double));
+
+    srand(3);
+
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        fahrenheit[i] = (-40.0 + 414.0 * (rand() / (double)RAND_MAX)) * 1.8 + 32.0;
+    }
+
+    printf("Speed\n");
+    timeScalar("vaporPressureOfWaterInPsiForTemp", vaporPressureOfWaterInPsiForTemp, fahrenheit);
+    timeScalar("vaporPressureOfWaterInPsiForTempFast", vaporPressureOfWaterInPsiForTempFast, fahrenheit);
+
+    // Worst relative error above and below 1 C, where the bound changes
+    double warmWorst = 0.0, warmAtC = 0.0, coldWorst = 0.0, coldAtC = 0.0;
+    long steps = lround(414.0 / SWEEP_STEP_C);
+
+    for (long s = 0; s <= steps; s++)
+    {
+        double celsius = -40.0 + s * SWEEP_STEP_C;
+        double degreesF = celsius * 1.8 + 32.0;
+        double exact = vaporPressureOfWaterInPsiForTemp(degreesF);
+        double relative = fabs(vaporPressureOfWaterInPsiForTempFast(degreesF) - exact) / exact;
+
+        if (celsius >= 1.0 && !(relative <= warmWorst))
+        {
+            warmWorst = relative;
+            warmAtC = celsius;
+        }
+        else if (celsius < 1.0 && !(relative <= coldWorst))
+        {
+            coldWorst = relative;
+            coldAtC = celsius;
+        }
+    }
+
+    int failed = !(warmWorst <= WARM_BOUND) || !(coldWorst <= COLD_BOUND);
+
+    printf("\nAccuracy, %ld points\n", steps + 1);
+    printf("1 to 374 C                           max relative error %.3g at %.4f C (bound %.3g)\n",
+           warmWorst, warmAtC, WARM_BOUND);
+    printf("-40 to 1 C                           max relative error %.3g at %.4f C (bound %.3g)\n",
+           coldWorst, coldAtC, COLD_BOUND);
+    printf("%s\n", failed ? "FAIL" : "ok");
+
+    free(fahrenheit);
+
+    return failed;
+}
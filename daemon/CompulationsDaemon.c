@@ -0,0 +1,97 @@
+//
+//  CompulationsDaemon.c
+//
+//  compulationsd: serves the function table on a Unix domain socket until
+//  SIGINT or SIGTERM, then prints the latency it saw.
+//
+//  compulationsd [--socket path] [--threads N]
+//
+/*
+ Copyright (c) 2016 Mike Diehl - ifixcompressors@gmail.com
+
+ This file is part of Compulations.
+
+ Compulations is free software: you can redistribute it and/or modify
+ it under the terms of the GNU LESSER GENERAL PUBLIC LICENSE as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Compulations is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU LESSER GENERAL PUBLIC LICENSE
+ along with Compulations.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CalculationDaemon.h"
+#include "ThreadPool.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static CalculationDaemon *runningDaemon;
+
+static void stopOnSignal(int signalNumber)
+{
+    (void)signalNumber;
+    calculationDaemonStop(runningDaemon);
+}
+
+int main(int argc, char **argv)
+{
+    const char *socketPath = "/tmp/compulations.sock";
+    size_t threads = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+        {
+            socketPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = (size_t)atol(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--socket path] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    ThreadPool *pool = threadPoolCreate(threads);
+    runningDaemon = pool ? calculationDaemonCreate(socketPath, pool) : NULL;
+
+    if (!runningDaemon)
+    {
+        perror(socketPath);
+        threadPoolDestroy(pool);
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stopOnSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "compulationsd: %s, %zu threads\n", socketPath, threadPoolSize(pool));
+
+    int status = calculationDaemonRun(runningDaemon);
+
+    DaemonStatsReply stats;
+    calculationDaemonStats(runningDaemon, &stats);
+    fprintf(stderr, "compulationsd: %llu batches, %llu values, p50 %.1f us, p99 %.1f us, max %.1f us\n",
+            (unsigned long long)stats.requests, (unsigned long long)stats.values, stats.p50Microseconds,
+            stats.p99Microseconds, stats.maxMicroseconds);
+
+    calculationDaemonDestroy(runningDaemon);
+    threadPoolDestroy(pool);
+
+    return status == 0 ? 0 : 1;
+}